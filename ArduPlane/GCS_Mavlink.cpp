@@ -548,6 +548,42 @@ const AP_Param::GroupInfo GCS_MAVLINK_Parameters::var_info[] = {
     // @Increment: 1
     // @User: Advanced
     AP_GROUPINFO("ADSB",   9, GCS_MAVLINK_Parameters, streamRates[9],  5),
+
+#if HAL_GCS_STREAM_SCHEDULER_ENABLED
+    // @Param: SCHED
+    // @DisplayName: Stream scheduler
+    // @Description: Selects how stream-rated messages are scheduled on this link. Fixed intervals send each message at its stream rate, slowed down when the radio reports its buffer filling. Adaptive measures the throughput of the link and shares a target fraction of it between messages, giving flight-critical messages priority
+    // @Values: 0:Fixed intervals,1:Adaptive
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("SCHED",   10, GCS_MAVLINK_Parameters, sched_mode,  0),
+
+    // @Param: UTIL
+    // @DisplayName: Adaptive stream scheduler link utilisation
+    // @Description: Fraction of the measured link throughput the adaptive stream scheduler aims to use. Parameters, mission items and file transfers count towards this
+    // @Units: %
+    // @Range: 10 100
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("UTIL",    11, GCS_MAVLINK_Parameters, sched_util,  80),
+#endif
+
+    // @Param: MIS_WIN
+    // @DisplayName: Mission upload window
+    // @Description: Number of mission, fence or rally items requested at once while a ground station uploads them on this link. Items may then arrive in any order and only missing items are requested again. 1 requests one item at a time, which all ground stations support
+    // @Range: 1 32
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("MIS_WIN", 12, GCS_MAVLINK_Parameters, mission_window,  1),
+
+#if HAL_GCS_COMPACT_STATE_ENABLED
+    // @Param: CSTATE
+    // @DisplayName: Compact state fields
+    // @Description: Fields sent in the compact state stream on this link, packed into one DATA96 message per tick with a single timestamp. The rate is set by requesting DATA96 with MAV_CMD_SET_MESSAGE_INTERVAL. Fields which don't fit in the 96 bytes after those before them are left out; the layout is described by a schema DATA96 sent when it changes and every 5 seconds
+    // @Bitmask: 0:Attitude,1:Body rates,2:Quaternion,3:IMU accel,4:IMU gyro,5:Position NED,6:Velocity NED,7:Location,8:EKF variances,9:Wind
+    // @User: Advanced
+    AP_GROUPINFO("CSTATE",  13, GCS_MAVLINK_Parameters, cstate_fields,  0),
+#endif
     AP_GROUPEND
 };
 
@@ -1,5 +1,6 @@
 #include "DataFlashFileReader.h"
 #include <AP_Filesystem/AP_Filesystem.h>
+#include <AP_Math/AP_Math.h>
 
 #include <fcntl.h>
 #include <string.h>
@@ -9,6 +10,11 @@
 #include <time.h>
 #include <cinttypes>
 
+#if LOGREADER_MMAP_ENABLED
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #ifndef PRIu64
 #define PRIu64 "llu"
 #endif
@@ -19,20 +25,207 @@ AP_LoggerFileReader::AP_LoggerFileReader()
 AP_LoggerFileReader::~AP_LoggerFileReader()
 {
     ::printf("Replay counts: %" PRIu64 " bytes  %u entries\n", bytes_read, message_count);
+    if (fd != -1) {
+        AP::FS().close(fd);
+    }
+    delete[] pending;
+#if HAL_LOGGER_COLUMNAR_ENABLED
+    delete[] chunk_payload;
+    delete[] chunk_scratch;
+#endif
+#if LOGREADER_MMAP_ENABLED
+    if (map != nullptr) {
+        munmap(map, map_length);
+    }
+#endif
 }
 
 bool AP_LoggerFileReader::open_log(const char *logfile)
 {
+#if LOGREADER_MMAP_ENABLED
+    if (use_mmap && map_log(logfile)) {
+        return true;
+    }
+#endif
     fd = AP::FS().open(logfile, O_RDONLY);
     if (fd == -1) {
         return false;
     }
+#if HAL_LOGGER_COLUMNAR_ENABLED
+    pending = new uint8_t[AP_Logger_Columnar::CHUNK_SIZE];
+    chunk_payload = new uint8_t[AP_Logger_Columnar::CHUNK_SIZE];
+    chunk_scratch = new uint8_t[AP_Logger_Columnar::CHUNK_SIZE];
+    if (pending == nullptr || chunk_payload == nullptr || chunk_scratch == nullptr) {
+        return false;
+    }
+
+    // columnar logs start with a magic number; anything else is a
+    // raw log and the bytes we peeked at are its first message
+    uint8_t magic[sizeof(AP_Logger_Columnar::file_magic)];
+    const ssize_t n = AP::FS().read(fd, magic, sizeof(magic));
+    if (n == ssize_t(sizeof(magic)) &&
+        memcmp(magic, AP_Logger_Columnar::file_magic, sizeof(magic)) == 0) {
+        columnar = true;
+        ::printf("Columnar log format\n");
+    } else if (n > 0) {
+        memcpy(pending, magic, n);
+        pending_length = n;
+    }
+#endif
+    return true;
+}
+
+#if LOGREADER_MMAP_ENABLED
+/*
+  map a raw log into memory so messages can be handled without
+  copying them. The map is private and writable so a handler that
+  changes a message only changes its own copy of the page. Columnar
+  logs are left to the read() path, which decodes them a chunk at a
+  time
+ */
+bool AP_LoggerFileReader::map_log(const char *logfile)
+{
+    const int mfd = ::open(logfile, O_RDONLY|O_CLOEXEC);
+    if (mfd == -1) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(mfd, &st) != 0 || st.st_size < 3) {
+        ::close(mfd);
+        return false;
+    }
+    void *p = mmap(nullptr, st.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE, mfd, 0);
+    ::close(mfd);
+    if (p == MAP_FAILED) {
+        return false;
+    }
+    map = (uint8_t *)p;
+    map_length = st.st_size;
+    map_offset = 0;
+    prefetch_end = 0;
+
+#if HAL_LOGGER_COLUMNAR_ENABLED
+    if (map_length >= sizeof(AP_Logger_Columnar::file_magic) &&
+        memcmp(map, AP_Logger_Columnar::file_magic, sizeof(AP_Logger_Columnar::file_magic)) == 0) {
+        munmap(map, map_length);
+        map = nullptr;
+        return false;
+    }
+#endif
+
+    madvise(map, map_length, MADV_SEQUENTIAL);
+    prefetch();
+    return true;
+}
+
+/*
+  ask the kernel to start reading the next window of the log once we
+  are half way through the last one, so we don't wait on page faults
+ */
+void AP_LoggerFileReader::prefetch()
+{
+    if (prefetch_end >= map_length || map_offset + prefetch_window/2 < prefetch_end) {
+        return;
+    }
+    const uint64_t len = MIN(uint64_t(prefetch_window), map_length - prefetch_end);
+    madvise(&map[prefetch_end], len, MADV_WILLNEED);
+    prefetch_end += len;
+}
+
+/*
+  handle the next message of a mapped log in place
+ */
+bool AP_LoggerFileReader::update_mapped()
+{
+    if (map_length - map_offset < 3) {
+        return false;
+    }
+    uint8_t *hdr = &map[map_offset];
+    if (hdr[0] != HEAD_BYTE1 || hdr[1] != HEAD_BYTE2) {
+        printf("bad log header\n");
+        return false;
+    }
+    packet_counts[hdr[2]]++;
+    prefetch();
+
+    if (hdr[2] == LOG_FORMAT_MSG) {
+        struct log_Format f;
+        if (map_length - map_offset < sizeof(f)) {
+            return false;
+        }
+        memcpy(&f, hdr, sizeof(f));
+        memcpy(&formats[f.type], &f, sizeof(formats[f.type]));
+        map_offset += sizeof(f);
+        bytes_read += sizeof(f);
+        message_count++;
+        return handle_log_format_msg(f);
+    }
+
+    const struct log_Format &f = formats[hdr[2]];
+    if (f.length == 0) {
+        ::printf("No format defined for type (%d)\n", hdr[2]);
+        exit(1);
+    }
+    if (map_length - map_offset < f.length) {
+        return false;
+    }
+    map_offset += f.length;
+    bytes_read += f.length;
+    message_count++;
+    return handle_msg(f, hdr);
+}
+#endif // LOGREADER_MMAP_ENABLED
+
+#if HAL_LOGGER_COLUMNAR_ENABLED
+/*
+  read and decode the next chunk of a columnar log into pending
+ */
+bool AP_LoggerFileReader::read_chunk()
+{
+    AP_Logger_Columnar::ChunkHeader hdr;
+    if (AP::FS().read(fd, &hdr, sizeof(hdr)) != ssize_t(sizeof(hdr))) {
+        return false;
+    }
+    if (hdr.encoded_length > AP_Logger_Columnar::CHUNK_SIZE ||
+        AP::FS().read(fd, chunk_payload, hdr.encoded_length) != hdr.encoded_length) {
+        return false;
+    }
+    if (!AP_Logger_Columnar::decode_chunk(hdr, chunk_payload, pending, chunk_scratch)) {
+        printf("bad columnar chunk\n");
+        return false;
+    }
+    pending_length = hdr.raw_length;
+    pending_offset = 0;
     return true;
 }
+#endif
 
 ssize_t AP_LoggerFileReader::read_input(void *buffer, const size_t count)
 {
-    uint64_t ret = AP::FS().read(fd, buffer, count);
+    uint8_t *b = (uint8_t *)buffer;
+    size_t ret = 0;
+    while (ret < count) {
+        if (pending_offset < pending_length) {
+            const uint32_t n = MIN(uint32_t(count - ret), pending_length - pending_offset);
+            memcpy(&b[ret], &pending[pending_offset], n);
+            pending_offset += n;
+            ret += n;
+            continue;
+        }
+#if HAL_LOGGER_COLUMNAR_ENABLED
+        if (columnar) {
+            if (!read_chunk()) {
+                break;
+            }
+            continue;
+        }
+#endif
+        const ssize_t n = AP::FS().read(fd, &b[ret], count - ret);
+        if (n <= 0) {
+            break;
+        }
+        ret += n;
+    }
     bytes_read += ret;
     return ret;
 }
@@ -53,6 +246,12 @@ void AP_LoggerFileReader::get_packet_counts(uint64_t dest[])
 
 bool AP_LoggerFileReader::update()
 {
+#if LOGREADER_MMAP_ENABLED
+    if (map != nullptr) {
+        return update_mapped();
+    }
+#endif
+
     uint8_t hdr[3];
     if (read_input(hdr, 3) != 3) {
         return false;
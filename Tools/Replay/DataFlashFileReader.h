@@ -1,9 +1,14 @@
 #pragma once
 
 #include <AP_Logger/AP_Logger.h>
+#include <AP_Logger/AP_Logger_Columnar.h>
 
 #define LOGREADER_MAX_FORMATS 255 // must be >= highest MESSAGE
 
+#ifndef LOGREADER_MMAP_ENABLED
+#define LOGREADER_MMAP_ENABLED HAL_OS_POSIX_IO
+#endif
+
 class AP_LoggerFileReader
 {
 public:
@@ -20,6 +25,14 @@ public:
     void format_type(uint16_t type, char dest[5]);
     void get_packet_counts(uint64_t dest[]);
 
+    // offset in the log of the end of the last message handled. For
+    // columnar logs this is the offset in the decoded messages
+    uint64_t get_bytes_read(void) const { return bytes_read; }
+
+    // read the log with read() rather than mapping it into memory.
+    // Must be called before open_log()
+    void set_use_mmap(bool enable) { use_mmap = enable; }
+
 protected:
     int fd = -1;
 
@@ -28,6 +41,36 @@ protected:
 private:
     ssize_t read_input(void *buf, size_t count);
 
+    bool use_mmap = true;
+
+#if LOGREADER_MMAP_ENABLED
+    // a raw log mapped into memory; messages are handled in place
+    uint8_t *map = nullptr;
+    uint64_t map_length;
+    uint64_t map_offset;
+
+    // end of the part of the map the kernel has been asked to read
+    static const uint32_t prefetch_window = 16*1024*1024;
+    uint64_t prefetch_end;
+
+    bool map_log(const char *logfile);
+    void prefetch();
+    bool update_mapped();
+#endif
+
+    // bytes already read from the file but not yet returned by
+    // read_input; a decoded chunk for columnar logs
+    uint8_t *pending = nullptr;
+    uint32_t pending_length = 0;
+    uint32_t pending_offset = 0;
+
+#if HAL_LOGGER_COLUMNAR_ENABLED
+    bool columnar = false;
+    uint8_t *chunk_payload = nullptr;
+    uint8_t *chunk_scratch = nullptr;
+    bool read_chunk();
+#endif
+
     uint64_t bytes_read = 0;
     uint32_t message_count = 0;
     uint64_t start_micros;
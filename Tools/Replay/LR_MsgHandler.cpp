@@ -1,6 +1,7 @@
 #include "LR_MsgHandler.h"
 #include "LogReader.h"
 #include "Replay.h"
+#include "ReplaySweep.h"
 
 #include <AP_DAL/AP_DAL.h>
 
@@ -39,6 +40,7 @@ void LR_MsgHandler_RFRF::process_message(uint8_t *msgbytes)
     }
 #undef MAP_FLAG
     AP::dal().handle_message(msg, ekf2, ekf3);
+    replay_sweep.handle_frame(msg.frame_types);
 }
 
 void LR_MsgHandler_RFRN::process_message(uint8_t *msgbytes)
@@ -116,11 +118,9 @@ void LR_MsgHandler_RWA2::process_message(uint8_t *msgbytes)
 }
 
 
-void LR_MsgHandler_REV3::process_message(uint8_t *msgbytes)
+static void handle_event(NavEKF3 &ekf3, AP_DAL::Event event)
 {
-    MSG_CREATE(REV3, msgbytes);
-
-    switch ((AP_DAL::Event)msg.event) {
+    switch (event) {
 
     case AP_DAL::Event::resetGyroBias:
         ekf3.resetGyroBias();
@@ -153,6 +153,15 @@ void LR_MsgHandler_REV3::process_message(uint8_t *msgbytes)
         ekf3.checkLaneSwitch();
         break;
     }
+}
+
+void LR_MsgHandler_REV3::process_message(uint8_t *msgbytes)
+{
+    MSG_CREATE(REV3, msgbytes);
+
+    const AP_DAL::Event event = (AP_DAL::Event)msg.event;
+    handle_event(ekf3, event);
+    replay_sweep.for_each_ekf3([&](NavEKF3 &e) { handle_event(e, event); });
 
     if (replay_force_ekf2) {
         LR_MsgHandler_REV2 h{f, ekf2, ekf3};
@@ -168,6 +177,7 @@ void LR_MsgHandler_RSO3::process_message(uint8_t *msgbytes)
     loc.lng = msg.lng;
     loc.alt = msg.alt;
     ekf3.setOriginLLH(loc);
+    replay_sweep.for_each_ekf3([&](NavEKF3 &e) { e.setOriginLLH(loc); });
     if (replay_force_ekf2) {
         LR_MsgHandler_RSO2 h{f, ekf2, ekf3};
         h.process_message(msgbytes);
@@ -178,16 +188,35 @@ void LR_MsgHandler_RWA3::process_message(uint8_t *msgbytes)
 {
     MSG_CREATE(RWA3, msgbytes);
     ekf3.writeDefaultAirSpeed(msg.airspeed);
+    replay_sweep.for_each_ekf3([&](NavEKF3 &e) { e.writeDefaultAirSpeed(msg.airspeed); });
     if (replay_force_ekf2) {
         LR_MsgHandler_RWA2 h{f, ekf2, ekf3};
         h.process_message(msgbytes);
     }
 }
 
+void LR_MsgHandler_RWS3::process_message(uint8_t *msgbytes)
+{
+    MSG_CREATE(RWS3, msgbytes);
+    NavEKF3::WarmStart ws;
+    ws.gyro_bias = msg.gyro_bias;
+    ws.accel_bias = msg.accel_bias;
+    ws.earth_magfield = msg.earth_magfield;
+    ws.body_magfield = msg.body_magfield;
+    ws.yaw = msg.yaw;
+    ws.gyro_bias_var = msg.gyro_bias_var;
+    ws.accel_bias_var = msg.accel_bias_var;
+    ekf3.setWarmStart(msg.imu_index, ws);
+    replay_sweep.for_each_ekf3([&](NavEKF3 &e) { e.setWarmStart(msg.imu_index, ws); });
+}
+
 void LR_MsgHandler_REY3::process_message(uint8_t *msgbytes)
 {
     MSG_CREATE(REY3, msgbytes);
     ekf3.writeEulerYawAngle(msg.yawangle, msg.yawangleerr, msg.timestamp_ms, msg.type);
+    replay_sweep.for_each_ekf3([&](NavEKF3 &e) {
+        e.writeEulerYawAngle(msg.yawangle, msg.yawangleerr, msg.timestamp_ms, msg.type);
+    });
 }
 
 void LR_MsgHandler_RISH::process_message(uint8_t *msgbytes)
@@ -288,30 +317,45 @@ void LR_MsgHandler_ROFH::process_message(uint8_t *msgbytes)
 {
     MSG_CREATE(ROFH, msgbytes);
     AP::dal().handle_message(msg, ekf2, ekf3);
+    replay_sweep.for_each_ekf3([&](NavEKF3 &e) {
+        e.writeOptFlowMeas(msg.rawFlowQuality, msg.rawFlowRates, msg.rawGyroRates, msg.msecFlowMeas, msg.posOffset);
+    });
 }
 
 void LR_MsgHandler_RWOH::process_message(uint8_t *msgbytes)
 {
     MSG_CREATE(RWOH, msgbytes);
     AP::dal().handle_message(msg, ekf2, ekf3);
+    replay_sweep.for_each_ekf3([&](NavEKF3 &e) {
+        e.writeWheelOdom(msg.delAng, msg.delTime, msg.timeStamp_ms, msg.posOffset, msg.radius);
+    });
 }
 
 void LR_MsgHandler_RBOH::process_message(uint8_t *msgbytes)
 {
     MSG_CREATE(RBOH, msgbytes);
     AP::dal().handle_message(msg, ekf2, ekf3);
+    replay_sweep.for_each_ekf3([&](NavEKF3 &e) {
+        e.writeBodyFrameOdom(msg.quality, msg.delPos, msg.delAng, msg.delTime, msg.timeStamp_ms, msg.delay_ms, msg.posOffset);
+    });
 }
 
 void LR_MsgHandler_REPH::process_message(uint8_t *msgbytes)
 {
     MSG_CREATE(REPH, msgbytes);
     AP::dal().handle_message(msg, ekf2, ekf3);
+    replay_sweep.for_each_ekf3([&](NavEKF3 &e) {
+        e.writeExtNavData(msg.pos, msg.quat, msg.posErr, msg.angErr, msg.timeStamp_ms, msg.delay_ms, msg.resetTime_ms);
+    });
 }
 
 void LR_MsgHandler_REVH::process_message(uint8_t *msgbytes)
 {
     MSG_CREATE(REVH, msgbytes);
     AP::dal().handle_message(msg, ekf2, ekf3);
+    replay_sweep.for_each_ekf3([&](NavEKF3 &e) {
+        e.writeExtNavVelData(msg.vel, msg.err, msg.timeStamp_ms, msg.delay_ms);
+    });
 }
 
 #include <AP_AHRS/AP_AHRS.h>
@@ -16,6 +16,10 @@ public:
         // like it.
         process_message(msg);
     }
+
+    // true if the message is an input to the EKFs rather than
+    // sensor data held by the DAL
+    virtual bool feeds_ekf(void) const { return false; }
 };
 
 class LR_MsgHandler_RFRH : public LR_MsgHandler
@@ -34,6 +38,7 @@ public:
         ekf3(_ekf3) {}
     using LR_MsgHandler::LR_MsgHandler;
     virtual void process_message(uint8_t *msg) override = 0;
+    bool feeds_ekf(void) const override { return true; }
 protected:
     NavEKF2 &ekf2;
     NavEKF3 &ekf3;
@@ -125,6 +130,13 @@ public:
     void process_message(uint8_t *msg) override;
 };
 
+class LR_MsgHandler_RWS3 : public LR_MsgHandler_EKF
+{
+public:
+    using LR_MsgHandler_EKF::LR_MsgHandler_EKF;
+    void process_message(uint8_t *msg) override;
+};
+
 class LR_MsgHandler_REY3 : public LR_MsgHandler_EKF
 {
 public:
@@ -2,6 +2,7 @@
 
 #include "MsgHandler.h"
 #include "Replay.h"
+#include "ReplayCheckpoint.h"
 
 #include <stdio.h>
 #include <unistd.h>
@@ -59,6 +60,9 @@ bool LogReader::handle_log_format_msg(const struct log_Format &f)
         return true;
     }
 
+    static const char *seek_copy_types[] = { "PARM", "FMTU", "UNIT", "MULT", NULL };
+    copy_when_seeking[f.type] = in_list(name, seek_copy_types);
+
     // map from format name to a parser subclass:
 	if (streq(name, "PARM")) {
         msgparser[f.type] = new LR_MsgHandler_PARM(formats[f.type]);
@@ -66,6 +70,7 @@ bool LogReader::handle_log_format_msg(const struct log_Format &f)
         msgparser[f.type] = new LR_MsgHandler_RFRH(formats[f.type]);
     } else if (streq(name, "RFRF")) {
         msgparser[f.type] = new LR_MsgHandler_RFRF(formats[f.type], ekf2, ekf3);
+        rfrf_type = f.type;
     } else if (streq(name, "RFRN")) {
         msgparser[f.type] = new LR_MsgHandler_RFRN(formats[f.type]);
     } else if (streq(name, "REV2")) {
@@ -80,6 +85,8 @@ bool LogReader::handle_log_format_msg(const struct log_Format &f)
         msgparser[f.type] = new LR_MsgHandler_RSO3(formats[f.type], ekf2, ekf3);
 	} else if (streq(name, "RWA3")) {
         msgparser[f.type] = new LR_MsgHandler_RWA3(formats[f.type], ekf2, ekf3);
+	} else if (streq(name, "RWS3")) {
+        msgparser[f.type] = new LR_MsgHandler_RWS3(formats[f.type], ekf2, ekf3);
 	} else if (streq(name, "REY3")) {
         msgparser[f.type] = new LR_MsgHandler_REY3(formats[f.type], ekf2, ekf3);
 	} else if (streq(name, "RISH")) {
@@ -132,15 +139,27 @@ bool LogReader::handle_log_format_msg(const struct log_Format &f)
 }
 
 bool LogReader::handle_msg(const struct log_Format &f, uint8_t *msg) {
+    const bool seeking = replay_checkpoint.seeking();
+
     // emit the output as we receive it:
-    AP::logger().WriteBlock(msg, f.length);
+    if (!seeking || copy_when_seeking[f.type]) {
+        AP::logger().WriteBlock(msg, f.length);
+    }
 
     LR_MsgHandler *p = msgparser[f.type];
     if (p == NULL) {
         return true;
     }
 
-    p->process_message(msg);
+    // while seeking to a checkpoint only the DAL is updated; the
+    // EKF state comes from the checkpoint
+    if (!seeking || !p->feeds_ekf()) {
+        p->process_message(msg);
+    }
+
+    if (f.type == rfrf_type) {
+        replay_checkpoint.handle_frame(get_bytes_read(), ekf2, ekf3);
+    }
 
     return true;
 }
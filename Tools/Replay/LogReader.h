@@ -31,6 +31,13 @@ private:
     uint8_t _log_structure_count;
 
     class LR_MsgHandler *msgparser[LOGREADER_MAX_FORMATS] {};
+
+    // type of the frame message, which checkpoints are taken after
+    uint8_t rfrf_type;
+
+    // types that are copied to the output log while seeking to a
+    // checkpoint: the metadata and the parameters
+    bool copy_when_seeking[LOGREADER_MAX_FORMATS] {};
 };
 
 // some vars are difficult to get through the layers
@@ -16,6 +16,8 @@
 #include "Replay.h"
 
 #include "LogReader.h"
+#include "ReplaySweep.h"
+#include "ReplayCheckpoint.h"
 
 #include <stdio.h>
 #include <AP_HAL/utility/getopt_cpp.h>
@@ -131,11 +133,23 @@ void Replay::usage(void)
     ::printf("\t--param-file FILENAME  load parameters from a file\n");
     ::printf("\t--force-ekf2 force enable EKF2\n");
     ::printf("\t--force-ekf3 force enable EKF3\n");
+    ::printf("\t--no-mmap read the log with read() rather than mapping it\n");
+    ::printf("\t--sweep NAME=VALUE[,NAME=VALUE...]  run an extra EKF3 with these parameter overrides\n");
+    ::printf("\t--sweep-file FILENAME  run an extra EKF3 for each line of overrides in a file\n");
+    ::printf("\t--sweep-threads N  number of threads for the sweep EKF3s (default number of CPUs)\n");
+    ::printf("\t--checkpoint SECONDS  save the EKF state to LOGFILE.ckpt every SECONDS of log time\n");
+    ::printf("\t--seek SECONDS  start the EKFs from the last checkpoint at or before SECONDS since boot\n");
 }
 
 enum param_key : uint8_t {
     FORCE_EKF2 = 1,
     FORCE_EKF3,
+    NO_MMAP,
+    SWEEP,
+    SWEEP_FILE,
+    SWEEP_THREADS,
+    CHECKPOINT,
+    SEEK,
 };
 
 void Replay::_parse_command_line(uint8_t argc, char * const argv[])
@@ -147,6 +161,12 @@ void Replay::_parse_command_line(uint8_t argc, char * const argv[])
         {"param-file",      true,   0, 'F'},
         {"force-ekf2",      false,  0, param_key::FORCE_EKF2},
         {"force-ekf3",      false,  0, param_key::FORCE_EKF3},
+        {"no-mmap",         false,  0, param_key::NO_MMAP},
+        {"sweep",           true,   0, param_key::SWEEP},
+        {"sweep-file",      true,   0, param_key::SWEEP_FILE},
+        {"sweep-threads",   true,   0, param_key::SWEEP_THREADS},
+        {"checkpoint",      true,   0, param_key::CHECKPOINT},
+        {"seek",            true,   0, param_key::SEEK},
         {"help",            false,  0, 'h'},
         {0, false, 0, 0}
     };
@@ -182,6 +202,38 @@ void Replay::_parse_command_line(uint8_t argc, char * const argv[])
             replay_force_ekf3 = true;
             break;
 
+        case param_key::NO_MMAP:
+            reader.set_use_mmap(false);
+            break;
+
+        case param_key::SWEEP:
+            if (!replay_sweep.add_config(gopt.optarg)) {
+                exit(1);
+            }
+            break;
+
+        case param_key::SWEEP_FILE:
+            if (!replay_sweep.load_config_file(gopt.optarg)) {
+                exit(1);
+            }
+            break;
+
+        case param_key::SWEEP_THREADS:
+            replay_sweep.set_num_threads(constrain_int32(atoi(gopt.optarg), 1, UINT8_MAX));
+            break;
+
+        case param_key::CHECKPOINT:
+            if (!is_positive(atof(gopt.optarg))) {
+                ::printf("Usage: --checkpoint SECONDS\n");
+                exit(1);
+            }
+            replay_checkpoint.set_interval(atof(gopt.optarg));
+            break;
+
+        case param_key::SEEK:
+            replay_checkpoint.set_seek(atof(gopt.optarg));
+            break;
+
         case 'h':
         default:
             usage();
@@ -226,6 +278,17 @@ void Replay::setup()
         exit(1);
     }
 
+    if (replay_checkpoint.seek_enabled() &&
+        (replay_checkpoint.save_enabled() || replay_sweep.enabled())) {
+        // the sweep filters are not saved in checkpoints
+        ::printf("Cannot seek while saving checkpoints or sweeping\n");
+        exit(1);
+    }
+
+    if (replay_sweep.enabled()) {
+        replay_sweep.init(_vehicle.ekf3);
+    }
+
     if (filename == nullptr) {
 #if CONFIG_HAL_BOARD == HAL_BOARD_CHIBIOS
         // allow replay on stm32
@@ -240,11 +303,13 @@ void Replay::setup()
         ::printf("open(%s): %m\n", filename);
         exit(1);
     }
+    replay_checkpoint.init(filename);
 }
 
 void Replay::loop()
 {
     if (!reader.update()) {
+        replay_sweep.report();
 #if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
     // If we don't tear down the threads then they continue to access
     // global state during object destruction.
@@ -0,0 +1,169 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ReplayCheckpoint.h"
+
+#include <AP_DAL/AP_DAL.h>
+#include <AP_Math/crc.h>
+
+#include <stdlib.h>
+#include <sys/stat.h>
+
+ReplayCheckpoint replay_checkpoint;
+
+void ReplayCheckpoint::init(const char *logfile)
+{
+    if (!save_enabled() && !seek_enabled()) {
+        return;
+    }
+    struct stat st;
+    if (stat(logfile, &st) != 0) {
+        ::printf("stat(%s): %m\n", logfile);
+        exit(1);
+    }
+    char *filename = nullptr;
+    if (asprintf(&filename, "%s.ckpt", logfile) == -1) {
+        exit(1);
+    }
+    if (save_enabled()) {
+        open_for_save(filename, st.st_size);
+    } else {
+        open_for_seek(filename, st.st_size);
+    }
+    free(filename);
+}
+
+void ReplayCheckpoint::open_for_save(const char *filename, uint64_t log_length)
+{
+    file = fopen(filename, "wb");
+    if (file == nullptr) {
+        ::printf("Failed to create %s: %m\n", filename);
+        exit(1);
+    }
+    const FileHeader hdr {
+        file_magic,
+        file_version,
+        log_length,
+    };
+    if (fwrite(&hdr, sizeof(hdr), 1, file) != 1) {
+        ::printf("Failed to write %s\n", filename);
+        exit(1);
+    }
+    ::printf("Saving checkpoints to %s\n", filename);
+}
+
+/*
+  find the last checkpoint at or before the seek time and read its
+  state
+ */
+void ReplayCheckpoint::open_for_seek(const char *filename, uint64_t log_length)
+{
+    FILE *f = fopen(filename, "rb");
+    if (f == nullptr) {
+        ::printf("Failed to open %s: %m\n", filename);
+        exit(1);
+    }
+    FileHeader hdr;
+    if (fread(&hdr, sizeof(hdr), 1, f) != 1 ||
+        hdr.magic != file_magic ||
+        hdr.version != file_version) {
+        ::printf("%s is not a checkpoint file\n", filename);
+        exit(1);
+    }
+    if (hdr.log_length != log_length) {
+        ::printf("%s was saved from a different log\n", filename);
+        exit(1);
+    }
+
+    Entry best {};
+    long best_pos = -1;
+    Entry e;
+    while (fread(&e, sizeof(e), 1, f) == 1 && e.time_us <= seek_us) {
+        best = e;
+        best_pos = ftell(f);
+        if (fseek(f, e.length, SEEK_CUR) != 0) {
+            break;
+        }
+    }
+    if (best_pos == -1) {
+        ::printf("No checkpoint at or before %.1fs in %s\n", seek_us*1.0e-6, filename);
+        exit(1);
+    }
+
+    uint8_t *data = cp.reserve(best.length);
+    if (data == nullptr ||
+        fseek(f, best_pos, SEEK_SET) != 0 ||
+        fread(data, best.length, 1, f) != 1 ||
+        crc_crc32(0, data, best.length) != best.crc) {
+        ::printf("Failed to read checkpoint at %.1fs from %s\n", best.time_us*1.0e-6, filename);
+        exit(1);
+    }
+    fclose(f);
+
+    seek_offset = best.offset;
+    ::printf("Seeking to checkpoint at %.1fs\n", best.time_us*1.0e-6);
+}
+
+void ReplayCheckpoint::handle_frame(uint64_t offset, NavEKF2 &ekf2, NavEKF3 &ekf3)
+{
+    if (seeking()) {
+        if (offset == seek_offset) {
+            restore(ekf2, ekf3);
+        } else if (offset > seek_offset) {
+            ::printf("Checkpoint is not at a frame of the log\n");
+            exit(1);
+        }
+        return;
+    }
+    if (file == nullptr) {
+        return;
+    }
+    const uint64_t now_us = AP::dal().micros64();
+    if (last_save_us != 0 && now_us - last_save_us < interval_us) {
+        return;
+    }
+    last_save_us = now_us;
+    save(offset, ekf2, ekf3);
+}
+
+void ReplayCheckpoint::save(uint64_t offset, NavEKF2 &ekf2, NavEKF3 &ekf3)
+{
+    cp.clear();
+    if (!AP::dal().save_checkpoint(cp, ekf2, ekf3)) {
+        ::printf("Failed to save checkpoint\n");
+        exit(1);
+    }
+    const Entry e {
+        AP::dal().micros64(),
+        offset,
+        cp.get_length(),
+        crc_crc32(0, cp.get_data(), cp.get_length()),
+    };
+    if (fwrite(&e, sizeof(e), 1, file) != 1 ||
+        fwrite(cp.get_data(), cp.get_length(), 1, file) != 1) {
+        ::printf("Failed to write checkpoint\n");
+        exit(1);
+    }
+}
+
+void ReplayCheckpoint::restore(NavEKF2 &ekf2, NavEKF3 &ekf3)
+{
+    if (!AP::dal().load_checkpoint(cp, ekf2, ekf3)) {
+        ::printf("Failed to load checkpoint; it must be saved by the same build with the same parameters\n");
+        exit(1);
+    }
+    seek_offset = 0;
+    ::printf("Resumed at %.1fs\n", AP::dal().micros64()*1.0e-6);
+}
@@ -0,0 +1,97 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  checkpoints for Replay. A run with --checkpoint saves the state of
+  the DAL and the EKFs at the end of a frame every few seconds of log
+  time to LOGFILE.ckpt. A later run with --seek loads the last
+  checkpoint before the time asked for and only handles the sensor
+  messages up to it, so the EKFs start running part way through the
+  log with the state they had in the full replay.
+
+  The EKF state is saved as an image of its memory, so checkpoints
+  are only valid for the same build of Replay, the same log and the
+  same parameters
+ */
+
+#pragma once
+
+#include <AP_DAL/AP_DAL_Checkpoint.h>
+#include <stdio.h>
+
+class NavEKF2;
+class NavEKF3;
+
+class ReplayCheckpoint {
+public:
+    // save a checkpoint every interval_s seconds of log time
+    void set_interval(float interval_s) { interval_us = interval_s * 1.0e6f; }
+
+    // resume from the last checkpoint at or before time_s seconds of
+    // log time
+    void set_seek(float time_s) {
+        seek_us = time_s * 1.0e6f;
+        seek_requested = true;
+    }
+
+    bool save_enabled(void) const { return interval_us > 0; }
+    bool seek_enabled(void) const { return seek_requested; }
+
+    // true until the checkpoint being resumed from is reached. While
+    // seeking only the sensor messages are handled
+    bool seeking(void) const { return seek_offset != 0; }
+
+    // create or read the checkpoint file for logfile. Called once
+    // the parameters have been set up
+    void init(const char *logfile);
+
+    // called after each frame message is handled, with the offset
+    // of the end of the message in the log
+    void handle_frame(uint64_t offset, NavEKF2 &ekf2, NavEKF3 &ekf3);
+
+private:
+    static const uint32_t file_magic = 0x504B4352; // "RCKP"
+    static const uint16_t file_version = 1;
+
+    struct PACKED FileHeader {
+        uint32_t magic;
+        uint16_t version;
+        uint64_t log_length;
+    };
+
+    // each checkpoint is followed by length bytes of state
+    struct PACKED Entry {
+        uint64_t time_us;       // log time of the frame
+        uint64_t offset;        // offset of the end of the frame message
+        uint32_t length;
+        uint32_t crc;
+    };
+
+    uint64_t interval_us;
+    uint64_t last_save_us;
+
+    uint64_t seek_us;
+    bool seek_requested;
+    uint64_t seek_offset;
+
+    FILE *file;
+    AP_DAL_Checkpoint cp;
+
+    void open_for_save(const char *filename, uint64_t log_length);
+    void open_for_seek(const char *filename, uint64_t log_length);
+    void save(uint64_t offset, NavEKF2 &ekf2, NavEKF3 &ekf3);
+    void restore(NavEKF2 &ekf2, NavEKF3 &ekf3);
+};
+
+extern ReplayCheckpoint replay_checkpoint;
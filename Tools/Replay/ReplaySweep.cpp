@@ -0,0 +1,348 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ReplaySweep.h"
+#include "Replay.h"
+
+#include <AP_DAL/AP_DAL.h>
+
+#include <stdio.h>
+#include <unistd.h>
+
+extern const AP_HAL::HAL& hal;
+
+ReplaySweep replay_sweep;
+
+/*
+  parse a list of NAME=VALUE overrides separated by commas or spaces
+ */
+bool ReplaySweep::add_config(const char *overrides)
+{
+    if (num_configs >= REPLAY_SWEEP_MAX_CONFIGS) {
+        ::printf("Too many sweep configurations (max %u)\n", REPLAY_SWEEP_MAX_CONFIGS);
+        return false;
+    }
+    Config &config = configs[num_configs];
+
+    char *list = strdup(overrides);
+    if (list == nullptr) {
+        return false;
+    }
+    // keep the overrides in the order given so the last one of a
+    // name wins
+    user_parameter **tail = &config.overrides;
+    char *saveptr = nullptr;
+    for (char *item = strtok_r(list, ", \t\r\n", &saveptr);
+         item != nullptr;
+         item = strtok_r(nullptr, ", \t\r\n", &saveptr)) {
+        const char *eq = strchr(item, '=');
+        if (eq == nullptr || eq == item || size_t(eq - item) > AP_MAX_NAME_SIZE) {
+            ::printf("Bad sweep override %s: expected NAME=VALUE\n", item);
+            free(list);
+            return false;
+        }
+        user_parameter *u = new user_parameter;
+        strncpy(u->name, item, eq-item);
+        u->value = atof(eq+1);
+        *tail = u;
+        tail = &u->next;
+    }
+    free(list);
+
+    num_configs++;
+    return true;
+}
+
+/*
+  load one configuration from each line of a file. Empty lines and
+  lines starting with # are skipped
+ */
+bool ReplaySweep::load_config_file(const char *filename)
+{
+    FILE *f = fopen(filename, "r");
+    if (f == nullptr) {
+        ::printf("Failed to open sweep file: %s\n", filename);
+        return false;
+    }
+    char line[256];
+    bool ret = true;
+    while (ret && fgets(line, sizeof(line), f)) {
+        const char *p = line + strspn(line, " \t");
+        if (*p == '#' || *p == '\r' || *p == '\n' || *p == 0) {
+            continue;
+        }
+        ret = add_config(p);
+    }
+    fclose(f);
+    return ret;
+}
+
+void ReplaySweep::init(NavEKF3 &ekf3)
+{
+    replayed = &ekf3;
+
+    for (uint8_t i=0; i<num_configs; i++) {
+        Config &config = configs[i];
+        config.ekf3 = new NavEKF3();
+        if (config.ekf3 == nullptr) {
+            ::printf("Failed to allocate sweep EKF3\n");
+            exit(1);
+        }
+        // only the replayed EKF3 writes to the output log
+        config.ekf3->disableLogging();
+
+        for (const user_parameter *u=config.overrides; u; u=u->next) {
+            enum ap_var_type var_type;
+            const AP_Param *vp = AP_Param::find(u->name, &var_type);
+            if (vp == nullptr || config_param(config, vp) == nullptr ||
+                var_type < AP_PARAM_INT8 || var_type > AP_PARAM_FLOAT) {
+                ::printf("Sweep parameter %s is not an EKF3 parameter\n", u->name);
+                exit(1);
+            }
+        }
+    }
+
+    uint8_t n = num_threads;
+    if (n == 0) {
+        n = constrain_int32(sysconf(_SC_NPROCESSORS_ONLN), 1, UINT8_MAX);
+    }
+    n = MIN(n, num_configs);
+    if (n < 2) {
+        return;
+    }
+
+    workers = new Workers;
+    if (workers == nullptr) {
+        return;
+    }
+    pthread_mutex_init(&workers->mutex, nullptr);
+    pthread_cond_init(&workers->start_cond, nullptr);
+    pthread_cond_init(&workers->done_cond, nullptr);
+    // no work until the first frame
+    workers->next = num_configs;
+    for (uint8_t i=1; i<n; i++) {
+        if (!hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&ReplaySweep::worker_thread, void),
+                                          "Sweep",
+                                          65536, AP_HAL::Scheduler::PRIORITY_MAIN, 0)) {
+            ::printf("Failed to start sweep thread\n");
+            break;
+        }
+    }
+    ::printf("Sweeping %u configurations on %u threads\n", num_configs, n);
+}
+
+/*
+  return the parameter of a configuration's EKF3 that is at the same
+  offset as vp is in the replayed EKF3
+ */
+AP_Param *ReplaySweep::config_param(const Config &config, const AP_Param *vp) const
+{
+    const uint8_t *base = (const uint8_t *)replayed;
+    const uint8_t *p = (const uint8_t *)vp;
+    if (p < base || p >= base + sizeof(NavEKF3)) {
+        return nullptr;
+    }
+    return (AP_Param *)((uint8_t *)config.ekf3 + (p - base));
+}
+
+/*
+  copy the parameters of the replayed EKF3, which include any set from
+  the log and on the command line, then apply the overrides
+ */
+void ReplaySweep::set_parameters(Config &config)
+{
+    AP_Param::ParamToken token;
+    enum ap_var_type var_type;
+    for (AP_Param *vp = AP_Param::first(&token, &var_type);
+         vp != nullptr;
+         vp = AP_Param::next_scalar(&token, &var_type)) {
+        AP_Param *dest = config_param(config, vp);
+        if (dest != nullptr) {
+            memcpy((void *)dest, (const void *)vp, AP_Param::type_size(var_type));
+        }
+    }
+
+    for (const user_parameter *u=config.overrides; u; u=u->next) {
+        const AP_Param *vp = AP_Param::find(u->name, &var_type);
+        AP_Param::set_value(var_type, config_param(config, vp), u->value);
+    }
+    config.params_set = true;
+}
+
+void ReplaySweep::handle_frame(uint8_t frame_types)
+{
+    if (!enabled()) {
+        return;
+    }
+    const bool initialise = frame_types & uint8_t(AP_DAL::FrameType::InitialiseFilterEKF3);
+    const bool update = frame_types & uint8_t(AP_DAL::FrameType::UpdateFilterEKF3);
+    if (!initialise && !update) {
+        return;
+    }
+
+    // initialisation touches the parameter table so is done on this
+    // thread
+    for (uint8_t i=0; i<num_configs; i++) {
+        Config &config = configs[i];
+        if (initialise || !config.init_done) {
+            if (!config.params_set) {
+                set_parameters(config);
+            }
+            config.init_done = config.ekf3->InitialiseFilter();
+        }
+    }
+
+    if (update) {
+        update_all();
+    }
+}
+
+/*
+  update one filter and accumulate its innovations
+ */
+void ReplaySweep::update(Config &config)
+{
+    if (!config.init_done) {
+        return;
+    }
+    NavEKF3 &ekf3 = *config.ekf3;
+    ekf3.UpdateFilter();
+
+    float ratio[NUM_RATIOS];
+    Vector3f mag_ratio;
+    Vector2f offset;
+    ekf3.getVariances(-1, ratio[VEL], ratio[POS], ratio[HGT], mag_ratio, ratio[TAS], offset);
+    ratio[MAG] = MAX(MAX(mag_ratio.x, mag_ratio.y), mag_ratio.z);
+
+    Vector3f vel_innov, pos_innov, mag_innov;
+    float tas_innov, yaw_innov;
+    ekf3.getInnovations(-1, vel_innov, pos_innov, mag_innov, tas_innov, yaw_innov);
+
+    Stats &stats = config.stats;
+    stats.frames++;
+    if (!ekf3.healthy()) {
+        stats.unhealthy++;
+    }
+    for (uint8_t r=0; r<NUM_RATIOS; r++) {
+        stats.ratio_sum[r] += ratio[r];
+        stats.ratio_max[r] = MAX(stats.ratio_max[r], ratio[r]);
+        if (ratio[r] > 1.0f) {
+            stats.ratio_fail[r]++;
+        }
+    }
+    stats.vel_innov_sq += vel_innov.length_squared();
+    stats.pos_innov_sq += pos_innov.length_squared();
+}
+
+/*
+  take the next configuration to update. Called with the mutex held
+ */
+bool ReplaySweep::take_config(uint8_t &idx)
+{
+    if (workers->next >= num_configs) {
+        return false;
+    }
+    idx = workers->next++;
+    return true;
+}
+
+void ReplaySweep::worker_thread(void)
+{
+    Workers &w = *workers;
+    pthread_mutex_lock(&w.mutex);
+    while (true) {
+        uint8_t idx;
+        while (!take_config(idx)) {
+            pthread_cond_wait(&w.start_cond, &w.mutex);
+        }
+        pthread_mutex_unlock(&w.mutex);
+
+        update(configs[idx]);
+
+        pthread_mutex_lock(&w.mutex);
+        if (++w.done == num_configs) {
+            pthread_cond_signal(&w.done_cond);
+        }
+    }
+}
+
+/*
+  update all the filters, with this thread taking configurations
+  alongside the workers. Returns once every filter has been updated
+ */
+void ReplaySweep::update_all(void)
+{
+    if (workers == nullptr) {
+        for (uint8_t i=0; i<num_configs; i++) {
+            update(configs[i]);
+        }
+        return;
+    }
+    Workers &w = *workers;
+    pthread_mutex_lock(&w.mutex);
+    w.next = 0;
+    w.done = 0;
+    pthread_cond_broadcast(&w.start_cond);
+    uint8_t idx;
+    while (take_config(idx)) {
+        pthread_mutex_unlock(&w.mutex);
+        update(configs[idx]);
+        pthread_mutex_lock(&w.mutex);
+        w.done++;
+    }
+    while (w.done < num_configs) {
+        pthread_cond_wait(&w.done_cond, &w.mutex);
+    }
+    pthread_mutex_unlock(&w.mutex);
+}
+
+void ReplaySweep::report(void) const
+{
+    if (!enabled()) {
+        return;
+    }
+    static const char *ratio_names[NUM_RATIOS] { "vel", "pos", "hgt", "mag", "tas" };
+
+    ::printf("Sweep summary: normalised innovations as mean/max/%% of frames above 1, innovation RMS in m/s and m\n");
+    ::printf("cfg   frames unhlth");
+    for (uint8_t r=0; r<NUM_RATIOS; r++) {
+        ::printf(" %18s", ratio_names[r]);
+    }
+    ::printf("  velRMS  posRMS  overrides\n");
+
+    for (uint8_t i=0; i<num_configs; i++) {
+        const Config &config = configs[i];
+        const Stats &s = config.stats;
+        if (s.frames == 0) {
+            ::printf("%3u  never initialised", i);
+        } else {
+            ::printf("%3u %8u %5.1f%%", i, (unsigned)s.frames, 100.0 * s.unhealthy / s.frames);
+            for (uint8_t r=0; r<NUM_RATIOS; r++) {
+                ::printf(" %5.2f/%5.2f/%5.1f%%",
+                         s.ratio_sum[r] / s.frames,
+                         s.ratio_max[r],
+                         100.0 * s.ratio_fail[r] / s.frames);
+            }
+            ::printf(" %7.3f %7.3f ", sqrt(s.vel_innov_sq / s.frames), sqrt(s.pos_innov_sq / s.frames));
+        }
+        if (config.overrides == nullptr) {
+            ::printf(" (replayed parameters)");
+        }
+        for (const user_parameter *u=config.overrides; u; u=u->next) {
+            ::printf(" %s=%g", u->name, u->value);
+        }
+        ::printf("\n");
+    }
+}
@@ -0,0 +1,128 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  parameter sweep for Replay. Each configuration runs its own EKF3
+  from the same decoded log, with its own EK3_ parameter overrides on
+  top of the parameters of the EKF3 being replayed. The filters are
+  updated in parallel on worker threads at each frame, and a summary
+  of the innovations of each configuration is printed at the end
+ */
+
+#pragma once
+
+#include <AP_NavEKF3/AP_NavEKF3.h>
+#include <pthread.h>
+
+#define REPLAY_SWEEP_MAX_CONFIGS 32
+
+struct user_parameter;
+
+class ReplaySweep {
+public:
+    // add a configuration given as NAME=VALUE overrides separated by
+    // commas. An empty list gives a copy of the replayed EKF3
+    bool add_config(const char *overrides);
+
+    // add one configuration for each line of a file
+    bool load_config_file(const char *filename);
+
+    // number of threads, including the Replay thread, used to update
+    // the filters. Defaults to the number of CPUs
+    void set_num_threads(uint8_t n) { num_threads = n; }
+
+    bool enabled(void) const { return num_configs > 0; }
+
+    // check the overrides and create the filters, copying parameters
+    // from ekf3. Called once the parameter table has been set up
+    void init(NavEKF3 &ekf3);
+
+    // call fn on the EKF3 of each configuration. Used to pass on
+    // the inputs that Replay gives the replayed EKF3
+    template <typename F>
+    void for_each_ekf3(F fn) {
+        for (uint8_t i=0; i<num_configs; i++) {
+            if (configs[i].ekf3 != nullptr) {
+                fn(*configs[i].ekf3);
+            }
+        }
+    }
+
+    // run the filters for a frame with the frame_types of an RFRF
+    // message
+    void handle_frame(uint8_t frame_types);
+
+    // print the summary for each configuration
+    void report(void) const;
+
+private:
+    // normalised innovations (square root of the test ratios)
+    enum Ratio : uint8_t {
+        VEL = 0,
+        POS,
+        HGT,
+        MAG,
+        TAS,
+        NUM_RATIOS
+    };
+
+    struct Stats {
+        uint32_t frames;            // frames updated since initialisation
+        uint32_t unhealthy;         // frames the filter was unhealthy
+        float ratio_sum[NUM_RATIOS];
+        float ratio_max[NUM_RATIOS];
+        uint32_t ratio_fail[NUM_RATIOS]; // frames with a ratio above 1
+        double vel_innov_sq;        // sum of squared velocity innovations
+        double pos_innov_sq;        // sum of squared position innovations
+    };
+
+    struct Config {
+        user_parameter *overrides;
+        NavEKF3 *ekf3;
+        bool params_set;
+        bool init_done;
+        Stats stats;
+    };
+
+    // the EKF3 being replayed, which the parameters are copied from
+    NavEKF3 *replayed;
+
+    Config configs[REPLAY_SWEEP_MAX_CONFIGS];
+    uint8_t num_configs;
+    uint8_t num_threads;
+
+    // worker threads. The Replay thread sets next to zero to start
+    // a frame, then all threads take configurations in turn until
+    // every filter has been updated
+    struct Workers {
+        pthread_mutex_t mutex;
+        pthread_cond_t start_cond;
+        pthread_cond_t done_cond;
+        uint8_t next;           // next configuration to update
+        uint8_t done;           // configurations updated this frame
+    } *workers;
+
+    // pointer to a parameter of config that is at the same place as
+    // vp is in the replayed EKF3, or nullptr if vp is not an EKF3
+    // parameter
+    AP_Param *config_param(const Config &config, const AP_Param *vp) const;
+
+    void set_parameters(Config &config);
+    void update(Config &config);
+    bool take_config(uint8_t &idx);
+    void worker_thread(void);
+    void update_all(void);
+};
+
+extern ReplaySweep replay_sweep;
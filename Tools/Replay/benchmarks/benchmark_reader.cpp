@@ -0,0 +1,100 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include "../DataFlashFileReader.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+  log reading throughput of Replay, with the log read by read() and
+  with it mapped into memory. The argument selects mmap. A synthetic
+  log is written to /tmp on first use; items/s is messages per second
+  delivered to the handlers
+ */
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+static const char *log_name = "/tmp/benchmark_reader.bin";
+static const uint32_t num_messages = 1000000;
+
+// message types in the log, with lengths similar to IMU, RFRH and RISI
+static const struct {
+    uint8_t type;
+    uint8_t length;
+    const char *name;
+} types[] = {
+    { 200, 44, "BIMU" },
+    { 201, 15, "BFRH" },
+    { 202, 38, "BISI" },
+};
+
+class CountingReader : public AP_LoggerFileReader {
+public:
+    bool handle_log_format_msg(const struct log_Format &f) override {
+        messages++;
+        return true;
+    }
+    bool handle_msg(const struct log_Format &f, uint8_t *msg) override {
+        messages++;
+        sum += msg[f.length-1];
+        return true;
+    }
+    uint32_t messages = 0;
+    uint32_t sum = 0;
+};
+
+static void write_log()
+{
+    if (access(log_name, R_OK) == 0) {
+        return;
+    }
+    FILE *f = fopen(log_name, "wb");
+    if (f == nullptr) {
+        return;
+    }
+    for (const auto &t : types) {
+        struct log_Format fmt {};
+        fmt.head1 = HEAD_BYTE1;
+        fmt.head2 = HEAD_BYTE2;
+        fmt.msgid = LOG_FORMAT_MSG;
+        fmt.type = t.type;
+        fmt.length = t.length;
+        memcpy(fmt.name, t.name, sizeof(fmt.name));
+        fwrite(&fmt, sizeof(fmt), 1, f);
+    }
+    uint8_t msg[256];
+    for (uint32_t i=0; i<num_messages; i++) {
+        const auto &t = types[i % ARRAY_SIZE(types)];
+        msg[0] = HEAD_BYTE1;
+        msg[1] = HEAD_BYTE2;
+        msg[2] = t.type;
+        memset(&msg[3], i, t.length-3);
+        fwrite(msg, t.length, 1, f);
+    }
+    fclose(f);
+}
+
+static void BM_ReadLog(benchmark::State& state)
+{
+    write_log();
+    uint64_t messages = 0;
+    while (state.KeepRunning()) {
+        CountingReader reader;
+        reader.set_use_mmap(state.range(0) != 0);
+        if (!reader.open_log(log_name)) {
+            state.SetLabel("no log");
+            break;
+        }
+        while (reader.update()) {
+        }
+        gbenchmark_escape(&reader.sum);
+        messages += reader.messages;
+    }
+    state.SetItemsProcessed(messages);
+}
+
+BENCHMARK(BM_ReadLog)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
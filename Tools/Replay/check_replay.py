@@ -6,6 +6,9 @@ check that replay produced identical results
 
 from __future__ import print_function
 
+ek2_list = ['NKF1','NKF2','NKF3','NKF4','NKF5','NKF0','NKQ', 'NKY0', 'NKY1']
+ek3_list = ['XKF1','XKF2','XKF3','XKF4','XKF0','XKFS','XKQ','XKFD','XKV1','XKV2','XKY0','XKY1']
+
 def check_log(logfile, progress=print, ekf2_only=False, ekf3_only=False, verbose=False):
     '''check replay log for matching output'''
     from pymavlink import mavutil
@@ -19,9 +22,6 @@ def check_log(logfile, progress=print, ekf2_only=False, ekf3_only=False, verbose
 
     mlog = mavutil.mavlink_connection(logfile)
 
-    ek2_list = ['NKF1','NKF2','NKF3','NKF4','NKF5','NKF0','NKQ', 'NKY0', 'NKY1']
-    ek3_list = ['XKF1','XKF2','XKF3','XKF4','XKF0','XKFS','XKQ','XKFD','XKV1','XKV2','XKY0','XKY1']
-    
     if ekf2_only:
         mlist = ek2_list
     elif ekf3_only:
@@ -75,6 +75,76 @@ def check_log(logfile, progress=print, ekf2_only=False, ekf3_only=False, verbose
         return False
     return True
 
+def log_time_range(logfile):
+    '''return the first and last TimeUS in a log'''
+    from pymavlink import mavutil
+    mlog = mavutil.mavlink_connection(logfile)
+    first = None
+    last = None
+    while True:
+        m = mlog.recv_match()
+        if m is None:
+            break
+        t = getattr(m, 'TimeUS', None)
+        if t is None:
+            continue
+        if first is None:
+            first = t
+        last = t
+    return (first, last)
+
+def replay_output(logfile):
+    '''return the EKF messages written by replay, keyed by type, core and time'''
+    from pymavlink import mavutil
+    mlog = mavutil.mavlink_connection(logfile)
+    ret = {}
+    while True:
+        m = mlog.recv_match(type=ek2_list+ek3_list)
+        if m is None:
+            break
+        if not hasattr(m,'C') or m.C < 100:
+            continue
+        ret[(m.get_type(), m.C, m.TimeUS)] = m
+    return ret
+
+def check_seek(full_logfile, seek_logfile, progress=print, verbose=False):
+    '''check that a replay started with --seek matches a full replay of
+    the same log from the checkpoint it resumed at'''
+    progress("Comparing %s with %s" % (seek_logfile, full_logfile))
+    full = replay_output(full_logfile)
+    seek = replay_output(seek_logfile)
+    if len(seek) == 0:
+        progress("No replay output after seeking")
+        return False
+    start = min([k[2] for k in seek.keys()])
+    if start <= min([k[2] for k in full.keys()]):
+        progress("Replay did not seek")
+        return False
+    errors = 0
+    for k in sorted(full.keys(), key=lambda x : x[2]):
+        if k[2] < start:
+            continue
+        if not k in seek:
+            errors += 1
+            progress("Missing %s core %u at %u" % k)
+            continue
+        m1 = full[k]
+        m2 = seek[k]
+        for f in m1._fieldnames:
+            if getattr(m1,f) != getattr(m2,f):
+                errors += 1
+                progress("Mismatch in field %s.%s: %s %s" % (k[0], f, str(getattr(m2,f)), str(getattr(m1,f))))
+    extra = len([k for k in seek.keys() if not k in full])
+    if extra != 0:
+        errors += 1
+        progress("%u messages after seeking are not in the full replay" % extra)
+    count = len([k for k in full.keys() if k[2] >= start])
+    progress("Seek started at %.1fs, compared %u messages, %u errors" % (start*1.0e-6, count, errors))
+    if verbose:
+        for mtype in sorted(set([k[0] for k in seek.keys()])):
+            progress("%s %u" % (mtype, len([k for k in seek.keys() if k[0] == mtype])))
+    return errors == 0
+
 if __name__ == '__main__':
     import sys
     from argparse import ArgumentParser
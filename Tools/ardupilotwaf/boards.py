@@ -453,6 +453,7 @@ class sitl(Board):
         ]
 
         cfg.check_librt(env)
+        cfg.check_librt_shm(env)
         cfg.check_feenableexcept()
 
         env.LINKFLAGS += ['-pthread',]
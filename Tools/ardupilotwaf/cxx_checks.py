@@ -169,6 +169,37 @@ def check_librt(cfg, env):
 
     return ret
 
+@conf
+def check_librt_shm(cfg, env):
+    '''shm_open is used by the SITL SharedMem backend and lives in librt on
+    older glibc, even where clock_gettime does not'''
+    if cfg.env.DEST_OS == 'darwin':
+        return True
+
+    ret = cfg.check(
+        compiler='cxx',
+        fragment='''
+        #include <fcntl.h>
+        #include <sys/mman.h>
+
+        int main() {
+            return shm_open("/ardupilot", O_RDONLY, 0);
+        }''',
+        msg='Checking for need to link with librt for shm_open',
+        okmsg='not necessary',
+        errmsg='necessary',
+        mandatory=False,
+    )
+
+    if ret:
+        return ret
+
+    ret = cfg.check(compiler='cxx', lib='rt')
+    if ret and 'rt' not in env.LIB:
+        env.LIB += cfg.env['LIB_RT']
+
+    return ret
+
 @conf
 def check_feenableexcept(cfg):
 
@@ -5838,6 +5838,60 @@ class AutoTestCopter(AutoTest):
         if ex is not None:
             raise ex
 
+    def test_ekf3_warm_start(self):
+        '''check that a lane seeded from a warm start keeps its yaw
+        through tilt alignment'''
+        self.context_push()
+        ex = None
+        try:
+            self.set_parameters({
+                "EK3_ENABLE": 1,
+                "AHRS_EKF_TYPE": 3,
+                "EK3_OPTIONS": 2,
+                "LOG_DISARMED": 1,
+            })
+            self.reboot_sitl()
+            self.wait_ready_to_arm()
+            self.arm_vehicle()
+            self.delay_sim_time(5)
+            self.disarm_vehicle()
+            # the states are saved a few seconds after disarming
+            self.delay_sim_time(10)
+            yaw = math.degrees(self.assert_receive_message('ATTITUDE', timeout=2).yaw)
+
+            self.reboot_sitl()
+            self.wait_ready_to_arm()
+            self.delay_sim_time(10)
+            new_yaw = math.degrees(self.assert_receive_message('ATTITUDE', timeout=2).yaw)
+
+            dfreader = self.dfreader_for_current_onboard_log()
+            messages = []
+            while True:
+                m = dfreader.recv_match(type='MSG')
+                if m is None:
+                    break
+                messages.append(m.Message)
+            if "EKF3 IMU0 warm start with yaw" not in messages:
+                raise NotAchievedException("EKF3 was not warm started with yaw")
+            if "EKF3 IMU0 tilt alignment complete" not in messages:
+                raise NotAchievedException("EKF3 did not complete tilt alignment")
+            if "EKF3 IMU0 initial yaw alignment complete" in messages:
+                raise NotAchievedException("Seeded yaw was replaced on alignment")
+            yaw_change = (new_yaw - yaw + 180) % 360 - 180
+            self.progress("Yaw %.1f before reboot, %.1f after" % (yaw, new_yaw))
+            if abs(yaw_change) > 2:
+                raise NotAchievedException("Yaw changed by %.1f degrees" % yaw_change)
+
+        except Exception as e:
+            self.disarm_vehicle(force=True)
+            self.progress("Caught exception: %s" %
+                          self.get_exception_stacktrace(e))
+            ex = e
+        self.context_pop()
+        self.reboot_sitl()
+        if ex is not None:
+            raise ex
+
     def test_replay_gps_bit(self):
         self.set_parameters({
             "LOG_REPLAY": 1,
@@ -5922,10 +5976,38 @@ class AutoTestCopter(AutoTest):
         self.progress("Building Replay")
         util.build_SITL('tools/Replay', clean=False, configure=False)
 
-        self.test_replay_bit(self.test_replay_gps_bit)
-        self.test_replay_bit(self.test_replay_beacon_bit)
+        gps_log = self.test_replay_bit(self.test_replay_gps_bit)
+        beacon_log = self.test_replay_bit(self.test_replay_beacon_bit)
         self.test_replay_bit(self.test_replay_optical_flow_bit)
 
+        # start part way through the logs from a checkpoint, with and
+        # without beacon data and the GSF yaw estimators
+        no_gsf = ['--parm', 'EK2_GSF_RUN_MASK=0', '--parm', 'EK3_GSF_RUN_MASK=0']
+        for log_filepath in gps_log, beacon_log:
+            self.test_replay_seek_bit(log_filepath)
+            self.test_replay_seek_bit(log_filepath, no_gsf)
+
+    def test_replay_seek_bit(self, log_filepath, extra_args=[]):
+        '''check that replay started with --seek gives the same EKF2
+        and EKF3 output as a full replay from the same checkpoint'''
+        check_replay = util.load_local_module("Tools/Replay/check_replay.py")
+        args = ['--force-ekf2', '--force-ekf3'] + extra_args
+
+        self.progress("Running replay with checkpoints on (%s)" % log_filepath)
+        util.run_cmd(['build/sitl/tools/Replay', '--checkpoint', '5'] + args + [log_filepath],
+                     directory=util.topdir(), checkfail=True, show=True)
+        full_log_filepath = self.current_onboard_log_filepath()
+
+        (first_us, last_us) = check_replay.log_time_range(log_filepath)
+        seek_s = (first_us + last_us) * 0.5e-6
+        self.progress("Running replay from %.1fs on (%s)" % (seek_s, log_filepath))
+        util.run_cmd(['build/sitl/tools/Replay', '--seek', str(seek_s)] + args + [log_filepath],
+                     directory=util.topdir(), checkfail=True, show=True)
+        seek_log_filepath = self.current_onboard_log_filepath()
+
+        if not check_replay.check_seek(full_log_filepath, seek_log_filepath, self.progress, verbose=True):
+            raise NotAchievedException("check_seek failed")
+
     def test_replay_bit(self, bit):
 
         self.context_push()
@@ -5947,6 +6029,8 @@ class AutoTestCopter(AutoTest):
         if not ok:
             raise NotAchievedException("check_replay failed")
 
+        return current_log_filepath
+
     # a wrapper around all the 1A,1B,1C..etc tests for travis
     def tests1(self):
         ret = ([])
@@ -6315,6 +6399,10 @@ class AutoTestCopter(AutoTest):
                  "Check EKF Source Prearms work",
                  self.test_ekf_source),
 
+            Test("EKF3WarmStart",
+                 "Check EKF3 keeps a warm started yaw",
+                 self.test_ekf3_warm_start),
+
             Test("DataFlash",
                  "Test DataFlash Block backend",
                  self.test_dataflash_sitl),
@@ -3,7 +3,7 @@
 unpack a param.pck file from @PARAM/param.pck via mavlink FTP
 '''
 
-import struct, sys
+import struct, sys, zlib
 
 from argparse import ArgumentParser
 parser = ArgumentParser(description=__doc__)
@@ -14,16 +14,25 @@ args = parser.parse_args()
 data = open(args.file,'rb').read()
 last_name = ""
 
+# fetched with deflate=1
+if bytearray(data[0:1]) == bytearray([0x28]):
+    data = zlib.decompress(data)
+
 magic = 0x671b
+magic_gen = 0x671c
 
-# header of 6 bytes
+# header of 6 bytes, or 16 bytes when fetched with since=N
 magic2,num_params,total_params = struct.unpack("<HHH", data[0:6])
-if magic != magic2:
+if magic2 == magic_gen:
+    flags,generation,crc = struct.unpack("<HII", data[6:16])
+    print("generation %u crc %u%s" % (generation, crc, " (changes only)" if flags & 1 else ""))
+    data = data[16:]
+elif magic2 == magic:
+    data = data[6:]
+else:
     print("Bad magic 0x%x expected 0x%x" % (magic2, magic))
     sys.exit(1)
 
-data = data[6:]
-
 # mapping of data type to type length and format
 data_types = {
     1: (1, 'b'),
@@ -20,7 +20,7 @@
 #include <AP_Logger/AP_Logger.h>
 
 #define OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK  32      // expanding arrays for fence points and paths to destination will grow in increments of 20 elements
-#define OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX        255     // index use to indicate we do not have a tentative short path for a node
+#define OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX        65535   // index use to indicate we do not have a tentative short path for a node
 #define OA_DIJKSTRA_ERROR_REPORTING_INTERVAL_MS         5000    // failure messages sent to GCS every 5 seconds
 
 /// Constructor
@@ -29,10 +29,18 @@ AP_OADijkstra::AP_OADijkstra() :
         _exclusion_polygon_pts(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
         _exclusion_circle_pts(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
         _short_path_data(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
+        _short_path_heap(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
         _path(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK)
 {
 }
 
+AP_OADijkstra::~AP_OADijkstra()
+{
+    delete[] _fence_visgraph_pts;
+    delete[] _fence_visgraph_items;
+    delete[] _fence_visgraph_bits;
+}
+
 // calculate a destination to avoid fences
 // returns DIJKSTRA_STATE_SUCCESS and populates origin_new and destination_new if avoidance is required
 AP_OADijkstra::AP_OADijkstra_State AP_OADijkstra::update(const Location &current_loc, const Location &destination, Location& origin_new, Location& destination_new)
@@ -160,7 +168,7 @@ AP_OADijkstra::AP_OADijkstra_State AP_OADijkstra::update(const Location &current
             _path_idx_returned++;
         }
         // log success
-        AP::logger().Write_OADijkstra(DIJKSTRA_STATE_SUCCESS, 0, _path_idx_returned, _path_numpoints, destination, destination_new);
+        AP::logger().Write_OADijkstra(DIJKSTRA_STATE_SUCCESS, 0, MIN(_path_idx_returned, UINT8_MAX), MIN(_path_numpoints, UINT8_MAX), destination, destination_new);
         return DIJKSTRA_STATE_SUCCESS;
     }
 
@@ -587,7 +595,121 @@ bool AP_OADijkstra::intersects_fence(const Vector2f &seg_start, const Vector2f &
     return false;
 }
 
+// get all lines and circles of the polygon fence.  items is allocated by this function
+// returns true on success
+bool AP_OADijkstra::get_fence_items(FenceItem *&items, uint16_t &num_items) const
+{
+    const AC_Fence *fence = AC_Fence::get_singleton();
+    if (fence == nullptr) {
+        return false;
+    }
+    const AC_PolyFence_loader &polyfence = fence->polyfence();
+    const uint8_t num_inclusion_polygons = polyfence.get_inclusion_polygon_count();
+    const uint8_t num_exclusion_polygons = polyfence.get_exclusion_polygon_count();
+    const uint8_t num_inclusion_circles = polyfence.get_inclusion_circle_count();
+    const uint8_t num_exclusion_circles = polyfence.get_exclusion_circle_count();
+
+    // count items
+    uint32_t count = num_inclusion_circles + num_exclusion_circles;
+    for (uint16_t i = 0; i < num_inclusion_polygons + num_exclusion_polygons; i++) {
+        uint16_t num_points = 0;
+        const Vector2f* boundary = (i < num_inclusion_polygons) ? polyfence.get_inclusion_polygon(i, num_points) : polyfence.get_exclusion_polygon(i - num_inclusion_polygons, num_points);
+        if (boundary != nullptr) {
+            count += num_points;
+        }
+    }
+    if (count > UINT16_MAX) {
+        return false;
+    }
+
+    items = new FenceItem[MAX(count, 1U)];
+    if (items == nullptr) {
+        return false;
+    }
+    num_items = 0;
+
+    // add lines of each polygon.  As with Polygon_intersects a closing point which is the same as the first point is ignored
+    for (uint16_t i = 0; i < num_inclusion_polygons + num_exclusion_polygons; i++) {
+        uint16_t num_points = 0;
+        const Vector2f* boundary = (i < num_inclusion_polygons) ? polyfence.get_inclusion_polygon(i, num_points) : polyfence.get_exclusion_polygon(i - num_inclusion_polygons, num_points);
+        if (boundary == nullptr) {
+            continue;
+        }
+        if (Polygon_complete(boundary, num_points)) {
+            num_points--;
+        }
+        for (uint16_t j = 0; j < num_points; j++) {
+            items[num_items++] = {FenceItem::Type::LINE, boundary[j], boundary[(j+1 < num_points) ? j+1 : 0]};
+        }
+    }
+
+    // add circles
+    for (uint8_t i = 0; i < num_inclusion_circles; i++) {
+        Vector2f center_pos_cm;
+        float radius;
+        if (polyfence.get_inclusion_circle(i, center_pos_cm, radius)) {
+            items[num_items++] = {FenceItem::Type::INCLUSION_CIRCLE, center_pos_cm, Vector2f(radius * 100.0f, 0.0f)};
+        }
+    }
+    for (uint8_t i = 0; i < num_exclusion_circles; i++) {
+        Vector2f center_pos_cm;
+        float radius;
+        if (polyfence.get_exclusion_circle(i, center_pos_cm, radius)) {
+            items[num_items++] = {FenceItem::Type::EXCLUSION_CIRCLE, center_pos_cm, Vector2f(radius * 100.0f, 0.0f)};
+        }
+    }
+
+    return true;
+}
+
+// returns true if line segment intersects a single fence line or circle
+// this gives the same result as the corresponding part of intersects_fence
+bool AP_OADijkstra::intersects_fence_item(const FenceItem &item, const Vector2f &seg_start, const Vector2f &seg_end)
+{
+    switch (item.type) {
+    case FenceItem::Type::LINE: {
+        const Vector2f &v1 = item.p1;
+        const Vector2f &v2 = item.p2;
+        // optimisations for common cases
+        if ((v1.x > seg_start.x && v2.x > seg_start.x && v1.x > seg_end.x && v2.x > seg_end.x) ||
+            (v1.y > seg_start.y && v2.y > seg_start.y && v1.y > seg_end.y && v2.y > seg_end.y) ||
+            (v1.x < seg_start.x && v2.x < seg_start.x && v1.x < seg_end.x && v2.x < seg_end.x) ||
+            (v1.y < seg_start.y && v2.y < seg_start.y && v1.y < seg_end.y && v2.y < seg_end.y)) {
+            return false;
+        }
+        Vector2f intersection;
+        return Vector2f::segment_intersection(v1, v2, seg_start, seg_end, intersection);
+    }
+    case FenceItem::Type::INCLUSION_CIRCLE: {
+        // intersects circle if either start or end is further from the center than the radius
+        const float radius_cm_sq = sq(item.p2.x);
+        return ((seg_start - item.p1).length_squared() > radius_cm_sq) ||
+               ((seg_end - item.p1).length_squared() > radius_cm_sq);
+    }
+    case FenceItem::Type::EXCLUSION_CIRCLE:
+        // intersects if distance between circle's center and segment is less than radius
+        return Vector2f::closest_distance_between_line_and_point(seg_start, seg_end, item.p1) <= item.p2.x;
+    }
+    return false;
+}
+
+// returns true if fence points i and j (indexes as used by get_point) can see each other
+bool AP_OADijkstra::fence_points_visible(uint16_t i, uint16_t j) const
+{
+    if (i == j) {
+        return false;
+    }
+    if (i > j) {
+        const uint16_t tmp = i;
+        i = j;
+        j = tmp;
+    }
+    const uint32_t bit = ((uint32_t)j * (j - 1)) / 2 + i;
+    return (_fence_visgraph_bits[bit / 8] & (1U << (bit % 8))) != 0;
+}
+
 // create visibility graph for all fence (with margin) points
+// only pairs of points which are new, or whose line crosses a fence line or circle which has changed, are checked against the fence
 // returns true on success.  returns false on failure and err_id is updated
 // requires these functions to have been run create_inclusion_polygon_with_margin, create_exclusion_polygon_with_margin, create_exclusion_circle_with_margin
 bool AP_OADijkstra::create_fence_visgraph(AP_OADijkstra_Error &err_id)
@@ -599,37 +721,109 @@ bool AP_OADijkstra::create_fence_visgraph(AP_OADijkstra_Error &err_id)
         return false;
     }
 
-    // fail if more fence points than algorithm can handle
-    if (total_numpoints() >= OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX) {
+    // fail if more fence points than algorithm can handle (source and destination also need nodes)
+    const uint16_t num_points = total_numpoints();
+    if (num_points >= OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX - 2) {
         err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_TOO_MANY_FENCE_POINTS;
         return false;
     }
 
-    // clear fence points visibility graph
-    _fence_visgraph.clear();
-
-    // calculate distance from each point to all other points
-    for (uint8_t i = 0; i < total_numpoints() - 1; i++) {
-        Vector2f start_seg;
-        if (get_point(i, start_seg)) {
-            for (uint8_t j = i + 1; j < total_numpoints(); j++) {
-                Vector2f end_seg;
-                if (get_point(j, end_seg)) {
-                    // if line segment does not intersect with any inclusion or exclusion zones add to visgraph
-                    if (!intersects_fence(start_seg, end_seg)) {
-                        if (!_fence_visgraph.add_item({AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, i},
-                                                      {AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, j},
-                                                      (start_seg - end_seg).length())) {
-                            // failure to add a point can only be caused by out-of-memory
-                            err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
-                            return false;
-                        }
+    // allocate new graph
+    const uint32_t num_pairs = ((uint32_t)num_points * (num_points - 1)) / 2;
+    Vector2f *pts = new Vector2f[MAX(num_points, 1U)];
+    uint16_t *prev_idx = new uint16_t[MAX(num_points, 1U)];
+    uint8_t *bits = new uint8_t[MAX((num_pairs + 7) / 8, 1U)];
+    FenceItem *items = nullptr;
+    uint16_t num_items = 0;
+    FenceItem *changed_items = nullptr;
+    uint16_t num_changed_items = 0;
+    if ((pts == nullptr) || (prev_idx == nullptr) || (bits == nullptr) || !get_fence_items(items, num_items) ||
+        ((changed_items = new FenceItem[MAX(num_items + _fence_visgraph_numitems, 1)]) == nullptr)) {
+        delete[] pts;
+        delete[] prev_idx;
+        delete[] bits;
+        delete[] items;
+        err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
+        return false;
+    }
+    memset(bits, 0, MAX((num_pairs + 7) / 8, 1U));
+
+    // find each point in the previous graph.  Points keep their order so searching from the last match is quick
+    uint16_t search_start = 0;
+    for (uint16_t i = 0; i < num_points; i++) {
+        get_point(i, pts[i]);
+        prev_idx[i] = OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX;
+        for (uint16_t k = 0; k < _fence_visgraph_numpoints; k++) {
+            const uint16_t idx = (search_start + k) % _fence_visgraph_numpoints;
+            if (_fence_visgraph_pts[idx] == pts[i]) {
+                prev_idx[i] = idx;
+                search_start = idx + 1;
+                break;
+            }
+        }
+    }
+
+    // find fence lines and circles which have been added or removed since the previous graph
+    for (uint8_t pass = 0; pass < 2; pass++) {
+        const FenceItem *a = (pass == 0) ? items : _fence_visgraph_items;
+        const uint16_t num_a = (pass == 0) ? num_items : _fence_visgraph_numitems;
+        const FenceItem *b = (pass == 0) ? _fence_visgraph_items : items;
+        const uint16_t num_b = (pass == 0) ? _fence_visgraph_numitems : num_items;
+        search_start = 0;
+        for (uint16_t i = 0; i < num_a; i++) {
+            bool found = false;
+            for (uint16_t k = 0; k < num_b; k++) {
+                const uint16_t idx = (search_start + k) % num_b;
+                if (b[idx] == a[i]) {
+                    found = true;
+                    search_start = idx + 1;
+                    break;
+                }
+            }
+            if (!found) {
+                changed_items[num_changed_items++] = a[i];
+            }
+        }
+    }
+
+    // calculate visibility between each pair of points
+    for (uint16_t j = 1; j < num_points; j++) {
+        for (uint16_t i = 0; i < j; i++) {
+            bool visible;
+            if ((prev_idx[i] != OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX) &&
+                (prev_idx[j] != OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX) &&
+                (prev_idx[i] != prev_idx[j])) {
+                // both points were in the previous graph so the result can only differ if the line crosses a changed item
+                bool crosses_changed_item = false;
+                for (uint16_t k = 0; k < num_changed_items; k++) {
+                    if (intersects_fence_item(changed_items[k], pts[i], pts[j])) {
+                        crosses_changed_item = true;
+                        break;
                     }
                 }
+                visible = crosses_changed_item ? !intersects_fence(pts[i], pts[j]) : fence_points_visible(prev_idx[i], prev_idx[j]);
+            } else {
+                visible = !intersects_fence(pts[i], pts[j]);
+            }
+            if (visible) {
+                const uint32_t bit = ((uint32_t)j * (j - 1)) / 2 + i;
+                bits[bit / 8] |= (1U << (bit % 8));
             }
         }
     }
 
+    // replace previous graph
+    delete[] prev_idx;
+    delete[] changed_items;
+    delete[] _fence_visgraph_pts;
+    delete[] _fence_visgraph_items;
+    delete[] _fence_visgraph_bits;
+    _fence_visgraph_pts = pts;
+    _fence_visgraph_numpoints = num_points;
+    _fence_visgraph_items = items;
+    _fence_visgraph_numitems = num_items;
+    _fence_visgraph_bits = bits;
+
     return true;
 }
 
@@ -648,7 +842,7 @@ bool AP_OADijkstra::update_visgraph(AP_OAVisGraph& visgraph, const AP_OAVisGraph
     visgraph.clear();
 
     // calculate distance from position to all inclusion/exclusion fence points
-    for (uint8_t i = 0; i < total_numpoints(); i++) {
+    for (uint16_t i = 0; i < total_numpoints(); i++) {
         Vector2f seg_end;
         if (get_point(i, seg_end)) {
             if (!intersects_fence(position, seg_end)) {
@@ -681,39 +875,98 @@ void AP_OADijkstra::update_visible_node_distances(node_index curr_node_idx)
         return;
     }
 
-    // get current node for convenience
+    // only fence points have neighbours to update.  the source is handled by calc_shortest_path and the search ends at the destination
     const ShortPathNode &curr_node = _short_path_data[curr_node_idx];
+    if (curr_node.id.id_type != AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT) {
+        return;
+    }
+
+    // update fence points visible from this one
+    const uint16_t curr_pt = curr_node.id.id_num;
+    const Vector2f &curr_pos = _fence_visgraph_pts[curr_pt];
+    for (uint16_t i = 0; i < _fence_visgraph_numpoints; i++) {
+        if (fence_points_visible(curr_pt, i)) {
+            node_index item_node_idx;
+            if (find_node_from_id({AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, i}, item_node_idx)) {
+                update_node_distance(curr_node_idx, item_node_idx, (curr_pos - _fence_visgraph_pts[i]).length());
+            }
+        }
+    }
 
-    // for each visibility graph
-    const AP_OAVisGraph* visgraphs[] = {&_fence_visgraph, &_destination_visgraph};
-    for (uint8_t v=0; v<ARRAY_SIZE(visgraphs); v++) {
+    // update destination if visible
+    if (curr_node.destination_distance_cm < FLT_MAX) {
+        update_node_distance(curr_node_idx, 1, curr_node.destination_distance_cm);
+    }
+}
 
-        // skip if empty
-        const AP_OAVisGraph &curr_visgraph = *visgraphs[v];
-        if (curr_visgraph.num_items() == 0) {
-            continue;
+// update a node's distance if reaching it via curr_node_idx is shorter
+void AP_OADijkstra::update_node_distance(node_index curr_node_idx, node_index node_idx, float distance_cm)
+{
+    ShortPathNode &node = _short_path_data[node_idx];
+    if (node.visited) {
+        return;
+    }
+    // if current node's distance + distance to item is less than item's current distance, update item's distance
+    const float dist_via_current_node = _short_path_data[curr_node_idx].distance_cm + distance_cm;
+    if (dist_via_current_node < node.distance_cm) {
+        // update item's distance and set "distance_from_idx" to current node's index
+        node.distance_cm = dist_via_current_node;
+        node.distance_from_idx = curr_node_idx;
+        heap_update(node_idx);
+    }
+}
+
+// add node to heap or move it up after its distance has been reduced
+void AP_OADijkstra::heap_update(node_index node_idx)
+{
+    node_index heap_idx = _short_path_data[node_idx].heap_idx;
+    if (heap_idx == OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX) {
+        // add to end of heap.  _short_path_heap has been expanded to hold all nodes
+        heap_idx = _short_path_heap_numpoints++;
+    }
+
+    // move parents down until we find the node's place
+    const float dist = _short_path_data[node_idx].distance_cm;
+    while (heap_idx > 0) {
+        const node_index parent_idx = (heap_idx - 1) / 2;
+        const node_index parent_node_idx = _short_path_heap[parent_idx];
+        if (_short_path_data[parent_node_idx].distance_cm <= dist) {
+            break;
         }
+        _short_path_heap[heap_idx] = parent_node_idx;
+        _short_path_data[parent_node_idx].heap_idx = heap_idx;
+        heap_idx = parent_idx;
+    }
+    _short_path_heap[heap_idx] = node_idx;
+    _short_path_data[node_idx].heap_idx = heap_idx;
+}
 
-        // search visibility graph for items visible from current_node
-        for (uint16_t i = 0; i < curr_visgraph.num_items(); i++) {
-            const AP_OAVisGraph::VisGraphItem &item = curr_visgraph[i];
-            // match if current node's id matches either of the id's in the graph (i.e. either end of the vector)
-            if ((curr_node.id == item.id1) || (curr_node.id == item.id2)) {
-                AP_OAVisGraph::OAItemID matching_id = (curr_node.id == item.id1) ? item.id2 : item.id1;
-                // find item's id in node array
-                node_index item_node_idx;
-                if (find_node_from_id(matching_id, item_node_idx)) {
-                    // if current node's distance + distance to item is less than item's current distance, update item's distance
-                    const float dist_to_item_via_current_node = _short_path_data[curr_node_idx].distance_cm + item.distance_cm;
-                    if (dist_to_item_via_current_node < _short_path_data[item_node_idx].distance_cm) {
-                        // update item's distance and set "distance_from_idx" to current node's index
-                        _short_path_data[item_node_idx].distance_cm = dist_to_item_via_current_node;
-                        _short_path_data[item_node_idx].distance_from_idx = curr_node_idx;
-                    }
-                }
-            }
+// move element of heap down until its children are further away
+void AP_OADijkstra::heap_sift_down(node_index heap_idx)
+{
+    const node_index node_idx = _short_path_heap[heap_idx];
+    const float dist = _short_path_data[node_idx].distance_cm;
+    while (true) {
+        const uint32_t left_idx = 2 * (uint32_t)heap_idx + 1;
+        if (left_idx >= _short_path_heap_numpoints) {
+            break;
+        }
+        // pick closer child
+        node_index child_idx = left_idx;
+        if ((left_idx + 1 < _short_path_heap_numpoints) &&
+            (_short_path_data[_short_path_heap[left_idx + 1]].distance_cm < _short_path_data[_short_path_heap[left_idx]].distance_cm)) {
+            child_idx = left_idx + 1;
         }
+        const node_index child_node_idx = _short_path_heap[child_idx];
+        if (_short_path_data[child_node_idx].distance_cm >= dist) {
+            break;
+        }
+        _short_path_heap[heap_idx] = child_node_idx;
+        _short_path_data[child_node_idx].heap_idx = heap_idx;
+        heap_idx = child_idx;
     }
+    _short_path_heap[heap_idx] = node_idx;
+    _short_path_data[node_idx].heap_idx = heap_idx;
 }
 
 // find a node's index into _short_path_data array from it's id (i.e. id type and id number)
@@ -748,27 +1001,24 @@ bool AP_OADijkstra::find_node_from_id(const AP_OAVisGraph::OAItemID &id, node_in
     return false;
 }
 
-// find index of node with lowest tentative distance (ignore visited nodes)
+// find index of node with lowest tentative distance (ignore visited nodes) and remove it from the heap
 // returns true if successful and node_idx argument is updated
-bool AP_OADijkstra::find_closest_node_idx(node_index &node_idx) const
+bool AP_OADijkstra::find_closest_node_idx(node_index &node_idx)
 {
-    node_index lowest_idx = 0;
-    float lowest_dist = FLT_MAX;
-
-    // scan through all nodes looking for closest
-    for (node_index i=0; i<_short_path_data_numpoints; i++) {
-        const ShortPathNode &node = _short_path_data[i];
-        if (!node.visited && (node.distance_cm < lowest_dist)) {
-            lowest_idx = i;
-            lowest_dist = node.distance_cm;
-        }
+    // only nodes with a distance are in the heap and the closest is always first
+    if (_short_path_heap_numpoints == 0) {
+        return false;
     }
-
-    if (lowest_dist < FLT_MAX) {
-        node_idx = lowest_idx;
-        return true;
+    node_idx = _short_path_heap[0];
+    _short_path_data[node_idx].heap_idx = OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX;
+
+    // move last element to top and restore heap order
+    _short_path_heap_numpoints--;
+    if (_short_path_heap_numpoints > 0) {
+        _short_path_heap[0] = _short_path_heap[_short_path_heap_numpoints];
+        heap_sift_down(0);
     }
-    return false;
+    return true;
 }
 
 // calculate shortest path from origin to destination
@@ -794,20 +1044,30 @@ bool AP_OADijkstra::calc_shortest_path(const Location &origin, const Location &d
         return false;
     }
 
-    // expand _short_path_data if necessary
-    if (!_short_path_data.expand_to_hold(2 + total_numpoints())) {
+    // expand _short_path_data and _short_path_heap if necessary
+    if (!_short_path_data.expand_to_hold(2 + total_numpoints()) ||
+        !_short_path_heap.expand_to_hold(2 + total_numpoints())) {
         err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
         return false;
     }
 
-    // add origin and destination (node_type, id, visited, distance_from_idx, distance_cm) to short_path_data array
-    _short_path_data[0] = {{AP_OAVisGraph::OATYPE_SOURCE, 0}, false, 0, 0};
-    _short_path_data[1] = {{AP_OAVisGraph::OATYPE_DESTINATION, 0}, false, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX, FLT_MAX};
+    // add origin and destination (node_type, id, visited, distance_from_idx, distance_cm, destination_distance_cm, heap_idx) to short_path_data array
+    _short_path_data[0] = {{AP_OAVisGraph::OATYPE_SOURCE, 0}, false, 0, 0, FLT_MAX, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX};
+    _short_path_data[1] = {{AP_OAVisGraph::OATYPE_DESTINATION, 0}, false, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX, FLT_MAX, FLT_MAX, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX};
     _short_path_data_numpoints = 2;
+    _short_path_heap_numpoints = 0;
+
+    // add all inclusion and exclusion fence points to short_path_data array
+    for (uint16_t i=0; i<total_numpoints(); i++) {
+        _short_path_data[_short_path_data_numpoints++] = {{AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, i}, false, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX, FLT_MAX, FLT_MAX, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX};
+    }
 
-    // add all inclusion and exclusion fence points to short_path_data array (node_type, id, visited, distance_from_idx, distance_cm)
-    for (uint8_t i=0; i<total_numpoints(); i++) {
-        _short_path_data[_short_path_data_numpoints++] = {{AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, i}, false, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX, FLT_MAX};
+    // record distance to destination from each fence point which can see it
+    for (uint16_t i = 0; i < _destination_visgraph.num_items(); i++) {
+        node_index node_idx;
+        if (find_node_from_id(_destination_visgraph[i].id2, node_idx)) {
+            _short_path_data[node_idx].destination_distance_cm = _destination_visgraph[i].distance_cm;
+        }
     }
 
     // start algorithm from source point
@@ -819,6 +1079,7 @@ bool AP_OADijkstra::calc_shortest_path(const Location &origin, const Location &d
         if (find_node_from_id(_source_visgraph[i].id2, node_idx)) {
             _short_path_data[node_idx].distance_cm = _source_visgraph[i].distance_cm;
             _short_path_data[node_idx].distance_from_idx = current_node_idx;
+            heap_update(node_idx);
         } else {
             err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_COULD_NOT_FIND_PATH;
             return false;
@@ -829,11 +1090,16 @@ bool AP_OADijkstra::calc_shortest_path(const Location &origin, const Location &d
 
     // move current_node_idx to node with lowest distance
     while (find_closest_node_idx(current_node_idx)) {
-        // update distances to all neighbours of current node
-        update_visible_node_distances(current_node_idx);
-
         // mark current node as visited
         _short_path_data[current_node_idx].visited = true;
+
+        // the shortest path to the destination is known once it is the closest node
+        if (_short_path_data[current_node_idx].id.id_type == AP_OAVisGraph::OATYPE_DESTINATION) {
+            break;
+        }
+
+        // update distances to all neighbours of current node
+        update_visible_node_distances(current_node_idx);
     }
 
     // extract path starting from destination
@@ -880,7 +1146,7 @@ bool AP_OADijkstra::calc_shortest_path(const Location &origin, const Location &d
 }
 
 // return point from final path as an offset (in cm) from the ekf origin
-bool AP_OADijkstra::get_shortest_path_point(uint8_t point_num, Vector2f& pos)
+bool AP_OADijkstra::get_shortest_path_point(uint16_t point_num, Vector2f& pos)
 {
     if ((_path_numpoints == 0) || (point_num >= _path_numpoints)) {
         return false;
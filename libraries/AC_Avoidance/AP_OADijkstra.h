@@ -14,6 +14,7 @@ class AP_OADijkstra {
 public:
 
     AP_OADijkstra();
+    ~AP_OADijkstra();
 
     /* Do not allow copies */
     AP_OADijkstra(const AP_OADijkstra &other) = delete;
@@ -110,9 +111,32 @@ private:
     bool intersects_fence(const Vector2f &seg_start, const Vector2f &seg_end) const;
 
     // create visibility graph for all fence (with margin) points
+    // only pairs of points which are new, or whose line crosses a fence line or circle which has changed, are checked against the fence
     // returns true on success.  returns false on failure and err_id is updated
     bool create_fence_visgraph(AP_OADijkstra_Error &err_id);
 
+    // a single line or circle from the polygon fence
+    struct FenceItem {
+        enum class Type : uint8_t {
+            LINE,
+            INCLUSION_CIRCLE,
+            EXCLUSION_CIRCLE
+        } type;
+        Vector2f p1;    // line start or circle center (offset in cm from EKF origin)
+        Vector2f p2;    // line end.  for circles x holds the radius in cm
+        bool operator ==(const FenceItem &f) const { return (type == f.type) && (p1 == f.p1) && (p2 == f.p2); }
+    };
+
+    // get all lines and circles of the polygon fence.  items is allocated by this function
+    // returns true on success
+    bool get_fence_items(FenceItem *&items, uint16_t &num_items) const;
+
+    // returns true if line segment intersects a single fence line or circle
+    static bool intersects_fence_item(const FenceItem &item, const Vector2f &seg_start, const Vector2f &seg_end);
+
+    // returns true if fence points i and j (indexes as used by get_point) can see each other
+    bool fence_points_visible(uint16_t i, uint16_t j) const;
+
     // calculate shortest path from origin to destination
     // returns true on success.  returns false on failure and err_id is updated
     // requires create_polygon_fence_with_margin and create_polygon_fence_visgraph to have been run
@@ -127,26 +151,33 @@ private:
     bool _shortest_path_ok;
 
     Location _destination_prev;     // destination of previous iterations (used to determine if path should be re-calculated)
-    uint8_t _path_idx_returned;     // index into _path array which gives location vehicle should be currently moving towards
+    uint16_t _path_idx_returned;    // index into _path array which gives location vehicle should be currently moving towards
 
     // inclusion polygon (with margin) related variables
     float _polyfence_margin = 10;           // margin around polygon defaults to 10m but is overriden with set_fence_margin
     AP_ExpandingArray<Vector2f> _inclusion_polygon_pts; // array of nodes corresponding to inclusion polygon points plus a margin
-    uint8_t _inclusion_polygon_numpoints;   // number of points held in above array
+    uint16_t _inclusion_polygon_numpoints;  // number of points held in above array
     uint32_t _inclusion_polygon_update_ms;  // system time of boundary update from AC_Fence (used to detect changes to polygon fence)
 
     // exclusion polygon related variables
     AP_ExpandingArray<Vector2f> _exclusion_polygon_pts; // array of nodes corresponding to exclusion polygon points plus a margin
-    uint8_t _exclusion_polygon_numpoints;   // number of points held in above array
+    uint16_t _exclusion_polygon_numpoints;  // number of points held in above array
     uint32_t _exclusion_polygon_update_ms;  // system time exclusion polygon was updated (used to detect changes)
 
     // exclusion circle related variables
     AP_ExpandingArray<Vector2f> _exclusion_circle_pts; // array of nodes surrounding exclusion circles plus a margin
-    uint8_t _exclusion_circle_numpoints;    // number of points held in above array
+    uint16_t _exclusion_circle_numpoints;   // number of points held in above array
     uint32_t _exclusion_circle_update_ms;   // system time exclusion circles were updated (used to detect changes)
 
-    // visibility graphs
-    AP_OAVisGraph _fence_visgraph;          // holds distances between all inclusion/exclusion fence points (with margin)
+    // visibility between all inclusion/exclusion fence points (with margin)
+    // the points and fence items are kept so that the graph can be updated incrementally when the fence changes
+    Vector2f *_fence_visgraph_pts;          // fence points in the order returned by get_point
+    uint16_t _fence_visgraph_numpoints;     // number of points in above array
+    FenceItem *_fence_visgraph_items;       // fence lines and circles the graph was checked against
+    uint16_t _fence_visgraph_numitems;      // number of items in above array
+    uint8_t *_fence_visgraph_bits;          // one bit per pair of points, set if they can see each other
+
+    // other visibility graphs
     AP_OAVisGraph _source_visgraph;         // holds distances from source point to all other nodes
     AP_OAVisGraph _destination_visgraph;    // holds distances from the destination to all other nodes
 
@@ -156,36 +187,51 @@ private:
     // returns true on success
     bool update_visgraph(AP_OAVisGraph& visgraph, const AP_OAVisGraph::OAItemID& oaid, const Vector2f &position, bool add_extra_position = false, Vector2f extra_position = Vector2f(0,0));
 
-    typedef uint8_t node_index;         // indices into short path data
+    typedef uint16_t node_index;        // indices into short path data
     struct ShortPathNode {
         AP_OAVisGraph::OAItemID id;     // unique id for node (combination of type and id number)
         bool visited;                   // true if all this node's neighbour's distances have been updated
-        node_index distance_from_idx;   // index into _short_path_data from where distance was updated (or 255 if not set)
+        node_index distance_from_idx;   // index into _short_path_data from where distance was updated (or OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX if not set)
         float distance_cm;              // distance from source (number is tentative until this node is the current node and/or visited = true)
+        float destination_distance_cm;  // distance to destination if visible from this node, FLT_MAX if not
+        node_index heap_idx;            // index into _short_path_heap (or OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX if not in heap)
     };
     AP_ExpandingArray<ShortPathNode> _short_path_data;
     node_index _short_path_data_numpoints;  // number of elements in _short_path_data array
 
+    // binary min-heap of unvisited nodes with a tentative distance, ordered by distance_cm
+    AP_ExpandingArray<node_index> _short_path_heap;
+    node_index _short_path_heap_numpoints;  // number of elements in _short_path_heap array
+
+    // add node to heap or move it up after its distance has been reduced
+    void heap_update(node_index node_idx);
+
+    // move element of heap down until its children are further away
+    void heap_sift_down(node_index heap_idx);
+
     // update total distance for all nodes visible from current node
     // curr_node_idx is an index into the _short_path_data array
     void update_visible_node_distances(node_index curr_node_idx);
 
+    // update a node's distance if reaching it via curr_node_idx is shorter
+    void update_node_distance(node_index curr_node_idx, node_index node_idx, float distance_cm);
+
     // find a node's index into _short_path_data array from it's id (i.e. id type and id number)
     // returns true if successful and node_idx is updated
     bool find_node_from_id(const AP_OAVisGraph::OAItemID &id, node_index &node_idx) const;
 
-    // find index of node with lowest tentative distance (ignore visited nodes)
+    // find index of node with lowest tentative distance (ignore visited nodes) and remove it from the heap
     // returns true if successful and node_idx argument is updated
-    bool find_closest_node_idx(node_index &node_idx) const;
+    bool find_closest_node_idx(node_index &node_idx);
 
     // final path variables and functions
     AP_ExpandingArray<AP_OAVisGraph::OAItemID> _path;   // ids of points on return path in reverse order (i.e. destination is first element)
-    uint8_t _path_numpoints;                            // number of points on return path
+    uint16_t _path_numpoints;                           // number of points on return path
     Vector2f _path_source;                              // source point used in shortest path calculations (offset in cm from EKF origin)
     Vector2f _path_destination;                         // destination position used in shortest path calculations (offset in cm from EKF origin)
 
     // return point from final path as an offset (in cm) from the ekf origin
-    bool get_shortest_path_point(uint8_t point_num, Vector2f& pos);
+    bool get_shortest_path_point(uint16_t point_num, Vector2f& pos);
 
     AP_OADijkstra_Error _error_last_id;                 // last error id sent to GCS
     uint32_t _error_last_report_ms;                     // last time an error message was sent to GCS
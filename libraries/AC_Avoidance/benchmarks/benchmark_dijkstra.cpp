@@ -0,0 +1,125 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AC_Avoidance/AP_OADijkstra.h>
+#include <AC_Fence/AC_Fence.h>
+#include <AP_AHRS/AP_AHRS_DCM.h>
+#include <AP_Logger/AP_Logger.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+/*
+  cost of path planning around a large polygon fence. The fence is a
+  grid of exclusion circles (six nodes each) inside an inclusion
+  polygon, which is about as many nodes as fence storage allows
+ */
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+// AHRS with a fixed EKF origin so the fence can be loaded
+class BenchAHRS : public AP_AHRS_DCM {
+public:
+    bool get_origin(Location &ret) const override {
+        ret = Location(-353632610, 1491652300, 58400, Location::AltFrame::ABSOLUTE);
+        return true;
+    }
+};
+
+static BenchAHRS ahrs;
+static AP_Int32 logger_bitmask;
+static AP_Logger logger{logger_bitmask};
+static GCS_Dummy _gcs;
+static AC_Fence fence;
+
+// grid of exclusion circles, spaced in units of 1e-7 degrees
+static const uint8_t grid_size = 6;
+static const int32_t grid_spacing = 20000;
+
+// last_circle_radius allows a single fence item to be changed
+static void write_fence(float last_circle_radius)
+{
+    Location origin;
+    UNUSED_RESULT(ahrs.get_origin(origin));
+
+    AC_PolyFenceItem items[4 + grid_size*grid_size];
+    uint16_t count = 0;
+
+    // inclusion square around the grid
+    const int32_t extent = grid_spacing * (grid_size + 1);
+    const Vector2l corners[] = {
+        {origin.lat - grid_spacing, origin.lng - grid_spacing},
+        {origin.lat + extent, origin.lng - grid_spacing},
+        {origin.lat + extent, origin.lng + extent},
+        {origin.lat - grid_spacing, origin.lng + extent},
+    };
+    for (const Vector2l &corner : corners) {
+        items[count++] = {AC_PolyFenceType::POLYGON_INCLUSION, corner, ARRAY_SIZE(corners), 0};
+    }
+
+    for (uint8_t i = 0; i < grid_size; i++) {
+        for (uint8_t j = 0; j < grid_size; j++) {
+            const Vector2l center{origin.lat + i * grid_spacing + grid_spacing / 2, origin.lng + j * grid_spacing + grid_spacing / 2};
+            const bool last = (i == grid_size-1) && (j == grid_size-1);
+            items[count++] = {AC_PolyFenceType::CIRCLE_EXCLUSION, center, 0, last ? last_circle_radius : 50.0f};
+        }
+    }
+
+    if (!fence.polyfence().write_fence(items, count)) {
+        AP_HAL::panic("failed to write fence");
+    }
+    fence.polyfence().update();
+}
+
+// path from one corner of the grid to the other
+static void get_path_ends(Location &start, Location &end)
+{
+    UNUSED_RESULT(ahrs.get_origin(start));
+    end = start;
+    end.lat += grid_spacing * grid_size;
+    end.lng += grid_spacing * grid_size;
+}
+
+static void BM_DijkstraShortestPath(benchmark::State& state)
+{
+    AP_OADijkstra dijkstra;
+    dijkstra.set_fence_margin(2);
+    write_fence(50);
+
+    Location start, end, origin_new, destination_new;
+    get_path_ends(start, end);
+
+    while (state.KeepRunning()) {
+        dijkstra.recalculate_path();
+        AP_OADijkstra::AP_OADijkstra_State ret = dijkstra.update(start, end, origin_new, destination_new);
+        gbenchmark_escape(&ret);
+    }
+}
+
+static void BM_DijkstraFenceChange(benchmark::State& state)
+{
+    AP_OADijkstra dijkstra;
+    dijkstra.set_fence_margin(2);
+    write_fence(50);
+
+    Location start, end, origin_new, destination_new;
+    get_path_ends(start, end);
+    UNUSED_RESULT(dijkstra.update(start, end, origin_new, destination_new));
+
+    float radius = 50;
+    while (state.KeepRunning()) {
+        // alternate the size of one circle so that every iteration sees a fence change
+        state.PauseTiming();
+        radius = (radius < 55) ? 60 : 50;
+        write_fence(radius);
+        // fence changes are detected by load time
+        hal.scheduler->delay(1);
+        state.ResumeTiming();
+
+        AP_OADijkstra::AP_OADijkstra_State ret = dijkstra.update(start, end, origin_new, destination_new);
+        gbenchmark_escape(&ret);
+    }
+}
+
+BENCHMARK(BM_DijkstraShortestPath);
+BENCHMARK(BM_DijkstraFenceChange);
+
+BENCHMARK_MAIN();
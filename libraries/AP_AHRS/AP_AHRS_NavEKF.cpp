@@ -326,11 +326,23 @@ void AP_AHRS_NavEKF::update_EKF3(void)
             }
         }
         if (AP_HAL::millis() - start_time_ms > startup_delay_ms) {
+#if AP_AHRS_WARM_START_ENABLED
+            // the lanes must be given their saved states before they start
+            if (!warm_start_applied) {
+                warm_start_applied = warm_start.apply(EKF3);
+                if (!warm_start_applied) {
+                    return;
+                }
+            }
+#endif
             _ekf3_started = EKF3.InitialiseFilter();
         }
     }
     if (_ekf3_started) {
         EKF3.UpdateFilter();
+#if AP_AHRS_WARM_START_ENABLED
+        warm_start.update(EKF3);
+#endif
         if (active_EKF_type() == EKFType::THREE) {
             Vector3f eulers;
             EKF3.getRotationBodyToNED(_dcm_matrix);
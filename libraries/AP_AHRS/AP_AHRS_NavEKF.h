@@ -44,6 +44,7 @@
 #include <AP_NavEKF2/AP_NavEKF2.h>
 #include <AP_NavEKF3/AP_NavEKF3.h>
 #include <AP_NavEKF/AP_Nav_Common.h>              // definitions shared by inertial and ekf nav filters
+#include "AP_AHRS_WarmStart.h"
 
 
 #define AP_AHRS_NAVEKF_SETTLE_TIME_MS 20000     // time in milliseconds the ekf needs to settle after being started
@@ -365,6 +366,10 @@ private:
     bool _ekf3_started;
     void update_EKF3(void);
 #endif
+#if AP_AHRS_WARM_START_ENABLED
+    AP_AHRS_WarmStart warm_start;
+    bool warm_start_applied;
+#endif
 
     // rotation from vehicle body to NED frame
     Matrix3f _dcm_matrix;
@@ -0,0 +1,242 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_AHRS.h"
+
+#if AP_AHRS_WARM_START_ENABLED
+
+#include <AP_Compass/AP_Compass.h>
+#include <AP_Filesystem/AP_Filesystem.h>
+#include <AP_Math/crc.h>
+#include <AP_RTC/AP_RTC.h>
+
+extern const AP_HAL::HAL& hal;
+
+static const char *warm_start_file = HAL_BOARD_STORAGE_DIRECTORY "/ekf3_warm.dat";
+
+/*
+  give the EKF3 lanes the saved states that are still valid. Nothing
+  is given if the snapshot is too old, or its age is unknown because
+  the clock has not been set. The yaw and field states are only given
+  if the magnetic heading has not changed, and each lane is only given
+  its states if the tilt and temperature of its IMU have not changed
+ */
+bool AP_AHRS_WarmStart::apply(NavEKF3 &ekf3)
+{
+    if (!ekf3.warmStartEnabled()) {
+        return true;
+    }
+    if (!io_registered) {
+        io_registered = true;
+        start_ms = AP_HAL::millis();
+        hal.scheduler->register_io_process(FUNCTOR_BIND_MEMBER(&AP_AHRS_WarmStart::io_timer, void));
+    }
+
+    WITH_SEMAPHORE(sem);
+
+    if (!load_done) {
+        return AP_HAL::millis() - start_ms > load_timeout_ms;
+    }
+    if (snapshot.magic != snapshot_magic) {
+        // no snapshot, or it was not valid
+        return true;
+    }
+    uint64_t now_usec;
+    if (!AP::rtc().get_utc_usec(now_usec) ||
+        now_usec < snapshot.saved_utc_usec ||
+        now_usec - snapshot.saved_utc_usec > max_age_s * 1000000ULL) {
+        return true;
+    }
+
+    bool heading_ok = false;
+    float heading, strength;
+    if (snapshot.have_heading && get_mag_heading(heading, strength)) {
+        heading_ok = fabsf(wrap_PI(heading - snapshot.mag_heading)) < radians(max_heading_change_deg) &&
+                     fabsf(strength - snapshot.mag_strength) < max_strength_change * snapshot.mag_strength;
+    }
+
+    const AP_InertialSensor &ins = AP::ins();
+    for (uint8_t i=0; i<ARRAY_SIZE(snapshot.lane); i++) {
+        if ((snapshot.lane_mask & (1U<<i)) == 0 || !ins.get_accel_health(i)) {
+            continue;
+        }
+        const Lane &lane = snapshot.lane[i];
+        const Vector3f &accel = ins.get_accel(i);
+        if (accel.length() < 0.5f * GRAVITY_MSS) {
+            continue;
+        }
+        // written so that a NaN fails the checks
+        const float tilt_change = accel.normalized().angle(lane.accel_dir);
+        if (!(tilt_change < radians(max_tilt_change_deg)) ||
+            !(fabsf(ins.get_temperature(i) - lane.temperature) < max_temperature_change)) {
+            continue;
+        }
+        NavEKF3::WarmStart ws = lane.ws;
+        if (!heading_ok) {
+            ws.yaw = NAN;
+        }
+        ekf3.setWarmStart(i, ws);
+    }
+
+    return true;
+}
+
+/*
+  take a snapshot of the EKF3 states once the vehicle has been
+  disarmed for long enough for the motors to have stopped
+ */
+void AP_AHRS_WarmStart::update(const NavEKF3 &ekf3)
+{
+    if (!ekf3.warmStartEnabled()) {
+        return;
+    }
+    const uint32_t now_ms = AP_HAL::millis();
+    if (hal.util->get_soft_armed()) {
+        was_armed = true;
+        disarm_ms = 0;
+        return;
+    }
+    if (!was_armed) {
+        return;
+    }
+    if (disarm_ms == 0) {
+        disarm_ms = now_ms;
+        return;
+    }
+    if (now_ms - disarm_ms < settle_time_ms) {
+        return;
+    }
+    was_armed = false;
+
+    Snapshot s {};
+    s.magic = snapshot_magic;
+    s.version = snapshot_version;
+    if (!AP::rtc().get_utc_usec(s.saved_utc_usec)) {
+        // the snapshot could never be used
+        return;
+    }
+
+    const AP_InertialSensor &ins = AP::ins();
+    for (uint8_t i=0; i<ARRAY_SIZE(s.lane); i++) {
+        Lane &lane = s.lane[i];
+        const Vector3f &accel = ins.get_accel(i);
+        if (!ins.get_accel_health(i) ||
+            accel.length() < 0.5f * GRAVITY_MSS ||
+            !ekf3.getWarmStart(i, lane.ws)) {
+            continue;
+        }
+        lane.accel_dir = accel.normalized();
+        lane.temperature = ins.get_temperature(i);
+        s.lane_mask |= 1U<<i;
+    }
+    if (s.lane_mask == 0) {
+        return;
+    }
+    s.have_heading = get_mag_heading(s.mag_heading, s.mag_strength);
+    s.crc = snapshot_crc(s);
+
+    WITH_SEMAPHORE(sem);
+    snapshot = s;
+    save_pending = true;
+    if (!io_registered) {
+        io_registered = true;
+        hal.scheduler->register_io_process(FUNCTOR_BIND_MEMBER(&AP_AHRS_WarmStart::io_timer, void));
+    }
+}
+
+/*
+  magnetic heading, ignoring declination, from the primary compass
+  levelled using the primary accel
+ */
+bool AP_AHRS_WarmStart::get_mag_heading(float &heading, float &strength)
+{
+    const Compass &compass = AP::compass();
+    if (!compass.use_for_yaw() || !compass.healthy()) {
+        return false;
+    }
+    Vector3f accel = AP::ins().get_accel();
+    if (accel.length() < 0.5f * GRAVITY_MSS) {
+        return false;
+    }
+    accel.normalize();
+
+    // same levelling as the EKF uses to initialise its tilt
+    const float pitch = asinf(constrain_float(accel.x, -1.0f, 1.0f));
+    const float roll = atan2f(-accel.y, -accel.z);
+    Matrix3f dcm;
+    dcm.from_euler(roll, pitch, 0.0f);
+    const Vector3f field = dcm * compass.get_field();
+
+    heading = atan2f(-field.y, field.x);
+    strength = compass.get_field().length();
+    return is_positive(strength);
+}
+
+uint32_t AP_AHRS_WarmStart::snapshot_crc(const Snapshot &s)
+{
+    return crc_crc32(0, (const uint8_t *)&s, sizeof(s) - sizeof(s.crc));
+}
+
+void AP_AHRS_WarmStart::io_timer(void)
+{
+    if (!load_done) {
+        load();
+    }
+    if (save_pending) {
+        save();
+    }
+}
+
+// read the snapshot saved on the last disarm
+void AP_AHRS_WarmStart::load(void)
+{
+    Snapshot s;
+    bool ok = false;
+    const int fd = AP::FS().open(warm_start_file, O_RDONLY);
+    if (fd != -1) {
+        ok = AP::FS().read(fd, &s, sizeof(s)) == sizeof(s) &&
+             s.magic == snapshot_magic &&
+             s.version == snapshot_version &&
+             s.crc == snapshot_crc(s);
+        AP::FS().close(fd);
+    }
+
+    WITH_SEMAPHORE(sem);
+    if (ok && !save_pending) {
+        snapshot = s;
+    }
+    load_done = true;
+}
+
+void AP_AHRS_WarmStart::save(void)
+{
+    Snapshot s;
+    {
+        WITH_SEMAPHORE(sem);
+        s = snapshot;
+        save_pending = false;
+    }
+
+    const int fd = AP::FS().open(warm_start_file, O_WRONLY|O_CREAT|O_TRUNC);
+    if (fd == -1) {
+        return;
+    }
+    // a short write is caught by the CRC when the file is read
+    AP::FS().write(fd, &s, sizeof(s));
+    AP::FS().fsync(fd);
+    AP::FS().close(fd);
+}
+
+#endif // AP_AHRS_WARM_START_ENABLED
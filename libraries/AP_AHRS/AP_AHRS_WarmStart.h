@@ -0,0 +1,106 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  EKF3 warm start. The biases, magnetic field states and yaw of each
+  lane are saved to a file a few seconds after disarming, and given
+  back to the lanes on the next boot if the snapshot is recent and the
+  IMU tilt, magnetic heading and IMU temperature show the vehicle has
+  not been moved
+ */
+
+#pragma once
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Filesystem/AP_Filesystem_Available.h>
+
+#ifndef AP_AHRS_WARM_START_ENABLED
+#define AP_AHRS_WARM_START_ENABLED (HAVE_FILESYSTEM_SUPPORT && HAL_NAVEKF3_AVAILABLE)
+#endif
+
+#if AP_AHRS_WARM_START_ENABLED
+
+#include <AP_InertialSensor/AP_InertialSensor.h>
+#include <AP_NavEKF3/AP_NavEKF3.h>
+
+class AP_AHRS_WarmStart {
+public:
+    // give the EKF3 lanes the saved states that are still valid.
+    // Returns false while the file is still being read
+    bool apply(NavEKF3 &ekf3);
+
+    // save the EKF3 states once the vehicle has settled after
+    // disarming. Called at the AHRS rate
+    void update(const NavEKF3 &ekf3);
+
+private:
+    // states of one lane and of its IMU
+    struct Lane {
+        NavEKF3::WarmStart ws;
+        Vector3f accel_dir;         // unit accel vector in the body frame
+        float temperature;          // IMU temperature (degC)
+    };
+
+    struct Snapshot {
+        uint16_t magic;
+        uint16_t version;
+        uint64_t saved_utc_usec;    // time the snapshot was taken
+        uint8_t lane_mask;          // lanes with valid states, by IMU index
+        bool have_heading;
+        float mag_heading;          // magnetic heading from the primary compass and IMU (rad)
+        float mag_strength;         // field strength from the primary compass (mGauss)
+        Lane lane[INS_MAX_INSTANCES];
+        uint32_t crc;
+    };
+
+    static constexpr uint16_t snapshot_magic = 0x3357;
+    static constexpr uint16_t snapshot_version = 2;
+
+    // snapshots older than this are not used
+    static constexpr uint32_t max_age_s = 24*60*60;
+
+    // time after disarming before the snapshot is taken
+    static constexpr uint32_t settle_time_ms = 3000;
+
+    // give up on the file if it hasn't been read in this time
+    static constexpr uint32_t load_timeout_ms = 5000;
+
+    // limits on how much the vehicle may have moved
+    static constexpr float max_tilt_change_deg = 2.0f;
+    static constexpr float max_heading_change_deg = 5.0f;
+    static constexpr float max_strength_change = 0.15f;
+    static constexpr float max_temperature_change = 10.0f;
+
+    // magnetic heading from the primary compass and IMU
+    static bool get_mag_heading(float &heading, float &strength);
+
+    static uint32_t snapshot_crc(const Snapshot &s);
+
+    // read and write the file on the IO thread
+    void io_timer(void);
+    void load(void);
+    void save(void);
+
+    HAL_Semaphore sem;
+    bool io_registered;
+    bool load_done;
+    bool save_pending;
+    bool was_armed;
+    uint32_t start_ms;
+    uint32_t disarm_ms;
+
+    Snapshot snapshot;
+};
+
+#endif // AP_AHRS_WARM_START_ENABLED
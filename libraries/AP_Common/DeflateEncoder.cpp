@@ -0,0 +1,244 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DeflateEncoder.h"
+
+#include <string.h>
+
+#include <AP_Math/AP_Math.h>
+
+// base values and extra bits of the deflate length and distance codes
+static const uint16_t length_base[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t length_extra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t dist_base[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t dist_extra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+#define ADLER_MOD 65521U
+
+void DeflateEncoder::reset(void)
+{
+    memset(head, 0, sizeof(head));
+    in_pos = 0;
+    enc_pos = 0;
+    adler_a = 1;
+    adler_b = 0;
+    bit_buf = 0;
+    bit_count = 0;
+    finishing = false;
+    ended = false;
+
+    // zlib header: deflate with a 1k window, no dictionary
+    out[0] = 0x28;
+    out[1] = 0x15;
+    out_len = 2;
+
+    // a single final block with fixed Huffman codes
+    put_bits(3, 3);
+}
+
+uint16_t DeflateEncoder::write(const uint8_t *data, uint16_t len)
+{
+    const uint16_t mask = window_size - 1;
+    uint16_t n = 0;
+    while (n < len && !finishing) {
+        if (in_pos - enc_pos >= 2*max_match) {
+            process();
+            if (in_pos - enc_pos >= 2*max_match) {
+                // output is full
+                break;
+            }
+        }
+        const uint8_t b = data[n++];
+        window[in_pos++ & mask] = b;
+        adler_a = (adler_a + b) % ADLER_MOD;
+        adler_b = (adler_b + adler_a) % ADLER_MOD;
+    }
+    process();
+    return n;
+}
+
+void DeflateEncoder::finish(void)
+{
+    finishing = true;
+    process();
+}
+
+uint16_t DeflateEncoder::read(uint8_t *buf, uint16_t len)
+{
+    uint16_t total = 0;
+    while (total < len) {
+        if (out_len == 0) {
+            process();
+            if (out_len == 0) {
+                break;
+            }
+        }
+        const uint8_t n = MIN(out_len, len - total);
+        if (buf != nullptr) {
+            memcpy(&buf[total], out, n);
+        }
+        memmove(&out[0], &out[n], out_len - n);
+        out_len -= n;
+        total += n;
+    }
+    return total;
+}
+
+/*
+  encode as much input as there is room for in the output
+  buffer. Each step produces at most 31 bits
+ */
+void DeflateEncoder::process(void)
+{
+    while (out_len + 8U <= sizeof(out)) {
+        const uint32_t avail = in_pos - enc_pos;
+        if (avail == 0 || (!finishing && avail < max_match)) {
+            break;
+        }
+        encode_one();
+    }
+    if (finishing && !ended && in_pos == enc_pos && out_len + 8U <= sizeof(out)) {
+        put_literal(256);
+        flush_bits();
+        out[out_len++] = adler_b >> 8;
+        out[out_len++] = adler_b;
+        out[out_len++] = adler_a >> 8;
+        out[out_len++] = adler_a;
+        ended = true;
+    }
+}
+
+uint8_t DeflateEncoder::hash(uint32_t pos) const
+{
+    const uint16_t mask = window_size - 1;
+    const uint32_t v = window[pos & mask] |
+                       (window[(pos+1) & mask] << 8) |
+                       (window[(pos+2) & mask] << 16);
+    return (v * 2654435761U) >> 24;
+}
+
+/*
+  encode the next literal or match
+ */
+void DeflateEncoder::encode_one(void)
+{
+    const uint16_t mask = window_size - 1;
+    const uint32_t avail = in_pos - enc_pos;
+    uint16_t match_len = 0;
+    uint16_t dist = 0;
+
+    if (avail >= 3) {
+        const uint8_t h = hash(enc_pos);
+        dist = uint16_t(enc_pos) - head[h];
+        head[h] = uint16_t(enc_pos);
+        // the candidate is only a hint; the bytes are checked
+        if (dist > 0 && dist <= max_distance && dist <= enc_pos) {
+            const uint16_t limit = avail < max_match ? avail : max_match;
+            while (match_len < limit &&
+                   window[(enc_pos - dist + match_len) & mask] == window[(enc_pos + match_len) & mask]) {
+                match_len++;
+            }
+        }
+    }
+
+    if (match_len < 3) {
+        put_literal(window[enc_pos & mask]);
+        enc_pos++;
+        return;
+    }
+
+    put_match(match_len, dist);
+    for (uint16_t i=1; i<match_len; i++) {
+        const uint32_t pos = enc_pos + i;
+        if (in_pos - pos >= 3) {
+            head[hash(pos)] = uint16_t(pos);
+        }
+    }
+    enc_pos += match_len;
+}
+
+void DeflateEncoder::put_bits(uint32_t v, uint8_t n)
+{
+    bit_buf |= v << bit_count;
+    bit_count += n;
+    while (bit_count >= 8) {
+        out[out_len++] = bit_buf;
+        bit_buf >>= 8;
+        bit_count -= 8;
+    }
+}
+
+// Huffman codes are packed starting with the most significant bit
+void DeflateEncoder::put_code(uint16_t code, uint8_t n)
+{
+    uint16_t rev = 0;
+    for (uint8_t i=0; i<n; i++) {
+        rev = (rev << 1) | ((code >> i) & 1);
+    }
+    put_bits(rev, n);
+}
+
+// a literal/length symbol in the fixed Huffman code
+void DeflateEncoder::put_literal(uint16_t v)
+{
+    if (v < 144) {
+        put_code(0x30 + v, 8);
+    } else if (v < 256) {
+        put_code(0x190 + (v - 144), 9);
+    } else if (v < 280) {
+        put_code(v - 256, 7);
+    } else {
+        put_code(0xC0 + (v - 280), 8);
+    }
+}
+
+void DeflateEncoder::put_match(uint16_t len, uint16_t dist)
+{
+    uint8_t i = ARRAY_SIZE(length_base) - 1;
+    while (length_base[i] > len) {
+        i--;
+    }
+    put_literal(257 + i);
+    put_bits(len - length_base[i], length_extra[i]);
+
+    i = ARRAY_SIZE(dist_base) - 1;
+    while (dist_base[i] > dist) {
+        i--;
+    }
+    put_code(i, 5);
+    put_bits(dist - dist_base[i], dist_extra[i]);
+}
+
+// pad the output to a byte boundary
+void DeflateEncoder::flush_bits(void)
+{
+    if (bit_count > 0) {
+        out[out_len++] = bit_buf;
+    }
+    bit_buf = 0;
+    bit_count = 0;
+}
@@ -0,0 +1,79 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  streaming zlib (RFC1950/RFC1951) encoder with a small fixed memory
+  footprint. The output is a single fixed Huffman block, with LZ77
+  matches found through a one entry per hash bucket table, so it can
+  be decoded by any inflate implementation
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+class DeflateEncoder {
+public:
+
+    // start a new stream
+    void reset(void);
+
+    // add input. Returns the number of bytes taken, which is less
+    // than len when output must be read before more input can be taken
+    uint16_t write(const uint8_t *data, uint16_t len);
+
+    // mark the end of the input
+    void finish(void);
+
+    // get up to len bytes of output. If buf is nullptr the output is
+    // discarded
+    uint16_t read(uint8_t *buf, uint16_t len);
+
+    // true once finish() has been called and all output has been read
+    bool done(void) const {
+        return ended && out_len == 0;
+    }
+
+private:
+    // history and lookahead; must be a power of 2
+    static constexpr uint16_t window_size = 1024;
+    static constexpr uint16_t max_match = 64;
+    static constexpr uint16_t max_distance = window_size - 2*max_match;
+    static constexpr uint16_t hash_size = 256;
+
+    uint8_t window[window_size];
+    uint16_t head[hash_size];   // low 16 bits of last position with this hash
+    uint32_t in_pos;            // bytes of input taken
+    uint32_t enc_pos;           // bytes of input encoded
+
+    uint32_t adler_a;
+    uint32_t adler_b;
+
+    uint32_t bit_buf;
+    uint8_t bit_count;
+    uint8_t out[64];
+    uint8_t out_len;
+
+    bool finishing;
+    bool ended;
+
+    void process(void);
+    void encode_one(void);
+    uint8_t hash(uint32_t pos) const;
+    void put_bits(uint32_t v, uint8_t n);
+    void put_code(uint16_t code, uint8_t n);
+    void put_literal(uint16_t v);
+    void put_match(uint16_t len, uint16_t dist);
+    void flush_bits(void);
+};
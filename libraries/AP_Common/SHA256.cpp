@@ -0,0 +1,320 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SHA256.h"
+
+#include <string.h>
+
+#include <AP_HAL/AP_HAL_Boards.h>
+#include <AP_Math/AP_Math.h>
+
+#if defined(__x86_64__) && defined(__GNUC__) && \
+    (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#define SHA256_X86_ENABLED 1
+#include <cpuid.h>
+#include <immintrin.h>
+#else
+#define SHA256_X86_ENABLED 0
+#endif
+
+#if defined(__aarch64__) && defined(__GNUC__) && \
+    (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#define SHA256_ARMV8_ENABLED 1
+#include <arm_neon.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#else
+#define SHA256_ARMV8_ENABLED 0
+#endif
+
+static const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+typedef void (*compress_fn)(uint32_t state[8], const uint8_t *data, uint32_t blocks);
+
+static inline uint32_t ror32(uint32_t x, uint8_t n)
+{
+    return (x >> n) | (x << (32 - n));
+}
+
+/*
+  portable compression function, with a 16 word rolling message
+  schedule to keep the stack small
+ */
+static void compress_generic(uint32_t state[8], const uint8_t *data, uint32_t blocks)
+{
+    while (blocks--) {
+        uint32_t w[16];
+        for (uint8_t i=0; i<16; i++) {
+            w[i] = (uint32_t(data[4*i]) << 24) | (uint32_t(data[4*i+1]) << 16) |
+                   (uint32_t(data[4*i+2]) << 8) | data[4*i+3];
+        }
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (uint8_t i=0; i<64; i++) {
+            if (i >= 16) {
+                const uint32_t w15 = w[(i-15) & 15];
+                const uint32_t w2 = w[(i-2) & 15];
+                const uint32_t s0 = ror32(w15, 7) ^ ror32(w15, 18) ^ (w15 >> 3);
+                const uint32_t s1 = ror32(w2, 17) ^ ror32(w2, 19) ^ (w2 >> 10);
+                w[i & 15] += s0 + w[(i-7) & 15] + s1;
+            }
+            const uint32_t S1 = ror32(e, 6) ^ ror32(e, 11) ^ ror32(e, 25);
+            const uint32_t ch = (e & f) ^ (~e & g);
+            const uint32_t t1 = h + S1 + ch + K[i] + w[i & 15];
+            const uint32_t S0 = ror32(a, 2) ^ ror32(a, 13) ^ ror32(a, 22);
+            const uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + S0 + maj;
+        }
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+        data += SHA256::block_size;
+    }
+}
+
+#if SHA256_X86_ENABLED
+static bool have_x86_sha(void)
+{
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    const bool sse41 = (ecx & (1U<<19)) != 0;
+    const bool ssse3 = (ecx & (1U<<9)) != 0;
+    if (__get_cpuid_max(0, nullptr) < 7) {
+        return false;
+    }
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    const bool sha = (ebx & (1U<<29)) != 0;
+    return sse41 && ssse3 && sha;
+}
+
+/*
+  compression with the x86 SHA extensions. The state is held as ABEF
+  and CDGH, the layout sha256rnds2 works on
+ */
+__attribute__((target("sha,sse4.1,ssse3")))
+static void compress_x86(uint32_t state[8], const uint8_t *data, uint32_t blocks)
+{
+    const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i tmp = _mm_loadu_si128((const __m128i *)&state[0]);
+    __m128i state1 = _mm_loadu_si128((const __m128i *)&state[4]);
+    tmp = _mm_shuffle_epi32(tmp, 0xB1);             // CDAB
+    state1 = _mm_shuffle_epi32(state1, 0x1B);       // EFGH
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);   // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);    // CDGH
+
+    while (blocks--) {
+        const __m128i abef_save = state0;
+        const __m128i cdgh_save = state1;
+        __m128i w[4];
+        for (uint8_t j=0; j<16; j++) {
+            __m128i &x = w[j & 3];
+            if (j < 4) {
+                x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)&data[16*j]), bswap);
+            } else {
+                x = _mm_sha256msg1_epu32(x, w[(j-3) & 3]);
+                x = _mm_add_epi32(x, _mm_alignr_epi8(w[(j-1) & 3], w[(j-2) & 3], 4));
+                x = _mm_sha256msg2_epu32(x, w[(j-1) & 3]);
+            }
+            __m128i msg = _mm_add_epi32(x, _mm_loadu_si128((const __m128i *)&K[4*j]));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+            msg = _mm_shuffle_epi32(msg, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+        }
+        state0 = _mm_add_epi32(state0, abef_save);
+        state1 = _mm_add_epi32(state1, cdgh_save);
+        data += SHA256::block_size;
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);          // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1);       // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);    // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8);       // HGFE
+    _mm_storeu_si128((__m128i *)&state[0], state0);
+    _mm_storeu_si128((__m128i *)&state[4], state1);
+}
+#endif // SHA256_X86_ENABLED
+
+#if SHA256_ARMV8_ENABLED
+static bool have_armv8_sha(void)
+{
+    return (getauxval(AT_HWCAP) & HWCAP_SHA2) != 0;
+}
+
+/*
+  compression with the ARMv8 cryptography extensions
+ */
+#if defined(__clang__)
+__attribute__((target("crypto")))
+#else
+__attribute__((target("+crypto")))
+#endif
+static void compress_armv8(uint32_t state[8], const uint8_t *data, uint32_t blocks)
+{
+    uint32x4_t state0 = vld1q_u32(&state[0]);   // ABCD
+    uint32x4_t state1 = vld1q_u32(&state[4]);   // EFGH
+
+    while (blocks--) {
+        const uint32x4_t abcd_save = state0;
+        const uint32x4_t efgh_save = state1;
+        uint32x4_t w[4];
+        for (uint8_t j=0; j<16; j++) {
+            uint32x4_t &x = w[j & 3];
+            if (j < 4) {
+                x = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(&data[16*j])));
+            } else {
+                x = vsha256su0q_u32(x, w[(j-3) & 3]);
+                x = vsha256su1q_u32(x, w[(j-2) & 3], w[(j-1) & 3]);
+            }
+            const uint32x4_t msg = vaddq_u32(x, vld1q_u32(&K[4*j]));
+            const uint32x4_t abcd = state0;
+            state0 = vsha256hq_u32(state0, state1, msg);
+            state1 = vsha256h2q_u32(state1, abcd, msg);
+        }
+        state0 = vaddq_u32(state0, abcd_save);
+        state1 = vaddq_u32(state1, efgh_save);
+        data += SHA256::block_size;
+    }
+
+    vst1q_u32(&state[0], state0);
+    vst1q_u32(&state[4], state1);
+}
+#endif // SHA256_ARMV8_ENABLED
+
+static compress_fn compress;
+static SHA256::Kernel kernel;
+
+bool SHA256::set_kernel(Kernel k)
+{
+    switch (k) {
+    case Kernel::GENERIC:
+        compress = compress_generic;
+        kernel = k;
+        return true;
+    case Kernel::X86_SHA:
+#if SHA256_X86_ENABLED
+        if (have_x86_sha()) {
+            compress = compress_x86;
+            kernel = k;
+            return true;
+        }
+#endif
+        break;
+    case Kernel::ARMV8_CE:
+#if SHA256_ARMV8_ENABLED
+        if (have_armv8_sha()) {
+            compress = compress_armv8;
+            kernel = k;
+            return true;
+        }
+#endif
+        break;
+    }
+    return false;
+}
+
+SHA256::Kernel SHA256::get_kernel(void)
+{
+    if (compress == nullptr) {
+        // pick the fastest this CPU supports
+        if (!set_kernel(Kernel::X86_SHA) && !set_kernel(Kernel::ARMV8_CE)) {
+            set_kernel(Kernel::GENERIC);
+        }
+    }
+    return kernel;
+}
+
+void SHA256::init(void)
+{
+    static const uint32_t initial_state[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    memcpy(state, initial_state, sizeof(state));
+    total_len = 0;
+    buf_len = 0;
+    get_kernel();
+}
+
+void SHA256::update(const void *data, uint32_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    total_len += len;
+
+    if (buf_len > 0) {
+        const uint32_t n = MIN(len, uint32_t(block_size - buf_len));
+        memcpy(&buf[buf_len], p, n);
+        buf_len += n;
+        p += n;
+        len -= n;
+        if (buf_len < block_size) {
+            return;
+        }
+        compress(state, buf, 1);
+        buf_len = 0;
+    }
+
+    // whole blocks are hashed without copying
+    const uint32_t blocks = len / block_size;
+    if (blocks > 0) {
+        compress(state, p, blocks);
+        p += blocks * block_size;
+        len -= blocks * block_size;
+    }
+
+    memcpy(buf, p, len);
+    buf_len = len;
+}
+
+void SHA256::final(uint8_t *digest, uint8_t len)
+{
+    const uint64_t bits = total_len * 8;
+
+    buf[buf_len++] = 0x80;
+    if (buf_len > block_size - 8) {
+        memset(&buf[buf_len], 0, block_size - buf_len);
+        compress(state, buf, 1);
+        buf_len = 0;
+    }
+    memset(&buf[buf_len], 0, block_size - 8 - buf_len);
+    for (uint8_t i=0; i<8; i++) {
+        buf[block_size - 1 - i] = bits >> (8*i);
+    }
+    compress(state, buf, 1);
+
+    if (len > digest_size) {
+        len = digest_size;
+    }
+    for (uint8_t i=0; i<len; i++) {
+        digest[i] = state[i/4] >> (24 - 8*(i%4));
+    }
+}
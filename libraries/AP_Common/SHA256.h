@@ -0,0 +1,57 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  SHA-256 (FIPS 180-4). Whole blocks are hashed straight from the
+  caller's buffer by a compression kernel chosen at runtime: the SHA
+  extensions on x86, the crypto extensions on ARMv8, or portable C
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+class SHA256 {
+public:
+    static constexpr uint8_t block_size = 64;
+    static constexpr uint8_t digest_size = 32;
+
+    enum class Kernel : uint8_t {
+        GENERIC = 0,
+        X86_SHA = 1,    // x86 SHA extensions
+        ARMV8_CE = 2,   // ARMv8 cryptography extensions
+    };
+
+    // start a new hash
+    void init(void);
+
+    // add data to the hash
+    void update(const void *data, uint32_t len);
+
+    // finish the hash and write the first len bytes of the digest
+    void final(uint8_t *digest, uint8_t len=digest_size);
+
+    // the kernel in use
+    static Kernel get_kernel(void);
+
+    // use a particular kernel; returns false if this CPU doesn't
+    // support it. For testing and benchmarking
+    static bool set_kernel(Kernel kernel);
+
+private:
+    uint32_t state[8];
+    uint64_t total_len;
+    uint8_t buf[block_size];
+    uint8_t buf_len;
+};
@@ -7,7 +7,7 @@
 #include <AP_OpticalFlow/AP_OpticalFlow.h>
 #include <AP_WheelEncoder/AP_WheelEncoder.h>
 
-#if APM_BUILD_TYPE(APM_BUILD_Replay)
+#if APM_BUILD_TYPE(APM_BUILD_Replay) || AP_DAL_CHECKPOINT_ENABLED
 #include <AP_NavEKF2/AP_NavEKF2.h>
 #include <AP_NavEKF3/AP_NavEKF3.h>
 #endif
@@ -230,6 +230,25 @@ void AP_DAL::log_writeEulerYawAngle(float yawAngle, float yawAngleErr, uint32_t
 #endif
 }
 
+void AP_DAL::log_setWarmStart3(uint8_t imu_index, const Vector3f &gyro_bias, const Vector3f &accel_bias,
+                               const Vector3f &earth_magfield, const Vector3f &body_magfield,
+                               float yaw, float gyro_bias_var, float accel_bias_var)
+{
+#if !APM_BUILD_TYPE(APM_BUILD_AP_DAL_Standalone) && !APM_BUILD_TYPE(APM_BUILD_Replay)
+    struct log_RWS3 pkt{
+        gyro_bias      : gyro_bias,
+        accel_bias     : accel_bias,
+        earth_magfield : earth_magfield,
+        body_magfield  : body_magfield,
+        yaw            : yaw,
+        gyro_bias_var  : gyro_bias_var,
+        accel_bias_var : accel_bias_var,
+        imu_index      : imu_index,
+    };
+    WRITE_REPLAY_BLOCK(RWS3, pkt);
+#endif
+}
+
 int AP_DAL::snprintf(char* str, size_t size, const char *format, ...) const
 {
     va_list ap;
@@ -474,6 +493,33 @@ void AP_DAL::handle_message(const log_RBOH &msg, NavEKF2 &ekf2, NavEKF3 &ekf3)
 }
 #endif // APM_BUILD_Replay
 
+#if AP_DAL_CHECKPOINT_ENABLED
+bool AP_DAL::save_checkpoint(AP_DAL_Checkpoint &cp, const NavEKF2 &ekf2, const NavEKF3 &ekf3) const
+{
+    if (!cp.write(&_RFRF.core_slow, sizeof(_RFRF.core_slow)) ||
+        !cp.write(&ekf2_init_done, sizeof(ekf2_init_done)) ||
+        !cp.write(&ekf3_init_done, sizeof(ekf3_init_done))) {
+        return false;
+    }
+    // a filter that has not initialised will try again at its next
+    // update, so only the initialised filters are saved
+    return (!ekf2_init_done || ekf2.saveCheckpoint(cp)) &&
+        (!ekf3_init_done || ekf3.saveCheckpoint(cp));
+}
+
+bool AP_DAL::load_checkpoint(AP_DAL_Checkpoint &cp, NavEKF2 &ekf2, NavEKF3 &ekf3)
+{
+    if (!cp.read(&_RFRF.core_slow, sizeof(_RFRF.core_slow)) ||
+        !cp.read(&ekf2_init_done, sizeof(ekf2_init_done)) ||
+        !cp.read(&ekf3_init_done, sizeof(ekf3_init_done))) {
+        return false;
+    }
+    return (!ekf2_init_done || ekf2.loadCheckpoint(cp)) &&
+        (!ekf3_init_done || ekf3.loadCheckpoint(cp)) &&
+        cp.read_complete();
+}
+#endif
+
 namespace AP {
 
 AP_DAL &dal()
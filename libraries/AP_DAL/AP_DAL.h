@@ -8,6 +8,7 @@
 #include "AP_DAL_Airspeed.h"
 #include "AP_DAL_Beacon.h"
 #include "AP_DAL_VisualOdom.h"
+#include "AP_DAL_Checkpoint.h"
 
 #include "LogStructure.h"
 
@@ -81,6 +82,9 @@ public:
     void log_SetOriginLLH3(const Location &loc);
     void log_writeDefaultAirSpeed3(float aspeed);
     void log_writeEulerYawAngle(float yawAngle, float yawAngleErr, uint32_t timeStamp_ms, uint8_t type);
+    void log_setWarmStart3(uint8_t imu_index, const Vector3f &gyro_bias, const Vector3f &accel_bias,
+                           const Vector3f &earth_magfield, const Vector3f &body_magfield,
+                           float yaw, float gyro_bias_var, float accel_bias_var);
 
     enum class StateMask {
         ARMED = (1U<<0),
@@ -308,6 +312,15 @@ public:
     void handle_message(const log_RWOH &msg, NavEKF2 &ekf2, NavEKF3 &ekf3);
     void handle_message(const log_RBOH &msg, NavEKF2 &ekf2, NavEKF3 &ekf3);
 
+#if AP_DAL_CHECKPOINT_ENABLED
+    // save the framing state and the state of the EKFs at the end of
+    // a frame, and load it back. The sensor state is not saved as
+    // Replay rebuilds it by handling every sensor message up to the
+    // frame the checkpoint was saved at
+    bool save_checkpoint(AP_DAL_Checkpoint &cp, const NavEKF2 &ekf2, const NavEKF3 &ekf3) const;
+    bool load_checkpoint(AP_DAL_Checkpoint &cp, NavEKF2 &ekf2, NavEKF3 &ekf3);
+#endif
+
     // map core number for replay
     uint8_t logging_core(uint8_t c) const;
 
@@ -0,0 +1,62 @@
+#include "AP_DAL_Checkpoint.h"
+
+#if AP_DAL_CHECKPOINT_ENABLED
+
+#include <stdlib.h>
+#include <string.h>
+
+AP_DAL_Checkpoint::~AP_DAL_Checkpoint()
+{
+    free(data);
+}
+
+// make space for at least len bytes, doubling to avoid many copies
+bool AP_DAL_Checkpoint::expand(uint32_t len)
+{
+    if (len <= space) {
+        return true;
+    }
+    uint32_t new_space = space > 0 ? space : 4096;
+    while (new_space < len) {
+        new_space *= 2;
+    }
+    uint8_t *new_data = (uint8_t *)realloc(data, new_space);
+    if (new_data == nullptr) {
+        return false;
+    }
+    data = new_data;
+    space = new_space;
+    return true;
+}
+
+bool AP_DAL_Checkpoint::write(const void *ptr, uint32_t len)
+{
+    if (!expand(length + len)) {
+        return false;
+    }
+    memcpy(&data[length], ptr, len);
+    length += len;
+    return true;
+}
+
+bool AP_DAL_Checkpoint::read(void *ptr, uint32_t len)
+{
+    if (length - read_ofs < len) {
+        return false;
+    }
+    memcpy(ptr, &data[read_ofs], len);
+    read_ofs += len;
+    return true;
+}
+
+uint8_t *AP_DAL_Checkpoint::reserve(uint32_t len)
+{
+    clear();
+    if (!expand(len)) {
+        return nullptr;
+    }
+    length = len;
+    return data;
+}
+
+#endif // AP_DAL_CHECKPOINT_ENABLED
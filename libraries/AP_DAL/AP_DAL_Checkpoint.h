@@ -0,0 +1,61 @@
+/*
+  state of the EKFs and the DAL at a frame boundary, which Replay
+  writes to a file alongside the log so it can resume part way
+  through the log. Objects write their state in order and read it
+  back in the same order. Objects are written as images of their
+  memory, so a checkpoint can only be loaded by the same build with
+  the same parameters
+ */
+#pragma once
+
+#include <AP_HAL/AP_HAL_Boards.h>
+#include <AP_Vehicle/AP_Vehicle_Type.h>
+#include <stdint.h>
+
+#ifndef AP_DAL_CHECKPOINT_ENABLED
+#define AP_DAL_CHECKPOINT_ENABLED APM_BUILD_TYPE(APM_BUILD_Replay)
+#endif
+
+#if AP_DAL_CHECKPOINT_ENABLED
+
+class AP_DAL_Checkpoint {
+public:
+    AP_DAL_Checkpoint() {}
+    ~AP_DAL_Checkpoint();
+
+    AP_DAL_Checkpoint(const AP_DAL_Checkpoint &other) = delete;
+    AP_DAL_Checkpoint &operator=(const AP_DAL_Checkpoint&) = delete;
+
+    // append len bytes of state. Returns false if out of memory
+    bool write(const void *ptr, uint32_t len);
+
+    // read the next len bytes of state. Returns false if the
+    // checkpoint is too short
+    bool read(void *ptr, uint32_t len);
+
+    // empty the checkpoint, keeping its memory
+    void clear(void) {
+        length = 0;
+        read_ofs = 0;
+    }
+
+    // empty the checkpoint and return space for len bytes of state
+    // to be filled in, such as from a file, before reading
+    uint8_t *reserve(uint32_t len);
+
+    const uint8_t *get_data(void) const { return data; }
+    uint32_t get_length(void) const { return length; }
+
+    // true when all of the state has been read
+    bool read_complete(void) const { return read_ofs == length; }
+
+private:
+    uint8_t *data;
+    uint32_t length;
+    uint32_t space;
+    uint32_t read_ofs;
+
+    bool expand(uint32_t len);
+};
+
+#endif // AP_DAL_CHECKPOINT_ENABLED
@@ -37,7 +37,8 @@
     LOG_REPH_MSG, \
     LOG_REVH_MSG, \
     LOG_RWOH_MSG, \
-    LOG_RBOH_MSG
+    LOG_RBOH_MSG, \
+    LOG_RWS3_MSG
 
 // Replay Data Structures
 struct log_RFRH {
@@ -351,6 +352,20 @@ struct log_RBOH {
     uint8_t _end;
 };
 
+// @LoggerMessage: RWS3
+// @Description: Replay EKF3 warm start
+struct log_RWS3 {
+    Vector3f gyro_bias;
+    Vector3f accel_bias;
+    Vector3f earth_magfield;
+    Vector3f body_magfield;
+    float yaw;
+    float gyro_bias_var;
+    float accel_bias_var;
+    uint8_t imu_index;
+    uint8_t _end;
+};
+
 #define RLOG_SIZE(sname) 3+offsetof(struct log_ ##sname,_end)
 
 #define LOG_STRUCTURE_FROM_DAL        \
@@ -415,4 +430,6 @@ struct log_RBOH {
     { LOG_RWOH_MSG, RLOG_SIZE(RWOH),                                   \
       "RWOH", "ffIffff", "DA,DT,TS,PX,PY,PZ,R", "-------", "-------" }, \
     { LOG_RBOH_MSG, RLOG_SIZE(RBOH),                                   \
-      "RBOH", "ffffffffIfffH", "Q,DPX,DPY,DPZ,DAX,DAY,DAZ,DT,TS,OX,OY,OZ,D", "-------------", "-------------" },
+      "RBOH", "ffffffffIfffH", "Q,DPX,DPY,DPZ,DAX,DAY,DAZ,DT,TS,OX,OY,OZ,D", "-------------", "-------------" }, \
+    { LOG_RWS3_MSG, RLOG_SIZE(RWS3),                                   \
+      "RWS3", "fffffffffffffffB", "GX,GY,GZ,AX,AY,AZ,EX,EY,EZ,BX,BY,BZ,Yaw,GV,AV,I", "---------------#", "----------------" },
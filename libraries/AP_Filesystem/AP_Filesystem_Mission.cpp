@@ -0,0 +1,339 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  ArduPilot filesystem interface for the mission, allowing the whole
+  mission to be transferred as one file
+ */
+#include "AP_Filesystem.h"
+#include "AP_Filesystem_Mission.h"
+
+#if AP_FILESYSTEM_MISSION_ENABLED
+
+#include <AP_Mission/AP_Mission.h>
+#include <AP_Logger/AP_Logger.h>
+#include <AP_Math/AP_Math.h>
+#include <GCS_MAVLink/GCS.h>
+
+#define MISSION_NAME "mission.dat"
+
+static_assert(sizeof(mavlink_mission_item_int_t) == MAVLINK_MSG_ID_MISSION_ITEM_INT_LEN, "items are stored as the packed message");
+
+extern int errno;
+
+int AP_Filesystem_Mission::open(const char *fname, int flags)
+{
+    if (!check_file_name(fname)) {
+        errno = ENOENT;
+        return -1;
+    }
+    const AP_Mission *mission = AP::mission();
+    if (mission == nullptr) {
+        errno = ENOENT;
+        return -1;
+    }
+    const int mode = flags & O_ACCMODE;
+    if (mode != O_RDONLY && mode != O_WRONLY) {
+        errno = EINVAL;
+        return -1;
+    }
+    uint8_t idx;
+    for (idx=0; idx<max_open_file; idx++) {
+        if (!file[idx].open) {
+            break;
+        }
+    }
+    if (idx == max_open_file) {
+        errno = ENFILE;
+        return -1;
+    }
+    if (mode == O_WRONLY) {
+        // only one upload at a time, including MAVLink uploads
+        if (mavlink_upload_active()) {
+            errno = EBUSY;
+            return -1;
+        }
+        for (uint8_t i=0; i<max_open_file; i++) {
+            if (file[i].open && file[i].writing) {
+                errno = EBUSY;
+                return -1;
+            }
+        }
+    }
+    struct rfile &r = file[idx];
+    memset(&r, 0, sizeof(r));
+    r.writing = (mode == O_WRONLY);
+    if (!r.writing) {
+        r.num_items = mission->num_commands();
+    }
+    r.open = true;
+    return idx;
+}
+
+int AP_Filesystem_Mission::close(int fd)
+{
+    if (fd < 0 || fd >= max_open_file || !file[fd].open) {
+        errno = EBADF;
+        return -1;
+    }
+    struct rfile &r = file[fd];
+    r.open = false;
+    if (r.writing && !r.failed &&
+        r.bytes_taken >= sizeof(struct header) &&
+        r.items_stored == r.hdr.num_items) {
+        AP::logger().Write_EntireMission();
+    }
+    return 0;
+}
+
+/*
+  read from the file. The header is followed by one
+  MISSION_ITEM_INT payload per item
+ */
+int32_t AP_Filesystem_Mission::read(int fd, void *buf, uint32_t count)
+{
+    if (fd < 0 || fd >= max_open_file || !file[fd].open || file[fd].writing) {
+        errno = EBADF;
+        return -1;
+    }
+    struct rfile &r = file[fd];
+    uint8_t *out = (uint8_t *)buf;
+    const uint32_t file_size = sizeof(struct header) + uint32_t(r.num_items) * item_size;
+    uint32_t total = 0;
+
+    while (total < count && r.file_ofs < file_size) {
+        uint8_t item[item_size];
+        uint32_t base;
+        uint8_t len;
+        if (r.file_ofs < sizeof(struct header)) {
+            struct header hdr;
+            hdr.magic = header_magic;
+            hdr.data_type = MAV_MISSION_TYPE_MISSION;
+            hdr.options = 0;
+            hdr.start = 0;
+            hdr.num_items = r.num_items;
+            memcpy(item, &hdr, sizeof(hdr));
+            base = 0;
+            len = sizeof(hdr);
+        } else {
+            const uint16_t idx = (r.file_ofs - sizeof(struct header)) / item_size;
+            if (!get_item(idx, item)) {
+                // the mission has been shortened since the file was opened
+                errno = EIO;
+                return -1;
+            }
+            base = sizeof(struct header) + uint32_t(idx) * item_size;
+            len = item_size;
+        }
+        const uint32_t ofs = r.file_ofs - base;
+        const uint32_t n = MIN(len - ofs, count - total);
+        memcpy(&out[total], &item[ofs], n);
+        total += n;
+        r.file_ofs += n;
+    }
+    return total;
+}
+
+/*
+  write to the file. Data must be written in order, but data which
+  has already been written may be written again and is ignored. Each
+  item is stored to the mission as soon as all of it has arrived
+ */
+int32_t AP_Filesystem_Mission::write(int fd, const void *buf, uint32_t count)
+{
+    if (fd < 0 || fd >= max_open_file || !file[fd].open || !file[fd].writing) {
+        errno = EBADF;
+        return -1;
+    }
+    struct rfile &r = file[fd];
+    if (r.failed || r.file_ofs > r.bytes_taken) {
+        // a gap can't be filled in later
+        errno = EINVAL;
+        return -1;
+    }
+    const uint8_t *in = (const uint8_t *)buf;
+    uint32_t total = MIN(count, r.bytes_taken - r.file_ofs);
+
+    while (total < count) {
+        uint32_t base;
+        uint8_t len;
+        if (r.bytes_taken < sizeof(struct header)) {
+            base = 0;
+            len = sizeof(struct header);
+        } else {
+            base = sizeof(struct header) + ((r.bytes_taken - sizeof(struct header)) / item_size) * item_size;
+            len = item_size;
+        }
+        const uint32_t ofs = r.bytes_taken - base;
+        const uint32_t n = MIN(len - ofs, count - total);
+        memcpy(&r.buf[ofs], &in[total], n);
+        total += n;
+        r.bytes_taken += n;
+        if (ofs + n < len) {
+            continue;
+        }
+        const bool ok = (base == 0) ? start_upload(r) : store_item(r, r.buf);
+        if (!ok) {
+            r.failed = true;
+            errno = EINVAL;
+            return -1;
+        }
+    }
+    r.file_ofs += count;
+    return count;
+}
+
+int32_t AP_Filesystem_Mission::lseek(int fd, int32_t offset, int seek_from)
+{
+    if (fd < 0 || fd >= max_open_file || !file[fd].open) {
+        errno = EBADF;
+        return -1;
+    }
+    struct rfile &r = file[fd];
+    switch (seek_from) {
+    case SEEK_SET:
+        r.file_ofs = offset;
+        break;
+    case SEEK_CUR:
+        r.file_ofs += offset;
+        break;
+    case SEEK_END:
+        errno = EINVAL;
+        return -1;
+    }
+    return r.file_ofs;
+}
+
+int AP_Filesystem_Mission::stat(const char *name, struct stat *stbuf)
+{
+    if (!check_file_name(name)) {
+        errno = ENOENT;
+        return -1;
+    }
+    const AP_Mission *mission = AP::mission();
+    if (mission == nullptr) {
+        errno = ENOENT;
+        return -1;
+    }
+    memset(stbuf, 0, sizeof(*stbuf));
+    stbuf->st_size = sizeof(struct header) + uint32_t(mission->num_commands()) * item_size;
+    return 0;
+}
+
+/*
+  check for the right file name
+ */
+bool AP_Filesystem_Mission::check_file_name(const char *name) const
+{
+    return strcmp(name, MISSION_NAME) == 0;
+}
+
+/*
+  get one item as a MISSION_ITEM_INT payload
+ */
+bool AP_Filesystem_Mission::get_item(uint16_t idx, uint8_t *buf) const
+{
+    const AP_Mission *mission = AP::mission();
+    mavlink_mission_item_int_t item {};
+    if (mission == nullptr || !mission->get_item(idx, item)) {
+        return false;
+    }
+    item.mission_type = MAV_MISSION_TYPE_MISSION;
+    memcpy(buf, &item, item_size);
+    return true;
+}
+
+/*
+  true while a MAVLink mission upload is receiving items. Writes to
+  the mission are made with the mission semaphore held and fail once
+  a MAVLink upload has started, so the two can't interleave
+ */
+bool AP_Filesystem_Mission::mavlink_upload_active(void) const
+{
+    const MissionItemProtocol *prot = gcs().get_prot_for_mission_type(MAV_MISSION_TYPE_MISSION);
+    return prot != nullptr && prot->receiving;
+}
+
+/*
+  check the header of a file being written. Like a MISSION_COUNT, an
+  upload starting at item zero replaces the whole mission
+ */
+bool AP_Filesystem_Mission::start_upload(struct rfile &r)
+{
+    AP_Mission *mission = AP::mission();
+    if (mission == nullptr) {
+        return false;
+    }
+    WITH_SEMAPHORE(mission->get_semaphore());
+    memcpy(&r.hdr, r.buf, sizeof(r.hdr));
+    if (mavlink_upload_active() ||
+        r.hdr.magic != header_magic ||
+        r.hdr.data_type != MAV_MISSION_TYPE_MISSION ||
+        r.hdr.start > mission->num_commands() ||
+        uint32_t(r.hdr.start) + r.hdr.num_items > mission->num_commands_max()) {
+        return false;
+    }
+    if (r.hdr.start == 0) {
+        mission->truncate(r.hdr.num_items);
+    }
+    return true;
+}
+
+/*
+  store the next item of a file being written, with the same checks
+  as an item uploaded with MISSION_ITEM_INT
+ */
+bool AP_Filesystem_Mission::store_item(struct rfile &r, const uint8_t *buf)
+{
+    AP_Mission *mission = AP::mission();
+    if (mission == nullptr || r.items_stored >= r.hdr.num_items) {
+        return false;
+    }
+    WITH_SEMAPHORE(mission->get_semaphore());
+    if (mavlink_upload_active()) {
+        return false;
+    }
+    mavlink_mission_item_int_t item;
+    memcpy(&item, buf, item_size);
+
+    AP_Mission::Mission_Command cmd {};
+    if (AP_Mission::mavlink_int_to_mission_cmd(item, cmd) != MAV_MISSION_ACCEPTED) {
+        return false;
+    }
+
+    const uint16_t idx = r.hdr.start + r.items_stored;
+    const uint16_t end = r.hdr.start + r.hdr.num_items;
+    if (cmd.id == MAV_CMD_DO_JUMP) {
+        if ((cmd.content.jump.target >= mission->num_commands() && cmd.content.jump.target >= end) ||
+            cmd.content.jump.target == 0) {
+            return false;
+        }
+    }
+
+    bool ok;
+    if (idx < mission->num_commands()) {
+        ok = mission->replace_cmd(idx, cmd);
+    } else if (idx == mission->num_commands()) {
+        ok = mission->add_cmd(cmd);
+    } else {
+        ok = false;
+    }
+    if (!ok) {
+        return false;
+    }
+    r.items_stored++;
+    return true;
+}
+
+#endif // AP_FILESYSTEM_MISSION_ENABLED
@@ -0,0 +1,77 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "AP_Filesystem_backend.h"
+
+#include <GCS_MAVLink/GCS_MAVLink.h>
+
+#ifndef AP_FILESYSTEM_MISSION_ENABLED
+#define AP_FILESYSTEM_MISSION_ENABLED (BOARD_FLASH_SIZE > 1024)
+#endif
+
+#if AP_FILESYSTEM_MISSION_ENABLED
+
+class AP_Filesystem_Mission : public AP_Filesystem_Backend
+{
+public:
+    // functions that closely match the equivalent posix calls
+    int open(const char *fname, int flags) override;
+    int close(int fd) override;
+    int32_t read(int fd, void *buf, uint32_t count) override;
+    int32_t write(int fd, const void *buf, uint32_t count) override;
+    int32_t lseek(int fd, int32_t offset, int whence) override;
+    int stat(const char *pathname, struct stat *stbuf) override;
+
+private:
+    // only allow up to 4 files at a time
+    static constexpr uint8_t max_open_file = 4;
+
+    // each item is the payload of a MISSION_ITEM_INT message
+    static constexpr uint8_t item_size = MAVLINK_MSG_ID_MISSION_ITEM_INT_LEN;
+
+    // header at front of the file
+    static constexpr uint16_t header_magic = 0x763d;
+    struct PACKED header {
+        uint16_t magic;
+        uint16_t data_type;
+        uint16_t options;
+        uint16_t start;
+        uint16_t num_items;
+    };
+    static_assert(sizeof(struct header) <= item_size, "header must fit in the item buffer");
+
+    struct rfile {
+        bool open;
+        bool writing;
+        bool failed;
+        uint32_t file_ofs;
+        uint16_t num_items;
+        // file being written
+        struct header hdr;
+        uint32_t bytes_taken;
+        uint16_t items_stored;
+        uint8_t buf[item_size];
+    } file[max_open_file];
+
+    bool check_file_name(const char *fname) const;
+    bool get_item(uint16_t idx, uint8_t *buf) const;
+    bool store_item(struct rfile &r, const uint8_t *buf);
+    bool start_upload(struct rfile &r);
+    bool mavlink_upload_active(void) const;
+};
+
+#endif // AP_FILESYSTEM_MISSION_ENABLED
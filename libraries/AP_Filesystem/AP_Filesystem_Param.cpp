@@ -45,19 +45,20 @@ int AP_Filesystem_Param::open(const char *fname, int flags)
         return -1;
     }
     struct rfile &r = file[idx];
+    memset(&r, 0, sizeof(r));
     r.cursors = new cursor[num_cursors];
     if (r.cursors == nullptr) {
         errno = ENOMEM;
         return -1;
     }
-    r.file_ofs = 0;
     r.open = true;
-    r.start = 0;
-    r.count = 0;
 
     /*
       allow for URI style arguments param.pck?start=N&count=C
      */
+    bool have_crc = false;
+    uint32_t since = 0;
+    uint32_t crc = 0;
     const char *c = strchr(fname, '?');
     while (c && *c) {
         c++;
@@ -81,26 +82,122 @@ int AP_Filesystem_Param::open(const char *fname, int flags)
             c = strchr(c, '&');
             continue;
         }
+#if AP_PARAM_JOURNAL_ENABLED
+        if (strncmp(c, "since=", 6) == 0) {
+            since = strtoul(c+6, nullptr, 10);
+            r.with_gen = true;
+            c += 6;
+            c = strchr(c, '&');
+            continue;
+        }
+        if (strncmp(c, "crc=", 4) == 0) {
+            crc = strtoul(c+4, nullptr, 10);
+            have_crc = true;
+            c += 4;
+            c = strchr(c, '&');
+            continue;
+        }
+#endif
+#if AP_FILESYSTEM_PARAM_DEFLATE_ENABLED
+        if (strncmp(c, "deflate=", 8) == 0) {
+            if (strtoul(c+8, nullptr, 10) != 0 && r.deflate == nullptr) {
+                r.deflate = new compressor;
+                if (r.deflate == nullptr) {
+                    free_file(r);
+                    errno = ENOMEM;
+                    return -1;
+                }
+                compressor_reset(*r.deflate);
+            }
+            c += 8;
+            c = strchr(c, '&');
+            continue;
+        }
+#endif
     }
 
+#if AP_PARAM_JOURNAL_ENABLED
+    if (r.with_gen) {
+        // the generation must be taken before the changes so that
+        // none are missed
+        AP_Param::journal_get(r.generation, r.crc);
+        if (have_crc) {
+            // if the journal doesn't go back to since, or the crc is
+            // from another boot, the whole table is sent
+            get_changes(r, since, crc);
+        }
+    }
+#else
+    (void)have_crc;
+    (void)since;
+    (void)crc;
+#endif
+
     return idx;
 
 failed:
-    delete [] r.cursors;
-    r.open = false;
+    free_file(r);
     errno = EINVAL;
     return -1;
 }
 
+void AP_Filesystem_Param::free_file(struct rfile &r)
+{
+    delete [] r.cursors;
+    r.cursors = nullptr;
+#if AP_PARAM_JOURNAL_ENABLED
+    delete [] r.changed;
+    r.changed = nullptr;
+#endif
+#if AP_FILESYSTEM_PARAM_DEFLATE_ENABLED
+    delete r.deflate;
+    r.deflate = nullptr;
+#endif
+    r.open = false;
+}
+
+#if AP_PARAM_JOURNAL_ENABLED
+/*
+  fill in the list of parameters changed since a generation. Returns
+  false if the journal can't supply them
+ */
+bool AP_Filesystem_Param::get_changes(struct rfile &r, uint32_t since, uint32_t crc)
+{
+    r.changed = new char[AP_PARAM_JOURNAL_SIZE][AP_MAX_NAME_SIZE+1];
+    if (r.changed == nullptr) {
+        return false;
+    }
+    uint16_t count;
+    if (!AP_Param::journal_changes(since, crc, r.changed, count)) {
+        delete [] r.changed;
+        r.changed = nullptr;
+        return false;
+    }
+    // drop any which are no longer visible so that num_params is right
+    r.num_changed = 0;
+    for (uint16_t i=0; i<count; i++) {
+        enum ap_var_type ptype;
+        AP_Param::ParamToken token;
+        if (AP_Param::find_by_name(r.changed[i], &ptype, &token) == nullptr) {
+            continue;
+        }
+        if (i != r.num_changed) {
+            memcpy(r.changed[r.num_changed], r.changed[i], sizeof(r.changed[i]));
+        }
+        r.num_changed++;
+    }
+    r.changes_only = true;
+    return true;
+}
+#endif
+
 int AP_Filesystem_Param::close(int fd)
 {
     if (fd < 0 || fd >= max_open_file || !file[fd].open) {
         errno = EBADF;
         return -1;
     }
-    struct rfile &r = file[fd];
-    r.open = false;
-    delete [] r.cursors;
+    free_file(file[fd]);
     return 0;
 }
 
@@ -123,6 +220,17 @@ int AP_Filesystem_Param::close(int fd)
     Any leading zero bytes after the header should be discarded as pad
     bytes. Pad bytes are used to ensure that a parameter data[] field
     does not cross a read packet boundary
+
+  with since=N in the query the file header is:
+      uint16_t magic = 0x671c
+      uint16_t num_params
+      uint16_t total_params
+      uint16_t flags        // bit 0: only parameters changed since N follow
+      uint32_t generation
+      uint32_t crc
+
+  with deflate=1 the whole file, header included, is sent as a zlib
+  stream without pad bytes
  */
 
 /*
@@ -135,22 +243,37 @@ uint8_t AP_Filesystem_Param::pack_param(const struct rfile &r, struct cursor &c,
     enum ap_var_type ptype;
     AP_Param *ap;
 
-    if (c.token_ofs == 0) {
-        c.idx = 0;
-        ap = AP_Param::first(&c.token, &ptype);
-        uint16_t idx = 0;
-        while (idx < r.start && ap) {
+#if AP_PARAM_JOURNAL_ENABLED
+    if (r.changes_only) {
+        c.idx = (c.token_ofs == 0) ? 0 : c.idx+1;
+        if (c.idx >= r.num_changed) {
+            return 0;
+        }
+        ap = AP_Param::find_by_name(r.changed[c.idx], &ptype, &c.token);
+        if (ap == nullptr) {
+            return 0;
+        }
+        strncpy(name, r.changed[c.idx], AP_MAX_NAME_SIZE);
+    } else
+#endif
+    {
+        if (c.token_ofs == 0) {
+            c.idx = 0;
+            ap = AP_Param::first(&c.token, &ptype);
+            uint16_t idx = 0;
+            while (idx < r.start && ap) {
+                ap = AP_Param::next_scalar(&c.token, &ptype);
+                idx++;
+            }
+        } else {
+            c.idx++;
             ap = AP_Param::next_scalar(&c.token, &ptype);
-            idx++;
         }
-    } else {
-        c.idx++;
-        ap = AP_Param::next_scalar(&c.token, &ptype);
-    }
-    if (ap == nullptr || (r.count && c.idx >= r.count)) {
-        return 0;
+        if (ap == nullptr || (r.count && c.idx >= r.count)) {
+            return 0;
+        }
+        ap->copy_name_token(c.token, name, AP_MAX_NAME_SIZE, true);
     }
-    ap->copy_name_token(c.token, name, AP_MAX_NAME_SIZE, true);
 
     uint8_t common_len = 0;
     const char *last_name = c.last_name;
@@ -170,8 +293,15 @@ uint8_t AP_Filesystem_Param::pack_param(const struct rfile &r, struct cursor &c,
       crosses a block boundary. This ensures that re-reading a block
       won't get a corrupt value for a parameter
      */
-    if (type_len > 1) {
-        const uint32_t ofs = c.token_ofs + sizeof(struct header) + packed_len;
+    bool pad = type_len > 1;
+#if AP_FILESYSTEM_PARAM_DEFLATE_ENABLED
+    if (r.deflate != nullptr) {
+        // a compressed file is only usable once all of it has arrived
+        pad = false;
+    }
+#endif
+    if (pad) {
+        const uint32_t ofs = c.token_ofs + header_size(r) + packed_len;
         const uint32_t ofs_mod = ofs % r.read_size;
         if (ofs_mod > 0 && ofs_mod < type_len) {
             const uint8_t pad = type_len - ofs_mod;
@@ -255,20 +385,21 @@ int32_t AP_Filesystem_Param::read(int fd, void *buf, uint32_t count)
     }
 
 
-    if (r.file_ofs < sizeof(struct header)) {
-        struct header hdr;
-        hdr.total_params = AP_Param::count_parameters();
-        if (hdr.total_params <= r.start) {
+#if AP_FILESYSTEM_PARAM_DEFLATE_ENABLED
+    if (r.deflate != nullptr) {
+        return read_compressed(r, (uint8_t *)buf, count);
+    }
+#endif
+
+    const uint8_t hdr_size = header_size(r);
+    if (r.file_ofs < hdr_size) {
+        uint8_t hdr[max_pack_len];
+        if (!fill_header(r, hdr)) {
             errno = EINVAL;
             return -1;
         }
-        hdr.num_params = hdr.total_params - r.start;
-        if (r.count > 0 && hdr.num_params > r.count) {
-            hdr.num_params = r.count;
-        }
-        uint8_t n = MIN(sizeof(hdr) - r.file_ofs, count);
-        const uint8_t *b = (const uint8_t *)&hdr;
-        memcpy(buf, &b[r.file_ofs], n);
+        uint8_t n = MIN(hdr_size - r.file_ofs, count);
+        memcpy(buf, &hdr[r.file_ofs], n);
         count -= n;
         header_total += n;
         r.file_ofs += n;
@@ -278,7 +409,7 @@ int32_t AP_Filesystem_Param::read(int fd, void *buf, uint32_t count)
         }
     }
 
-    uint32_t data_ofs = r.file_ofs - sizeof(struct header);
+    uint32_t data_ofs = r.file_ofs - hdr_size;
     uint8_t best_i = 0;
     uint32_t best_ofs = r.cursors[0].token_ofs;
     size_t total = 0;
@@ -339,6 +470,125 @@ int32_t AP_Filesystem_Param::read(int fd, void *buf, uint32_t count)
     return total + header_total;
 }
 
+uint8_t AP_Filesystem_Param::header_size(const struct rfile &r) const
+{
+#if AP_PARAM_JOURNAL_ENABLED
+    if (r.with_gen) {
+        return sizeof(struct header_gen);
+    }
+#endif
+    return sizeof(struct header);
+}
+
+/*
+  fill in the file header. buf must have room for header_size() bytes
+ */
+bool AP_Filesystem_Param::fill_header(const struct rfile &r, uint8_t *buf)
+{
+    const uint16_t total_params = AP_Param::count_parameters();
+    uint16_t num_params;
+#if AP_PARAM_JOURNAL_ENABLED
+    if (r.changes_only) {
+        num_params = r.num_changed;
+    } else
+#endif
+    {
+        if (total_params <= r.start) {
+            return false;
+        }
+        num_params = total_params - r.start;
+        if (r.count > 0 && num_params > r.count) {
+            num_params = r.count;
+        }
+    }
+#if AP_PARAM_JOURNAL_ENABLED
+    if (r.with_gen) {
+        struct header_gen hdr;
+        hdr.num_params = num_params;
+        hdr.total_params = total_params;
+        hdr.flags = r.changes_only ? header_flag_changes : 0;
+        hdr.generation = r.generation;
+        hdr.crc = r.crc;
+        memcpy(buf, &hdr, sizeof(hdr));
+        return true;
+    }
+#endif
+    struct header hdr;
+    hdr.num_params = num_params;
+    hdr.total_params = total_params;
+    memcpy(buf, &hdr, sizeof(hdr));
+    return true;
+}
+
+#if AP_FILESYSTEM_PARAM_DEFLATE_ENABLED
+void AP_Filesystem_Param::compressor_reset(struct compressor &z)
+{
+    z.encoder.reset();
+    memset(&z.c, 0, sizeof(z.c));
+    z.out_ofs = 0;
+    z.pending_len = 0;
+    z.pending_ofs = 0;
+    z.header_done = false;
+    z.input_done = false;
+}
+
+/*
+  read from a compressed file. The uncompressed file is fed to the
+  encoder a header or parameter at a time, and output before the file
+  offset is discarded
+ */
+int32_t AP_Filesystem_Param::read_compressed(struct rfile &r, uint8_t *buf, uint32_t count)
+{
+    struct compressor &z = *r.deflate;
+    if (r.file_ofs < z.out_ofs) {
+        // going back, eg. to fill in a lost block
+        compressor_reset(z);
+    }
+    uint32_t total = 0;
+    while (total < count) {
+        uint16_t n;
+        if (z.out_ofs < r.file_ofs) {
+            n = z.encoder.read(nullptr, MIN(r.file_ofs - z.out_ofs, UINT16_MAX));
+        } else {
+            n = z.encoder.read(&buf[total], MIN(count - total, UINT16_MAX));
+            total += n;
+            r.file_ofs += n;
+        }
+        z.out_ofs += n;
+        if (n > 0) {
+            continue;
+        }
+        if (z.input_done) {
+            // all of the output has been read
+            break;
+        }
+        if (z.pending_ofs == z.pending_len) {
+            uint8_t len;
+            if (!z.header_done) {
+                if (!fill_header(r, z.pending)) {
+                    errno = EINVAL;
+                    return -1;
+                }
+                len = header_size(r);
+                z.header_done = true;
+            } else {
+                len = pack_param(r, z.c, z.pending);
+                z.c.token_ofs += len;
+            }
+            z.pending_len = len;
+            z.pending_ofs = 0;
+            if (len == 0) {
+                z.encoder.finish();
+                z.input_done = true;
+                continue;
+            }
+        }
+        z.pending_ofs += z.encoder.write(&z.pending[z.pending_ofs], z.pending_len - z.pending_ofs);
+    }
+    return total;
+}
+#endif // AP_FILESYSTEM_PARAM_DEFLATE_ENABLED
+
 int32_t AP_Filesystem_Param::lseek(int fd, int32_t offset, int seek_from)
 {
     if (fd < 0 || fd >= max_open_file || !file[fd].open) {
@@ -18,6 +18,12 @@
 #include "AP_Filesystem_backend.h"
 
 #include <AP_Param/AP_Param.h>
+#include <AP_Common/DeflateEncoder.h>
+
+// allow param.pck to be fetched compressed with ?deflate=1
+#ifndef AP_FILESYSTEM_PARAM_DEFLATE_ENABLED
+#define AP_FILESYSTEM_PARAM_DEFLATE_ENABLED (BOARD_FLASH_SIZE > 1024)
+#endif
 
 class AP_Filesystem_Param : public AP_Filesystem_Backend
 {
@@ -47,6 +53,22 @@ private:
         uint16_t total_params;
     };
 
+#if AP_PARAM_JOURNAL_ENABLED
+    // header at front of the file when the query has since=N
+    struct header_gen {
+        uint16_t magic = 0x671c;
+        uint16_t num_params;
+        uint16_t total_params;
+        uint16_t flags;
+        uint32_t generation;
+        uint32_t crc;
+    };
+    static_assert(sizeof(struct header_gen) <= max_pack_len, "header_gen must fit in a pack buffer");
+
+    // the file holds only the parameters changed since the requested generation
+    static constexpr uint16_t header_flag_changes = (1U<<0);
+#endif
+
     struct cursor {
         AP_Param::ParamToken token;
         uint32_t token_ofs;
@@ -56,6 +78,24 @@ private:
         uint16_t idx;
     };
 
+#if AP_FILESYSTEM_PARAM_DEFLATE_ENABLED
+    /*
+      state of a compressed file. Reads are served from one encoder,
+      which starts again from the beginning if asked for an earlier
+      offset than it has reached
+     */
+    struct compressor {
+        DeflateEncoder encoder;
+        struct cursor c;        // position in the uncompressed data
+        uint32_t out_ofs;       // compressed bytes taken from the encoder
+        uint8_t pending[max_pack_len];
+        uint8_t pending_len;
+        uint8_t pending_ofs;
+        bool header_done;
+        bool input_done;
+    };
+#endif
+
     struct rfile {
         bool open;
         uint16_t read_size;
@@ -63,8 +103,29 @@ private:
         uint16_t count;
         uint32_t file_ofs;
         struct cursor *cursors;
+#if AP_PARAM_JOURNAL_ENABLED
+        bool with_gen;
+        bool changes_only;
+        uint32_t generation;
+        uint32_t crc;
+        uint16_t num_changed;
+        char (*changed)[AP_MAX_NAME_SIZE+1];
+#endif
+#if AP_FILESYSTEM_PARAM_DEFLATE_ENABLED
+        struct compressor *deflate;
+#endif
     } file[max_open_file];
 
+    void free_file(struct rfile &r);
+    uint8_t header_size(const struct rfile &r) const;
+    bool fill_header(const struct rfile &r, uint8_t *buf);
+#if AP_PARAM_JOURNAL_ENABLED
+    bool get_changes(struct rfile &r, uint32_t since, uint32_t crc);
+#endif
+#if AP_FILESYSTEM_PARAM_DEFLATE_ENABLED
+    void compressor_reset(struct compressor &z);
+    int32_t read_compressed(struct rfile &r, uint8_t *buf, uint32_t count);
+#endif
     bool token_seek(const struct rfile &r, const uint32_t data_ofs, struct cursor &c);
     uint8_t pack_param(const struct rfile &r, struct cursor &c, uint8_t *buf);
     bool check_file_name(const char *fname);
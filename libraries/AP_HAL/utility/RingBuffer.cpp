@@ -264,3 +264,198 @@ int16_t ByteBuffer::peek(uint32_t ofs) const
     }
     return buf[(head+ofs)%size];
 }
+
+/*
+ * ByteBuffer_SPSC: lock-free single producer, single consumer ring
+ */
+
+// round up to a power of 2 so indexes can be masked
+static uint32_t round_up_pow2(uint32_t n)
+{
+    if (n <= 1) {
+        return n;
+    }
+    n--;
+    n |= n >> 1;
+    n |= n >> 2;
+    n |= n >> 4;
+    n |= n >> 8;
+    n |= n >> 16;
+    return n + 1;
+}
+
+ByteBuffer_SPSC::ByteBuffer_SPSC(uint32_t _size)
+{
+    _size = round_up_pow2(_size);
+    buf = _size ? (uint8_t*)calloc(1, _size) : nullptr;
+    size = buf ? _size : 0;
+}
+
+ByteBuffer_SPSC::~ByteBuffer_SPSC(void)
+{
+    free(buf);
+}
+
+/*
+ * Caller is responsible for making sure neither side is using the buffer
+ */
+bool ByteBuffer_SPSC::set_size(uint32_t _size)
+{
+    _size = round_up_pow2(_size);
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+    if (_size != size) {
+        free(buf);
+        buf = _size ? (uint8_t*)calloc(1, _size) : nullptr;
+        if (buf == nullptr) {
+            size = 0;
+            return _size == 0;
+        }
+        size = _size;
+    }
+    return true;
+}
+
+uint32_t ByteBuffer_SPSC::available(void) const
+{
+    return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+}
+
+uint32_t ByteBuffer_SPSC::space(void) const
+{
+    return size - available();
+}
+
+bool ByteBuffer_SPSC::is_empty(void) const
+{
+    return available() == 0;
+}
+
+void ByteBuffer_SPSC::clear(void)
+{
+    head.store(tail.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+uint8_t ByteBuffer_SPSC::make_iovec(ByteBuffer::IoVec vec[2], uint32_t idx, uint32_t len) const
+{
+    if (len == 0) {
+        return 0;
+    }
+    const uint32_t ofs = idx & (size - 1);
+    const uint32_t n = size - ofs;
+    vec[0].data = &buf[ofs];
+    if (len <= n) {
+        vec[0].len = len;
+        return 1;
+    }
+    vec[0].len = n;
+    vec[1].data = &buf[0];
+    vec[1].len = len - n;
+    return 2;
+}
+
+uint32_t ByteBuffer_SPSC::write(const uint8_t *data, uint32_t len)
+{
+    ByteBuffer::IoVec vec[2];
+    const uint8_t n_vec = reserve(vec, len);
+    uint32_t ret = 0;
+    for (uint8_t i = 0; i < n_vec; i++) {
+        memcpy(vec[i].data, data + ret, vec[i].len);
+        ret += vec[i].len;
+    }
+    commit(ret);
+    return ret;
+}
+
+uint8_t ByteBuffer_SPSC::reserve(ByteBuffer::IoVec vec[2], uint32_t len)
+{
+    const uint32_t _tail = tail.load(std::memory_order_relaxed);
+    const uint32_t _space = size - (_tail - head.load(std::memory_order_acquire));
+    if (len > _space) {
+        len = _space;
+    }
+    return make_iovec(vec, _tail, len);
+}
+
+bool ByteBuffer_SPSC::commit(uint32_t len)
+{
+    if (len > space()) {
+        return false;
+    }
+    tail.store(tail.load(std::memory_order_relaxed) + len, std::memory_order_release);
+    return true;
+}
+
+uint32_t ByteBuffer_SPSC::peekbytes(uint8_t *data, uint32_t len)
+{
+    ByteBuffer::IoVec vec[2];
+    const uint8_t n_vec = peekiovec(vec, len);
+    uint32_t ret = 0;
+    for (uint8_t i = 0; i < n_vec; i++) {
+        memcpy(data + ret, vec[i].data, vec[i].len);
+        ret += vec[i].len;
+    }
+    return ret;
+}
+
+uint8_t ByteBuffer_SPSC::peekiovec(ByteBuffer::IoVec vec[2], uint32_t len)
+{
+    const uint32_t _head = head.load(std::memory_order_relaxed);
+    const uint32_t _available = tail.load(std::memory_order_acquire) - _head;
+    if (len > _available) {
+        len = _available;
+    }
+    return make_iovec(vec, _head, len);
+}
+
+uint32_t ByteBuffer_SPSC::read(uint8_t *data, uint32_t len)
+{
+    const uint32_t ret = peekbytes(data, len);
+    advance(ret);
+    return ret;
+}
+
+bool ByteBuffer_SPSC::read_byte(uint8_t *data)
+{
+    if (!data) {
+        return false;
+    }
+    const int16_t ret = peek(0);
+    if (ret < 0) {
+        return false;
+    }
+    *data = ret;
+    return advance(1);
+}
+
+bool ByteBuffer_SPSC::advance(uint32_t n)
+{
+    if (n > available()) {
+        return false;
+    }
+    head.store(head.load(std::memory_order_relaxed) + n, std::memory_order_release);
+    return true;
+}
+
+const uint8_t *ByteBuffer_SPSC::readptr(uint32_t &available_bytes)
+{
+    const uint32_t _head = head.load(std::memory_order_relaxed);
+    available_bytes = tail.load(std::memory_order_acquire) - _head;
+    if (available_bytes == 0) {
+        return nullptr;
+    }
+    const uint32_t ofs = _head & (size - 1);
+    if (available_bytes > size - ofs) {
+        available_bytes = size - ofs;
+    }
+    return &buf[ofs];
+}
+
+int16_t ByteBuffer_SPSC::peek(uint32_t ofs) const
+{
+    const uint32_t _head = head.load(std::memory_order_relaxed);
+    if (ofs >= tail.load(std::memory_order_acquire) - _head) {
+        return -1;
+    }
+    return buf[(_head + ofs) & (size - 1)];
+}
@@ -101,6 +101,90 @@ private:
     bool external_buf;
 };
 
+/*
+ * Lock-free circular buffer of bytes for exactly one producer thread
+ * and one consumer thread. The producer owns the tail and may call
+ * space(), write(), reserve() and commit(); the consumer owns the
+ * head and may call read(), read_byte(), peek(), peekbytes(),
+ * peekiovec(), readptr(), advance() and clear(). available() and
+ * space() may be called from either side.
+ *
+ * The size is rounded up to a power of 2 and all of it is usable. The
+ * indexes run freely and are masked on access; each side publishes
+ * its index with a release store and loads the other side's with an
+ * acquire, so no semaphore is needed.
+ */
+class ByteBuffer_SPSC {
+public:
+    ByteBuffer_SPSC(uint32_t size);
+    ~ByteBuffer_SPSC(void);
+
+    // number of bytes available to be read
+    uint32_t available(void) const;
+
+    // discards the buffer content, emptying it. Consumer only
+    void clear(void);
+
+    // number of bytes space available to write
+    uint32_t space(void) const;
+
+    // true if available() is zero
+    bool is_empty(void) const WARN_IF_UNUSED;
+
+    // write bytes to ringbuffer. Returns number of bytes written
+    uint32_t write(const uint8_t *data, uint32_t len);
+
+    // read bytes from ringbuffer. Returns number of bytes read
+    uint32_t read(uint8_t *data, uint32_t len);
+
+    // read a byte from ring buffer. Returns true on success, false otherwise
+    bool read_byte(uint8_t *data) WARN_IF_UNUSED;
+
+    // return size of ringbuffer
+    uint32_t get_size(void) const { return size; }
+
+    // set size of ringbuffer, rounded up to a power of 2. Not thread
+    // safe; neither side may be using the buffer
+    bool set_size(uint32_t size);
+
+    // advance the read pointer (discarding bytes)
+    bool advance(uint32_t n);
+
+    // Returns the pointer and size to a contiguous read of the next available data
+    const uint8_t *readptr(uint32_t &available_bytes);
+
+    // peek one byte without advancing read pointer. Return byte
+    // or -1 if none available
+    int16_t peek(uint32_t ofs) const;
+
+    // read len bytes without advancing the read pointer
+    uint32_t peekbytes(uint8_t *data, uint32_t len);
+
+    // fill out vec with up to len bytes of the data available to
+    // read, in one part or two if it wraps. Returns the number of
+    // parts. Consume the data with advance()
+    uint8_t peekiovec(ByteBuffer::IoVec vec[2], uint32_t len);
+
+    // fill out vec with up to len bytes of free space, in one part or
+    // two if it wraps, so the producer can read() or DMA straight into
+    // the buffer. Returns the number of parts. Publish the data with
+    // commit(); write() must not be called in between
+    uint8_t reserve(ByteBuffer::IoVec vec[2], uint32_t len);
+
+    // make len bytes of previously reserved space available to read
+    bool commit(uint32_t len);
+
+private:
+    uint8_t *buf;
+    uint32_t size;
+
+    std::atomic<uint32_t> head{0}; // bytes read, owned by the consumer
+    std::atomic<uint32_t> tail{0}; // bytes written, owned by the producer
+
+    // split len bytes from free running index idx into one or two parts
+    uint8_t make_iovec(ByteBuffer::IoVec vec[2], uint32_t idx, uint32_t len) const;
+};
+
 /*
   ring buffer class for objects of fixed size
   !!! Note ObjectBuffer_TS is a duplicate of this update, in both places !!!
@@ -4,4 +4,5 @@
   return the number of bytes to send for a packetised connection
 */
 uint16_t mavlink_packetise(ByteBuffer &writebuf, uint16_t n);
+uint16_t mavlink_packetise(ByteBuffer_SPSC &writebuf, uint16_t n);
 
@@ -0,0 +1,133 @@
+#include <AP_gtest.h>
+
+#include <thread>
+#include <AP_HAL/utility/RingBuffer.h>
+
+TEST(ByteBuffer_SPSC, Size)
+{
+    ByteBuffer_SPSC buf{1000};
+    EXPECT_EQ(1024U, buf.get_size());
+    EXPECT_EQ(1024U, buf.space());
+    EXPECT_TRUE(buf.is_empty());
+
+    EXPECT_TRUE(buf.set_size(0));
+    EXPECT_EQ(0U, buf.get_size());
+    EXPECT_EQ(0U, buf.space());
+    const uint8_t b = 1;
+    EXPECT_EQ(0U, buf.write(&b, 1));
+
+    EXPECT_TRUE(buf.set_size(16));
+    EXPECT_EQ(16U, buf.space());
+}
+
+// the whole buffer is usable, and data survives the wrap
+TEST(ByteBuffer_SPSC, Wrap)
+{
+    ByteBuffer_SPSC buf{16};
+    uint8_t data[16];
+    for (uint8_t i=0; i<sizeof(data); i++) {
+        data[i] = i;
+    }
+    EXPECT_EQ(16U, buf.write(data, 16));
+    EXPECT_EQ(0U, buf.space());
+    EXPECT_EQ(0U, buf.write(data, 1));
+
+    uint8_t out[16];
+    EXPECT_EQ(10U, buf.read(out, 10));
+    EXPECT_EQ(0, memcmp(out, data, 10));
+    EXPECT_EQ(8U, buf.write(data, 8));
+    EXPECT_EQ(14U, buf.available());
+    EXPECT_EQ(15, buf.peek(5));
+    EXPECT_EQ(0, buf.peek(6));
+    EXPECT_EQ(-1, buf.peek(14));
+
+    uint32_t n;
+    const uint8_t *p = buf.readptr(n);
+    ASSERT_NE(nullptr, p);
+    EXPECT_EQ(6U, n);
+    EXPECT_EQ(10, p[0]);
+
+    ByteBuffer::IoVec vec[2];
+    EXPECT_EQ(2, buf.peekiovec(vec, 100));
+    EXPECT_EQ(6U, vec[0].len);
+    EXPECT_EQ(8U, vec[1].len);
+
+    EXPECT_EQ(14U, buf.read(out, 16));
+    EXPECT_EQ(0, memcmp(out, &data[10], 6));
+    EXPECT_EQ(0, memcmp(&out[6], data, 8));
+    EXPECT_TRUE(buf.is_empty());
+}
+
+TEST(ByteBuffer_SPSC, ReserveCommit)
+{
+    ByteBuffer_SPSC buf{8};
+    uint8_t data[6] {1, 2, 3, 4, 5, 6};
+    uint8_t out[8];
+    EXPECT_EQ(6U, buf.write(data, 6));
+    EXPECT_EQ(6U, buf.read(out, 6));
+
+    ByteBuffer::IoVec vec[2];
+    EXPECT_EQ(2, buf.reserve(vec, 5));
+    EXPECT_EQ(2U, vec[0].len);
+    EXPECT_EQ(3U, vec[1].len);
+    // nothing is visible until it is committed
+    EXPECT_TRUE(buf.is_empty());
+    memcpy(vec[0].data, data, 2);
+    memcpy(vec[1].data, &data[2], 3);
+    EXPECT_TRUE(buf.commit(5));
+    EXPECT_EQ(5U, buf.available());
+    EXPECT_FALSE(buf.commit(4));
+
+    uint8_t c;
+    EXPECT_TRUE(buf.read_byte(&c));
+    EXPECT_EQ(1, c);
+    EXPECT_TRUE(buf.advance(3));
+    EXPECT_FALSE(buf.advance(2));
+    EXPECT_TRUE(buf.read_byte(&c));
+    EXPECT_EQ(5, c);
+    EXPECT_FALSE(buf.read_byte(&c));
+}
+
+// a producer and a consumer thread moving a counting sequence through
+// a small buffer must see every byte exactly once, in order
+TEST(ByteBuffer_SPSC, Threads)
+{
+    ByteBuffer_SPSC buf{64};
+    const uint32_t total = 100000;
+    uint32_t errors = 0;
+
+    std::thread producer([&buf, total]() {
+        uint32_t count = 0;
+        while (count < total) {
+            ByteBuffer::IoVec vec[2];
+            const uint8_t n_vec = buf.reserve(vec, 1 + count % 37);
+            uint32_t n = 0;
+            for (uint8_t i=0; i<n_vec; i++) {
+                for (uint32_t j=0; j<vec[i].len && count+n < total; j++) {
+                    vec[i].data[j] = uint8_t(count + n);
+                    n++;
+                }
+            }
+            buf.commit(n);
+            count += n;
+        }
+    });
+
+    uint32_t count = 0;
+    while (count < total) {
+        uint8_t out[29];
+        const uint32_t n = buf.read(out, 1 + count % sizeof(out));
+        for (uint32_t i=0; i<n; i++) {
+            if (out[i] != uint8_t(count + i)) {
+                errors++;
+            }
+        }
+        count += n;
+    }
+    producer.join();
+
+    EXPECT_EQ(0U, errors);
+    EXPECT_TRUE(buf.is_empty());
+}
+
+AP_GTEST_MAIN()
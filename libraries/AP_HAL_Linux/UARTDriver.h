@@ -95,9 +95,11 @@ protected:
     volatile bool _initialised;
 
     // we use in-task ring buffers to reduce the system call cost
-    // of ::read() and ::write() in the main loop
-    ByteBuffer _readbuf{0};
-    ByteBuffer _writebuf{0};
+    // of ::read() and ::write() in the main loop. The timer thread
+    // is the only producer of _readbuf and the only consumer of
+    // _writebuf; writers to _writebuf are serialised by _write_mutex
+    ByteBuffer_SPSC _readbuf{0};
+    ByteBuffer_SPSC _writebuf{0};
 
     virtual int _write_fd(const uint8_t *buf, uint16_t n);
     virtual int _read_fd(uint8_t *buf, uint16_t n);
@@ -31,6 +31,7 @@
 #include <sys/ioctl.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <sys/select.h>
@@ -672,10 +673,19 @@ void UARTDriver::_timer_tick(void)
             n = mavlink_packetise(_writebuffer, n);
         }
         if (n > 0) {
-            // keep as a single UDP packet
-            uint8_t tmpbuf[n];
-            _writebuffer.peekbytes(tmpbuf, n);
-            ssize_t ret = send(_fd, tmpbuf, n, MSG_DONTWAIT);
+            // keep as a single UDP packet, gathered straight from the
+            // ring even if it wraps
+            ByteBuffer::IoVec vec[2];
+            struct iovec iov[2];
+            const uint8_t n_vec = _writebuffer.peekiovec(vec, n);
+            for (uint8_t i=0; i<n_vec; i++) {
+                iov[i].iov_base = vec[i].data;
+                iov[i].iov_len = vec[i].len;
+            }
+            struct msghdr msg {};
+            msg.msg_iov = iov;
+            msg.msg_iovlen = n_vec;
+            ssize_t ret = sendmsg(_fd, &msg, MSG_DONTWAIT);
             if (ret > 0) {
                 _writebuffer.advance(ret);
             }
@@ -714,14 +724,27 @@ void UARTDriver::_timer_tick(void)
         return;
     }
     space = MIN(space, max_bytes);
-    
-    char buf[space];
+
+    // receive straight into the free space of the ring, which is in
+    // two parts if it wraps
+    ByteBuffer::IoVec vec[2];
+    struct iovec iov[2];
+    const uint8_t n_vec = _readbuffer.reserve(vec, space);
+    for (uint8_t i=0; i<n_vec; i++) {
+        iov[i].iov_base = vec[i].data;
+        iov[i].iov_len = vec[i].len;
+    }
+    struct msghdr msg {};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = n_vec;
+
     ssize_t nread = 0;
     if (_mc_fd >= 0) {
         if (_select_check(_mc_fd)) {
             struct sockaddr_in from;
-            socklen_t fromlen = sizeof(from);
-            nread = recvfrom(_mc_fd, buf, space, MSG_DONTWAIT, (struct sockaddr *)&from, &fromlen);
+            msg.msg_name = &from;
+            msg.msg_namelen = sizeof(from);
+            nread = recvmsg(_mc_fd, &msg, MSG_DONTWAIT);
             uint16_t port = ntohs(from.sin_port);
             if (_mc_myport == 0) {
                 // get our own address, so we can recognise packets from ourself
@@ -745,14 +768,14 @@ void UARTDriver::_timer_tick(void)
             return;
         }
         int fd = _console?0:_fd;
-        nread = ::read(fd, buf, space);
+        nread = ::readv(fd, iov, n_vec);
         if (nread == -1 && errno != EAGAIN && _uart_path) {
             close(_fd);
             _fd = -1;
             _connected = false;
         }
     } else if (_select_check(_fd)) {
-        nread = recv(_fd, buf, space, MSG_DONTWAIT);
+        nread = recvmsg(_fd, &msg, MSG_DONTWAIT);
         if (nread <= 0 && !_is_udp) {
             // the socket has reached EOF
             close(_fd);
@@ -764,7 +787,7 @@ void UARTDriver::_timer_tick(void)
         }
     }
     if (nread > 0) {
-        _readbuffer.write((uint8_t *)buf, nread);
+        _readbuffer.commit(nread);
         _receive_timestamp = AP_HAL::micros64();
     }
 }
@@ -95,8 +95,8 @@ private:
     int _serial_port;
     static bool _console;
     bool _nonblocking_writes;
-    ByteBuffer _readbuffer{16384};
-    ByteBuffer _writebuffer{16384};
+    ByteBuffer_SPSC _readbuffer{16384};
+    ByteBuffer_SPSC _writebuffer{16384};
 
     // default multicast IP and port
     const char *mcast_ip_default = "239.255.145.50";
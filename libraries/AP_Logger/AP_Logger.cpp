@@ -114,6 +114,15 @@ const AP_Param::GroupInfo AP_Logger::var_info[] = {
     // @User: Standard
     AP_GROUPINFO("_FILE_MB_FREE",  7, AP_Logger, _params.min_MB_free, 500),
 
+#if HAL_LOGGER_COLUMNAR_ENABLED
+    // @Param: _FILE_FORMAT
+    // @DisplayName: Log file format
+    // @Description: Format used for new log files. Columnar logs group messages by type and compress timestamps and slowly changing fields, and can only be read by Replay, which decodes them; other log tools need raw logs. Raw is the default. Takes effect when the next log is started.
+    // @Values: 0:Raw,1:Columnar
+    // @User: Advanced
+    AP_GROUPINFO("_FILE_FORMAT",  8, AP_Logger, _params.file_format, 0),
+#endif
+
     AP_GROUPEND
 };
 
@@ -208,29 +208,11 @@ bool AP_Logger_Backend::Write_Emit_FMT(uint8_t msg_type)
     return true;
 }
 
-bool AP_Logger_Backend::Write(const uint8_t msg_type, va_list arg_list, bool is_critical)
+/*
+  pack the arguments of a Write() call into a message in buffer
+ */
+static void pack_message(uint8_t *buffer, const uint8_t msg_type, const char *fmt, va_list arg_list)
 {
-    // stack-allocate a buffer so we can WriteBlock(); this could be
-    // 255 bytes!  If we were willing to lose the WriteBlock
-    // abstraction we could do WriteBytes() here instead?
-    const char *fmt  = nullptr;
-    uint8_t msg_len;
-    AP_Logger::log_write_fmt *f;
-    for (f = _front.log_write_fmts; f; f=f->next) {
-        if (f->msg_type == msg_type) {
-            fmt = f->fmt;
-            msg_len = f->msg_len;
-            break;
-        }
-    }
-    if (fmt == nullptr) {
-        INTERNAL_ERROR(AP_InternalError::error_t::logger_logwrite_missingfmt);
-        return false;
-    }
-    if (bufferspace_available() < msg_len) {
-        return false;
-    }
-    uint8_t buffer[msg_len];
     uint8_t offset = 0;
     buffer[offset++] = HEAD_BYTE1;
     buffer[offset++] = HEAD_BYTE2;
@@ -329,7 +311,45 @@ bool AP_Logger_Backend::Write(const uint8_t msg_type, va_list arg_list, bool is_
             offset += charlen;
         }
     }
+}
 
+bool AP_Logger_Backend::Write(const uint8_t msg_type, va_list arg_list, bool is_critical)
+{
+    const char *fmt  = nullptr;
+    uint8_t msg_len;
+    AP_Logger::log_write_fmt *f;
+    for (f = _front.log_write_fmts; f; f=f->next) {
+        if (f->msg_type == msg_type) {
+            fmt = f->fmt;
+            msg_len = f->msg_len;
+            break;
+        }
+    }
+    if (fmt == nullptr) {
+        INTERNAL_ERROR(AP_InternalError::error_t::logger_logwrite_missingfmt);
+        return false;
+    }
+    if (bufferspace_available() < msg_len) {
+        return false;
+    }
+#if HAL_LOGGER_MULTI_WRITER_ENABLED
+    // fill the message in place in the backend's buffer if we can
+    if (supports_reservations()) {
+        LoggerWriteBuffer::Reservation reservation;
+        uint8_t *buffer = reserve_block(msg_len, is_critical, reservation);
+        if (buffer == nullptr) {
+            return false;
+        }
+        pack_message(buffer, msg_type, fmt, arg_list);
+        commit_block(reservation);
+        return true;
+    }
+#endif
+    // stack-allocate a buffer so we can WriteBlock(); this could be
+    // 255 bytes!  If we were willing to lose the WriteBlock
+    // abstraction we could do WriteBytes() here instead?
+    uint8_t buffer[msg_len];
+    pack_message(buffer, msg_type, fmt, arg_list);
     return WritePrioritisedBlock(buffer, msg_len, is_critical);
 }
 
@@ -414,6 +434,30 @@ bool AP_Logger_Backend::WritePrioritisedBlock(const void *pBuffer, uint16_t size
     return _WritePrioritisedBlock(pBuffer, size, is_critical);
 }
 
+#if HAL_LOGGER_MULTI_WRITER_ENABLED
+uint8_t *AP_Logger_Backend::reserve_block(uint16_t size, bool is_critical, LoggerWriteBuffer::Reservation &r)
+{
+    if (!ShouldLog(is_critical)) {
+        return nullptr;
+    }
+    if (StartNewLogOK()) {
+        start_new_log();
+    }
+    if (!WritesOK()) {
+        return nullptr;
+    }
+    return _reserve_block(size, is_critical, r);
+}
+
+void AP_Logger_Backend::commit_block(const LoggerWriteBuffer::Reservation &r)
+{
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL && !APM_BUILD_TYPE(APM_BUILD_Replay)
+    validate_WritePrioritisedBlock(r.data, r.size);
+#endif
+    _commit_block(r);
+}
+#endif
+
 bool AP_Logger_Backend::ShouldLog(bool is_critical)
 {
     if (!_front.WritesEnabled()) {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "AP_Logger.h"
+#include "LoggerWriteBuffer.h"
 
 class LoggerMessageWriter_DFLogStart;
 
@@ -33,6 +34,18 @@ public:
 
     bool WritePrioritisedBlock(const void *pBuffer, uint16_t size, bool is_critical);
 
+#if HAL_LOGGER_MULTI_WRITER_ENABLED
+    /*
+      zero-copy writes: reserve_block() returns space for a message of
+      size bytes which the caller fills in place and then passes to
+      commit_block(). Only valid when supports_reservations() is true;
+      returns nullptr if the message is to be dropped
+     */
+    virtual bool supports_reservations() const { return false; }
+    uint8_t *reserve_block(uint16_t size, bool is_critical, LoggerWriteBuffer::Reservation &r);
+    void commit_block(const LoggerWriteBuffer::Reservation &r);
+#endif
+
     // high level interface, indexed by the position in the list of logs
     virtual uint16_t find_last_log() = 0;
     virtual void get_log_boundaries(uint16_t list_entry, uint32_t & start_page, uint32_t & end_page) = 0;
@@ -156,7 +169,7 @@ protected:
 
     uint16_t _cached_oldest_log;
 
-    uint32_t _dropped;
+    std::atomic<uint32_t> _dropped; // may be incremented from any writer thread
     uint32_t _log_file_size_bytes;
     // should we rotate when we next stop logging
     bool _rotate_pending;
@@ -188,6 +201,10 @@ protected:
     };
 
     virtual bool _WritePrioritisedBlock(const void *pBuffer, uint16_t size, bool is_critical) = 0;
+#if HAL_LOGGER_MULTI_WRITER_ENABLED
+    virtual uint8_t *_reserve_block(uint16_t size, bool is_critical, LoggerWriteBuffer::Reservation &r) { return nullptr; }
+    virtual void _commit_block(const LoggerWriteBuffer::Reservation &r) { }
+#endif
 
     bool _initialised;
 
@@ -0,0 +1,489 @@
+/*
+   AP_Logger columnar log encoding
+
+   A columnar log file starts with file_magic followed by a sequence
+   of chunks, each a ChunkHeader followed by encoded_length bytes of
+   payload which decode to raw_length bytes of the normal log stream.
+
+   COLUMNAR chunk payload:
+     varint  number of messages
+     varint  number of types
+     per type:  type, length, flags, varint count
+     order:     runs of (type index, varint run length) in log order
+     times:     per TIME_DELTA type, zigzag varint delta from the
+                previous timestamp of that type
+     data:      per type, per byte column after the header and
+                timestamp, the XOR with the same byte of the previous
+                message of that type.  Zero bytes are run-length
+                encoded as a 0 followed by a varint count
+ */
+
+#include "AP_Logger_Columnar.h"
+
+#if HAL_LOGGER_COLUMNAR_ENABLED
+
+#include <AP_Math/AP_Math.h>
+#include <string.h>
+
+const uint8_t AP_Logger_Columnar::file_magic[4] { 'A', 'P', 'C', '1' };
+
+namespace {
+
+class ChunkWriter {
+public:
+    ChunkWriter(uint8_t *_buf, uint32_t _size) :
+        buf(_buf),
+        size(_size) {}
+
+    void put(uint8_t b) {
+        if (ofs >= size) {
+            overflow = true;
+            return;
+        }
+        buf[ofs++] = b;
+    }
+    void put_varint(uint64_t v) {
+        while (v >= 0x80) {
+            put(uint8_t(v) | 0x80);
+            v >>= 7;
+        }
+        put(uint8_t(v));
+    }
+    // zero-run compressed byte
+    void put_rle(uint8_t b) {
+        if (b == 0) {
+            zero_run++;
+            return;
+        }
+        flush_zeros();
+        put(b);
+    }
+    void flush_zeros() {
+        if (zero_run > 0) {
+            put(0);
+            put_varint(zero_run);
+            zero_run = 0;
+        }
+    }
+
+    uint32_t ofs = 0;
+    bool overflow = false;
+
+private:
+    uint8_t *buf;
+    uint32_t size;
+    uint32_t zero_run = 0;
+};
+
+class ChunkReader {
+public:
+    ChunkReader(const uint8_t *_buf, uint32_t _size) :
+        buf(_buf),
+        size(_size) {}
+
+    uint8_t get() {
+        if (ofs >= size) {
+            overflow = true;
+            return 0;
+        }
+        return buf[ofs++];
+    }
+    uint64_t get_varint() {
+        uint64_t v = 0;
+        for (uint8_t shift=0; shift<64; shift+=7) {
+            const uint8_t b = get();
+            v |= uint64_t(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) {
+                return v;
+            }
+        }
+        overflow = true;
+        return 0;
+    }
+    uint8_t get_rle() {
+        if (zero_run > 0) {
+            zero_run--;
+            return 0;
+        }
+        const uint8_t b = get();
+        if (b == 0) {
+            zero_run = get_varint();
+            if (zero_run == 0) {
+                overflow = true;
+                return 0;
+            }
+            zero_run--;
+        }
+        return b;
+    }
+
+    bool overflow = false;
+
+private:
+    const uint8_t *buf;
+    uint32_t size;
+    uint32_t ofs = 0;
+    uint64_t zero_run = 0;
+};
+
+}
+
+bool AP_Logger_Columnar::init()
+{
+    raw = new uint8_t[CHUNK_SIZE];
+    out = new uint8_t[sizeof(file_magic) + sizeof(ChunkHeader) + CHUNK_SIZE];
+    msg_offset = new uint16_t[CHUNK_MAX_MESSAGES];
+    msg_sorted = new uint16_t[CHUNK_MAX_MESSAGES];
+    if (raw == nullptr || out == nullptr || msg_offset == nullptr || msg_sorted == nullptr) {
+        delete[] raw;
+        delete[] out;
+        delete[] msg_offset;
+        delete[] msg_sorted;
+        raw = out = nullptr;
+        msg_offset = msg_sorted = nullptr;
+        return false;
+    }
+    reset();
+    return true;
+}
+
+void AP_Logger_Columnar::reset()
+{
+    raw_length = 0;
+    parse_offset = 0;
+    num_messages = 0;
+    output_length = 0;
+    output_offset = 0;
+    passthrough = false;
+    magic_written = false;
+    memset(type_length, 0, sizeof(type_length));
+    memset(type_flags, 0, sizeof(type_flags));
+    type_length[LOG_FORMAT_MSG] = sizeof(struct log_Format);
+}
+
+uint32_t AP_Logger_Columnar::consume(const uint8_t *data, uint32_t len)
+{
+    if (output_length > output_offset) {
+        return 0;
+    }
+    const uint32_t n = MIN(len, uint32_t(CHUNK_SIZE - raw_length));
+    memcpy(&raw[raw_length], data, n);
+    raw_length += n;
+
+    parse_messages();
+
+    if (raw_length == CHUNK_SIZE || num_messages == CHUNK_MAX_MESSAGES) {
+        finish_chunk();
+    }
+    return n;
+}
+
+/*
+  find complete messages in the staging buffer, learning message
+  lengths from FMT messages as they go past
+ */
+void AP_Logger_Columnar::parse_messages()
+{
+    while (!passthrough && num_messages < CHUNK_MAX_MESSAGES) {
+        const uint16_t avail = raw_length - parse_offset;
+        if (avail < 3) {
+            break;
+        }
+        const uint8_t *msg = &raw[parse_offset];
+        const uint8_t len = type_length[msg[2]];
+        if (msg[0] != HEAD_BYTE1 || msg[1] != HEAD_BYTE2 || len < 3) {
+            // lost sync with the message stream; everything staged
+            // from now on goes out as stored chunks
+            passthrough = true;
+            break;
+        }
+        if (avail < len) {
+            break;
+        }
+        if (msg[2] == LOG_FORMAT_MSG) {
+            const struct log_Format &f = *(const struct log_Format *)msg;
+            type_length[f.type] = f.length;
+            type_flags[f.type] = (f.format[0] == 'Q' && f.length >= 3 + sizeof(uint64_t)) ? TIME_DELTA : 0;
+        }
+        msg_offset[num_messages++] = parse_offset;
+        parse_offset += len;
+    }
+}
+
+void AP_Logger_Columnar::finish_chunk()
+{
+    if (output_length > output_offset) {
+        // previous chunk has not been written yet
+        return;
+    }
+    output_length = 0;
+    output_offset = 0;
+
+    if (passthrough) {
+        if (raw_length > 0) {
+            write_stored(raw, raw_length);
+        }
+        raw_length = 0;
+        parse_offset = 0;
+        num_messages = 0;
+        return;
+    }
+    if (num_messages == 0) {
+        return;
+    }
+
+    encode_chunk();
+
+    // keep any partial message for the next chunk
+    memmove(raw, &raw[parse_offset], raw_length - parse_offset);
+    raw_length -= parse_offset;
+    parse_offset = 0;
+    num_messages = 0;
+}
+
+void AP_Logger_Columnar::advance(uint32_t n)
+{
+    output_offset = MIN(output_offset + n, output_length);
+}
+
+void AP_Logger_Columnar::write_stored(const uint8_t *data, uint16_t len)
+{
+    if (!magic_written) {
+        memcpy(&out[output_length], file_magic, sizeof(file_magic));
+        output_length += sizeof(file_magic);
+        magic_written = true;
+    }
+    const ChunkHeader hdr {
+        CHUNK_SYNC, uint8_t(ChunkKind::STORED), len, len
+    };
+    memcpy(&out[output_length], &hdr, sizeof(hdr));
+    output_length += sizeof(hdr);
+    memcpy(&out[output_length], data, len);
+    output_length += len;
+}
+
+/*
+  encode the complete messages in the staging buffer into out
+ */
+void AP_Logger_Columnar::encode_chunk()
+{
+    // assign type indexes in order of first appearance and count
+    // the messages of each type
+    uint8_t types[256];
+    uint8_t type_index[256];
+    uint16_t type_count[256];
+    uint16_t type_start[256];
+    bool seen[256] {};
+    uint16_t num_types = 0;
+    for (uint16_t i=0; i<num_messages; i++) {
+        const uint8_t t = raw[msg_offset[i]+2];
+        if (!seen[t]) {
+            seen[t] = true;
+            type_index[t] = num_types;
+            types[num_types] = t;
+            type_count[num_types] = 0;
+            num_types++;
+        }
+        type_count[type_index[t]]++;
+    }
+
+    // group message offsets by type, keeping log order within a type
+    uint16_t n = 0;
+    for (uint16_t i=0; i<num_types; i++) {
+        type_start[i] = n;
+        n += type_count[i];
+    }
+    for (uint16_t i=0; i<num_messages; i++) {
+        const uint8_t idx = type_index[raw[msg_offset[i]+2]];
+        msg_sorted[type_start[idx]++] = msg_offset[i];
+    }
+    for (uint16_t i=0; i<num_types; i++) {
+        type_start[i] -= type_count[i];
+    }
+
+    const uint32_t hdr_ofs = output_length + (magic_written ? 0 : sizeof(file_magic));
+    const uint32_t payload_ofs = hdr_ofs + sizeof(ChunkHeader);
+
+    // an encoding no smaller than the raw data is stored instead
+    ChunkWriter w { &out[payload_ofs], uint32_t(parse_offset - 1) };
+
+    w.put_varint(num_messages);
+    w.put_varint(num_types);
+    for (uint16_t i=0; i<num_types; i++) {
+        const uint8_t t = types[i];
+        w.put(t);
+        w.put(type_length[t]);
+        w.put(type_flags[t]);
+        w.put_varint(type_count[i]);
+    }
+
+    for (uint16_t i=0; i<num_messages; ) {
+        const uint8_t t = raw[msg_offset[i]+2];
+        uint16_t run = 1;
+        while (i + run < num_messages && raw[msg_offset[i+run]+2] == t) {
+            run++;
+        }
+        w.put(type_index[t]);
+        w.put_varint(run);
+        i += run;
+    }
+
+    for (uint16_t i=0; i<num_types && !w.overflow; i++) {
+        if (!(type_flags[types[i]] & TIME_DELTA)) {
+            continue;
+        }
+        uint64_t prev = 0;
+        for (uint16_t j=type_start[i]; j<type_start[i]+type_count[i]; j++) {
+            uint64_t time_us;
+            memcpy(&time_us, &raw[msg_sorted[j]+3], sizeof(time_us));
+            const int64_t delta = int64_t(time_us - prev);
+            w.put_varint((uint64_t(delta) << 1) ^ uint64_t(delta >> 63));
+            prev = time_us;
+        }
+    }
+
+    for (uint16_t i=0; i<num_types && !w.overflow; i++) {
+        const uint8_t t = types[i];
+        const uint8_t first = (type_flags[t] & TIME_DELTA) ? 3 + sizeof(uint64_t) : 3;
+        for (uint8_t c=first; c<type_length[t]; c++) {
+            uint8_t prev = 0;
+            for (uint16_t j=type_start[i]; j<type_start[i]+type_count[i]; j++) {
+                const uint8_t b = raw[msg_sorted[j]+c];
+                w.put_rle(b ^ prev);
+                prev = b;
+            }
+        }
+    }
+    w.flush_zeros();
+
+    if (w.overflow) {
+        write_stored(raw, parse_offset);
+        return;
+    }
+
+    if (!magic_written) {
+        memcpy(&out[output_length], file_magic, sizeof(file_magic));
+        magic_written = true;
+    }
+    const ChunkHeader hdr {
+        CHUNK_SYNC, uint8_t(ChunkKind::COLUMNAR), parse_offset, uint16_t(w.ofs)
+    };
+    memcpy(&out[hdr_ofs], &hdr, sizeof(hdr));
+    output_length = payload_ofs + w.ofs;
+}
+
+/*
+  decode one chunk back into the raw log stream
+ */
+bool AP_Logger_Columnar::decode_chunk(const ChunkHeader &hdr, const uint8_t *payload, uint8_t *raw, uint8_t *scratch)
+{
+    if (hdr.sync != CHUNK_SYNC || hdr.raw_length > CHUNK_SIZE) {
+        return false;
+    }
+    if (hdr.kind == uint8_t(ChunkKind::STORED)) {
+        if (hdr.encoded_length != hdr.raw_length) {
+            return false;
+        }
+        memcpy(raw, payload, hdr.raw_length);
+        return true;
+    }
+    if (hdr.kind != uint8_t(ChunkKind::COLUMNAR)) {
+        return false;
+    }
+
+    ChunkReader r { payload, hdr.encoded_length };
+
+    const uint64_t num_messages = r.get_varint();
+    const uint64_t num_types = r.get_varint();
+    if (num_messages > CHUNK_MAX_MESSAGES || num_types > 256) {
+        return false;
+    }
+
+    uint8_t types[256];
+    uint8_t type_length[256];
+    uint8_t type_flags[256];
+    uint16_t type_count[256];
+    uint16_t type_next[256];
+    uint32_t type_start[256];
+    uint32_t total = 0;
+    uint32_t count_total = 0;
+    for (uint16_t i=0; i<num_types; i++) {
+        types[i] = r.get();
+        type_length[i] = r.get();
+        type_flags[i] = r.get();
+        const uint64_t count = r.get_varint();
+        const uint8_t min_length = (type_flags[i] & TIME_DELTA) ? 3 + sizeof(uint64_t) : 3;
+        if (count > num_messages || type_length[i] < min_length) {
+            return false;
+        }
+        type_count[i] = count;
+        type_next[i] = 0;
+        type_start[i] = total;
+        total += type_count[i] * type_length[i];
+        count_total += type_count[i];
+    }
+    if (r.overflow || total != hdr.raw_length || count_total != num_messages) {
+        return false;
+    }
+
+    // message order, as type indexes
+    uint8_t order[CHUNK_MAX_MESSAGES];
+    for (uint32_t i=0; i<num_messages; ) {
+        const uint8_t idx = r.get();
+        const uint64_t run = r.get_varint();
+        if (r.overflow || idx >= num_types || run == 0 || run > num_messages - i) {
+            return false;
+        }
+        memset(&order[i], idx, run);
+        i += run;
+    }
+
+    // rebuild each type's messages in scratch, one after another
+    for (uint16_t i=0; i<num_types; i++) {
+        uint8_t *msgs = &scratch[type_start[i]];
+        const uint8_t len = type_length[i];
+        for (uint16_t j=0; j<type_count[i]; j++) {
+            msgs[j*len+0] = HEAD_BYTE1;
+            msgs[j*len+1] = HEAD_BYTE2;
+            msgs[j*len+2] = types[i];
+        }
+        if (!(type_flags[i] & TIME_DELTA)) {
+            continue;
+        }
+        uint64_t prev = 0;
+        for (uint16_t j=0; j<type_count[i]; j++) {
+            const uint64_t z = r.get_varint();
+            const uint64_t time_us = prev + ((z >> 1) ^ (~(z & 1) + 1));
+            memcpy(&msgs[j*len+3], &time_us, sizeof(time_us));
+            prev = time_us;
+        }
+    }
+    for (uint16_t i=0; i<num_types; i++) {
+        uint8_t *msgs = &scratch[type_start[i]];
+        const uint8_t len = type_length[i];
+        const uint8_t first = (type_flags[i] & TIME_DELTA) ? 3 + sizeof(uint64_t) : 3;
+        for (uint8_t c=first; c<len; c++) {
+            uint8_t prev = 0;
+            for (uint16_t j=0; j<type_count[i]; j++) {
+                prev ^= r.get_rle();
+                msgs[j*len+c] = prev;
+            }
+        }
+    }
+    if (r.overflow) {
+        return false;
+    }
+
+    // interleave back into log order
+    uint32_t ofs = 0;
+    for (uint32_t i=0; i<num_messages; i++) {
+        const uint8_t idx = order[i];
+        const uint8_t len = type_length[idx];
+        memcpy(&raw[ofs], &scratch[type_start[idx] + type_next[idx]*len], len);
+        type_next[idx]++;
+        ofs += len;
+    }
+    return true;
+}
+
+#endif // HAL_LOGGER_COLUMNAR_ENABLED
@@ -0,0 +1,114 @@
+/*
+   AP_Logger columnar log encoding
+
+   Groups the packed message stream written by AP_Logger_File into
+   self-contained chunks. Within a chunk messages are stored by type,
+   timestamps are delta encoded and the remaining fields are XORed
+   against the previous message of the same type and stored
+   column-major with zero-run compression. The original message order
+   is kept as a run-length encoded stream so the decoder reproduces
+   the raw log byte-for-byte.
+ */
+#pragma once
+
+#include "AP_Logger.h"
+
+#ifndef HAL_LOGGER_COLUMNAR_ENABLED
+#define HAL_LOGGER_COLUMNAR_ENABLED (HAL_LOGGING_FILESYSTEM_ENABLED && (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX))
+#endif
+
+#if HAL_LOGGER_COLUMNAR_ENABLED
+
+#include <stdint.h>
+
+class AP_Logger_Columnar
+{
+public:
+
+    // bytes at the start of a columnar log file
+    static const uint8_t file_magic[4];
+
+    // maximum number of raw log bytes in one chunk
+    static const uint16_t CHUNK_SIZE = 16384;
+
+    // maximum number of messages in one chunk
+    static const uint16_t CHUNK_MAX_MESSAGES = 2048;
+
+    enum class ChunkKind : uint8_t {
+        STORED = 0,     // raw bytes, used when encoding does not help
+        COLUMNAR = 1,
+    };
+
+    struct PACKED ChunkHeader {
+        uint8_t sync;
+        uint8_t kind;
+        uint16_t raw_length;
+        uint16_t encoded_length;
+    };
+    static const uint8_t CHUNK_SYNC = 0xC7;
+
+    // allocate buffers; returns false on allocation failure
+    bool init();
+
+    // forget all state, ready for a new log file
+    void reset();
+
+    // copy up to len bytes of raw log data into the staging buffer,
+    // returning the number of bytes consumed.  Nothing is consumed
+    // while an encoded chunk is waiting to be written
+    uint32_t consume(const uint8_t *data, uint32_t len);
+
+    // encode any complete staged messages into a chunk
+    void finish_chunk();
+
+    // true if there is staged or encoded data which finish_chunk()
+    // and output() would produce
+    bool have_data() const { return output_length > output_offset || num_messages > 0 || (passthrough && raw_length > 0); }
+
+    // encoded data ready to be written
+    const uint8_t *output(uint32_t &len) const {
+        len = output_length - output_offset;
+        return &out[output_offset];
+    }
+    void advance(uint32_t n);
+
+    // decode the payload of one chunk.  raw must have room for
+    // hdr.raw_length bytes and scratch must be CHUNK_SIZE bytes long
+    static bool decode_chunk(const ChunkHeader &hdr, const uint8_t *payload, uint8_t *raw, uint8_t *scratch);
+
+private:
+
+    enum TypeFlags : uint8_t {
+        TIME_DELTA = 1U<<0,     // first field is a uint64_t timestamp
+    };
+
+    // staged raw log data; complete messages are at the start
+    uint8_t *raw;
+    uint16_t raw_length;
+    uint16_t parse_offset;
+
+    // encoded chunk, including header and file magic
+    uint8_t *out;
+    uint32_t output_length;
+    uint32_t output_offset;
+
+    // per-chunk message offsets in log order and grouped by type
+    uint16_t *msg_offset;
+    uint16_t *msg_sorted;
+    uint16_t num_messages;
+
+    // set on loss of message sync; the rest of the log is stored raw
+    bool passthrough;
+
+    bool magic_written;
+
+    // learnt from FMT messages for the current log
+    uint8_t type_length[256];
+    uint8_t type_flags[256];
+
+    void parse_messages();
+    void encode_chunk();
+    void write_stored(const uint8_t *data, uint16_t len);
+};
+
+#endif // HAL_LOGGER_COLUMNAR_ENABLED
@@ -124,6 +124,12 @@ void AP_Logger_File::periodic_1Hz()
 {
     AP_Logger_Backend::periodic_1Hz();
 
+#if HAL_LOGGER_MULTI_WRITER_ENABLED
+    if (logging_started()) {
+        Write_Thread_Stats();
+    }
+#endif
+
     if (_initialised &&
         _write_fd == -1 && _read_fd == -1 &&
         logging_enabled() &&
@@ -158,6 +164,14 @@ void AP_Logger_File::periodic_1Hz()
 void AP_Logger_File::periodic_fullrate()
 {
     AP_Logger_Backend::push_log_blocks();
+#if HAL_LOGGER_MULTI_WRITER_ENABLED && !APM_BUILD_TYPE(APM_BUILD_Replay)
+    // other threads may reserve space once the formats are written
+    if (!_reservations_open.load(std::memory_order_relaxed) &&
+        _write_fd != -1 &&
+        _startup_messagewriter->fmt_done()) {
+        _reservations_open.store(true, std::memory_order_release);
+    }
+#endif
 }
 
 uint32_t AP_Logger_File::bufferspace_available()
@@ -451,6 +465,19 @@ bool AP_Logger_File::StartNewLogOK() const
 /* Write a block of data at current offset */
 bool AP_Logger_File::_WritePrioritisedBlock(const void *pBuffer, uint16_t size, bool is_critical)
 {
+#if HAL_LOGGER_MULTI_WRITER_ENABLED
+    if (supports_reservations()) {
+        LoggerWriteBuffer::Reservation r;
+        uint8_t *dest = _reserve_block(size, is_critical, r);
+        if (dest == nullptr) {
+            return false;
+        }
+        memcpy(dest, pBuffer, size);
+        _commit_block(r);
+        return true;
+    }
+#endif
+
     WITH_SEMAPHORE(semaphore);
 
     if (! WriteBlockCheckStartupMessages()) {
@@ -501,6 +528,89 @@ bool AP_Logger_File::_WritePrioritisedBlock(const void *pBuffer, uint16_t size,
     return true;
 }
 
+#if HAL_LOGGER_MULTI_WRITER_ENABLED
+bool AP_Logger_File::supports_reservations() const
+{
+#if APM_BUILD_TYPE(APM_BUILD_Replay)
+    return false;
+#else
+    if (!_reservations_open.load(std::memory_order_acquire)) {
+        return false;
+    }
+    // startup messages are rate limited under the semaphore. Only the
+    // main thread writes them, so only it looks at the flag
+    return !(hal.scheduler->in_main_thread() && _writing_startup_messages);
+#endif
+}
+
+/*
+  lock-free reservation in the write buffer, for any thread
+ */
+uint8_t *AP_Logger_File::_reserve_block(uint16_t size, bool is_critical, LoggerWriteBuffer::Reservation &r)
+{
+    // count ourselves in before checking the log is open, so
+    // close_reservations() either sees us or we see it closed
+    _reservations_inflight++;
+    if (!_reservations_open.load()) {
+        _reservations_inflight--;
+        _dropped++;
+        return nullptr;
+    }
+    // we reserve some amount of space for critical messages:
+    const uint32_t keep_free = is_critical ? 0 : critical_message_reserved_space(_writebuf.get_size());
+    uint8_t *ret = _writebuf.reserve(size, keep_free, r);
+    if (ret == nullptr) {
+        _reservations_inflight--;
+        _dropped++;
+    }
+    return ret;
+}
+
+void AP_Logger_File::_commit_block(const LoggerWriteBuffer::Reservation &r)
+{
+    _writebuf.commit(r);
+    df_stats_gather(r.size, _writebuf.space());
+    _reservations_inflight--;
+}
+
+/*
+  refuse new reservations and wait for those being filled in, so none
+  lands in the next log ahead of its FMT messages. A writer only fills
+  in and commits its message, so the wait is short; it is bounded so
+  a stalled writer cannot hold up the caller, at the cost of that one
+  message possibly landing in the next log
+ */
+void AP_Logger_File::close_reservations(void)
+{
+    _reservations_open.store(false);
+    const uint32_t start_us = AP_HAL::micros();
+    while (_reservations_inflight.load() != 0 &&
+           AP_HAL::micros() - start_us < 5000) {
+        hal.scheduler->delay_microseconds(50);
+    }
+}
+
+void AP_Logger_File::Write_Thread_Stats()
+{
+    const uint64_t now = AP_HAL::micros64();
+    for (uint8_t i=0; i<_writebuf.num_thread_stats(); i++) {
+        const LoggerWriteBuffer::ThreadStats &st = _writebuf.thread_stats(i);
+        struct log_DSF_Thread pkt {
+            LOG_PACKET_HEADER_INIT(LOG_DF_THREAD_STATS),
+            time_us  : now,
+            slot     : i,
+            name     : {},
+            reserved : st.reserved,
+            retries  : st.retries,
+            waits    : st.waits,
+            dropped  : st.dropped,
+        };
+        memcpy(pkt.name, st.name, sizeof(pkt.name));
+        WriteBlock(&pkt, sizeof(pkt));
+    }
+}
+#endif
+
 /*
   find the highest log number
  */
@@ -701,8 +811,16 @@ uint16_t AP_Logger_File::get_num_logs()
  */
 void AP_Logger_File::stop_logging(void)
 {
+#if HAL_LOGGER_MULTI_WRITER_ENABLED
+    close_reservations();
+#endif
     // best-case effort to avoid annoying the IO thread
     const bool have_sem = write_fd_semaphore.take(hal.util->get_soft_armed()?1:20);
+#if HAL_LOGGER_COLUMNAR_ENABLED
+    if (have_sem && _write_fd != -1 && _columnar_active) {
+        columnar_flush();
+    }
+#endif
     if (_write_fd != -1) {
         int fd = _write_fd;
         _write_fd = -1;
@@ -797,6 +915,24 @@ void AP_Logger_File::start_new_log(void)
     _open_error_ms = 0;
     _write_offset = 0;
     _writebuf.clear();
+#if HAL_LOGGER_COLUMNAR_ENABLED
+    _columnar_active = false;
+    if (_front._params.file_format == 1) {
+        if (_columnar == nullptr) {
+            _columnar = new AP_Logger_Columnar();
+            if (_columnar != nullptr && !_columnar->init()) {
+                delete _columnar;
+                _columnar = nullptr;
+            }
+        }
+        if (_columnar != nullptr) {
+            _columnar->reset();
+            _columnar_active = true;
+        } else {
+            hal.console->printf("Out of memory for columnar logging\n");
+        }
+    }
+#endif
     write_fd_semaphore.give();
 
     // now update lastlog.txt with the new log number
@@ -830,7 +966,12 @@ void AP_Logger_File::flush(void)
 #if APM_BUILD_TYPE(APM_BUILD_Replay) || APM_BUILD_TYPE(APM_BUILD_UNKNOWN)
 {
     uint32_t tnow = AP_HAL::millis();
-    while (_write_fd != -1 && _initialised && !recent_open_error() && _writebuf.available()) {
+    while (_write_fd != -1 && _initialised && !recent_open_error() &&
+           (_writebuf.available()
+#if HAL_LOGGER_COLUMNAR_ENABLED
+            || (_columnar_active && _columnar->have_data())
+#endif
+               )) {
         // convince the IO timer that it really is OK to write out
         // less than _writebuf_chunk bytes:
         if (tnow > 2001) { // avoid resetting _last_write_time to 0
@@ -862,15 +1003,37 @@ void AP_Logger_File::io_timer(void)
         return;
     }
 
-    uint32_t nbytes = _writebuf.available();
-    if (nbytes == 0) {
-        return;
-    }
-    if (nbytes < _writebuf_chunk && 
-        tnow - _last_write_time < 2000UL) {
-        // write in _writebuf_chunk-sized chunks, but always write at
-        // least once per 2 seconds if data is available
-        return;
+    uint32_t nbytes;
+    bool have_sem = false;
+#if HAL_LOGGER_COLUMNAR_ENABLED
+    if (_columnar_active) {
+        // start_new_log() resets the encoder with write_fd_semaphore
+        // held, so hold it from preparing a chunk until it is written
+        if (!write_fd_semaphore.take(1)) {
+            return;
+        }
+        have_sem = true;
+        // the encoder stages data until it has a full chunk, so only
+        // force out a partial chunk every 2 seconds
+        if (_write_fd == -1 || !_columnar_active ||
+            !columnar_prepare(tnow - _last_write_time >= 2000UL)) {
+            write_fd_semaphore.give();
+            return;
+        }
+        _columnar->output(nbytes);
+    } else
+#endif
+    {
+        nbytes = _writebuf.available();
+        if (nbytes == 0) {
+            return;
+        }
+        if (nbytes < _writebuf_chunk &&
+            tnow - _last_write_time < 2000UL) {
+            // write in _writebuf_chunk-sized chunks, but always write at
+            // least once per 2 seconds if data is available
+            return;
+        }
     }
     if (tnow - _free_space_last_check_time > _free_space_check_interval) {
         _free_space_last_check_time = tnow;
@@ -880,6 +1043,9 @@ void AP_Logger_File::io_timer(void)
             stop_logging();
             _open_error_ms = AP_HAL::millis(); // prevent logging starting again for 5s
             last_io_operation = "";
+            if (have_sem) {
+                write_fd_semaphore.give();
+            }
             return;
         }
         last_io_operation = "";
@@ -892,7 +1058,15 @@ void AP_Logger_File::io_timer(void)
     }
 
     uint32_t size;
-    const uint8_t *head = _writebuf.readptr(size);
+    const uint8_t *head;
+#if HAL_LOGGER_COLUMNAR_ENABLED
+    if (_columnar_active) {
+        head = _columnar->output(size);
+    } else
+#endif
+    {
+        head = _writebuf.readptr(size);
+    }
     nbytes = MIN(nbytes, size);
 
     // try to align writes on a 512 byte boundary to avoid filesystem reads
@@ -904,7 +1078,7 @@ void AP_Logger_File::io_timer(void)
     }
 
     last_io_operation = "write";
-    if (!write_fd_semaphore.take(1)) {
+    if (!have_sem && !write_fd_semaphore.take(1)) {
         return;
     }
     if (_write_fd == -1) {
@@ -929,7 +1103,14 @@ void AP_Logger_File::io_timer(void)
         _last_write_failed = false;
         _last_write_ms = tnow;
         _write_offset += nwritten;
-        _writebuf.advance(nwritten);
+#if HAL_LOGGER_COLUMNAR_ENABLED
+        if (_columnar_active) {
+            _columnar->advance(nwritten);
+        } else
+#endif
+        {
+            _writebuf.advance(nwritten);
+        }
         /*
           the best strategy for minimizing corruption on microSD cards
           seems to be to write in 4k chunks and fsync the file on each
@@ -958,6 +1139,63 @@ void AP_Logger_File::io_timer(void)
     write_fd_semaphore.give();
 }
 
+#if HAL_LOGGER_COLUMNAR_ENABLED
+/*
+  move data from the ring buffer into the columnar encoder. Returns
+  true if the encoder has a chunk ready to be written
+ */
+bool AP_Logger_File::columnar_prepare(bool force)
+{
+    uint32_t available;
+    _columnar->output(available);
+    while (available == 0) {
+        uint32_t size;
+        const uint8_t *head = _writebuf.readptr(size);
+        if (size == 0) {
+            break;
+        }
+        const uint32_t consumed = _columnar->consume(head, size);
+        _writebuf.advance(consumed);
+        _columnar->output(available);
+        if (consumed == 0) {
+            break;
+        }
+    }
+    if (available == 0 && force) {
+        _columnar->finish_chunk();
+        _columnar->output(available);
+    }
+    return available > 0;
+}
+
+/*
+  write out the encoder's pending and staged data when a log is
+  stopped, so the file is not missing up to a chunk of messages.
+  Data still in the ring buffer is dropped, as it is for raw logs
+ */
+void AP_Logger_File::columnar_flush()
+{
+    while (_columnar->have_data()) {
+        uint32_t len;
+        _columnar->output(len);
+        if (len == 0) {
+            _columnar->finish_chunk();
+            _columnar->output(len);
+            if (len == 0) {
+                break;
+            }
+        }
+        const uint8_t *data = _columnar->output(len);
+        const ssize_t nwritten = AP::FS().write(_write_fd, data, len);
+        if (nwritten <= 0) {
+            break;
+        }
+        _write_offset += nwritten;
+        _columnar->advance(nwritten);
+    }
+}
+#endif
+
 bool AP_Logger_File::io_thread_alive() const
 {
     // if the io thread hasn't had a heartbeat in a full seconds then it is dead
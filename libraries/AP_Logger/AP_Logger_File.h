@@ -10,6 +10,7 @@
 
 #include <AP_HAL/utility/RingBuffer.h>
 #include "AP_Logger_Backend.h"
+#include "AP_Logger_Columnar.h"
 
 #if HAL_LOGGING_FILESYSTEM_ENABLED
 
@@ -57,10 +58,18 @@ public:
     bool logging_started(void) const override { return _write_fd != -1; }
     void io_timer(void) override;
 
+#if HAL_LOGGER_MULTI_WRITER_ENABLED
+    bool supports_reservations() const override;
+#endif
+
 protected:
 
     bool WritesOK() const override;
     bool StartNewLogOK() const override;
+#if HAL_LOGGER_MULTI_WRITER_ENABLED
+    uint8_t *_reserve_block(uint16_t size, bool is_critical, LoggerWriteBuffer::Reservation &r) override;
+    void _commit_block(const LoggerWriteBuffer::Reservation &r) override;
+#endif
 
 private:
     int _write_fd = -1;
@@ -96,10 +105,31 @@ private:
     bool log_exists(const uint16_t lognum) const;
 
     // write buffer
+#if HAL_LOGGER_MULTI_WRITER_ENABLED
+    LoggerWriteBuffer _writebuf;
+    void Write_Thread_Stats();
+
+    // set by the main thread once the FMT messages of the current log
+    // are written, and cleared while a log is stopped or rotated
+    std::atomic<bool> _reservations_open{false};
+    // reservations being filled in; stop_logging() waits for these
+    std::atomic<uint16_t> _reservations_inflight{0};
+    void close_reservations(void);
+#else
     ByteBuffer _writebuf{0};
+#endif
     const uint16_t _writebuf_chunk = HAL_LOGGER_WRITE_CHUNK_SIZE;
     uint32_t _last_write_time;
 
+#if HAL_LOGGER_COLUMNAR_ENABLED
+    // encoder for LOG_FILE_FORMAT=1; allocated on first use
+    AP_Logger_Columnar *_columnar = nullptr;
+    // true if the current log file is being written columnar
+    bool _columnar_active;
+    bool columnar_prepare(bool force);
+    void columnar_flush();
+#endif
+
     /* construct a file name given a log number. Caller must free. */
     char *_log_file_name(const uint16_t log_num) const;
     char *_log_file_name_long(const uint16_t log_num) const;
@@ -119,7 +149,9 @@ private:
     const uint32_t _free_space_check_interval = 1000UL; // milliseconds
     const uint32_t _free_space_min_avail = 8388608; // bytes
 
-    // semaphore mediates access to the ringbuffer
+    // semaphore mediates access to the ringbuffer; with multiple
+    // writer support it is only needed while startup messages are
+    // being written
     HAL_Semaphore semaphore;
     // write_fd_semaphore mediates access to write_fd so the frontend
     // can open/close files without causing the backend to write to a
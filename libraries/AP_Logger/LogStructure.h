@@ -195,6 +195,17 @@ struct PACKED log_DSF {
     uint32_t buf_space_avg;
 };
 
+struct PACKED log_DSF_Thread {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t slot;
+    char name[16];
+    uint32_t reserved;
+    uint32_t retries;
+    uint32_t waits;
+    uint32_t dropped;
+};
+
 struct PACKED log_Event {
     LOG_PACKET_HEADER;
     uint64_t time_us;
@@ -348,6 +359,18 @@ struct PACKED log_MAV {
     uint16_t times_full;
 };
 
+struct PACKED log_MAV_Rate {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t chan;
+    uint8_t id;
+    float requested_hz;
+    float achieved_hz;
+    uint32_t sent;
+    uint32_t stale;
+    uint32_t link_rate;
+};
+
 struct PACKED log_RSSI {
     LOG_PACKET_HEADER;
     uint64_t time_us;
@@ -828,6 +851,22 @@ struct PACKED log_Performance {
     uint32_t extra_loop_us;
 };
 
+struct PACKED log_Task_Stats {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t task;
+    uint16_t count;
+    uint16_t p50;
+    uint16_t p99;
+    uint16_t p999;
+    uint16_t max_time;
+    uint16_t avg_jitter;
+    uint16_t max_jitter;
+    uint16_t overruns;
+    uint16_t slips;
+    uint16_t misses;
+};
+
 struct PACKED log_SRTL {
     LOG_PACKET_HEADER;
     uint64_t time_us;
@@ -1079,6 +1118,16 @@ struct PACKED log_PSC {
 // @Field: FMx: Maximum free space in write buffer in last time period
 // @Field: FAv: Average free space in write buffer in last time period
 
+// @LoggerMessage: DSFT
+// @Description: Onboard logging per-thread write statistics, counted since boot
+// @Field: TimeUS: Time since system startup
+// @Field: I: writer thread slot
+// @Field: Name: name of the first thread to use this slot
+// @Field: Res: Number of messages written
+// @Field: Rtry: Number of times a write had to retry its reservation because another thread reserved first
+// @Field: Wait: Number of times a write had to wait for an earlier write from another thread to complete
+// @Field: Drop: Number of messages dropped for lack of buffer space
+
 // @LoggerMessage: DSTL
 // @Description: Deepstall Landing data
 // @Field: TimeUS: Time since system startup
@@ -1265,6 +1314,17 @@ struct PACKED log_PSC {
 // @Field: ss: stream slowdown is the number of ms being added to each message to fit within bandwidth
 // @Field: tf: times buffer was full when a message was going to be sent
 
+// @LoggerMessage: MAVR
+// @Description: GCS MAVLink adaptive stream scheduler per-message statistics
+// @Field: TimeUS: Time since system startup
+// @Field: chan: mavlink channel number
+// @Field: Id: internal (ap_message) id of the message
+// @Field: Req: requested message rate
+// @Field: Ach: rate the message has actually been sent at
+// @Field: Sent: number of times the message has been sent
+// @Field: Stale: number of times the message was sent later than its freshness budget allows
+// @Field: Link: estimated link throughput
+
 // @LoggerMessage: MAVC
 // @Description: MAVLink command we have just executed
 // @Field: TimeUS: Time since system startup
@@ -1389,6 +1449,21 @@ struct PACKED log_PSC {
 // @Field: I2CI: Number of i2c interrupts serviced
 // @Field: Ex: number of microseconds being added to each loop to address scheduler overruns
 
+// @LoggerMessage: TSKS
+// @Description: Scheduler per-task runtime and start jitter statistics, written once per task per second when per-task perf info is enabled
+// @Field: TimeUS: Time since system startup
+// @Field: I: task index in the scheduler table; the last index is the fast loop
+// @Field: N: number of times the task ran in this period
+// @Field: P50: median task runtime
+// @Field: P99: 99th percentile task runtime
+// @Field: P999: 99.9th percentile task runtime
+// @Field: Max: maximum task runtime
+// @Field: AJit: average delay of the task start relative to its nominal slot
+// @Field: MJit: maximum delay of the task start relative to its nominal slot
+// @Field: Ovr: number of runs that exceeded the task's time budget
+// @Field: Slp: number of times the task was delayed by two or more intervals
+// @Field: Miss: number of times the task was due but deferred because it did not fit in the remaining loop time
+
 // @LoggerMessage: POWR
 // @Description: System power information
 // @Field: TimeUS: Time since system startup
@@ -1709,6 +1784,8 @@ LOG_STRUCTURE_FROM_CAMERA \
       "PRX", "QBfffffffffff", "TimeUS,Health,D0,D45,D90,D135,D180,D225,D270,D315,DUp,CAn,CDis", "s-mmmmmmmmmhm", "F-00000000000" }, \
     { LOG_PERFORMANCE_MSG, sizeof(log_Performance),                     \
       "PM",  "QHHIIHHIIIIII", "TimeUS,NLon,NLoop,MaxT,Mem,Load,ErrL,IntE,ErrC,SPIC,I2CC,I2CI,Ex", "s---b%------s", "F---0A------F" }, \
+    { LOG_TASK_STATS_MSG, sizeof(log_Task_Stats), \
+      "TSKS", "QBHHHHHHHHHH", "TimeUS,I,N,P50,P99,P999,Max,AJit,MJit,Ovr,Slp,Miss", "s#-ssssss---", "F--FFFFFF---" }, \
     { LOG_SRTL_MSG, sizeof(log_SRTL), \
       "SRTL", "QBHHBfff", "TimeUS,Active,NumPts,MaxPts,Action,N,E,D", "s----mmm", "F----000" }, \
     { LOG_OA_BENDYRULER_MSG, sizeof(log_OABendyRuler), \
@@ -1765,12 +1842,16 @@ LOG_STRUCTURE_FROM_NAVEKF3 \
 LOG_STRUCTURE_FROM_AHRS \
     { LOG_DF_FILE_STATS, sizeof(log_DSF), \
       "DSF", "QIHIIII", "TimeUS,Dp,Blk,Bytes,FMn,FMx,FAv", "s--b---", "F--0---" }, \
+    { LOG_DF_THREAD_STATS, sizeof(log_DSF_Thread), \
+      "DSFT", "QBNIIII", "TimeUS,I,Name,Res,Rtry,Wait,Drop", "s#-----", "F------" }, \
     { LOG_RPM_MSG, sizeof(log_RPM), \
       "RPM",  "Qff", "TimeUS,rpm1,rpm2", "sqq", "F00" }, \
     { LOG_RALLY_MSG, sizeof(log_Rally), \
       "RALY", "QBBLLh", "TimeUS,Tot,Seq,Lat,Lng,Alt", "s--DUm", "F--GGB" },  \
     { LOG_MAV_MSG, sizeof(log_MAV),   \
       "MAV", "QBHHHBHH",   "TimeUS,chan,txp,rxp,rxdp,flags,ss,tf", "s#----s-", "F-000-C-" },   \
+    { LOG_MAV_RATE_MSG, sizeof(log_MAV_Rate),   \
+      "MAVR", "QBBffIII",   "TimeUS,chan,Id,Req,Ach,Sent,Stale,Link", "s#-zz---", "F--00---" },   \
     { LOG_VISUALODOM_MSG, sizeof(log_VisualOdom), \
       "VISO", "Qffffffff", "TimeUS,dt,AngDX,AngDY,AngDZ,PosDX,PosDY,PosDZ,conf", "ssrrrmmm-", "FF000000-" }, \
     { LOG_VISUALPOS_MSG, sizeof(log_VisualPosition), \
@@ -1916,6 +1997,9 @@ enum LogMessages : uint8_t {
     LOG_SIMPLE_AVOID_MSG,
     LOG_WINCH_MSG,
     LOG_PSC_MSG,
+    LOG_TASK_STATS_MSG,
+    LOG_DF_THREAD_STATS,
+    LOG_MAV_RATE_MSG,
 
     _LOG_LAST_MSG_
 };
@@ -0,0 +1,199 @@
+#include "LoggerWriteBuffer.h"
+
+#if HAL_LOGGER_MULTI_WRITER_ENABLED
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// number of times commit() polls for an earlier writer before sleeping
+#define LOGGER_COMMIT_SPIN_COUNT 64
+
+// each thread which writes to a log gets a stats slot the first time it
+// does so
+static std::atomic<uint8_t> writer_thread_count{0};
+static thread_local uint8_t writer_thread_slot = UINT8_MAX;
+
+LoggerWriteBuffer::~LoggerWriteBuffer(void)
+{
+    free(buf);
+}
+
+bool LoggerWriteBuffer::set_size(uint32_t _size)
+{
+    reserve_head = 0;
+    commit_head = 0;
+    tail = 0;
+    wrap_mark = 0;
+    if (_size != size) {
+        free(buf);
+        buf = (uint8_t*)calloc(1, _size);
+        if (!buf) {
+            size = 0;
+            return false;
+        }
+        size = _size;
+    }
+    return true;
+}
+
+LoggerWriteBuffer::ThreadStats &LoggerWriteBuffer::my_stats()
+{
+    if (writer_thread_slot == UINT8_MAX) {
+        writer_thread_slot = MIN(writer_thread_count++, uint8_t(LOGGER_WRITER_MAX_THREADS-1));
+    }
+    ThreadStats &s = stats[writer_thread_slot];
+    if (s.name[0] == 0) {
+        if (pthread_getname_np(pthread_self(), s.name, sizeof(s.name)) != 0 || s.name[0] == 0) {
+            strncpy(s.name, "?", sizeof(s.name));
+        }
+    }
+    return s;
+}
+
+uint8_t LoggerWriteBuffer::num_thread_stats(void) const
+{
+    return MIN(writer_thread_count.load(), uint8_t(LOGGER_WRITER_MAX_THREADS));
+}
+
+uint8_t *LoggerWriteBuffer::reserve(uint16_t len, uint32_t keep_free, Reservation &r)
+{
+    ThreadStats &st = my_stats();
+    if (len == 0 || len > size) {
+        st.dropped++;
+        return nullptr;
+    }
+    uint32_t head = reserve_head.load(std::memory_order_relaxed);
+    while (true) {
+        const uint32_t _tail = tail.load(std::memory_order_acquire);
+        const uint32_t ofs = head % size;
+        // a message never straddles the end of the buffer
+        const uint32_t pad = (ofs + len > size) ? size - ofs : 0;
+        if (distance(head, _tail) + pad + len + keep_free > size) {
+            st.dropped++;
+            return nullptr;
+        }
+        const uint32_t new_head = add(head, pad + len);
+        if (reserve_head.compare_exchange_weak(head, new_head,
+                                               std::memory_order_acq_rel,
+                                               std::memory_order_relaxed)) {
+            if (pad != 0 || ofs + len == size) {
+                // we are the writer which reaches the end of the
+                // buffer; record where valid data stops. This is
+                // published to the reader by our commit
+                wrap_mark.store(pad != 0 ? ofs : size, std::memory_order_relaxed);
+            }
+            st.reserved++;
+            r.data = &buf[pad != 0 ? 0 : ofs];
+            r.start = head;
+            r.end = new_head;
+            r.size = len;
+            return r.data;
+        }
+        // head has been updated with the current value
+        st.retries++;
+    }
+}
+
+void LoggerWriteBuffer::commit(const Reservation &r)
+{
+    if (commit_head.load(std::memory_order_acquire) != r.start) {
+        my_stats().waits++;
+        uint16_t spins = 0;
+        while (commit_head.load(std::memory_order_acquire) != r.start) {
+            if (++spins < LOGGER_COMMIT_SPIN_COUNT) {
+                continue;
+            }
+            // the earlier writer may have been preempted by us; sleep
+            // so that it can run even if it has a lower priority
+            const struct timespec ts { 0, 1000 };
+            nanosleep(&ts, nullptr);
+        }
+    }
+    commit_head.store(r.end, std::memory_order_release);
+}
+
+uint32_t LoggerWriteBuffer::write(const uint8_t *data, uint32_t len)
+{
+    if (len > UINT16_MAX) {
+        return 0;
+    }
+    Reservation r;
+    uint8_t *dest = reserve(len, 0, r);
+    if (dest == nullptr) {
+        return 0;
+    }
+    memcpy(dest, data, len);
+    commit(r);
+    return len;
+}
+
+uint32_t LoggerWriteBuffer::space(void) const
+{
+    if (size == 0) {
+        return 0;
+    }
+    return size - distance(reserve_head.load(), tail.load());
+}
+
+uint32_t LoggerWriteBuffer::available(void) const
+{
+    if (size == 0) {
+        return 0;
+    }
+    const uint32_t _commit = commit_head.load(std::memory_order_acquire);
+    const uint32_t _tail = tail.load(std::memory_order_relaxed);
+    const uint32_t ofs = _tail % size;
+    uint32_t n = distance(_commit, _tail);
+    if (n > size - ofs) {
+        // committed data wraps; don't count the skipped bytes
+        n -= size - wrap_mark.load(std::memory_order_relaxed);
+    }
+    return n;
+}
+
+const uint8_t *LoggerWriteBuffer::readptr(uint32_t &available_bytes)
+{
+    available_bytes = 0;
+    if (size == 0) {
+        return nullptr;
+    }
+    const uint32_t _commit = commit_head.load(std::memory_order_acquire);
+    uint32_t _tail = tail.load(std::memory_order_relaxed);
+    uint32_t ofs = _tail % size;
+    uint32_t n = distance(_commit, _tail);
+    if (n > size - ofs) {
+        const uint32_t mark = wrap_mark.load(std::memory_order_relaxed);
+        if (ofs >= mark) {
+            // skip the unused bytes at the end of the buffer
+            _tail = add(_tail, size - ofs);
+            tail.store(_tail, std::memory_order_release);
+            n -= size - ofs;
+            ofs = 0;
+        } else {
+            n = mark - ofs;
+        }
+    }
+    if (n == 0) {
+        return nullptr;
+    }
+    available_bytes = n;
+    return &buf[ofs];
+}
+
+bool LoggerWriteBuffer::advance(uint32_t n)
+{
+    if (n > available()) {
+        return false;
+    }
+    tail.store(add(tail.load(std::memory_order_relaxed), n), std::memory_order_release);
+    return true;
+}
+
+void LoggerWriteBuffer::clear(void)
+{
+    tail.store(commit_head.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+#endif // HAL_LOGGER_MULTI_WRITER_ENABLED
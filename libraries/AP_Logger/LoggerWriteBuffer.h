@@ -0,0 +1,121 @@
+/*
+  multi-producer ring buffer for log writes
+
+  Any number of threads may reserve contiguous space in the ring, fill
+  a message in place and commit it without taking a lock. A single
+  consumer (the logging IO thread) reads committed data through the
+  same readptr()/advance() interface as ByteBuffer.
+
+  Commits become visible in reservation order. A reservation which
+  would straddle the end of the buffer is placed at the start and the
+  skipped bytes at the end are never returned to the consumer.
+ */
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+#include "AP_Logger.h"
+
+#ifndef HAL_LOGGER_MULTI_WRITER_ENABLED
+#define HAL_LOGGER_MULTI_WRITER_ENABLED (HAL_LOGGING_FILESYSTEM_ENABLED && (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX))
+#endif
+
+#ifndef LOGGER_WRITER_MAX_THREADS
+#define LOGGER_WRITER_MAX_THREADS 8
+#endif
+
+#if HAL_LOGGER_MULTI_WRITER_ENABLED
+
+class LoggerWriteBuffer {
+public:
+    LoggerWriteBuffer() {}
+    ~LoggerWriteBuffer();
+
+    /* Do not allow copies */
+    LoggerWriteBuffer(const LoggerWriteBuffer &other) = delete;
+    LoggerWriteBuffer &operator=(const LoggerWriteBuffer&) = delete;
+
+    struct Reservation {
+        uint8_t *data;
+        uint32_t start;
+        uint32_t end;
+        uint16_t size;
+    };
+
+    // set size of ringbuffer, caller responsible for locking
+    bool set_size(uint32_t size);
+
+    // return size of ringbuffer
+    uint32_t get_size(void) const { return size; }
+
+    /*
+      reserve len contiguous bytes, leaving at least keep_free bytes
+      of space for other writers. Returns nullptr if there is not
+      enough space. A successful reservation must always be passed to
+      commit(), even if the caller decides not to fill it in
+     */
+    uint8_t *reserve(uint16_t len, uint32_t keep_free, Reservation &r);
+
+    // make a reservation visible to the reader. Waits for any earlier
+    // reservations to be committed first
+    void commit(const Reservation &r);
+
+    // reserve, copy and commit. Returns number of bytes written
+    uint32_t write(const uint8_t *data, uint32_t len);
+
+    // number of bytes space available to write
+    uint32_t space(void) const;
+
+    // number of committed bytes available to be read
+    uint32_t available(void) const;
+
+    // Returns the pointer and size to a contiguous read of the next available data
+    const uint8_t *readptr(uint32_t &available_bytes);
+
+    // advance the read pointer (discarding bytes)
+    bool advance(uint32_t n);
+
+    // discard committed data. Reservations in progress are kept
+    void clear(void);
+
+    // per-writer-thread contention and drop counters
+    struct ThreadStats {
+        char name[16];
+        uint32_t reserved;      // successful reservations
+        uint32_t retries;       // reservation attempts lost to another writer
+        uint32_t waits;         // commits which waited for an earlier writer
+        uint32_t dropped;       // reservations refused for lack of space
+    };
+    uint8_t num_thread_stats(void) const;
+    const ThreadStats &thread_stats(uint8_t i) const { return stats[i]; }
+
+private:
+    uint8_t *buf = nullptr;
+    uint32_t size = 0;
+
+    // positions count from 0 to 2*size-1 so a full buffer can be
+    // told apart from an empty one
+    std::atomic<uint32_t> reserve_head{0};
+    std::atomic<uint32_t> commit_head{0};
+    std::atomic<uint32_t> tail{0};
+
+    // offset at which committed data stops before the end of the
+    // buffer on the current lap
+    std::atomic<uint32_t> wrap_mark{0};
+
+    uint32_t distance(uint32_t to, uint32_t from) const {
+        return to >= from ? to - from : to + 2*size - from;
+    }
+    uint32_t add(uint32_t pos, uint32_t n) const {
+        pos += n;
+        return pos >= 2*size ? pos - 2*size : pos;
+    }
+
+    // indexed by the calling thread's writer slot; threads beyond
+    // the last slot share it
+    ThreadStats stats[LOGGER_WRITER_MAX_THREADS] {};
+    ThreadStats &my_stats();
+};
+
+#endif // HAL_LOGGER_MULTI_WRITER_ENABLED
@@ -140,8 +140,8 @@ bool Polygon_intersects(const Vector2f *V, unsigned N, const Vector2f &p1, const
     }
 
     float intersect_dist_sq = FLT_MAX;
-    for (uint8_t i=0; i<N; i++) {
-        uint8_t j = i+1;
+    for (unsigned i=0; i<N; i++) {
+        unsigned j = i+1;
         if (j >= N) {
             j = 0;
         }
@@ -209,6 +209,8 @@ void AP_Mission::reset()
 ///     returns true if mission was running so it could not be cleared
 bool AP_Mission::clear()
 {
+    WITH_SEMAPHORE(_rsem);
+
     // do not allow clearing the mission while it is running
     if (_flags.state == MISSION_RUNNING) {
         return false;
@@ -231,6 +233,8 @@ bool AP_Mission::clear()
 /// trucate - truncate any mission items beyond index
 void AP_Mission::truncate(uint16_t index)
 {
+    WITH_SEMAPHORE(_rsem);
+
     if ((unsigned)_cmd_total > index) {
         _cmd_total.set_and_save(index);
     }
@@ -245,6 +249,9 @@ void AP_Mission::update()
         return;
     }
 
+    // the mission may be uploaded from another thread
+    WITH_SEMAPHORE(_rsem);
+
     update_exit_position();
 
     // save persistent waypoint_num for watchdog restore
@@ -343,6 +350,8 @@ bool AP_Mission::start_command(const Mission_Command& cmd)
 ///     cmd.index is updated with it's new position in the mission
 bool AP_Mission::add_cmd(Mission_Command& cmd)
 {
+    WITH_SEMAPHORE(_rsem);
+
     // attempt to write the command to storage
     bool ret = write_cmd_to_storage(_cmd_total, cmd);
 
@@ -361,6 +370,8 @@ bool AP_Mission::add_cmd(Mission_Command& cmd)
 ///     returns true if successfully replaced, false on failure
 bool AP_Mission::replace_cmd(uint16_t index, const Mission_Command& cmd)
 {
+    WITH_SEMAPHORE(_rsem);
+
     // sanity check index
     if (index >= (unsigned)_cmd_total) {
         return false;
@@ -17,9 +17,23 @@
 #pragma once
 
 #include <stdint.h>
+#include <AP_HAL/AP_HAL_Boards.h>
 #include <AP_Math/AP_Math.h>
 #include <AP_Math/vectorN.h>
 
+/*
+  on boards where lanes or whole filters may be updated on more than
+  one thread (EK3_OPTIONS parallel lanes, the Replay sweep) each
+  thread gets its own copy of the scratch variables
+ */
+#ifndef EKF_SCRATCH_THREAD_LOCAL
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#define EKF_SCRATCH_THREAD_LOCAL thread_local
+#else
+#define EKF_SCRATCH_THREAD_LOCAL
+#endif
+#endif
+
 /*
   this declares a common parent class for AP_NavEKF2 and
   AP_NavEKF3. The purpose of this class is to hold common static
@@ -42,10 +56,10 @@ public:
 #endif
 
 protected:
-    static Matrix24 KH;                   // intermediate result used for covariance updates
-    static Matrix24 KHP;                  // intermediate result used for covariance updates
-    static Matrix24 nextP;                // Predicted covariance matrix before addition of process noise to diagonals
-    static Vector28 Kfusion;              // intermediate fusion vector
+    static EKF_SCRATCH_THREAD_LOCAL Matrix24 KH;           // intermediate result used for covariance updates
+    static EKF_SCRATCH_THREAD_LOCAL Matrix24 KHP;          // intermediate result used for covariance updates
+    static EKF_SCRATCH_THREAD_LOCAL Matrix24 nextP;        // Predicted covariance matrix before addition of process noise to diagonals
+    static EKF_SCRATCH_THREAD_LOCAL Vector28 Kfusion;      // intermediate fusion vector
 
     // fill all the common scratch variables with NaN on SITL
     void fill_scratch_variables(void);
@@ -123,6 +123,29 @@ void ekf_ring_buffer::reset()
     memset((void *)buffer,0,_size*uint32_t(elsize));
 }
 
+#if AP_DAL_CHECKPOINT_ENABLED
+bool ekf_ring_buffer::save_checkpoint(AP_DAL_Checkpoint &cp) const
+{
+    return cp.write(&_size, sizeof(_size)) &&
+        cp.write(&_head, sizeof(_head)) &&
+        cp.write(&_tail, sizeof(_tail)) &&
+        cp.write(&_new_data, sizeof(_new_data)) &&
+        cp.write(buffer, _size*uint32_t(elsize));
+}
+
+bool ekf_ring_buffer::load_checkpoint(AP_DAL_Checkpoint &cp)
+{
+    uint8_t size;
+    if (!cp.read(&size, sizeof(size)) || size != _size) {
+        return false;
+    }
+    return cp.read(&_head, sizeof(_head)) &&
+        cp.read(&_tail, sizeof(_tail)) &&
+        cp.read(&_new_data, sizeof(_new_data)) &&
+        cp.read(buffer, _size*uint32_t(elsize));
+}
+#endif
+
 ////////////////////////////////////////////////////
 /*
   IMU buffer operations implemented separately due to different
@@ -211,3 +234,26 @@ void *ekf_imu_buffer::get(uint8_t index) const
 {
     return get_offset(index);
 }
+
+#if AP_DAL_CHECKPOINT_ENABLED
+bool ekf_imu_buffer::save_checkpoint(AP_DAL_Checkpoint &cp) const
+{
+    return cp.write(&_size, sizeof(_size)) &&
+        cp.write(&_oldest, sizeof(_oldest)) &&
+        cp.write(&_youngest, sizeof(_youngest)) &&
+        cp.write(&_filled, sizeof(_filled)) &&
+        cp.write(buffer, _size*uint32_t(elsize));
+}
+
+bool ekf_imu_buffer::load_checkpoint(AP_DAL_Checkpoint &cp)
+{
+    uint8_t size;
+    if (!cp.read(&size, sizeof(size)) || size != _size) {
+        return false;
+    }
+    return cp.read(&_oldest, sizeof(_oldest)) &&
+        cp.read(&_youngest, sizeof(_youngest)) &&
+        cp.read(&_filled, sizeof(_filled)) &&
+        cp.read(buffer, _size*uint32_t(elsize));
+}
+#endif
@@ -3,8 +3,12 @@
   data to bring it onto the fusion time horizon
 */
 
+#pragma once
+
 #include <stdint.h>
+#include <string.h>
 #include <type_traits>
+#include <AP_DAL/AP_DAL_Checkpoint.h>
 
 typedef struct {
     // measurement timestamp (msec)
@@ -39,6 +43,13 @@ public:
     // zeroes all data in the ring buffer
     void reset();
 
+#if AP_DAL_CHECKPOINT_ENABLED
+    // save and restore the indices and contents. Loading fails if the
+    // buffer was initialised with a different size
+    bool save_checkpoint(AP_DAL_Checkpoint &cp) const;
+    bool load_checkpoint(AP_DAL_Checkpoint &cp);
+#endif
+
 private:
     const uint8_t elsize;
     void *buffer;
@@ -78,6 +89,16 @@ public:
     void reset() {
         return ekf_ring_buffer::reset();
     }
+
+#if AP_DAL_CHECKPOINT_ENABLED
+    bool save_checkpoint(AP_DAL_Checkpoint &cp) const {
+        return ekf_ring_buffer::save_checkpoint(cp);
+    }
+
+    bool load_checkpoint(AP_DAL_Checkpoint &cp) {
+        return ekf_ring_buffer::load_checkpoint(cp);
+    }
+#endif
 };
 
 
@@ -125,6 +146,13 @@ public:
         return _youngest;
     }
 
+#if AP_DAL_CHECKPOINT_ENABLED
+    // save and restore the indices and contents. Loading fails if the
+    // buffer was initialised with a different size
+    bool save_checkpoint(AP_DAL_Checkpoint &cp) const;
+    bool load_checkpoint(AP_DAL_Checkpoint &cp);
+#endif
+
 protected:
     const uint8_t elsize;
     void *buffer;
@@ -194,4 +222,34 @@ public:
     inline uint8_t get_youngest_index() {
         return ekf_imu_buffer::get_youngest_index();
     }
+
+#if AP_DAL_CHECKPOINT_ENABLED
+    bool save_checkpoint(AP_DAL_Checkpoint &cp) const {
+        return ekf_imu_buffer::save_checkpoint(cp);
+    }
+
+    bool load_checkpoint(AP_DAL_Checkpoint &cp) {
+        return ekf_imu_buffer::load_checkpoint(cp);
+    }
+#endif
 };
+
+#if AP_DAL_CHECKPOINT_ENABLED
+/*
+  save or load a buffer that is a member of an object which is being
+  checkpointed as an image of its memory. When loading, the image has
+  already been read over obj, so the buffer object is first put back
+  from live, a copy of obj taken before the image was read, as it
+  owns storage that is not part of the image. live is nullptr when
+  saving
+ */
+template <typename buffer_type>
+bool EKF_checkpoint_buffer(AP_DAL_Checkpoint &cp, buffer_type &buf, const void *obj, const uint8_t *live)
+{
+    if (live == nullptr) {
+        return buf.save_checkpoint(cp);
+    }
+    memcpy((void *)&buf, live + ((const uint8_t *)&buf - (const uint8_t *)obj), sizeof(buf));
+    return buf.load_checkpoint(cp);
+}
+#endif
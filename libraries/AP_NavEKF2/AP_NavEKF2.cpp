@@ -778,7 +778,6 @@ void NavEKF2::UpdateFilter(void)
     // Don't start running the check until the primary core has started returned healthy for at least 10 seconds to avoid switching
     // due to initial alignment fluctuations and race conditions
     if (!runCoreSelection) {
-        static uint64_t lastUnhealthyTime_us = 0;
         if (!core[primary].healthy() || lastUnhealthyTime_us == 0) {
             lastUnhealthyTime_us = imuSampleTime_us;
         }
@@ -27,6 +27,7 @@
 #include <AP_Param/AP_Param.h>
 #include <GCS_MAVLink/GCS_MAVLink.h>
 #include <AP_NavEKF/AP_Nav_Common.h>
+#include <AP_DAL/AP_DAL_Checkpoint.h>
 
 class NavEKF2_core;
 
@@ -304,6 +305,15 @@ public:
     // write EKF information to on-board logs
     void Log_Write();
 
+#if AP_DAL_CHECKPOINT_ENABLED
+    // save the state of the filter and its lanes, and load it back
+    // into a filter with the same parameters on the same build.
+    // Loading allocates the lanes if needed and fails if the number
+    // of lanes or the size of a buffer differs
+    bool saveCheckpoint(AP_DAL_Checkpoint &cp) const;
+    bool loadCheckpoint(AP_DAL_Checkpoint &cp);
+#endif
+
     // check if external navigation is being used for yaw observation
     bool isExtNavUsedForYaw(void) const;
 
@@ -444,10 +454,14 @@ private:
     } pos_down_reset_data;
 
     bool runCoreSelection; // true when the primary core has stabilised and the core selection logic can be started
+    uint64_t lastUnhealthyTime_us; // last time the primary core was unhealthy before core selection started
 
     // time of last lane switch
     uint32_t lastLaneSwitch_ms;
 
+    // last time a lane wrote the timing log message
+    uint32_t lastTimingLogTime_ms;
+
     enum class InitFailures {
         UNKNOWN,
         NO_ENABLE, 
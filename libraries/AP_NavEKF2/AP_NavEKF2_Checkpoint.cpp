@@ -0,0 +1,128 @@
+/*
+  save and load the complete state of the filter so that Replay can
+  resume part way through a log. Each object is written as an image
+  of its memory, then pointers and references are put back from the
+  live object when it is loaded, and the data that those point to is
+  handled separately
+ */
+#include "AP_NavEKF2.h"
+#include "AP_NavEKF2_core.h"
+
+#if AP_DAL_CHECKPOINT_ENABLED
+
+#include <stdlib.h>
+
+// sizes of the objects saved as images, which differ between most
+// builds that change the filter state
+static const uint32_t image_sizes[] {
+    sizeof(NavEKF2),
+    sizeof(NavEKF2_core),
+    sizeof(EKFGSF_yaw),
+};
+
+bool NavEKF2::saveCheckpoint(AP_DAL_Checkpoint &cp) const
+{
+    if (core == nullptr ||
+        !cp.write(image_sizes, sizeof(image_sizes)) ||
+        !cp.write(this, sizeof(*this))) {
+        return false;
+    }
+    for (uint8_t i=0; i<num_cores; i++) {
+        if (!core[i].saveCheckpoint(cp)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool NavEKF2::loadCheckpoint(AP_DAL_Checkpoint &cp)
+{
+    uint32_t sizes[ARRAY_SIZE(image_sizes)];
+    if (!cp.read(sizes, sizeof(sizes)) ||
+        memcmp(sizes, image_sizes, sizeof(sizes)) != 0) {
+        return false;
+    }
+
+    // allocate the lanes and their buffers. Whether the lanes go on
+    // to initialise does not matter as their state is replaced
+    InitialiseFilter();
+    if (core == nullptr) {
+        return false;
+    }
+    NavEKF2_core *live_core = core;
+    const uint8_t live_num_cores = num_cores;
+
+    const bool ret = cp.read(this, sizeof(*this));
+
+    core = live_core;
+    if (!ret || num_cores != live_num_cores) {
+        num_cores = live_num_cores;
+        return false;
+    }
+    for (uint8_t i=0; i<num_cores; i++) {
+        if (!core[i].loadCheckpoint(cp)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool NavEKF2_core::saveCheckpoint(AP_DAL_Checkpoint &cp)
+{
+    if (!cp.write(this, sizeof(*this)) ||
+        !checkpointBuffers(cp, nullptr)) {
+        return false;
+    }
+
+    const bool have_gsf = yawEstimator != nullptr;
+    return cp.write(&have_gsf, sizeof(have_gsf)) &&
+        (!have_gsf || cp.write(yawEstimator, sizeof(*yawEstimator)));
+}
+
+bool NavEKF2_core::loadCheckpoint(AP_DAL_Checkpoint &cp)
+{
+    uint8_t *live = (uint8_t *)malloc(sizeof(*this));
+    if (live == nullptr) {
+        return false;
+    }
+    memcpy(live, (const void *)this, sizeof(*this));
+
+    bool ret = cp.read(this, sizeof(*this));
+
+    // put back the pointers to the GSF, the DAL and the frontend
+    const uint8_t *start = (const uint8_t *)&yawEstimator;
+    const uint8_t *end = (const uint8_t *)&imu_index;
+    memcpy((void *)start, live + (start - (const uint8_t *)this), end - start);
+
+    ret = ret && checkpointBuffers(cp, live);
+    free(live);
+
+    bool have_gsf;
+    return ret &&
+        cp.read(&have_gsf, sizeof(have_gsf)) &&
+        have_gsf == (yawEstimator != nullptr) &&
+        (!have_gsf || cp.read(yawEstimator, sizeof(*yawEstimator)));
+}
+
+/*
+  every buffer is visited even after a failure so that all of them
+  are put back from the live lane when loading
+ */
+bool NavEKF2_core::checkpointBuffers(AP_DAL_Checkpoint &cp, const uint8_t *live)
+{
+    bool ret = true;
+    ret &= EKF_checkpoint_buffer(cp, storedIMU, this, live);
+    ret &= EKF_checkpoint_buffer(cp, storedGPS, this, live);
+    ret &= EKF_checkpoint_buffer(cp, storedMag, this, live);
+    ret &= EKF_checkpoint_buffer(cp, storedBaro, this, live);
+    ret &= EKF_checkpoint_buffer(cp, storedTAS, this, live);
+    ret &= EKF_checkpoint_buffer(cp, storedRange, this, live);
+    ret &= EKF_checkpoint_buffer(cp, storedOutput, this, live);
+    ret &= EKF_checkpoint_buffer(cp, storedOF, this, live);
+    ret &= EKF_checkpoint_buffer(cp, storedRangeBeacon, this, live);
+    ret &= EKF_checkpoint_buffer(cp, storedExtNav, this, live);
+    ret &= EKF_checkpoint_buffer(cp, storedExtNavVel, this, live);
+    return ret;
+}
+
+#endif // AP_DAL_CHECKPOINT_ENABLED
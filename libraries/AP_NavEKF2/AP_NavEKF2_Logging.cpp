@@ -252,11 +252,10 @@ void NavEKF2_core::Log_Write_Beacon(uint64_t time_us)
 void NavEKF2_core::Log_Write_Timing(uint64_t time_us)
 {
     // log EKF timing statistics every 5s
-    static uint32_t lastTimingLogTime_ms = 0;
-    if (AP::dal().millis() - lastTimingLogTime_ms <= 5000) {
+    if (AP::dal().millis() - frontend->lastTimingLogTime_ms <= 5000) {
         return;
     }
-    lastTimingLogTime_ms = AP::dal().millis();
+    frontend->lastTimingLogTime_ms = AP::dal().millis();
 
     const struct log_NKT nkt{
         LOG_PACKET_HEADER_INIT(LOG_NKT_MSG),
@@ -329,6 +329,13 @@ public:
 
     void Log_Write(uint64_t time_us);
 
+#if AP_DAL_CHECKPOINT_ENABLED
+    // save the state of the lane, and load it into a lane that has
+    // been set up with the same parameters
+    bool saveCheckpoint(AP_DAL_Checkpoint &cp);
+    bool loadCheckpoint(AP_DAL_Checkpoint &cp);
+#endif
+
 private:
     EKFGSF_yaw *yawEstimator;
     AP_DAL &dal;
@@ -1195,4 +1202,11 @@ private:
     void Log_Write_Beacon(uint64_t time_us);
     void Log_Write_Timing(uint64_t time_us);
     void Log_Write_GSF(uint64_t time_us) const;
+
+#if AP_DAL_CHECKPOINT_ENABLED
+    // save or load the data buffers, whose storage is not part of the
+    // image of the lane. live is the lane before the image was loaded,
+    // or nullptr when saving
+    bool checkpointBuffers(AP_DAL_Checkpoint &cp, const uint8_t *live);
+#endif
 };
@@ -10,6 +10,10 @@
 
 #include <new>
 
+#if EK3_FEATURE_PARALLEL_LANES
+extern const AP_HAL::HAL& hal;
+#endif
+
 /*
   parameter defaults for different types of vehicle. The
   APM_BUILD_DIRECTORY is taken from the main vehicle directory name
@@ -690,6 +694,14 @@ const AP_Param::GroupInfo NavEKF3::var_info2[] = {
     // @User: Advanced
     AP_GROUPINFO("DRAG_MCOEF", 5, NavEKF3, _momentumDragCoef, 0.0f),
 
+    // @Param: OPTIONS
+    // @DisplayName: EKF3 options
+    // @Description: Optional EKF3 behaviour. RunLanesInParallel runs the update of each lane after the first on its own thread on boards with multiple CPU cores (Linux and SITL), so that extra lanes don't add to the main loop time. When set, an origin set by one lane is shared with the other lanes at the end of each update on all boards, so logs replay identically. WarmStart saves the gyro and accel biases, magnetic field states and yaw of each lane on disarm and seeds the lanes from them on the next boot if the vehicle has not been moved, so the biases don't have to be learned again.
+    // @Bitmask: 0:RunLanesInParallel,1:WarmStart
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("OPTIONS", 6, NavEKF3, _options, 0),
+
     AP_GROUPEND
 };
 
@@ -812,6 +824,12 @@ bool NavEKF3::InitialiseFilter(void)
     // set last time the cores were primary to 0
     memset(coreLastTimePrimary_us, 0, sizeof(coreLastTimePrimary_us));
 
+#if EK3_FEATURE_PARALLEL_LANES
+    if (option_is_set(Option::PARALLEL_LANES) && num_cores > 1 && lane_threads == nullptr) {
+        start_lane_threads();
+    }
+#endif
+
     // zero the structs used capture reset events
     memset(&yaw_reset_data, 0, sizeof(yaw_reset_data));
     memset((void *)&pos_reset_data, 0, sizeof(pos_reset_data));
@@ -820,6 +838,125 @@ bool NavEKF3::InitialiseFilter(void)
     return ret;
 }
 
+/*
+  copy an origin set by a core during the last update to the common
+  origin shared between lanes
+ */
+void NavEKF3::publishCoreOrigins(void)
+{
+    if (common_origin_valid) {
+        return;
+    }
+    for (uint8_t i=0; i<num_cores; i++) {
+        Location origin;
+        if (core[i].takeOriginToPublish(origin)) {
+            common_EKF_origin = origin;
+            common_origin_valid = true;
+            return;
+        }
+    }
+}
+
+#if EK3_FEATURE_PARALLEL_LANES
+/*
+  create one thread for each lane after the first. Lanes run
+  sequentially until all the threads are waiting for work
+ */
+void NavEKF3::start_lane_threads(void)
+{
+    lane_threads = new LaneThreads;
+    if (lane_threads == nullptr) {
+        return;
+    }
+    pthread_mutex_init(&lane_threads->mutex, nullptr);
+    pthread_cond_init(&lane_threads->start_cond, nullptr);
+    pthread_cond_init(&lane_threads->done_cond, nullptr);
+    for (uint8_t i=1; i<num_cores; i++) {
+        if (!hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&NavEKF3::lane_thread, void),
+                                          "EKF3",
+                                          16384, AP_HAL::Scheduler::PRIORITY_MAIN, 0)) {
+            GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "EKF3 failed to start lane thread");
+            return;
+        }
+    }
+}
+
+/*
+  worker thread body. Each thread takes the next lane index when it
+  starts and runs that lane once per update
+ */
+void NavEKF3::lane_thread(void)
+{
+    LaneThreads &lt = *lane_threads;
+    pthread_mutex_lock(&lt.mutex);
+    const uint8_t lane = ++lt.num_ready;
+    uint32_t last_generation = lt.generation;
+    while (true) {
+        while (lt.generation == last_generation) {
+            pthread_cond_wait(&lt.start_cond, &lt.mutex);
+        }
+        last_generation = lt.generation;
+        const bool allow_state_prediction = lt.allow_state_prediction[lane];
+        pthread_mutex_unlock(&lt.mutex);
+
+        core[lane].UpdateFilter(allow_state_prediction);
+
+        pthread_mutex_lock(&lt.mutex);
+        if (--lt.running == 0) {
+            pthread_cond_signal(&lt.done_cond);
+        }
+    }
+}
+
+/*
+  run the first lane on the calling thread and the others on the lane
+  threads, returning once all lanes have finished. Returns false if
+  the lane threads are not available, in which case the caller runs
+  the lanes sequentially. All lanes start together, so the time left
+  for prediction is checked for each lane before any of them runs
+ */
+bool NavEKF3::update_lanes_parallel(void)
+{
+    if (lane_threads == nullptr) {
+        return false;
+    }
+    LaneThreads &lt = *lane_threads;
+    pthread_mutex_lock(&lt.mutex);
+    if (lt.num_ready != num_cores-1) {
+        pthread_mutex_unlock(&lt.mutex);
+        return false;
+    }
+    for (uint8_t i=0; i<num_cores; i++) {
+        lt.allow_state_prediction[i] = allowStatePrediction(i);
+    }
+    lt.running = num_cores-1;
+    lt.generation++;
+    pthread_cond_broadcast(&lt.start_cond);
+    pthread_mutex_unlock(&lt.mutex);
+
+    core[0].UpdateFilter(lt.allow_state_prediction[0]);
+
+    pthread_mutex_lock(&lt.mutex);
+    while (lt.running > 0) {
+        pthread_cond_wait(&lt.done_cond, &lt.mutex);
+    }
+    pthread_mutex_unlock(&lt.mutex);
+    return true;
+}
+#endif // EK3_FEATURE_PARALLEL_LANES
+
+/*
+  if we have not overrun by more than 3 IMU frames, and we have
+  already used more than 1/3 of the CPU budget for this loop then
+  suppress the prediction step. This allows multiple EKF instances to
+  cooperate on scheduling
+ */
+bool NavEKF3::allowStatePrediction(uint8_t i) const
+{
+    return !(core[i].getFramesSincePredict() < (_framesPerPrediction+3) &&
+             AP::dal().ekf_low_time_remaining(AP_DAL::EKFType::EKF3, i));
+}
+
 /*
   return true if a new core index has a better score than the current
   core
@@ -860,24 +997,24 @@ void NavEKF3::UpdateFilter(void)
 
     imuSampleTime_us = AP::dal().micros64();
 
-    for (uint8_t i=0; i<num_cores; i++) {
-        // if we have not overrun by more than 3 IMU frames, and we
-        // have already used more than 1/3 of the CPU budget for this
-        // loop then suppress the prediction step. This allows
-        // multiple EKF instances to cooperate on scheduling
-        bool allow_state_prediction = true;
-        if (core[i].getFramesSincePredict() < (_framesPerPrediction+3) &&
-            AP::dal().ekf_low_time_remaining(AP_DAL::EKFType::EKF3, i)) {
-            allow_state_prediction = false;
+#if EK3_FEATURE_PARALLEL_LANES
+    const bool ran_parallel = update_lanes_parallel();
+#else
+    const bool ran_parallel = false;
+#endif
+    if (!ran_parallel) {
+        for (uint8_t i=0; i<num_cores; i++) {
+            // each lane sees the time used by the lanes before it
+            core[i].UpdateFilter(allowStatePrediction(i));
         }
-        core[i].UpdateFilter(allow_state_prediction);
     }
 
+    publishCoreOrigins();
+
     // If the current core selected has a bad error score or is unhealthy, switch to a healthy core with the lowest fault score
     // Don't start running the check until the primary core has started returned healthy for at least 10 seconds to avoid switching
     // due to initial alignment fluctuations and race conditions
     if (!runCoreSelection) {
-        static uint64_t lastUnhealthyTime_us = 0;
         if (!core[primary].healthy() || lastUnhealthyTime_us == 0) {
             lastUnhealthyTime_us = imuSampleTime_us;
         }
@@ -1005,6 +1142,47 @@ void NavEKF3::requestYawReset(void)
     }
 }
 
+// get the states of the lane using IMU imu_index for a later warm start
+bool NavEKF3::getWarmStart(uint8_t imu_index, WarmStart &ws) const
+{
+    if (!core) {
+        return false;
+    }
+    for (uint8_t i=0; i<num_cores; i++) {
+        if (coreImuIndex[i] == imu_index) {
+            return core[i].getWarmStart(ws);
+        }
+    }
+    return false;
+}
+
+// seed the lane using IMU imu_index from ws when it next initialises
+void NavEKF3::setWarmStart(uint8_t imu_index, const WarmStart &ws)
+{
+    if (imu_index >= ARRAY_SIZE(warm_start)) {
+        return;
+    }
+
+    AP::dal().log_setWarmStart3(imu_index, ws.gyro_bias, ws.accel_bias,
+                                ws.earth_magfield, ws.body_magfield,
+                                ws.yaw, ws.gyro_bias_var, ws.accel_bias_var);
+
+    warm_start[imu_index] = ws;
+    warm_start_mask |= 1U<<imu_index;
+}
+
+// take the pending warm start for the lane using IMU imu_index, so
+// that a later reset of the lane starts cold
+bool NavEKF3::takeWarmStart(uint8_t imu_index, WarmStart &ws)
+{
+    if (imu_index >= ARRAY_SIZE(warm_start) || (warm_start_mask & (1U<<imu_index)) == 0) {
+        return false;
+    }
+    ws = warm_start[imu_index];
+    warm_start_mask &= ~(1U<<imu_index);
+    return true;
+}
+
 /*
   Update this instance error score value for all active cores
 */
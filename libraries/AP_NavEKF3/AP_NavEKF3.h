@@ -25,6 +25,12 @@
 #include <GCS_MAVLink/GCS_MAVLink.h>
 #include <AP_NavEKF/AP_Nav_Common.h>
 #include <AP_NavEKF/AP_NavEKF_Source.h>
+#include "AP_NavEKF3_feature.h"
+#include <AP_DAL/AP_DAL_Checkpoint.h>
+
+#if EK3_FEATURE_PARALLEL_LANES
+#include <pthread.h>
+#endif
 
 class NavEKF3_core;
 
@@ -354,12 +360,49 @@ public:
      */
     void requestYawReset(void);
 
+    // states carried across a reboot to warm start a lane
+    struct WarmStart {
+        Vector3f gyro_bias;         // gyro bias (rad/s)
+        Vector3f accel_bias;        // accel bias (m/s/s)
+        Vector3f earth_magfield;    // NED earth field states (gauss)
+        Vector3f body_magfield;     // body field states (gauss)
+        float yaw;                  // yaw (rad), NaN if the yaw and mag states are not to be used
+        float gyro_bias_var;        // largest gyro bias variance ((rad/s)^2)
+        float accel_bias_var;       // largest accel bias variance ((m/s/s)^2)
+    };
+
+    // true if EK3_OPTIONS enables warm starts
+    bool warmStartEnabled(void) const { return option_is_set(Option::WARM_START); }
+
+    // get the states of the lane using IMU imu_index for a later warm
+    // start. Returns false if there is no such lane or it has not
+    // aligned and learned its gyro bias
+    bool getWarmStart(uint8_t imu_index, WarmStart &ws) const;
+
+    // seed the lane using IMU imu_index from ws when it next
+    // initialises. This must be called before InitialiseFilter()
+    void setWarmStart(uint8_t imu_index, const WarmStart &ws);
+
     // set position, velocity and yaw sources to either 0=primary, 1=secondary, 2=tertiary
     void setPosVelYawSourceSet(uint8_t source_set_idx);
 
     // write EKF information to on-board logs
     void Log_Write();
 
+    // stop the lanes writing their own log messages. Used for filters
+    // run alongside the one being logged, such as by the Replay sweep
+    void disableLogging(void) { logging_disabled = true; }
+
+#if AP_DAL_CHECKPOINT_ENABLED
+    // save the state of the filter and its lanes, and load it back
+    // into a filter with the same parameters on the same build, such
+    // as by Replay to resume part way through a log. Loading
+    // allocates the lanes if needed and fails if the number of lanes
+    // or the size of a buffer differs
+    bool saveCheckpoint(AP_DAL_Checkpoint &cp) const;
+    bool loadCheckpoint(AP_DAL_Checkpoint &cp);
+#endif
+
     // are we using an external yaw source? This is needed by AHRS attitudes_consistent check
     bool using_external_yaw(void) const;
 
@@ -442,6 +485,15 @@ private:
     AP_Float _ballisticCoef_x;      // ballistic coefficient measured for flow in X body frame directions
     AP_Float _ballisticCoef_y;      // ballistic coefficient measured for flow in Y body frame directions
     AP_Float _momentumDragCoef;     // lift rotor momentum drag coefficient
+    AP_Int8 _options;               // bitmask of optional EKF3 behaviour
+
+    enum class Option {
+        PARALLEL_LANES = (1U<<0),
+        WARM_START     = (1U<<1),
+    };
+    bool option_is_set(Option option) const {
+        return (_options & int8_t(option)) != 0;
+    }
 
 // Possible values for _flowUse
 #define FLOW_USE_NONE    0
@@ -490,6 +542,9 @@ private:
     // last time of Log_Write
     uint64_t lastLogWrite_us;
 
+    // true if the lanes must not write log messages
+    bool logging_disabled;
+
     struct {
         uint32_t last_function_call;  // last time getLastYawResetAngle was called
         bool core_changed;            // true when a core change happened and hasn't been consumed, false otherwise
@@ -516,6 +571,7 @@ private:
 #define BETTER_THRESH   0.5 // a lane should have this much relative error difference to be considered for overriding a healthy primary core
     
     bool runCoreSelection;                          // true when the primary core has stabilised and the core selection logic can be started
+    uint64_t lastUnhealthyTime_us;                  // last time the primary core was unhealthy before core selection started
     bool coreSetupRequired[MAX_EKF_CORES];          // true when this core index needs to be setup
     uint8_t coreImuIndex[MAX_EKF_CORES];            // IMU index used by this core
     float coreRelativeErrors[MAX_EKF_CORES];        // relative errors of cores with respect to primary
@@ -525,7 +581,14 @@ private:
     // origin set by one of the cores
     struct Location common_EKF_origin;
     bool common_origin_valid;
-    
+
+    // warm starts waiting for the lane using each IMU to initialise
+    WarmStart warm_start[MAX_EKF_CORES];
+    uint8_t warm_start_mask;
+
+    // take the pending warm start for the lane using IMU imu_index
+    bool takeWarmStart(uint8_t imu_index, WarmStart &ws);
+
     // update the yaw reset data to capture changes due to a lane switch
     // new_primary - index of the ekf instance that we are about to switch to as the primary
     // old_primary - index of the ekf instance that we are currently using as the primary
@@ -554,6 +617,32 @@ private:
     // checks for alignment
     bool coreBetterScore(uint8_t new_core, uint8_t current_core) const;
 
+    // true if the prediction step of a lane may run this loop
+    bool allowStatePrediction(uint8_t i) const;
+
     // position, velocity and yaw source control
     AP_NavEKF_Source sources;
+
+    // publish origins set by cores during the last update. When lanes
+    // run in parallel the cores can't write the common origin directly
+    void publishCoreOrigins(void);
+
+#if EK3_FEATURE_PARALLEL_LANES
+    // worker threads which run the lanes after the first in parallel
+    // with the main thread. The main thread waits for all lanes to
+    // finish before lane selection
+    struct LaneThreads {
+        pthread_mutex_t mutex;
+        pthread_cond_t start_cond;
+        pthread_cond_t done_cond;
+        uint32_t generation;    // incremented to start each update
+        uint8_t num_ready;      // number of threads waiting for work
+        uint8_t running;        // number of lanes still updating
+        bool allow_state_prediction[MAX_EKF_CORES];
+    } *lane_threads = nullptr;
+
+    void start_lane_threads(void);
+    void lane_thread(void);
+    bool update_lanes_parallel(void);
+#endif
 };
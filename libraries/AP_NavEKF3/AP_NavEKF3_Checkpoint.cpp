@@ -0,0 +1,172 @@
+/*
+  save and load the complete state of the filter so that Replay can
+  resume part way through a log. Each object is written as an image
+  of its memory, then pointers and references are put back from the
+  live object when it is loaded, and the data that those point to is
+  handled separately
+ */
+#include "AP_NavEKF3.h"
+#include "AP_NavEKF3_core.h"
+
+#if AP_DAL_CHECKPOINT_ENABLED
+
+#include <stdlib.h>
+
+// sizes of the objects saved as images, which differ between most
+// builds that change the filter state
+static const uint32_t image_sizes[] {
+    sizeof(NavEKF3),
+    sizeof(NavEKF3_core),
+    sizeof(EKFGSF_yaw),
+};
+
+bool NavEKF3::saveCheckpoint(AP_DAL_Checkpoint &cp) const
+{
+    if (core == nullptr ||
+        !cp.write(image_sizes, sizeof(image_sizes)) ||
+        !cp.write(this, sizeof(*this))) {
+        return false;
+    }
+    for (uint8_t i=0; i<num_cores; i++) {
+        if (!core[i].saveCheckpoint(cp)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool NavEKF3::loadCheckpoint(AP_DAL_Checkpoint &cp)
+{
+    uint32_t sizes[ARRAY_SIZE(image_sizes)];
+    if (!cp.read(sizes, sizeof(sizes)) ||
+        memcmp(sizes, image_sizes, sizeof(sizes)) != 0) {
+        return false;
+    }
+
+    // allocate the lanes and their buffers. Whether the lanes go on
+    // to initialise does not matter as their state is replaced
+    InitialiseFilter();
+    if (core == nullptr) {
+        return false;
+    }
+    NavEKF3_core *live_core = core;
+    const uint8_t live_num_cores = num_cores;
+#if EK3_FEATURE_PARALLEL_LANES
+    LaneThreads *live_lane_threads = lane_threads;
+#endif
+
+    const bool ret = cp.read(this, sizeof(*this));
+
+    core = live_core;
+#if EK3_FEATURE_PARALLEL_LANES
+    lane_threads = live_lane_threads;
+#endif
+    if (!ret || num_cores != live_num_cores) {
+        num_cores = live_num_cores;
+        return false;
+    }
+    for (uint8_t i=0; i<num_cores; i++) {
+        if (!core[i].loadCheckpoint(cp)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool NavEKF3_core::saveCheckpoint(AP_DAL_Checkpoint &cp)
+{
+    if (!cp.write(this, sizeof(*this)) ||
+        !checkpointBuffers(cp, nullptr)) {
+        return false;
+    }
+
+    const bool have_gsf = yawEstimator != nullptr;
+    if (!cp.write(&have_gsf, sizeof(have_gsf)) ||
+        (have_gsf && !cp.write(yawEstimator, sizeof(*yawEstimator)))) {
+        return false;
+    }
+
+    const uint8_t num_reports = (rngBcnFusionReport != nullptr && dal.beacon() != nullptr) ? dal.beacon()->count() : 0;
+    return cp.write(&num_reports, sizeof(num_reports)) &&
+        cp.write(rngBcnFusionReport, num_reports * sizeof(rngBcnFusionReport_t));
+}
+
+bool NavEKF3_core::loadCheckpoint(AP_DAL_Checkpoint &cp)
+{
+    uint8_t *live = (uint8_t *)malloc(sizeof(*this));
+    if (live == nullptr) {
+        return false;
+    }
+    memcpy(live, (const void *)this, sizeof(*this));
+
+    bool ret = cp.read(this, sizeof(*this));
+
+    // put back the pointers to the GSF, the DAL and the frontend
+    const uint8_t *start = (const uint8_t *)&yawEstimator;
+    const uint8_t *end = (const uint8_t *)&imu_index;
+    memcpy((void *)start, live + (start - (const uint8_t *)this), end - start);
+    memcpy((void *)&rngBcnFusionReport, live + ((const uint8_t *)&rngBcnFusionReport - (const uint8_t *)this), sizeof(rngBcnFusionReport));
+
+    ret = ret && checkpointBuffers(cp, live);
+    free(live);
+
+    bool have_gsf;
+    if (!ret ||
+        !cp.read(&have_gsf, sizeof(have_gsf)) ||
+        have_gsf != (yawEstimator != nullptr) ||
+        (have_gsf && !cp.read(yawEstimator, sizeof(*yawEstimator)))) {
+        return false;
+    }
+
+    uint8_t num_reports;
+    if (!cp.read(&num_reports, sizeof(num_reports))) {
+        return false;
+    }
+    if (num_reports == 0) {
+        return true;
+    }
+    if (dal.beacon() == nullptr || dal.beacon()->count() != num_reports) {
+        return false;
+    }
+    if (rngBcnFusionReport == nullptr) {
+        rngBcnFusionReport = new rngBcnFusionReport_t[num_reports];
+        if (rngBcnFusionReport == nullptr) {
+            return false;
+        }
+    }
+    return cp.read(rngBcnFusionReport, num_reports * sizeof(rngBcnFusionReport_t));
+}
+
+/*
+  every buffer is visited even after a failure so that all of them
+  are put back from the live lane when loading
+ */
+bool NavEKF3_core::checkpointBuffers(AP_DAL_Checkpoint &cp, const uint8_t *live)
+{
+    bool ret = true;
+    ret &= EKF_checkpoint_buffer(cp, storedIMU, this, live);
+    ret &= EKF_checkpoint_buffer(cp, storedGPS, this, live);
+    ret &= EKF_checkpoint_buffer(cp, storedMag, this, live);
+    ret &= EKF_checkpoint_buffer(cp, storedBaro, this, live);
+    ret &= EKF_checkpoint_buffer(cp, storedTAS, this, live);
+    ret &= EKF_checkpoint_buffer(cp, storedRange, this, live);
+    ret &= EKF_checkpoint_buffer(cp, storedOutput, this, live);
+    ret &= EKF_checkpoint_buffer(cp, storedOF, this, live);
+#if EK3_FEATURE_BODY_ODOM
+    ret &= EKF_checkpoint_buffer(cp, storedBodyOdm, this, live);
+    ret &= EKF_checkpoint_buffer(cp, storedWheelOdm, this, live);
+#endif
+    ret &= EKF_checkpoint_buffer(cp, storedYawAng, this, live);
+    ret &= EKF_checkpoint_buffer(cp, storedRangeBeacon, this, live);
+#if EK3_FEATURE_DRAG_FUSION
+    ret &= EKF_checkpoint_buffer(cp, storedDrag, this, live);
+#endif
+#if EK3_FEATURE_EXTERNAL_NAV
+    ret &= EKF_checkpoint_buffer(cp, storedExtNav, this, live);
+    ret &= EKF_checkpoint_buffer(cp, storedExtNavVel, this, live);
+    ret &= EKF_checkpoint_buffer(cp, storedExtNavYawAng, this, live);
+#endif
+    return ret;
+}
+
+#endif // AP_DAL_CHECKPOINT_ENABLED
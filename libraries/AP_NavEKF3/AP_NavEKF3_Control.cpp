@@ -592,8 +592,26 @@ void NavEKF3_core::setOrigin(const Location &loc)
     GCS_SEND_TEXT(MAV_SEVERITY_INFO, "EKF3 IMU%u origin set",(unsigned)imu_index);
 
     // put origin in frontend as well to ensure it stays in sync between lanes
-    frontend->common_EKF_origin = EKF_origin;
-    frontend->common_origin_valid = true;
+    if (frontend->option_is_set(NavEKF3::Option::PARALLEL_LANES)) {
+        // lanes may be running in parallel, so let the frontend
+        // publish it at the end of the update
+        originToPublish = true;
+    } else {
+        frontend->common_EKF_origin = EKF_origin;
+        frontend->common_origin_valid = true;
+    }
+}
+
+// return true and the origin if this core has set an origin which
+// has not yet been shared with the other lanes
+bool NavEKF3_core::takeOriginToPublish(Location &origin)
+{
+    if (!originToPublish) {
+        return false;
+    }
+    originToPublish = false;
+    origin = EKF_origin;
+    return true;
 }
 
 // record a yaw reset event
@@ -273,9 +273,8 @@ void NavEKF3_core::Log_Write_BodyOdom(uint64_t time_us)
     }
 
     Vector3f velBodyInnov,velBodyInnovVar;
-    static uint32_t lastUpdateTime_ms = 0;
     uint32_t updateTime_ms = getBodyFrameOdomDebug( velBodyInnov, velBodyInnovVar);
-    if (updateTime_ms > lastUpdateTime_ms) {
+    if (updateTime_ms > logTimes.body_odom_update_ms) {
         const struct log_XKFD pkt11{
             LOG_PACKET_HEADER_INIT(LOG_XKFD_MSG),
             time_us : time_us,
@@ -288,20 +287,19 @@ void NavEKF3_core::Log_Write_BodyOdom(uint64_t time_us)
             velInnovVarZ : velBodyInnovVar.z
          };
         AP::logger().WriteBlock(&pkt11, sizeof(pkt11));
-        lastUpdateTime_ms = updateTime_ms;
+        logTimes.body_odom_update_ms = updateTime_ms;
     }
 }
 
-void NavEKF3_core::Log_Write_State_Variances(uint64_t time_us) const
+void NavEKF3_core::Log_Write_State_Variances(uint64_t time_us)
 {
     if (core_index != frontend->primary) {
         // log only primary instance for now
         return;
     }
 
-    static uint32_t lastEkfStateVarLogTime_ms = 0;
-    if (AP::dal().millis() - lastEkfStateVarLogTime_ms > 490) {
-        lastEkfStateVarLogTime_ms = AP::dal().millis();
+    if (AP::dal().millis() - logTimes.state_variances_ms > 490) {
+        logTimes.state_variances_ms = AP::dal().millis();
         const struct log_XKV pktv1{
             LOG_PACKET_HEADER_INIT(LOG_XKV1_MSG),
             time_us : time_us,
@@ -393,11 +391,10 @@ void NavEKF3_core::Log_Write(uint64_t time_us)
 void NavEKF3_core::Log_Write_Timing(uint64_t time_us)
 {
     // log EKF timing statistics every 5s
-    static uint32_t lastTimingLogTime_ms = 0;
-    if (AP::dal().millis() - lastTimingLogTime_ms <= 5000) {
+    if (AP::dal().millis() - logTimes.timing_ms <= 5000) {
         return;
     }
-    lastTimingLogTime_ms = AP::dal().millis();
+    logTimes.timing_ms = AP::dal().millis();
 
     const struct log_XKT xkt{
         LOG_PACKET_HEADER_INIT(LOG_XKT_MSG),
@@ -1359,6 +1359,9 @@ void NavEKF3_core::updateMovementCheck(void)
         logStatusChange = true;
     }
 
+    if (frontend->logging_disabled) {
+        return;
+    }
     if (logStatusChange || imuSampleTime_ms - lastMoveCheckLogTime_ms > 200) {
         lastMoveCheckLogTime_ms = imuSampleTime_ms;
         const struct log_XKFM pkt{
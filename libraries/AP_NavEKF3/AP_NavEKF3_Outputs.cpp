@@ -125,6 +125,29 @@ void NavEKF3_core::getAccelBias(Vector3f &accelBias) const
     accelBias = stateStruct.accel_bias / dtEkfAvg;
 }
 
+// get the states to warm start this lane after a reboot
+bool NavEKF3_core::getWarmStart(NavEKF3::WarmStart &ws) const
+{
+    if (!statesInitialised || !tiltAlignComplete || !delAngBiasLearned || dtEkfAvg < 1e-6f) {
+        return false;
+    }
+    ws.gyro_bias = stateStruct.gyro_bias / dtEkfAvg;
+    ws.accel_bias = stateStruct.accel_bias / dtEkfAvg;
+    ws.gyro_bias_var = MAX(MAX(P[10][10], P[11][11]), P[12][12]) / sq(dtEkfAvg);
+    ws.accel_bias_var = MAX(MAX(P[13][13], P[14][14]), P[15][15]) / sq(dtEkfAvg);
+    ws.earth_magfield = stateStruct.earth_magfield;
+    ws.body_magfield = stateStruct.body_magfield;
+
+    // the yaw and field states are only kept if they came from a
+    // compass, as that is the only way to check them on the next boot
+    ws.yaw = NAN;
+    if (yawAlignComplete && magStateInitComplete && use_compass()) {
+        float roll, pitch;
+        stateStruct.quat.to_euler(roll, pitch, ws.yaw);
+    }
+    return true;
+}
+
 // return the transformation matrix from XYZ (body) to NED axes
 void NavEKF3_core::getRotationBodyToNED(Matrix3f &mat) const
 {
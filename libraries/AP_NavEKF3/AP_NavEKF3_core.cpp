@@ -266,6 +266,7 @@ void NavEKF3_core::InitialiseVariables()
     inhibitDelAngBiasStates = true;
     gndOffsetValid =  false;
     validOrigin = false;
+    originToPublish = false;
     takeoffExpectedSet_ms = 0;
     expectTakeoff = false;
     touchdownExpectedSet_ms = 0;
@@ -566,6 +567,9 @@ bool NavEKF3_core::InitialiseFilterBootstrap(void)
     // initialise the covariance matrix
     CovarianceInit();
 
+    // seed the static states if we were given a warm start
+    applyWarmStart();
+
     // reset the output predictor states
     StoreOutputReset();
 
@@ -631,6 +635,57 @@ void NavEKF3_core::CovarianceInit()
 
 }
 
+/*
+  seed the biases, magnetic field states and yaw from a warm start
+  saved on a previous boot. The bias variances are taken from the warm
+  start but are never made larger than those of a cold start. The
+  caller is responsible for checking the vehicle has not been moved
+*/
+void NavEKF3_core::applyWarmStart()
+{
+    NavEKF3::WarmStart ws;
+    if (!frontend->takeWarmStart(imu_index, ws)) {
+        return;
+    }
+
+    stateStruct.gyro_bias = ws.gyro_bias * dtEkfAvg;
+    stateStruct.accel_bias = ws.accel_bias * dtEkfAvg;
+    if (is_positive(ws.gyro_bias_var)) {
+        const float var = MIN(ws.gyro_bias_var * sq(dtEkfAvg), P[10][10]);
+        P[10][10] = P[11][11] = P[12][12] = var;
+    }
+    if (is_positive(ws.accel_bias_var)) {
+        const float var = MIN(ws.accel_bias_var * sq(dtEkfAvg), P[13][13]);
+        P[13][13] = P[14][14] = P[15][15] = var;
+    }
+
+    // the yaw and field states replace the initial alignment from a
+    // single compass sample. The yaw is marked aligned and the field
+    // learned so that the end of tilt alignment does not request a
+    // yaw and field reset from the compass, which would overwrite
+    // them. The attitude variance set by CovarianceInit() is the same
+    // on all axes so is left as it is
+    bool yaw_seeded = false;
+    if (!isnan(ws.yaw) && use_compass()) {
+        float roll, pitch, yaw;
+        stateStruct.quat.to_euler(roll, pitch, yaw);
+        stateStruct.quat.from_euler(roll, pitch, ws.yaw);
+        stateStruct.earth_magfield = ws.earth_magfield;
+        stateStruct.body_magfield = ws.body_magfield;
+        recordYawReset();
+        recordMagReset();
+        yawAlignComplete = true;
+        magStateInitComplete = true;
+        magFieldLearned = true;
+        magYawResetRequest = false;
+        earthMagFieldVar = Vector3f(P[16][16], P[17][17], P[18][18]);
+        bodyMagFieldVar = Vector3f(P[19][19], P[20][20], P[21][21]);
+        yaw_seeded = true;
+    }
+
+    GCS_SEND_TEXT(MAV_SEVERITY_INFO, "EKF3 IMU%u warm start%s", (unsigned)imu_index, yaw_seeded ? " with yaw" : "");
+}
+
 /********************************************************
 *                 UPDATE FUNCTIONS                      *
 ********************************************************/
@@ -1476,6 +1531,28 @@ void NavEKF3_core::CovariancePrediction(Vector3f *rotVarVecPtr)
             nextP[15][15] = P[15][15];
 
             if (stateIndexLim > 15) {
+#if EK3_FEATURE_BLOCKED_COV_PREDICT
+                // the magnetic field and wind states are static, so each of
+                // their columns is the same combination of rows of P. See
+                // AP_NavEKF3/derivation/generated/covariance_generated_blocked.cpp
+                for (uint8_t j=16; j<=stateIndexLim; j++) {
+                    nextP[0][j] = -PS11*P[1][j] - PS12*P[2][j] - PS13*P[3][j] + PS6*P[10][j] + PS7*P[11][j] + PS9*P[12][j] + P[0][j];
+                    nextP[1][j] = PS11*P[0][j] - PS12*P[3][j] + PS13*P[2][j] - PS34*P[10][j] - PS7*P[12][j] + PS9*P[11][j] + P[1][j];
+                    nextP[2][j] = PS11*P[3][j] + PS12*P[0][j] - PS13*P[1][j] - PS34*P[11][j] + PS6*P[12][j] - PS9*P[10][j] + P[2][j];
+                    nextP[3][j] = -PS11*P[2][j] + PS12*P[1][j] + PS13*P[0][j] - PS34*P[12][j] - PS6*P[11][j] + PS7*P[10][j] + P[3][j];
+                    nextP[4][j] = -PS139*P[15][j] + PS140*P[14][j] - PS44*P[13][j] + PS60*P[2][j] + PS62*P[1][j] + PS72*P[0][j] - PS74*P[3][j] + P[4][j];
+                    nextP[5][j] = PS160*P[15][j] - PS162*P[13][j] - PS60*P[1][j] + PS62*P[2][j] - PS65*P[14][j] + PS72*P[3][j] + PS74*P[0][j] + P[5][j];
+                    nextP[6][j] = -PS165*P[14][j] + PS166*P[13][j] + PS60*P[0][j] + PS62*P[3][j] - PS70*P[15][j] - PS72*P[2][j] + PS74*P[1][j] + P[6][j];
+                    nextP[7][j] = P[4][j]*dt + P[7][j];
+                    nextP[8][j] = P[5][j]*dt + P[8][j];
+                    nextP[9][j] = P[6][j]*dt + P[9][j];
+                }
+                for (uint8_t i=10; i<=stateIndexLim; i++) {
+                    for (uint8_t j=MAX(i,16); j<=stateIndexLim; j++) {
+                        nextP[i][j] = P[i][j];
+                    }
+                }
+#else
                 nextP[0][16] = -PS11*P[1][16] - PS12*P[2][16] - PS13*P[3][16] + PS6*P[10][16] + PS7*P[11][16] + PS9*P[12][16] + P[0][16];
                 nextP[1][16] = PS11*P[0][16] - PS12*P[3][16] + PS13*P[2][16] - PS34*P[10][16] - PS7*P[12][16] + PS9*P[11][16] + P[1][16];
                 nextP[2][16] = PS11*P[3][16] + PS12*P[0][16] - PS13*P[1][16] - PS34*P[11][16] + PS6*P[12][16] - PS9*P[10][16] + P[2][16];
@@ -1643,6 +1720,7 @@ void NavEKF3_core::CovariancePrediction(Vector3f *rotVarVecPtr)
                     nextP[22][23] = P[22][23];
                     nextP[23][23] = P[23][23];
                 }
+#endif // EK3_FEATURE_BLOCKED_COV_PREDICT
             }
         }
     }
@@ -2027,6 +2105,9 @@ void NavEKF3_core::bestRotationOrder(rotationOrder &order)
 // and log with value generated by NavEKF3_core::calcTiltErrorVariance()
 void NavEKF3_core::verifyTiltErrorVariance()
 {
+    if (frontend->logging_disabled) {
+        return;
+    }
     const Vector3f gravity_ef = Vector3f(0.0f,0.0f,1.0f);
     Matrix3f Tnb;
     const float quat_delta = 0.001f;
@@ -2055,9 +2136,8 @@ void NavEKF3_core::verifyTiltErrorVariance()
     }
 
     tiltErrorVarianceAlt = MIN(tiltErrorVarianceAlt, sq(radians(30.0f)));
-    static uint32_t lastLogTime_ms = 0;
-    if (imuSampleTime_ms - lastLogTime_ms > 500) {
-        lastLogTime_ms = imuSampleTime_ms;
+    if (imuSampleTime_ms - logTimes.tilt_variance_ms > 500) {
+        logTimes.tilt_variance_ms = imuSampleTime_ms;
         const struct log_XKTV msg {
             LOG_PACKET_HEADER_INIT(LOG_XKTV_MSG),
             time_us      : dal.micros64(),
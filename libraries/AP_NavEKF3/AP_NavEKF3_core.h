@@ -36,6 +36,7 @@
 
 #include "AP_NavEKF/EKFGSF_yaw.h"
 #include "AP_NavEKF3_feature.h"
+#include "AP_NavEKF3.h"
 
 // GPS pre-flight check bit locations
 #define MASK_GPS_NSATS      (1<<0)
@@ -132,6 +133,10 @@ public:
     // return accelerometer bias in m/s/s
     void getAccelBias(Vector3f &accelBias) const;
 
+    // get the states to warm start this lane after a reboot. Returns
+    // false until the tilt is aligned and the gyro bias learned
+    bool getWarmStart(NavEKF3::WarmStart &ws) const;
+
     // reset body axis gyro bias estimates
     void resetGyroBias(void);
 
@@ -179,6 +184,10 @@ public:
     // Returns false if the filter has rejected the attempt to set the origin
     bool setOriginLLH(const Location &loc);
 
+    // return true and the origin if this core has set an origin which
+    // has not yet been shared with the other lanes
+    bool takeOriginToPublish(Location &origin);
+
     // return estimated height above ground level
     // return false if ground height is not being estimated.
     bool getHAGL(float &HAGL) const;
@@ -399,6 +408,13 @@ public:
 
     void Log_Write(uint64_t time_us);
 
+#if AP_DAL_CHECKPOINT_ENABLED
+    // save the state of the lane, and load it into a lane that has
+    // been set up with the same parameters
+    bool saveCheckpoint(AP_DAL_Checkpoint &cp);
+    bool loadCheckpoint(AP_DAL_Checkpoint &cp);
+#endif
+
 private:
     EKFGSF_yaw *yawEstimator;
     AP_DAL &dal;
@@ -745,6 +761,10 @@ private:
     // zero stored variables related to mag
     void InitialiseVariablesMag();
 
+    // seed the biases, magnetic field states and yaw from a pending
+    // warm start. Called once the covariance has been initialised
+    void applyWarmStart();
+
     // reset the horizontal position states uing the last GPS measurement
     void ResetPosition(resetDataSource posResetSource);
 
@@ -1030,6 +1050,7 @@ private:
     bool gpsNotAvailable;           // bool true when valid GPS data is not available
     struct Location EKF_origin;     // LLH origin of the NED axis system
     bool validOrigin;               // true when the EKF origin is valid
+    bool originToPublish;           // true when an origin has been set which the frontend has not yet shared with other lanes
     float gpsSpdAccuracy;           // estimated speed accuracy in m/s returned by the GPS receiver
     float gpsPosAccuracy;           // estimated position accuracy in m returned by the GPS receiver
     float gpsHgtAccuracy;           // estimated height accuracy in m returned by the GPS receiver
@@ -1483,7 +1504,23 @@ private:
     void Log_Write_Quaternion(uint64_t time_us) const;
     void Log_Write_Beacon(uint64_t time_us);
     void Log_Write_BodyOdom(uint64_t time_us);
-    void Log_Write_State_Variances(uint64_t time_us) const;
+    void Log_Write_State_Variances(uint64_t time_us);
     void Log_Write_Timing(uint64_t time_us);
     void Log_Write_GSF(uint64_t time_us);
+
+    // times this lane last wrote its rate limited log messages. These
+    // are per lane as lanes may run on their own threads
+    struct {
+        uint32_t body_odom_update_ms;   // update time of the last body odometry innovations logged
+        uint32_t state_variances_ms;
+        uint32_t timing_ms;
+        uint32_t tilt_variance_ms;
+    } logTimes;
+
+#if AP_DAL_CHECKPOINT_ENABLED
+    // save or load the data buffers, whose storage is not part of the
+    // image of the lane. live is the lane before the image was loaded,
+    // or nullptr when saving
+    bool checkpointBuffers(AP_DAL_Checkpoint &cp, const uint8_t *live);
+#endif
 };
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <AP_HAL/AP_HAL_Boards.h>
 #include <AP_Vehicle/AP_Vehicle_Type.h>
 
 // define for when to include all features
@@ -24,3 +25,16 @@
 #define EK3_FEATURE_DRAG_FUSION EK3_FEATURE_ALL || BOARD_FLASH_SIZE > 1024
 #endif
 
+
+// covariance prediction with the static state columns computed as
+// loops the compiler can vectorise. This gives the same result as the
+// fully unrolled generated code, and is used where the compiler has
+// SIMD to vectorise with
+#ifndef EK3_FEATURE_BLOCKED_COV_PREDICT
+#define EK3_FEATURE_BLOCKED_COV_PREDICT (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#endif
+
+// running lanes on worker threads, for boards with multiple CPU cores
+#ifndef EK3_FEATURE_PARALLEL_LANES
+#define EK3_FEATURE_PARALLEL_LANES (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX) && !(EK3_FEATURE_ALL)
+#endif
@@ -0,0 +1,106 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+
+/*
+  compare the two forms of the static state (magnetic field and wind)
+  columns of the EKF3 covariance prediction: the fully unrolled form
+  written by the code generator, and the blocked form selected by
+  EK3_FEATURE_BLOCKED_COV_PREDICT. The coefficients are the transition
+  matrix terms named as in AP_NavEKF3_core.cpp
+ */
+
+static const uint8_t stateIndexLim = 23;
+
+struct CovPredictBench {
+    float P[24][24];
+    float nextP[24][24];
+    float PS6, PS7, PS9, PS11, PS12, PS13, PS34;
+    float PS44, PS60, PS62, PS65, PS70, PS72, PS74;
+    float PS139, PS140, PS160, PS162, PS165, PS166;
+    float dt;
+
+    CovPredictBench() {
+        for (uint8_t i=0; i<24; i++) {
+            for (uint8_t j=i; j<24; j++) {
+                P[i][j] = P[j][i] = (i == j) ? 1.0f : 0.01f * ((i * 7 + j * 13) % 11);
+            }
+        }
+        PS6 = 0.5f;   PS7 = 0.1f;   PS9 = -0.2f;  PS34 = 0.4f;
+        PS11 = 1e-3f; PS12 = 2e-3f; PS13 = -1e-3f;
+        PS44 = 0.9f;  PS60 = 0.1f;  PS62 = -0.3f; PS65 = 0.8f;
+        PS70 = 0.7f;  PS72 = 0.2f;  PS74 = -0.1f;
+        PS139 = 0.05f; PS140 = -0.02f; PS160 = 0.03f;
+        PS162 = 0.01f; PS165 = -0.04f; PS166 = 0.06f;
+        dt = 0.0025f;
+    }
+};
+
+// one column as the unrolled generated code computes it
+#define STATIC_COLUMN(b, j) do { \
+    b.nextP[0][j] = -b.PS11*b.P[1][j] - b.PS12*b.P[2][j] - b.PS13*b.P[3][j] + b.PS6*b.P[10][j] + b.PS7*b.P[11][j] + b.PS9*b.P[12][j] + b.P[0][j]; \
+    b.nextP[1][j] = b.PS11*b.P[0][j] - b.PS12*b.P[3][j] + b.PS13*b.P[2][j] - b.PS34*b.P[10][j] - b.PS7*b.P[12][j] + b.PS9*b.P[11][j] + b.P[1][j]; \
+    b.nextP[2][j] = b.PS11*b.P[3][j] + b.PS12*b.P[0][j] - b.PS13*b.P[1][j] - b.PS34*b.P[11][j] + b.PS6*b.P[12][j] - b.PS9*b.P[10][j] + b.P[2][j]; \
+    b.nextP[3][j] = -b.PS11*b.P[2][j] + b.PS12*b.P[1][j] + b.PS13*b.P[0][j] - b.PS34*b.P[12][j] - b.PS6*b.P[11][j] + b.PS7*b.P[10][j] + b.P[3][j]; \
+    b.nextP[4][j] = -b.PS139*b.P[15][j] + b.PS140*b.P[14][j] - b.PS44*b.P[13][j] + b.PS60*b.P[2][j] + b.PS62*b.P[1][j] + b.PS72*b.P[0][j] - b.PS74*b.P[3][j] + b.P[4][j]; \
+    b.nextP[5][j] = b.PS160*b.P[15][j] - b.PS162*b.P[13][j] - b.PS60*b.P[1][j] + b.PS62*b.P[2][j] - b.PS65*b.P[14][j] + b.PS72*b.P[3][j] + b.PS74*b.P[0][j] + b.P[5][j]; \
+    b.nextP[6][j] = -b.PS165*b.P[14][j] + b.PS166*b.P[13][j] + b.PS60*b.P[0][j] + b.PS62*b.P[3][j] - b.PS70*b.P[15][j] - b.PS72*b.P[2][j] + b.PS74*b.P[1][j] + b.P[6][j]; \
+    b.nextP[7][j] = b.P[4][j]*b.dt + b.P[7][j]; \
+    b.nextP[8][j] = b.P[5][j]*b.dt + b.P[8][j]; \
+    b.nextP[9][j] = b.P[6][j]*b.dt + b.P[9][j]; \
+    for (uint8_t i=10; i<=j; i++) { \
+        b.nextP[i][j] = b.P[i][j]; \
+    } \
+} while (0)
+
+static void BM_CovPredictStaticUnrolled(benchmark::State& state)
+{
+    CovPredictBench b;
+
+    while (state.KeepRunning()) {
+        gbenchmark_clobber();
+        STATIC_COLUMN(b, 16);
+        STATIC_COLUMN(b, 17);
+        STATIC_COLUMN(b, 18);
+        STATIC_COLUMN(b, 19);
+        STATIC_COLUMN(b, 20);
+        STATIC_COLUMN(b, 21);
+        STATIC_COLUMN(b, 22);
+        STATIC_COLUMN(b, 23);
+        gbenchmark_escape(&b.nextP[0][0]);
+    }
+}
+
+static void BM_CovPredictStaticBlocked(benchmark::State& state)
+{
+    CovPredictBench b;
+    float (&P)[24][24] = b.P;
+    float (&nextP)[24][24] = b.nextP;
+
+    while (state.KeepRunning()) {
+        gbenchmark_clobber();
+        for (uint8_t j=16; j<=stateIndexLim; j++) {
+            nextP[0][j] = -b.PS11*P[1][j] - b.PS12*P[2][j] - b.PS13*P[3][j] + b.PS6*P[10][j] + b.PS7*P[11][j] + b.PS9*P[12][j] + P[0][j];
+            nextP[1][j] = b.PS11*P[0][j] - b.PS12*P[3][j] + b.PS13*P[2][j] - b.PS34*P[10][j] - b.PS7*P[12][j] + b.PS9*P[11][j] + P[1][j];
+            nextP[2][j] = b.PS11*P[3][j] + b.PS12*P[0][j] - b.PS13*P[1][j] - b.PS34*P[11][j] + b.PS6*P[12][j] - b.PS9*P[10][j] + P[2][j];
+            nextP[3][j] = -b.PS11*P[2][j] + b.PS12*P[1][j] + b.PS13*P[0][j] - b.PS34*P[12][j] - b.PS6*P[11][j] + b.PS7*P[10][j] + P[3][j];
+            nextP[4][j] = -b.PS139*P[15][j] + b.PS140*P[14][j] - b.PS44*P[13][j] + b.PS60*P[2][j] + b.PS62*P[1][j] + b.PS72*P[0][j] - b.PS74*P[3][j] + P[4][j];
+            nextP[5][j] = b.PS160*P[15][j] - b.PS162*P[13][j] - b.PS60*P[1][j] + b.PS62*P[2][j] - b.PS65*P[14][j] + b.PS72*P[3][j] + b.PS74*P[0][j] + P[5][j];
+            nextP[6][j] = -b.PS165*P[14][j] + b.PS166*P[13][j] + b.PS60*P[0][j] + b.PS62*P[3][j] - b.PS70*P[15][j] - b.PS72*P[2][j] + b.PS74*P[1][j] + P[6][j];
+            nextP[7][j] = P[4][j]*b.dt + P[7][j];
+            nextP[8][j] = P[5][j]*b.dt + P[8][j];
+            nextP[9][j] = P[6][j]*b.dt + P[9][j];
+        }
+        for (uint8_t i=10; i<=stateIndexLim; i++) {
+            for (uint8_t j=MAX(i,16); j<=stateIndexLim; j++) {
+                nextP[i][j] = P[i][j];
+            }
+        }
+        gbenchmark_escape(&nextP[0][0]);
+    }
+}
+
+BENCHMARK(BM_CovPredictStaticUnrolled);
+BENCHMARK(BM_CovPredictStaticBlocked);
+
+BENCHMARK_MAIN();
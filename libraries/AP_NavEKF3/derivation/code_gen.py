@@ -42,5 +42,48 @@ class CodeGenerator:
         write_string = write_string + "\n\n"
         self.file.write(write_string)
 
+    def write_matrix_blocked(self, matrix, variable_name, first_block_col, limit_name, pre_bracket="[", post_bracket="]", separator="]["):
+        # Write the upper triangle of a symmetric matrix, emitting columns from
+        # first_block_col onwards as loops over the column index. This is only
+        # valid when every column in the block has the same expressions with the
+        # column index substituted, which is checked here. The loops read and
+        # write contiguous memory so the compiler can vectorise them.
+        write_string = ""
+        n = matrix.shape[0]
+        for j in range(0, first_block_col):
+            for i in range(0, j+1):
+                write_string = write_string + variable_name + pre_bracket + str(i) + separator + str(j) + post_bracket + " = " + self.get_ccode(matrix[i,j]) + ";\n"
+
+        col_ref = separator + str(first_block_col) + post_bracket
+        col_var = separator + "j" + post_bracket
+        row_code = []
+        first_identity_row = None
+        for i in range(0, first_block_col + 1):
+            code = self.get_ccode(matrix[i,first_block_col])
+            if code == "P" + pre_bracket + str(i) + col_ref:
+                if first_identity_row is None:
+                    first_identity_row = i
+                continue
+            if first_identity_row is not None:
+                raise ValueError("non-identity row %u after identity rows in blocked matrix" % i)
+            row_code.append(code.replace(col_ref, col_var))
+        for j in range(first_block_col + 1, n):
+            for i in range(0, len(row_code)):
+                if self.get_ccode(matrix[i,j]).replace(separator + str(j) + post_bracket, col_var) != row_code[i]:
+                    raise ValueError("column %u of blocked matrix does not match column %u" % (j, first_block_col))
+
+        write_string = write_string + "\nfor (uint8_t j=" + str(first_block_col) + "; j<=" + limit_name + "; j++) {\n"
+        for i in range(0, len(row_code)):
+            write_string = write_string + "    " + variable_name + pre_bracket + str(i) + col_var + " = " + row_code[i] + ";\n"
+        write_string = write_string + "}\n"
+        if first_identity_row is not None:
+            write_string = write_string + "for (uint8_t i=" + str(first_identity_row) + "; i<=" + limit_name + "; i++) {\n"
+            write_string = write_string + "    for (uint8_t j=MAX(i," + str(first_block_col) + "); j<=" + limit_name + "; j++) {\n"
+            write_string = write_string + "        " + variable_name + pre_bracket + "i" + col_var + " = P" + pre_bracket + "i" + col_var + ";\n"
+            write_string = write_string + "    }\n}\n"
+
+        write_string = write_string + "\n\n"
+        self.file.write(write_string)
+
     def close(self):
         self.file.close()
@@ -655,6 +655,17 @@ def generate_code():
 
     cov_code_generator.close()
 
+    # the magnetic field and wind states (16 to 23) are static, so their
+    # columns are linear combinations of rows of P with coefficients that
+    # don't depend on the column. Write these columns as loops which the
+    # compiler can vectorise. Selected with EK3_FEATURE_BLOCKED_COV_PREDICT
+    print('Writing blocked covariance propagation to file ...')
+    cov_code_generator = CodeGenerator("./generated/covariance_generated_blocked.cpp")
+    cov_code_generator.print_string("Equations for covariance matrix prediction, without process noise, with static state columns as loops")
+    cov_code_generator.write_subexpressions(P_new_simple[0])
+    cov_code_generator.write_matrix_blocked(Matrix(P_new_simple[1]), "nextP", 16, "stateIndexLim")
+    cov_code_generator.close()
+
 
     # derive autocode for other methods
     print('Computing tilt error covariance matrix ...')
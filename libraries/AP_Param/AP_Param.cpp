@@ -25,6 +25,7 @@
 
 #include <cmath>
 #include <string.h>
+#include <ctype.h>
 
 #include <AP_Common/AP_Common.h>
 #include <AP_HAL/AP_HAL.h>
@@ -81,6 +82,39 @@ uint16_t AP_Param::_count_marker;
 uint16_t AP_Param::_count_marker_done;
 HAL_Semaphore AP_Param::_count_sem;
 
+#if AP_PARAM_SAVE_BATCH_ENABLED
+AP_Param::OffsetSlot *AP_Param::_ofs_cache;
+uint32_t AP_Param::_storage_write_count;
+uint16_t AP_Param::_ofs_cache_mask;
+uint16_t AP_Param::_ofs_cache_count;
+uint16_t AP_Param::_ofs_cache_sentinal;
+bool AP_Param::_ofs_cache_valid;
+HAL_Semaphore AP_Param::_ofs_cache_sem;
+uint8_t AP_Param::_save_batch_buf[AP_PARAM_SAVE_BATCH_BYTES];
+uint16_t AP_Param::_save_batch_len;
+const AP_Param *AP_Param::_save_batch_notify[];
+uint8_t AP_Param::_save_batch_notify_count;
+#endif
+
+#if AP_PARAM_HASH_INDEX_ENABLED
+AP_Param::HashSlot *AP_Param::_hash_index;
+uint16_t AP_Param::_hash_index_mask;
+uint16_t AP_Param::_hash_index_count;
+bool AP_Param::_hash_index_dirty = true;
+uint32_t AP_Param::_hash_index_build_ms;
+HAL_Semaphore AP_Param::_hash_index_sem;
+
+// minimum time between rebuilds of the hash index
+#define AP_PARAM_HASH_INDEX_REBUILD_MS 1000
+#endif
+
+#if AP_PARAM_JOURNAL_ENABLED
+AP_Param::JournalEntry *AP_Param::_journal;
+uint32_t AP_Param::_journal_generation;
+uint32_t AP_Param::_journal_base_crc;
+HAL_Semaphore AP_Param::_journal_sem;
+#endif
+
 // storage and naming information about all types that can be saved
 const AP_Param::Info *AP_Param::_var_info;
 
@@ -118,8 +152,11 @@ StorageAccess AP_Param::_storage_bak(StorageManager::StorageParamBak);
 uint16_t AP_Param::_frame_type_flags;
 
 // write to EEPROM
-void AP_Param::eeprom_write_check(const void *ptr, uint16_t ofs, uint8_t size)
+void AP_Param::eeprom_write_check(const void *ptr, uint16_t ofs, uint16_t size)
 {
+#if AP_PARAM_SAVE_BATCH_ENABLED
+    _storage_write_count++;
+#endif
     _storage.write_block(ofs, ptr, size);
     _storage_bak.write_block(ofs, ptr, size);
 }
@@ -135,6 +172,10 @@ void AP_Param::write_sentinal(uint16_t ofs)
     phdr.group_element = _sentinal_group;
     eeprom_write_check(&phdr, ofs, sizeof(phdr));
     sentinal_offset = ofs;
+#if AP_PARAM_SAVE_BATCH_ENABLED
+    WITH_SEMAPHORE(_ofs_cache_sem);
+    _ofs_cache_sentinal = ofs;
+#endif
 }
 
 // erase all EEPROM variables by re-writing the header and adding
@@ -152,6 +193,11 @@ void AP_Param::erase_all(void)
 
     // add a sentinal directly after the header
     write_sentinal(sizeof(struct EEPROM_header));
+
+#if AP_PARAM_SAVE_BATCH_ENABLED
+    WITH_SEMAPHORE(_ofs_cache_sem);
+    _ofs_cache_valid = false;
+#endif
 }
 
 /* the 'group_id' of a element of a group is the 18 bit identifier
@@ -720,6 +766,14 @@ bool AP_Param::is_sentinal(const Param_header &phdr)
 // if the sentinal isn't found either, the offset is set to 0xFFFF
 bool AP_Param::scan(const AP_Param::Param_header *target, uint16_t *pofs)
 {
+#if AP_PARAM_SAVE_BATCH_ENABLED
+    {
+        WITH_SEMAPHORE(_ofs_cache_sem);
+        if (_ofs_cache_valid || ofs_cache_build()) {
+            return ofs_cache_lookup(*target, *pofs);
+        }
+    }
+#endif
     struct Param_header phdr;
     uint16_t ofs = sizeof(AP_Param::EEPROM_header);
     while (ofs < _storage.size()) {
@@ -870,10 +924,10 @@ AP_Param::find_group(const char *name, uint16_t vindex, ptrdiff_t group_offset,
 }
 
 
-// Find a variable by name.
+// Find a variable by name by walking the var_info tree
 //
 AP_Param *
-AP_Param::find(const char *name, enum ap_var_type *ptype, uint16_t *flags)
+AP_Param::find_linear(const char *name, enum ap_var_type *ptype)
 {
     for (uint16_t i=0; i<_num_vars; i++) {
         uint8_t type = _var_info[i].type;
@@ -888,16 +942,6 @@ AP_Param::find(const char *name, enum ap_var_type *ptype, uint16_t *flags)
             }
             AP_Param *ap = find_group(name + len, i, 0, group_info, ptype);
             if (ap != nullptr) {
-                if (flags != nullptr) {
-                    uint32_t group_element = 0;
-                    const struct GroupInfo *ginfo;
-                    struct GroupNesting group_nesting {};
-                    uint8_t idx;
-                    ap->find_var_info(&group_element, ginfo, group_nesting, &idx);
-                    if (ginfo != nullptr) {
-                        *flags = ginfo->flags;
-                    }
-                }
                 return ap;
             }
             // we continue looking as we want to allow top level
@@ -915,6 +959,395 @@ AP_Param::find(const char *name, enum ap_var_type *ptype, uint16_t *flags)
     return nullptr;
 }
 
+// Find a variable by name.
+//
+AP_Param *
+AP_Param::find(const char *name, enum ap_var_type *ptype, uint16_t *flags)
+{
+    AP_Param *ap = nullptr;
+#if AP_PARAM_HASH_INDEX_ENABLED
+    ParamToken token;
+    bool indexed;
+    ap = hash_index_find(name, false, ptype, token, indexed);
+    if (ap == nullptr) {
+        ap = find_linear(name, ptype);
+        if (ap != nullptr && !indexed) {
+            // the parameter has appeared since the index was built,
+            // for example by allocation of a pointer group
+            _hash_index_dirty = true;
+        }
+    }
+#else
+    ap = find_linear(name, ptype);
+#endif
+    if (ap != nullptr && flags != nullptr) {
+        uint32_t group_element = 0;
+        const struct GroupInfo *ginfo;
+        struct GroupNesting group_nesting {};
+        uint8_t idx;
+        ap->find_var_info(&group_element, ginfo, group_nesting, &idx);
+        if (ginfo != nullptr) {
+            *flags = ginfo->flags;
+        }
+    }
+    return ap;
+}
+
+#if AP_PARAM_HASH_INDEX_ENABLED
+/*
+  FNV-1a hash of the upper case form of a parameter name, limited to
+  AP_MAX_NAME_SIZE characters
+ */
+uint32_t AP_Param::hash_name(const char *name)
+{
+    uint32_t h = 2166136261U;
+    for (uint8_t i=0; i<AP_MAX_NAME_SIZE && name[i] != 0; i++) {
+        h ^= (uint8_t)toupper(name[i]);
+        h *= 16777619U;
+    }
+    return h;
+}
+
+/*
+  get the parameter for a token without walking the rest of the tree.
+  hidden is set if next_scalar() would skip the parameter because of
+  its frame type or a disabled enable parameter earlier in its group
+ */
+AP_Param *AP_Param::find_by_token(ParamToken &token, enum ap_var_type *ptype, bool &hidden)
+{
+    if (token.key >= _num_vars) {
+        return nullptr;
+    }
+    const struct Info &info = _var_info[token.key];
+    enum ap_var_type type = (enum ap_var_type)info.type;
+    hidden = !check_frame_type(info.flags);
+    token.last_disabled = 0;
+    AP_Param *ap;
+    if (type == AP_PARAM_GROUP) {
+        const struct GroupInfo *group_info = get_group_info(info);
+        if (group_info == nullptr) {
+            return nullptr;
+        }
+        ap = find_by_token_group(token, group_info, 0, 0, 0, &type, hidden);
+    } else {
+        ptrdiff_t base;
+        if (!get_base(info, base)) {
+            return nullptr;
+        }
+        ap = (AP_Param *)base;
+    }
+    if (ap == nullptr) {
+        return nullptr;
+    }
+    if (token.idx != 0) {
+        if (type != AP_PARAM_VECTOR3F || token.idx > 3) {
+            return nullptr;
+        }
+        // an element of a Vector3f, seen as a float
+        ap = (AP_Param *)(((ptrdiff_t)ap) + sizeof(float)*(token.idx - 1u));
+        type = AP_PARAM_FLOAT;
+    }
+    *ptype = type;
+    return ap;
+}
+
+/// find_by_token() for a group, recursing into groups as next_group() does
+AP_Param *AP_Param::find_by_token_group(ParamToken &token,
+                                        const struct GroupInfo *group_info,
+                                        uint32_t group_base,
+                                        uint8_t group_shift,
+                                        ptrdiff_t group_offset,
+                                        enum ap_var_type *ptype,
+                                        bool &hidden)
+{
+    const bool parent_hidden = hidden;
+    bool disabled = parent_hidden;
+    uint8_t type;
+    for (uint8_t i=0;
+         (type=group_info[i].type) != AP_PARAM_NONE;
+         i++) {
+        const bool skipped = disabled || !check_frame_type(group_info[i].flags);
+        if (type == AP_PARAM_GROUP) {
+            const struct GroupInfo *ginfo = get_group_info(group_info[i]);
+            if (ginfo == nullptr) {
+                continue;
+            }
+            ptrdiff_t new_offset = group_offset;
+            if (!adjust_group_offset(token.key, group_info[i], new_offset)) {
+                continue;
+            }
+            hidden = skipped;
+            AP_Param *ap = find_by_token_group(token, ginfo, group_id(group_info, group_base, i, group_shift),
+                                               group_shift + _group_level_shift, new_offset, ptype, hidden);
+            if (ap != nullptr) {
+                return ap;
+            }
+            continue;
+        }
+        ptrdiff_t base;
+        if (!get_base(_var_info[token.key], base)) {
+            return nullptr;
+        }
+        AP_Param *ap = (AP_Param *)(base + group_info[i].offset + group_offset);
+        const bool disabled_enable = _hide_disabled_groups &&
+            type == AP_PARAM_INT8 &&
+            (group_info[i].flags & AP_PARAM_FLAG_ENABLE) &&
+            ((AP_Int8 *)ap)->get() == 0;
+        if (group_id(group_info, group_base, i, group_shift) == token.group_element) {
+            hidden = skipped;
+            if (!skipped && disabled_enable) {
+                token.last_disabled = 1;
+            }
+            *ptype = (enum ap_var_type)type;
+            return ap;
+        }
+        if (!skipped && disabled_enable) {
+            // next_scalar() leaves this group after a disabled enable
+            disabled = true;
+        }
+    }
+    hidden = parent_hidden;
+    return nullptr;
+}
+
+/*
+  get the name of the parameter for a token, as copy_name_token()
+  gives it with force_scalar set for Vector3f elements
+ */
+bool AP_Param::hash_index_name(ParamToken token, char *buf, size_t buf_size)
+{
+    enum ap_var_type type;
+    bool hidden;
+    const AP_Param *ap = find_by_token(token, &type, hidden);
+    if (ap == nullptr) {
+        return false;
+    }
+    ap->copy_name_token(token, buf, buf_size, token.idx != 0);
+    buf[buf_size-1] = 0;
+    return true;
+}
+
+void AP_Param::hash_index_insert(const char *name, const ParamToken &token)
+{
+    if (_hash_index == nullptr) {
+        // counting pass
+        _hash_index_count++;
+        return;
+    }
+    const uint32_t h = hash_name(name);
+    const uint16_t tag = h >> 16;
+    for (uint16_t i = h & _hash_index_mask; ; i = (i+1) & _hash_index_mask) {
+        HashSlot &slot = _hash_index[i];
+        if (slot.token == UINT32_MAX) {
+            memcpy(&slot.token, &token, sizeof(slot.token));
+            slot.tag = tag;
+            return;
+        }
+        if (slot.tag == tag) {
+            ParamToken t;
+            memcpy(&t, &slot.token, sizeof(t));
+            char buf[AP_MAX_NAME_SIZE+1];
+            if (hash_index_name(t, buf, sizeof(buf)) && strcasecmp(buf, name) == 0) {
+                // a duplicate name; the linear search would find the
+                // first one, so keep that
+                return;
+            }
+        }
+    }
+}
+
+/*
+  add a parameter to the index. Vector3f parameters are also added as
+  their three elements
+ */
+void AP_Param::hash_index_add(const char *name, uint16_t vindex, uint32_t group_element, uint8_t type)
+{
+    ParamToken token {};
+    token.key = vindex;
+    token.group_element = group_element;
+    hash_index_insert(name, token);
+    if (type == AP_PARAM_VECTOR3F) {
+        // names truncated as copy_name_token() truncates them
+        char buf[AP_MAX_NAME_SIZE+3];
+        const uint8_t len = strnlen(name, AP_MAX_NAME_SIZE);
+        memcpy(buf, name, len);
+        buf[len] = '_';
+        for (uint8_t i=0; i<3; i++) {
+            buf[len+1] = 'X' + i;
+            buf[len+2] = 0;
+            buf[AP_MAX_NAME_SIZE] = 0;
+            token.idx = i + 1;
+            hash_index_insert(buf, token);
+        }
+    }
+}
+
+void AP_Param::hash_index_add_group(uint16_t vindex,
+                                    const struct GroupInfo *group_info,
+                                    uint32_t group_base,
+                                    uint8_t group_shift,
+                                    ptrdiff_t group_offset,
+                                    char *name,
+                                    uint8_t name_len)
+{
+    uint8_t type;
+    for (uint8_t i=0;
+         (type=group_info[i].type) != AP_PARAM_NONE;
+         i++) {
+        strncpy(&name[name_len], group_info[i].name, AP_MAX_NAME_SIZE - name_len);
+        name[AP_MAX_NAME_SIZE] = 0;
+        const uint32_t id = group_id(group_info, group_base, i, group_shift);
+        if (type == AP_PARAM_GROUP) {
+            const struct GroupInfo *ginfo = get_group_info(group_info[i]);
+            if (ginfo == nullptr) {
+                continue;
+            }
+            ptrdiff_t new_offset = group_offset;
+            if (!adjust_group_offset(vindex, group_info[i], new_offset)) {
+                // not allocated yet. A find() which falls back to the
+                // linear search marks the index for rebuild
+                continue;
+            }
+            hash_index_add_group(vindex, ginfo, id, group_shift + _group_level_shift,
+                                 new_offset, name, strnlen(name, AP_MAX_NAME_SIZE));
+        } else {
+            hash_index_add(name, vindex, id, type);
+        }
+    }
+}
+
+/*
+  (re)build the hash index from the var_info tree. Called with
+  _hash_index_sem held
+ */
+void AP_Param::hash_index_build(void)
+{
+    delete[] _hash_index;
+    _hash_index = nullptr;
+    _hash_index_dirty = false;
+    _hash_index_build_ms = MAX(AP_HAL::millis(), 1U);
+
+    // first pass counts the entries, second pass fills the table
+    _hash_index_count = 0;
+    for (uint8_t pass=0; pass<2; pass++) {
+        for (uint16_t i=0; i<_num_vars; i++) {
+            const struct Info &info = _var_info[i];
+            ptrdiff_t base;
+            if (!get_base(info, base)) {
+                continue;
+            }
+            if (info.type == AP_PARAM_GROUP) {
+                const struct GroupInfo *group_info = get_group_info(info);
+                if (group_info == nullptr) {
+                    continue;
+                }
+                char name[AP_MAX_NAME_SIZE+1] {};
+                strncpy(name, info.name, AP_MAX_NAME_SIZE);
+                hash_index_add_group(i, group_info, 0, 0, 0, name, strnlen(name, AP_MAX_NAME_SIZE));
+            } else {
+                // find() does not give the elements of top level
+                // vectors, so only the vector itself is added
+                ParamToken token {};
+                token.key = i;
+                hash_index_insert(info.name, token);
+            }
+        }
+        if (pass != 0) {
+            break;
+        }
+        // keep the load factor below 2/3 so probe sequences stay short
+        uint32_t slots = 16;
+        while (slots < _hash_index_count + _hash_index_count/2U) {
+            slots *= 2;
+        }
+        if (slots > AP_PARAM_HASH_INDEX_MAX_SLOTS) {
+            return;
+        }
+        _hash_index = new HashSlot[slots];
+        if (_hash_index == nullptr) {
+            return;
+        }
+        memset(_hash_index, 0xFF, slots * sizeof(HashSlot));
+        _hash_index_mask = slots - 1;
+    }
+}
+
+/*
+  find a parameter using the hash index. indexed is set if the name is
+  in the index, in which case the linear search will not find a
+  different parameter. If scalar_only is set the lookup follows
+  find_by_name(): names are compared ignoring case and only
+  parameters which next_scalar() would return are found
+ */
+AP_Param *AP_Param::hash_index_find(const char *name, bool scalar_only,
+                                    enum ap_var_type *ptype, ParamToken &token,
+                                    bool &indexed)
+{
+    indexed = false;
+    if (_num_vars == 0) {
+        return nullptr;
+    }
+
+    WITH_SEMAPHORE(_hash_index_sem);
+
+    if (_hash_index_dirty &&
+        (_hash_index_build_ms == 0 || AP_HAL::millis() - _hash_index_build_ms >= AP_PARAM_HASH_INDEX_REBUILD_MS)) {
+        hash_index_build();
+    }
+    if (_hash_index == nullptr) {
+        return nullptr;
+    }
+
+    const uint32_t h = hash_name(name);
+    const uint16_t tag = h >> 16;
+    for (uint16_t i = h & _hash_index_mask; ; i = (i+1) & _hash_index_mask) {
+        const HashSlot &slot = _hash_index[i];
+        if (slot.token == UINT32_MAX) {
+            return nullptr;
+        }
+        if (slot.tag != tag) {
+            continue;
+        }
+        memcpy(&token, &slot.token, sizeof(token));
+        enum ap_var_type type;
+        bool hidden;
+        AP_Param *ap = find_by_token(token, &type, hidden);
+        if (ap == nullptr) {
+            continue;
+        }
+        char buf[AP_MAX_NAME_SIZE+1];
+        ap->copy_name_token(token, buf, sizeof(buf), token.idx != 0);
+        buf[AP_MAX_NAME_SIZE] = 0;
+        if (scalar_only) {
+            if (strncasecmp(name, buf, AP_MAX_NAME_SIZE) != 0) {
+                continue;
+            }
+            if (type > AP_PARAM_FLOAT) {
+                // next_scalar() gives the elements of a vector, not
+                // the vector, so leave this to the linear search
+                return nullptr;
+            }
+            indexed = true;
+            if (hidden) {
+                return nullptr;
+            }
+        } else {
+            if (strcasecmp(name, buf) != 0) {
+                continue;
+            }
+            indexed = true;
+            if (strcmp(name, buf) != 0) {
+                // find() is case sensitive for group prefixes and
+                // vector suffixes; leave mixed case to the linear search
+                return nullptr;
+            }
+        }
+        *ptype = type;
+        return ap;
+    }
+}
+#endif // AP_PARAM_HASH_INDEX_ENABLED
+
 // Find a variable by index. Note that this is quite slow.
 //
 AP_Param *
@@ -934,6 +1367,17 @@ AP_Param::find_by_index(uint16_t idx, enum ap_var_type *ptype, ParamToken *token
 AP_Param* AP_Param::find_by_name(const char* name, enum ap_var_type *ptype, ParamToken *token)
 {
     AP_Param *ap;
+#if AP_PARAM_HASH_INDEX_ENABLED
+    bool indexed;
+    ap = hash_index_find(name, true, ptype, *token, indexed);
+    if (ap != nullptr) {
+        return ap;
+    }
+    if (indexed) {
+        // known, but not visible through next_scalar()
+        return nullptr;
+    }
+#endif
     uint16_t count = 0;
     for (ap = AP_Param::first(token, ptype);
          ap && *ptype != AP_PARAM_GROUP && *ptype != AP_PARAM_NONE;
@@ -1080,56 +1524,94 @@ void AP_Param::notify() const {
 
 
 /*
-  Save the variable to HAL storage, synchronous version
+  work out the header, name and size used to store this variable.
+  Returns false if it can't be stored
 */
-void AP_Param::save_sync(bool force_save)
+bool AP_Param::save_prepare(struct save_info &s) const
 {
     uint32_t group_element = 0;
     const struct GroupInfo *ginfo;
     struct GroupNesting group_nesting {};
-    uint8_t idx;
-    const struct AP_Param::Info *info = find_var_info(&group_element, ginfo, group_nesting, &idx);
-    const AP_Param *ap;
+    const struct AP_Param::Info *info = find_var_info(&group_element, ginfo, group_nesting, &s.idx);
 
     if (info == nullptr) {
         // we don't have any info on how to store it
-        return;
+        return false;
     }
 
-    struct Param_header phdr;
-
     // create the header we will use to store the variable
     if (ginfo != nullptr) {
-        phdr.type = ginfo->type;
+        s.phdr.type = ginfo->type;
+        s.def_value_ptr = &ginfo->def_value;
     } else {
-        phdr.type = info->type;
+        s.phdr.type = info->type;
+        s.def_value_ptr = &info->def_value;
     }
-    set_key(phdr, info->key);
-    phdr.group_element = group_element;
+    set_key(s.phdr, info->key);
+    s.phdr.group_element = group_element;
+    s.info_type = info->type;
+    s.size = type_size((enum ap_var_type)s.phdr.type);
 
-    ap = this;
-    if (phdr.type != AP_PARAM_VECTOR3F && idx != 0) {
+    s.ap = this;
+    if (s.phdr.type != AP_PARAM_VECTOR3F && s.idx != 0) {
         // only vector3f can have non-zero idx for now
-        return;
+        return false;
     }
-    if (idx != 0) {
-        ap = (const AP_Param *)((ptrdiff_t)ap) - (idx*sizeof(float));
+    if (s.idx != 0) {
+        s.ap = (const AP_Param *)((ptrdiff_t)s.ap) - (s.idx*sizeof(float));
     }
 
-    if (phdr.type == AP_PARAM_INT8 && ginfo != nullptr && (ginfo->flags & AP_PARAM_FLAG_ENABLE)) {
+    if (s.phdr.type == AP_PARAM_INT8 && ginfo != nullptr && (ginfo->flags & AP_PARAM_FLAG_ENABLE)) {
         // clear cached parameter count
         invalidate_count();
     }
-    
-    char name[AP_MAX_NAME_SIZE+1];
-    copy_name_info(info, ginfo, group_nesting, idx, name, sizeof(name), true);
+
+    copy_name_info(info, ginfo, group_nesting, s.idx, s.name, sizeof(s.name), true);
+    return true;
+}
+
+/*
+  return true if a variable which is not yet in storage should not be
+  saved as it has its default value
+*/
+bool AP_Param::save_skip_default(const struct save_info &s, bool force_save) const
+{
+    if (s.phdr.type > AP_PARAM_FLOAT) {
+        return false;
+    }
+    float v1 = cast_to_float((enum ap_var_type)s.phdr.type);
+    float v2 = get_default_value(this, s.def_value_ptr);
+    if (is_equal(v1,v2) && !force_save) {
+        GCS_SEND_PARAM(s.name, (enum ap_var_type)s.info_type, v2);
+        return true;
+    }
+    if (!force_save &&
+        (s.phdr.type != AP_PARAM_INT32 &&
+         (fabsf(v1-v2) < 0.0001f*fabsf(v1)))) {
+        // for other than 32 bit integers, we accept values within
+        // 0.01 percent of the current value as being the same
+        GCS_SEND_PARAM(s.name, (enum ap_var_type)s.info_type, v2);
+        return true;
+    }
+    return false;
+}
+
+/*
+  Save the variable to HAL storage, synchronous version
+*/
+void AP_Param::save_sync(bool force_save)
+{
+    struct save_info s;
+    if (!save_prepare(s)) {
+        return;
+    }
 
     // scan EEPROM to find the right location
     uint16_t ofs;
-    if (scan(&phdr, &ofs)) {
+    if (scan(&s.phdr, &ofs)) {
         // found an existing copy of the variable
-        eeprom_write_check(ap, ofs+sizeof(phdr), type_size((enum ap_var_type)phdr.type));
-        send_parameter(name, (enum ap_var_type)phdr.type, idx);
+        eeprom_write_check(s.ap, ofs+sizeof(s.phdr), s.size);
+        send_parameter(s.name, (enum ap_var_type)s.phdr.type, s.idx);
         return;
     }
     if (ofs == (uint16_t) ~0) {
@@ -1137,40 +1619,28 @@ void AP_Param::save_sync(bool force_save)
     }
 
     // if the value is the default value then don't save
-    if (phdr.type <= AP_PARAM_FLOAT) {
-        float v1 = cast_to_float((enum ap_var_type)phdr.type);
-        float v2;
-        if (ginfo != nullptr) {
-            v2 = get_default_value(this, &ginfo->def_value);
-        } else {
-            v2 = get_default_value(this, &info->def_value);
-        }
-        if (is_equal(v1,v2) && !force_save) {
-            GCS_SEND_PARAM(name, (enum ap_var_type)info->type, v2);
-            return;
-        }
-        if (!force_save &&
-            (phdr.type != AP_PARAM_INT32 &&
-             (fabsf(v1-v2) < 0.0001f*fabsf(v1)))) {
-            // for other than 32 bit integers, we accept values within
-            // 0.01 percent of the current value as being the same
-            GCS_SEND_PARAM(name, (enum ap_var_type)info->type, v2);
-            return;
-        }
+    if (save_skip_default(s, force_save)) {
+        return;
     }
 
-    if (ofs+type_size((enum ap_var_type)phdr.type)+2*sizeof(phdr) >= _storage.size()) {
+    if (ofs+s.size+2*sizeof(s.phdr) >= _storage.size()) {
         // we are out of room for saving variables
         hal.console->printf("EEPROM full\n");
         return;
     }
 
     // write a new sentinal, then the data, then the header
-    write_sentinal(ofs + sizeof(phdr) + type_size((enum ap_var_type)phdr.type));
-    eeprom_write_check(ap, ofs+sizeof(phdr), type_size((enum ap_var_type)phdr.type));
-    eeprom_write_check(&phdr, ofs, sizeof(phdr));
+    write_sentinal(ofs + sizeof(s.phdr) + s.size);
+    eeprom_write_check(s.ap, ofs+sizeof(s.phdr), s.size);
+    eeprom_write_check(&s.phdr, ofs, sizeof(s.phdr));
+#if AP_PARAM_SAVE_BATCH_ENABLED
+    {
+        WITH_SEMAPHORE(_ofs_cache_sem);
+        ofs_cache_insert(s.phdr, ofs);
+    }
+#endif
 
-    send_parameter(name, (enum ap_var_type)phdr.type, idx);
+    send_parameter(s.name, (enum ap_var_type)s.phdr.type, s.idx);
 }
 
 /*
@@ -1211,15 +1681,280 @@ void AP_Param::save(bool force_save)
  */
 void AP_Param::save_io_handler(void)
 {
+    save_pending();
+    if (hal.scheduler->is_system_initialized()) {
+        // pay the cost of parameter counting in the IO thread
+        count_parameters();
+    }
+}
+
+/*
+  write out all queued saves
+ */
+void AP_Param::save_pending(void)
+{
+#if AP_PARAM_SAVE_BATCH_ENABLED
+    /*
+      variables already in storage are updated in place. New ones
+      are gathered in _save_batch_buf and appended to storage
+      together, so a bulk upload costs one write of each new variable
+      and a single sentinal move per batch
+     */
+    struct param_save p;
+    uint16_t batch_ofs = 0;
+    while (save_queue.pop(p)) {
+        struct save_info s;
+        if (!p.param->save_prepare(s)) {
+            continue;
+        }
+        uint16_t ofs;
+        if (scan(&s.phdr, &ofs)) {
+            eeprom_write_check(s.ap, ofs+sizeof(s.phdr), s.size);
+            p.param->send_parameter(s.name, (enum ap_var_type)s.phdr.type, s.idx);
+            continue;
+        }
+        if (ofs == (uint16_t) ~0) {
+            continue;
+        }
+        uint16_t bofs;
+        if (save_batch_find(s.phdr, bofs)) {
+            // saved earlier in this batch, eg. another element of a
+            // Vector3f
+            memcpy(&_save_batch_buf[bofs+sizeof(s.phdr)], s.ap, s.size);
+            save_batch_notify_add(p.param);
+            continue;
+        }
+        if (p.param->save_skip_default(s, p.force_save)) {
+            continue;
+        }
+        const uint16_t len = sizeof(s.phdr) + s.size;
+        if (_save_batch_len + len > sizeof(_save_batch_buf)) {
+            save_batch_flush(batch_ofs);
+            ofs = sentinal_offset;
+        }
+        if (ofs+_save_batch_len+len+sizeof(s.phdr) >= _storage.size()) {
+            // we are out of room for saving variables
+            hal.console->printf("EEPROM full\n");
+            continue;
+        }
+        batch_ofs = ofs;
+        memcpy(&_save_batch_buf[_save_batch_len], &s.phdr, sizeof(s.phdr));
+        memcpy(&_save_batch_buf[_save_batch_len+sizeof(s.phdr)], s.ap, s.size);
+        _save_batch_len += len;
+        save_batch_notify_add(p.param);
+    }
+    if (_save_batch_len > 0) {
+        save_batch_flush(batch_ofs);
+    }
+#else
     struct param_save p;
     while (save_queue.pop(p)) {
         p.param->save_sync(p.force_save);
     }
-    if (hal.scheduler->is_system_initialized()) {
-        // pay the cost of parameter counting in the IO thread
-        count_parameters();
+#endif
+}
+
+#if AP_PARAM_SAVE_BATCH_ENABLED
+/*
+  find a variable waiting in the batch buffer
+ */
+bool AP_Param::save_batch_find(const Param_header &phdr, uint16_t &bofs)
+{
+    for (uint16_t i=0; i<_save_batch_len; ) {
+        struct Param_header h;
+        memcpy(&h, &_save_batch_buf[i], sizeof(h));
+        if (memcmp(&h, &phdr, sizeof(h)) == 0) {
+            bofs = i;
+            return true;
+        }
+        i += sizeof(h) + type_size((enum ap_var_type)h.type);
+    }
+    return false;
+}
+
+/*
+  note a variable in the batch buffer for sending to the GCS after
+  the flush
+ */
+void AP_Param::save_batch_notify_add(const AP_Param *ap)
+{
+    for (uint8_t i=0; i<_save_batch_notify_count; i++) {
+        if (_save_batch_notify[i] == ap) {
+            return;
+        }
+    }
+    if (_save_batch_notify_count < ARRAY_SIZE(_save_batch_notify)) {
+        _save_batch_notify[_save_batch_notify_count++] = ap;
+    }
+}
+
+/*
+  append the batch buffer to storage at the sentinal offset ofs
+ */
+void AP_Param::save_batch_flush(uint16_t ofs)
+{
+    const uint16_t len = _save_batch_len;
+    _save_batch_len = 0;
+
+    // write the new sentinal and everything except the first header,
+    // then the first header over the old sentinal. As with a single
+    // save, storage holds a valid list at each step
+    write_sentinal(ofs + len);
+    eeprom_write_check(&_save_batch_buf[sizeof(Param_header)], ofs+sizeof(Param_header), len-sizeof(Param_header));
+    eeprom_write_check(_save_batch_buf, ofs, sizeof(Param_header));
+
+    {
+        WITH_SEMAPHORE(_ofs_cache_sem);
+        for (uint16_t i=0; i<len; ) {
+            struct Param_header phdr;
+            memcpy(&phdr, &_save_batch_buf[i], sizeof(phdr));
+            ofs_cache_insert(phdr, ofs+i);
+            i += sizeof(phdr) + type_size((enum ap_var_type)phdr.type);
+        }
+    }
+
+    // only now are the new values stored, so tell the GCS
+    const uint8_t count = _save_batch_notify_count;
+    _save_batch_notify_count = 0;
+    for (uint8_t i=0; i<count; i++) {
+        struct save_info s;
+        if (_save_batch_notify[i]->save_prepare(s)) {
+            _save_batch_notify[i]->send_parameter(s.name, (enum ap_var_type)s.phdr.type, s.idx);
+        }
+    }
+}
+
+static uint16_t ofs_cache_hash(uint32_t header)
+{
+    header ^= header >> 16;
+    header *= 0x7feb352dU;
+    header ^= header >> 15;
+    return header;
+}
+
+/*
+  the most slots the offset cache can need: enough for storage full of
+  the smallest variables at the 2/3 load factor
+ */
+uint32_t AP_Param::ofs_cache_max_slots(void)
+{
+    const uint32_t max_vars = (_storage.size() - sizeof(EEPROM_header)) / (sizeof(Param_header)+1);
+    uint32_t slots = 64;
+    while (slots*2U < max_vars*3U && slots < 0x8000U) {
+        slots *= 2;
+    }
+    return slots;
+}
+
+/*
+  add a stored variable to the offset cache, growing it as needed. If
+  the header is already present the existing entry is kept, as scan()
+  finds the first copy. Called with _ofs_cache_sem held
+ */
+bool AP_Param::ofs_cache_insert(const Param_header &phdr, uint16_t ofs)
+{
+    if (_ofs_cache == nullptr || (_ofs_cache_count+1U)*3U > (_ofs_cache_mask+1U)*2U) {
+        // grow, keeping the load factor below 2/3
+        const uint32_t slots = _ofs_cache == nullptr ? 64U : (_ofs_cache_mask+1U)*2U;
+        if (slots > ofs_cache_max_slots()) {
+            _ofs_cache_valid = false;
+            return false;
+        }
+        OffsetSlot *old = _ofs_cache;
+        const uint32_t old_slots = old == nullptr ? 0 : _ofs_cache_mask+1U;
+        _ofs_cache = new OffsetSlot[slots];
+        if (_ofs_cache == nullptr) {
+            _ofs_cache = old;
+            _ofs_cache_valid = false;
+            return false;
+        }
+        memset(_ofs_cache, 0xFF, slots*sizeof(OffsetSlot));
+        _ofs_cache_mask = slots - 1;
+        _ofs_cache_count = 0;
+        for (uint32_t i=0; i<old_slots; i++) {
+            if (old[i].header != UINT32_MAX) {
+                struct Param_header h;
+                memcpy(&h, &old[i].header, sizeof(h));
+                ofs_cache_insert(h, old[i].ofs);
+            }
+        }
+        delete[] old;
+    }
+
+    uint32_t header;
+    memcpy(&header, &phdr, sizeof(header));
+    for (uint16_t i = ofs_cache_hash(header) & _ofs_cache_mask; ; i = (i+1) & _ofs_cache_mask) {
+        OffsetSlot &slot = _ofs_cache[i];
+        if (slot.header == header) {
+            return true;
+        }
+        if (slot.header == UINT32_MAX) {
+            slot.header = header;
+            slot.ofs = ofs;
+            _ofs_cache_count++;
+            return true;
+        }
+    }
+}
+
+/*
+  fill the offset cache from storage. Called with _ofs_cache_sem held
+ */
+bool AP_Param::ofs_cache_build(void)
+{
+    _ofs_cache_count = 0;
+    if (_ofs_cache != nullptr) {
+        memset(_ofs_cache, 0xFF, (_ofs_cache_mask+1U)*sizeof(OffsetSlot));
+    }
+    _ofs_cache_valid = true;
+
+    struct Param_header phdr;
+    uint16_t ofs = sizeof(AP_Param::EEPROM_header);
+    while (ofs < _storage.size()) {
+        _storage.read_block(&phdr, ofs, sizeof(phdr));
+        if (is_sentinal(phdr)) {
+            _ofs_cache_sentinal = ofs;
+            sentinal_offset = ofs;
+            return _ofs_cache_valid;
+        }
+        if (!ofs_cache_insert(phdr, ofs)) {
+            return false;
+        }
+        ofs += type_size((enum ap_var_type)phdr.type) + sizeof(phdr);
+    }
+    // no sentinal; leave this to scan()
+    _ofs_cache_valid = false;
+    return false;
+}
+
+/*
+  equivalent of scan() using the offset cache. Called with
+  _ofs_cache_sem held
+ */
+bool AP_Param::ofs_cache_lookup(const Param_header &phdr, uint16_t &ofs)
+{
+    if (_ofs_cache == nullptr) {
+        // nothing stored yet
+        ofs = _ofs_cache_sentinal;
+        sentinal_offset = ofs;
+        return false;
+    }
+    uint32_t header;
+    memcpy(&header, &phdr, sizeof(header));
+    for (uint16_t i = ofs_cache_hash(header) & _ofs_cache_mask; ; i = (i+1) & _ofs_cache_mask) {
+        const OffsetSlot &slot = _ofs_cache[i];
+        if (slot.header == header) {
+            ofs = slot.ofs;
+            return true;
+        }
+        if (slot.header == UINT32_MAX) {
+            ofs = _ofs_cache_sentinal;
+            sentinal_offset = ofs;
+            return false;
+        }
     }
 }
+#endif // AP_PARAM_SAVE_BATCH_ENABLED
 
 /*
   wait for all parameters to save
@@ -2343,6 +3078,9 @@ void AP_Param::send_parameter(const char *name, enum ap_var_type var_type, uint8
     }
     if (var_type != AP_PARAM_VECTOR3F) {
         // nice and simple for scalar types
+#if AP_PARAM_JOURNAL_ENABLED
+        journal_record(name, var_type, this);
+#endif
         GCS_SEND_PARAM(name, var_type, cast_to_float(var_type));
         return;
     }
@@ -2359,14 +3097,130 @@ void AP_Param::send_parameter(const char *name, enum ap_var_type var_type, uint8
     char &name_axis = name2[strlen(name)-1];
     
     name_axis = 'X';
+#if AP_PARAM_JOURNAL_ENABLED
+    journal_record(name2, AP_PARAM_FLOAT, &v.x);
+#endif
     GCS_SEND_PARAM(name2, AP_PARAM_FLOAT, v.x);
     name_axis = 'Y';
+#if AP_PARAM_JOURNAL_ENABLED
+    journal_record(name2, AP_PARAM_FLOAT, &v.y);
+#endif
     GCS_SEND_PARAM(name2, AP_PARAM_FLOAT, v.y);
     name_axis = 'Z';
+#if AP_PARAM_JOURNAL_ENABLED
+    journal_record(name2, AP_PARAM_FLOAT, &v.z);
+#endif
     GCS_SEND_PARAM(name2, AP_PARAM_FLOAT, v.z);
 #endif // HAL_NO_GCS
 }
 
+#if AP_PARAM_JOURNAL_ENABLED
+/*
+  extend a journal CRC with one parameter value
+ */
+uint32_t AP_Param::journal_crc(uint32_t crc, const char *name, enum ap_var_type type, const void *value)
+{
+    const uint8_t t = type;
+    crc = crc_crc32(crc, (const uint8_t *)name, strlen(name));
+    crc = crc_crc32(crc, &t, 1);
+    return crc_crc32(crc, (const uint8_t *)value, type_size(type));
+}
+
+void AP_Param::journal_start(void)
+{
+    WITH_SEMAPHORE(_journal_sem);
+    if (_journal != nullptr) {
+        return;
+    }
+    JournalEntry *journal = new JournalEntry[AP_PARAM_JOURNAL_SIZE];
+    if (journal == nullptr) {
+        return;
+    }
+    uint32_t crc = 0;
+    ParamToken token;
+    enum ap_var_type ptype;
+    char name[AP_MAX_NAME_SIZE+1];
+    for (AP_Param *ap = AP_Param::first(&token, &ptype);
+         ap;
+         ap = AP_Param::next_scalar(&token, &ptype)) {
+        ap->copy_name_token(token, name, sizeof(name), true);
+        crc = journal_crc(crc, name, ptype, ap);
+    }
+    _journal_base_crc = crc;
+    _journal_generation = 0;
+    _journal = journal;
+}
+
+/*
+  add a change to the journal. Changes made before anyone has asked for
+  the table are part of generation zero
+ */
+void AP_Param::journal_record(const char *name, enum ap_var_type type, const void *value)
+{
+    if (_journal == nullptr) {
+        return;
+    }
+    WITH_SEMAPHORE(_journal_sem);
+    const uint32_t gen = _journal_generation;
+    const uint32_t crc = gen == 0 ? _journal_base_crc : _journal[(gen-1) % AP_PARAM_JOURNAL_SIZE].crc;
+    // the entry for change number g is at index g-1
+    JournalEntry &e = _journal[gen % AP_PARAM_JOURNAL_SIZE];
+    strncpy(e.name, name, AP_MAX_NAME_SIZE);
+    e.name[AP_MAX_NAME_SIZE] = 0;
+    e.crc = journal_crc(crc, e.name, type, value);
+    _journal_generation = gen + 1;
+}
+
+void AP_Param::journal_get(uint32_t &generation, uint32_t &crc)
+{
+    journal_start();
+    WITH_SEMAPHORE(_journal_sem);
+    generation = _journal_generation;
+    if (_journal == nullptr || generation == 0) {
+        crc = _journal_base_crc;
+    } else {
+        crc = _journal[(generation-1) % AP_PARAM_JOURNAL_SIZE].crc;
+    }
+}
+
+bool AP_Param::journal_changes(uint32_t since, uint32_t crc,
+                               char names[][AP_MAX_NAME_SIZE+1], uint16_t &count)
+{
+    WITH_SEMAPHORE(_journal_sem);
+    const uint32_t gen = _journal_generation;
+    if (_journal == nullptr || since > gen) {
+        return false;
+    }
+    uint32_t since_crc;
+    if (since == 0) {
+        if (gen > AP_PARAM_JOURNAL_SIZE) {
+            return false;
+        }
+        since_crc = _journal_base_crc;
+    } else {
+        if (gen - since >= AP_PARAM_JOURNAL_SIZE) {
+            return false;
+        }
+        since_crc = _journal[(since-1) % AP_PARAM_JOURNAL_SIZE].crc;
+    }
+    if (since_crc != crc) {
+        return false;
+    }
+    count = 0;
+    for (uint32_t g=since+1; g<=gen; g++) {
+        const char *name = _journal[(g-1) % AP_PARAM_JOURNAL_SIZE].name;
+        bool listed = false;
+        for (uint16_t i=0; i<count && !listed; i++) {
+            listed = strcmp(names[i], name) == 0;
+        }
+        if (!listed) {
+            strcpy(names[count++], name);
+        }
+    }
+    return true;
+}
+#endif // AP_PARAM_JOURNAL_ENABLED
+
 /*
   return count of all scalar parameters.
   Note that this function may be called from the IO thread, so needs
@@ -2413,6 +3267,9 @@ void AP_Param::invalidate_count(void)
     // not-equal test is strong enough to ensure we get the right
     // answer
     _count_marker++;
+#if AP_PARAM_HASH_INDEX_ENABLED
+    _hash_index_dirty = true;
+#endif
 }
 
 /*
@@ -46,6 +46,56 @@
 #endif
 #endif
 
+/*
+  hash index for find() and find_by_name(). The table is sized from
+  the number of parameters, 6 bytes a slot at a load factor of at
+  most 2/3, so a full vehicle needs around 24k. Only boards with
+  500k or more of RAM use it; the rest keep the linear search
+ */
+#ifndef AP_PARAM_HASH_INDEX_ENABLED
+#define AP_PARAM_HASH_INDEX_ENABLED (BOARD_FLASH_SIZE > 1024 && HAL_MEM_CLASS >= HAL_MEM_CLASS_500)
+#endif
+
+#if AP_PARAM_HASH_INDEX_ENABLED
+// maximum number of slots in the hash index. If there are more
+// parameters than fit with a sensible load factor the index is not
+// used
+#ifndef AP_PARAM_HASH_INDEX_MAX_SLOTS
+#define AP_PARAM_HASH_INDEX_MAX_SLOTS 4096
+#endif
+#endif
+
+/*
+  batched parameter saving. The IO thread coalesces queued saves,
+  appending new variables to storage as one contiguous block, and
+  keeps a map of where each stored variable lives
+ */
+#ifndef AP_PARAM_SAVE_BATCH_ENABLED
+#define AP_PARAM_SAVE_BATCH_ENABLED (BOARD_FLASH_SIZE > 1024)
+#endif
+
+#if AP_PARAM_SAVE_BATCH_ENABLED
+// size of the buffer holding variables appended in one batch
+#ifndef AP_PARAM_SAVE_BATCH_BYTES
+#define AP_PARAM_SAVE_BATCH_BYTES 512
+#endif
+#endif
+
+/*
+  journal of recent parameter changes, so a GCS which already has the
+  parameter table can fetch only what changed since it last looked
+ */
+#ifndef AP_PARAM_JOURNAL_ENABLED
+#define AP_PARAM_JOURNAL_ENABLED (BOARD_FLASH_SIZE > 1024)
+#endif
+
+#if AP_PARAM_JOURNAL_ENABLED
+// number of changes remembered
+#ifndef AP_PARAM_JOURNAL_SIZE
+#define AP_PARAM_JOURNAL_SIZE 32
+#endif
+#endif
+
 /*
   flags for variables in var_info and group tables
  */
@@ -318,6 +368,28 @@ public:
     // by-name equivalent of find_by_index()
     static AP_Param* find_by_name(const char* name, enum ap_var_type *ptype, ParamToken *token);
 
+#if AP_PARAM_JOURNAL_ENABLED
+    /*
+      The change journal starts on first use. From then on every change
+      notified to the GCS advances the generation, and the CRC identifies
+      the parameter table at each generation: it is the CRC of the whole
+      table when the journal started, extended with each change
+     */
+    static void journal_start(void);
+
+    // get the current generation and CRC, starting the journal if needed
+    static void journal_get(uint32_t &generation, uint32_t &crc);
+
+    /*
+      get the names of the parameters changed since generation since,
+      each once, given the CRC reported for that generation. names must
+      have room for AP_PARAM_JOURNAL_SIZE names. Returns false if the
+      journal does not go back that far or the CRC does not match
+     */
+    static bool journal_changes(uint32_t since, uint32_t crc,
+                                char names[][AP_MAX_NAME_SIZE+1], uint16_t &count);
+#endif
+
     /// Find a variable by pointer
     ///
     ///
@@ -365,6 +437,15 @@ public:
     ///
     void save(bool force_save=false);
 
+    /// write out all queued saves. This normally runs on the IO thread
+    static void save_pending(void);
+
+#if AP_PARAM_SAVE_BATCH_ENABLED
+    /// number of writes made to parameter storage, letting tests check
+    /// how well saves are batched
+    static uint32_t storage_write_count(void) { return _storage_write_count; }
+#endif
+
     /// Load the variable from EEPROM.
     ///
     /// @return                True if the variable was loaded successfully.
@@ -634,6 +715,51 @@ private:
                                     ptrdiff_t group_offset,
                                     const struct GroupInfo *group_info,
                                     enum ap_var_type *ptype);
+    static AP_Param *           find_linear(const char *name, enum ap_var_type *ptype);
+#if AP_PARAM_HASH_INDEX_ENABLED
+    /*
+      open addressing hash table mapping every parameter name,
+      including hidden ones and Vector3f elements, to its token. It is
+      built on first use and rebuilt when the var_info tree changes
+     */
+    struct PACKED HashSlot {
+        uint32_t token;     // ParamToken, or UINT32_MAX if empty
+        uint16_t tag;       // top bits of the name hash
+    };
+    static HashSlot *           _hash_index;
+    static uint16_t             _hash_index_mask;
+    static uint16_t             _hash_index_count;
+    static bool                 _hash_index_dirty;
+    static uint32_t             _hash_index_build_ms;
+    static HAL_Semaphore        _hash_index_sem;
+
+    static uint32_t             hash_name(const char *name);
+    static void                 hash_index_build(void);
+    static void                 hash_index_add_group(
+                                    uint16_t vindex,
+                                    const struct GroupInfo *group_info,
+                                    uint32_t group_base,
+                                    uint8_t group_shift,
+                                    ptrdiff_t group_offset,
+                                    char *name,
+                                    uint8_t name_len);
+    static void                 hash_index_add(const char *name, uint16_t vindex,
+                                               uint32_t group_element, uint8_t type);
+    static void                 hash_index_insert(const char *name, const ParamToken &token);
+    static bool                 hash_index_name(ParamToken token, char *buf, size_t buf_size);
+    static AP_Param *           hash_index_find(const char *name, bool scalar_only,
+                                                enum ap_var_type *ptype, ParamToken &token,
+                                                bool &indexed);
+    static AP_Param *           find_by_token(ParamToken &token, enum ap_var_type *ptype, bool &hidden);
+    static AP_Param *           find_by_token_group(
+                                    ParamToken &token,
+                                    const struct GroupInfo *group_info,
+                                    uint32_t group_base,
+                                    uint8_t group_shift,
+                                    ptrdiff_t group_offset,
+                                    enum ap_var_type *ptype,
+                                    bool &hidden);
+#endif
     static void                 write_sentinal(uint16_t ofs);
     static uint16_t             get_key(const Param_header &phdr);
     static void                 set_key(Param_header &phdr, uint16_t key);
@@ -644,7 +770,73 @@ private:
     static void                 eeprom_write_check(
                                     const void *ptr,
                                     uint16_t ofs,
-                                    uint8_t size);
+                                    uint16_t size);
+
+    // what is needed to store a variable, from find_var_info()
+    struct save_info {
+        struct Param_header phdr;
+        const AP_Param *ap;         // start of the stored variable
+        uint8_t idx;
+        uint8_t size;
+        uint8_t info_type;
+        const float *def_value_ptr;
+        char name[AP_MAX_NAME_SIZE+1];
+    };
+    bool                        save_prepare(struct save_info &s) const;
+    bool                        save_skip_default(const struct save_info &s, bool force_save) const;
+
+#if AP_PARAM_SAVE_BATCH_ENABLED
+    /*
+      open addressing hash table from the header of each stored
+      variable to its offset in storage, letting scan() answer
+      without reading storage. Built on first use
+     */
+    struct PACKED OffsetSlot {
+        uint32_t header;    // Param_header, or UINT32_MAX if empty
+        uint16_t ofs;
+    };
+    static OffsetSlot *         _ofs_cache;
+    static uint32_t             _storage_write_count;
+    static uint16_t             _ofs_cache_mask;
+    static uint16_t             _ofs_cache_count;
+    static uint16_t             _ofs_cache_sentinal;
+    static bool                 _ofs_cache_valid;
+    static HAL_Semaphore        _ofs_cache_sem;
+
+    static bool                 ofs_cache_build(void);
+    static uint32_t             ofs_cache_max_slots(void);
+    static bool                 ofs_cache_insert(const Param_header &phdr, uint16_t ofs);
+    static bool                 ofs_cache_lookup(const Param_header &phdr, uint16_t &ofs);
+
+    // variables to be appended after the sentinal, as they will be
+    // laid out in storage
+    static uint8_t              _save_batch_buf[AP_PARAM_SAVE_BATCH_BYTES];
+    static uint16_t             _save_batch_len;
+    static bool                 save_batch_find(const Param_header &phdr, uint16_t &bofs);
+    static void                 save_batch_flush(uint16_t ofs);
+
+    // variables saved into the batch buffer, sent to the GCS once
+    // the batch is in storage. The smallest variable takes a header
+    // and one byte, and each is listed once
+    static const AP_Param *     _save_batch_notify[AP_PARAM_SAVE_BATCH_BYTES/(sizeof(Param_header)+1)];
+    static uint8_t              _save_batch_notify_count;
+    static void                 save_batch_notify_add(const AP_Param *ap);
+#endif
+#if AP_PARAM_JOURNAL_ENABLED
+    struct JournalEntry {
+        char name[AP_MAX_NAME_SIZE+1];
+        uint32_t crc;           // CRC of the table after this change
+    };
+    static JournalEntry *       _journal;
+    static uint32_t             _journal_generation;
+    static uint32_t             _journal_base_crc;
+    static HAL_Semaphore        _journal_sem;
+
+    static uint32_t             journal_crc(uint32_t crc, const char *name,
+                                            enum ap_var_type type, const void *value);
+    static void                 journal_record(const char *name, enum ap_var_type type,
+                                               const void *value);
+#endif
     static AP_Param *           next_group(
                                     const uint16_t vindex,
                                     const struct GroupInfo *group_info,
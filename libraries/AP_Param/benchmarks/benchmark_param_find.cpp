@@ -0,0 +1,76 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Param/AP_Param.h>
+#include <AP_Param/tests/param_test.h>
+
+/*
+  cost of looking up a parameter by name against its position in the
+  parameter tree. Without the hash index find() walks the tree, so the
+  cost grows with the number of parameters before the one looked up
+ */
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+static const uint16_t num_groups = 500;
+
+class BenchGroup {
+public:
+    AP_Float p1;
+    AP_Float p2;
+    AP_Int8 enable;
+    AP_Int16 p3;
+    static const struct AP_Param::GroupInfo var_info[];
+};
+
+const AP_Param::GroupInfo BenchGroup::var_info[] = {
+    AP_GROUPINFO_FLAGS("ENABLE", 0, BenchGroup, enable, 1, AP_PARAM_FLAG_ENABLE),
+    AP_GROUPINFO("P1", 1, BenchGroup, p1, 0),
+    AP_GROUPINFO("P2", 2, BenchGroup, p2, 0),
+    AP_GROUPINFO("P3", 3, BenchGroup, p3, 0),
+    AP_GROUPEND
+};
+
+static ParamTestTable<BenchGroup, num_groups> table;
+
+static void setup_params()
+{
+    if (!table.setup("G%03u_")) {
+        return;
+    }
+    for (uint16_t i=0; i<num_groups; i++) {
+        table.groups[i].enable.set(1);
+    }
+}
+
+static void BM_ParamFind(benchmark::State& state)
+{
+    char name[AP_MAX_NAME_SIZE+1];
+    snprintf(name, sizeof(name), "G%03u_P3", unsigned(state.range(0)));
+    enum ap_var_type ptype;
+    setup_params();
+
+    while (state.KeepRunning()) {
+        AP_Param *vp = AP_Param::find(name, &ptype);
+        gbenchmark_escape(vp);
+    }
+}
+
+static void BM_ParamFindByName(benchmark::State& state)
+{
+    char name[AP_MAX_NAME_SIZE+1];
+    snprintf(name, sizeof(name), "G%03u_P3", unsigned(state.range(0)));
+    enum ap_var_type ptype;
+    AP_Param::ParamToken token;
+    setup_params();
+
+    while (state.KeepRunning()) {
+        AP_Param *vp = AP_Param::find_by_name(name, &ptype, &token);
+        gbenchmark_escape(vp);
+    }
+}
+
+BENCHMARK(BM_ParamFind)->Arg(0)->Arg(10)->Arg(100)->Arg(num_groups-1);
+BENCHMARK(BM_ParamFindByName)->Arg(0)->Arg(10)->Arg(100)->Arg(num_groups-1);
+
+BENCHMARK_MAIN();
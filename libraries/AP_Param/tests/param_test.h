@@ -0,0 +1,44 @@
+#pragma once
+
+#include <AP_Param/AP_Param.h>
+
+#include <stdio.h>
+#include <vector>
+
+/*
+  parameter table for AP_Param tests and benchmarks: FORMAT_VERSION
+  followed by num_groups copies of a group class, each named from a
+  printf format taking the group number
+ */
+template <typename Group, uint16_t num_groups>
+class ParamTestTable {
+public:
+    // top level keys are 9 bits
+    static_assert(num_groups < 511, "too many groups");
+
+    Group groups[num_groups];
+
+    /*
+      give the table to AP_Param. Only the first call does anything,
+      and returns true so the caller can finish its own setup
+     */
+    bool setup(const char *name_format) {
+        if (param != nullptr) {
+            return false;
+        }
+        var_info.push_back({AP_PARAM_INT16, "FORMAT_VERSION", 0, &format_version, {def_value : 0}, 0});
+        for (uint16_t i=0; i<num_groups; i++) {
+            snprintf(group_names[i], sizeof(group_names[i]), name_format, unsigned(i));
+            var_info.push_back({AP_PARAM_GROUP, group_names[i], uint16_t(i+1), &groups[i], {group_info : Group::var_info}, 0});
+        }
+        var_info.push_back({AP_PARAM_NONE, "", 0, nullptr, {group_info : nullptr}, 0});
+        param = new AP_Param(var_info.data());
+        return true;
+    }
+
+private:
+    AP_Int16 format_version;
+    char group_names[num_groups][8];
+    std::vector<AP_Param::Info> var_info;
+    AP_Param *param = nullptr;
+};
@@ -0,0 +1,127 @@
+#include <AP_gtest.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_Param/AP_Param.h>
+#include <AP_Param/tests/param_test.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+#include <vector>
+
+/*
+  check that the change journal gives each parameter changed since a
+  generation once, and refuses generations it no longer covers
+ */
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+GCS_Dummy _gcs;
+
+#if AP_PARAM_JOURNAL_ENABLED
+
+static const uint16_t num_groups = 4;
+
+class JournalGroup {
+public:
+    AP_Float p1;
+    AP_Int16 p2;
+    AP_Vector3f v;
+    static const struct AP_Param::GroupInfo var_info[];
+};
+
+const AP_Param::GroupInfo JournalGroup::var_info[] = {
+    AP_GROUPINFO("P1", 1, JournalGroup, p1, 0),
+    AP_GROUPINFO("P2", 2, JournalGroup, p2, 0),
+    AP_GROUPINFO("V", 3, JournalGroup, v, 0),
+    AP_GROUPEND
+};
+
+static ParamTestTable<JournalGroup, num_groups> table;
+static JournalGroup *groups = table.groups;
+
+static void setup_params()
+{
+    if (!table.setup("J%u_")) {
+        return;
+    }
+    AP_Param::setup();
+    AP_Param::erase_all();
+}
+
+static bool changes(uint32_t since, uint32_t crc, std::vector<std::string> &names)
+{
+    char buf[AP_PARAM_JOURNAL_SIZE][AP_MAX_NAME_SIZE+1];
+    uint16_t count;
+    names.clear();
+    if (!AP_Param::journal_changes(since, crc, buf, count)) {
+        return false;
+    }
+    for (uint16_t i=0; i<count; i++) {
+        names.push_back(buf[i]);
+    }
+    return true;
+}
+
+TEST(AP_Param, JournalChanges)
+{
+    setup_params();
+    uint32_t gen, crc;
+    AP_Param::journal_get(gen, crc);
+
+    groups[0].p1.set_and_notify(1.5);
+    groups[1].v.set_and_notify(Vector3f(1, 2, 3));
+    groups[0].p1.set_and_notify(2.5);
+
+    uint32_t gen2, crc2;
+    AP_Param::journal_get(gen2, crc2);
+    EXPECT_EQ(gen + 5, gen2);
+    EXPECT_NE(crc, crc2);
+
+    std::vector<std::string> names;
+    EXPECT_TRUE(changes(gen, crc, names));
+    ASSERT_EQ(4U, names.size());
+    EXPECT_EQ("J0_P1", names[0]);
+    EXPECT_EQ("J1_V_X", names[1]);
+    EXPECT_EQ("J1_V_Y", names[2]);
+    EXPECT_EQ("J1_V_Z", names[3]);
+
+    // nothing changed since the latest generation
+    EXPECT_TRUE(changes(gen2, crc2, names));
+    EXPECT_EQ(0U, names.size());
+}
+
+TEST(AP_Param, JournalMismatch)
+{
+    setup_params();
+    uint32_t gen, crc;
+    AP_Param::journal_get(gen, crc);
+    groups[2].p2.set_and_notify(groups[2].p2 + 1);
+
+    std::vector<std::string> names;
+    EXPECT_FALSE(changes(gen, crc + 1, names));
+    EXPECT_FALSE(changes(gen + 2, crc, names));
+}
+
+TEST(AP_Param, JournalOverflow)
+{
+    setup_params();
+    uint32_t gen, crc;
+    AP_Param::journal_get(gen, crc);
+    for (uint16_t i=0; i<AP_PARAM_JOURNAL_SIZE; i++) {
+        groups[3].p2.set_and_notify(groups[3].p2 + 1);
+    }
+    std::vector<std::string> names;
+    EXPECT_FALSE(changes(gen, crc, names));
+
+    // a generation which is still covered is fine
+    uint32_t gen2, crc2;
+    AP_Param::journal_get(gen2, crc2);
+    groups[3].p1.set_and_notify(groups[3].p1 + 1);
+    EXPECT_TRUE(changes(gen2, crc2, names));
+    ASSERT_EQ(1U, names.size());
+    EXPECT_EQ("J3_P1", names[0]);
+}
+
+#endif // AP_PARAM_JOURNAL_ENABLED
+
+AP_GTEST_MAIN()
@@ -0,0 +1,153 @@
+#include <AP_gtest.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_Param/AP_Param.h>
+#include <AP_Param/tests/param_test.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+#include <vector>
+
+/*
+  save a full parameter set the way a GCS upload does, with the IO
+  thread emptying the save queue as it fills, and check that it loads
+  back and that the saves were batched
+ */
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+GCS_Dummy _gcs;
+
+static const uint16_t num_groups = 100;
+
+class SaveGroup {
+public:
+    AP_Float p1;
+    AP_Float p2;
+    AP_Int32 p3;
+    AP_Int16 p4;
+    AP_Vector3f v;
+    static const struct AP_Param::GroupInfo var_info[];
+};
+
+const AP_Param::GroupInfo SaveGroup::var_info[] = {
+    AP_GROUPINFO("P1", 1, SaveGroup, p1, 0),
+    AP_GROUPINFO("P2", 2, SaveGroup, p2, 0),
+    AP_GROUPINFO("P3", 3, SaveGroup, p3, 0),
+    AP_GROUPINFO("P4", 4, SaveGroup, p4, 0),
+    AP_GROUPINFO("V", 5, SaveGroup, v, 0),
+    AP_GROUPEND
+};
+
+static ParamTestTable<SaveGroup, num_groups> table;
+static SaveGroup *groups = table.groups;
+static std::vector<AP_Param *> params;
+
+static void setup_params()
+{
+    if (!table.setup("S%03u_")) {
+        return;
+    }
+    for (uint16_t i=0; i<num_groups; i++) {
+        params.push_back(&groups[i].p1);
+        params.push_back(&groups[i].p2);
+        params.push_back(&groups[i].p3);
+        params.push_back(&groups[i].p4);
+        params.push_back(&groups[i].v);
+    }
+    AP_Param::setup();
+    AP_Param::erase_all();
+}
+
+static void set_values(int32_t base)
+{
+    for (uint16_t i=0; i<num_groups; i++) {
+        groups[i].p1.set(base + i + 0.5f);
+        groups[i].p2.set(-(base + i));
+        groups[i].p3.set(base * 1000 + i);
+        groups[i].p4.set(base + i);
+        groups[i].v.set(Vector3f(base, i, -i));
+    }
+}
+
+static void check_values(int32_t base)
+{
+    for (uint16_t i=0; i<num_groups; i++) {
+        groups[i].p1.set(0);
+        groups[i].p2.set(0);
+        groups[i].p3.set(0);
+        groups[i].p4.set(0);
+        groups[i].v.set(Vector3f());
+    }
+    for (AP_Param *p : params) {
+        EXPECT_TRUE(p->load());
+    }
+    for (uint16_t i=0; i<num_groups; i++) {
+        EXPECT_FLOAT_EQ(base + i + 0.5f, groups[i].p1.get());
+        EXPECT_FLOAT_EQ(-(base + i), groups[i].p2.get());
+        EXPECT_EQ(base * 1000 + i, groups[i].p3.get());
+        EXPECT_EQ(base + i, groups[i].p4.get());
+        EXPECT_TRUE(groups[i].v.get() == Vector3f(base, i, -i));
+    }
+}
+
+// the save queue holds 30 entries
+static const uint16_t save_chunk = 25;
+
+// queue all parameters for saving, returning the number of writes
+// to storage
+static uint32_t save_all()
+{
+#if AP_PARAM_SAVE_BATCH_ENABLED
+    const uint32_t start = AP_Param::storage_write_count();
+#endif
+    uint16_t queued = 0;
+    for (AP_Param *p : params) {
+        p->save();
+        if (++queued == save_chunk) {
+            AP_Param::save_pending();
+            queued = 0;
+        }
+    }
+    AP_Param::save_pending();
+#if AP_PARAM_SAVE_BATCH_ENABLED
+    return AP_Param::storage_write_count() - start;
+#else
+    return 0;
+#endif
+}
+
+TEST(AP_Param, SaveNew)
+{
+    setup_params();
+    set_values(1);
+    const uint32_t writes = save_all();
+    check_values(1);
+#if AP_PARAM_SAVE_BATCH_ENABLED
+    // each chunk of new parameters is appended as one block, needing
+    // only the sentinal, data and header writes. Saving them one at a
+    // time takes three writes per parameter
+    const uint32_t chunks = (params.size() + save_chunk - 1) / save_chunk;
+    EXPECT_LE(writes, 3 * chunks);
+#else
+    (void)writes;
+#endif
+}
+
+TEST(AP_Param, SaveUpdate)
+{
+    setup_params();
+    set_values(1);
+    save_all();
+    set_values(2);
+    const uint32_t writes = save_all();
+    check_values(2);
+#if AP_PARAM_SAVE_BATCH_ENABLED
+    // stored parameters are updated in place with one write each
+    EXPECT_LE(writes, params.size());
+#else
+    (void)writes;
+#endif
+}
+
+AP_GTEST_MAIN()
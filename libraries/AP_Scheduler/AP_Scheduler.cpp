@@ -62,7 +62,7 @@ const AP_Param::GroupInfo AP_Scheduler::var_info[] = {
     // @Param: OPTIONS
     // @DisplayName: Scheduling options
     // @Description: This controls optional aspects of the scheduler.
-    // @Bitmask: 0:Enable per-task perf info
+    // @Bitmask: 0:Enable per-task perf info, 1:Earliest deadline first task selection
     // @User: Advanced
     AP_GROUPINFO("OPTIONS",  2, AP_Scheduler, _options, 0),
 
@@ -148,6 +148,153 @@ static void fill_nanf_stack(void)
 }
 #endif
 
+/*
+  return the interval in ticks between runs of a task
+ */
+uint32_t AP_Scheduler::task_interval_ticks(const Task &task) const
+{
+    // we allow 0 to mean loop rate
+    uint32_t interval_ticks = (is_zero(task.rate_hz) ? 1 : _loop_rate_hz / task.rate_hz);
+    if (interval_ticks < 1) {
+        interval_ticks = 1;
+    }
+    return interval_ticks;
+}
+
+/*
+  run task i if it is due and fits in the time available. Returns
+  false if the time available for this tick has been used up
+ */
+bool AP_Scheduler::run_task(uint8_t i, uint32_t run_started_usec, uint32_t &now, uint32_t &time_available)
+{
+    const AP_Scheduler::Task& task = get_task(i);
+
+    // both counters are 16 bit, so wrap the difference to 16 bits
+    const uint32_t dt = uint16_t(_tick_counter - _last_run[i]);
+    const uint32_t interval_ticks = task_interval_ticks(task);
+    if (dt < interval_ticks) {
+        // this task is not yet scheduled to run again
+        return true;
+    }
+    // this task is due to run. Do we have enough time to run it?
+    _task_time_allowed = task.max_time_micros;
+
+    if (dt >= interval_ticks*2) {
+        perf_info.task_slipped(i);
+    }
+
+    if (dt >= interval_ticks*max_task_slowdown) {
+        // we are going beyond the maximum slowdown factor for a
+        // task. This will trigger increasing the time budget
+        task_not_achieved++;
+    }
+
+    if (_task_time_allowed > time_available) {
+        // not enough time to run this task.  Continue loop -
+        // maybe another task will fit into time remaining
+        perf_info.task_deadline_missed(i);
+        return true;
+    }
+
+    // run it
+    _task_time_started = now;
+
+    // start time jitter is how late the task is starting
+    // relative to the start of the tick in which it was due
+    const uint32_t tick_start_us = _loop_sample_time_us ? _loop_sample_time_us : run_started_usec;
+    const uint32_t jitter_us = (dt - interval_ticks) * get_loop_period_us() + (now - tick_start_us);
+    hal.util->persistent_data.scheduler_task = i;
+    if (_debug > 1 && _perf_counters && _perf_counters[i]) {
+        hal.util->perf_begin(_perf_counters[i]);
+    }
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+    fill_nanf_stack();
+#endif
+    task.function();
+    if (_debug > 1 && _perf_counters && _perf_counters[i]) {
+        hal.util->perf_end(_perf_counters[i]);
+    }
+    hal.util->persistent_data.scheduler_task = -1;
+
+    // record the tick counter when we ran. This drives
+    // when we next run the event
+    _last_run[i] = _tick_counter;
+
+    // work out how long the event actually took
+    now = AP_HAL::micros();
+    uint32_t time_taken = now - _task_time_started;
+    bool overrun = false;
+    if (time_taken > _task_time_allowed) {
+        overrun = true;
+        // the event overran!
+        debug(3, "Scheduler overrun task[%u-%s] (%u/%u)\n",
+              (unsigned)i,
+              task.name,
+              (unsigned)time_taken,
+              (unsigned)_task_time_allowed);
+    }
+
+    perf_info.update_task_info(i, time_taken, overrun, jitter_us);
+
+    if (time_taken >= time_available) {
+        time_available = 0;
+        return false;
+    }
+    time_available -= time_taken;
+    return true;
+}
+
+/*
+  push a ready task onto the earliest-deadline-first heap. The key is
+  the number of ticks until the task slips a whole interval, with the
+  task table order breaking ties so table priority is preserved
+ */
+void AP_Scheduler::edf_push(uint8_t i, int32_t deadline)
+{
+    uint16_t n = _edf_heap_size++;
+    while (n > 0) {
+        const uint16_t parent = (n - 1) / 2;
+        const EDFEntry &p = _edf_heap[parent];
+        if (p.deadline < deadline || (p.deadline == deadline && p.task < i)) {
+            break;
+        }
+        _edf_heap[n] = p;
+        n = parent;
+    }
+    _edf_heap[n].deadline = deadline;
+    _edf_heap[n].task = i;
+}
+
+/*
+  pop the task with the earliest deadline from the heap
+ */
+uint8_t AP_Scheduler::edf_pop()
+{
+    const uint8_t ret = _edf_heap[0].task;
+    const EDFEntry last = _edf_heap[--_edf_heap_size];
+    uint16_t n = 0;
+    while (true) {
+        uint16_t child = 2*n + 1;
+        if (child >= _edf_heap_size) {
+            break;
+        }
+        if (child+1 < _edf_heap_size &&
+            (_edf_heap[child+1].deadline < _edf_heap[child].deadline ||
+             (_edf_heap[child+1].deadline == _edf_heap[child].deadline &&
+              _edf_heap[child+1].task < _edf_heap[child].task))) {
+            child++;
+        }
+        const EDFEntry &c = _edf_heap[child];
+        if (last.deadline < c.deadline || (last.deadline == c.deadline && last.task < c.task)) {
+            break;
+        }
+        _edf_heap[n] = c;
+        n = child;
+    }
+    _edf_heap[n] = last;
+    return ret;
+}
+
 /*
   run one tick
   this will run as many scheduler tasks as we can in the specified time
@@ -168,79 +315,40 @@ void AP_Scheduler::run(uint32_t time_available)
             }
         }
     }
-    
-    for (uint8_t i=0; i<_num_tasks; i++) {
-        const AP_Scheduler::Task& task = (i < _num_unshared_tasks) ? _tasks[i] : _common_tasks[i - _num_unshared_tasks];
 
-        uint32_t dt = _tick_counter - _last_run[i];
-        // we allow 0 to mean loop rate
-        uint32_t interval_ticks = (is_zero(task.rate_hz) ? 1 : _loop_rate_hz / task.rate_hz);
-        if (interval_ticks < 1) {
-            interval_ticks = 1;
-        }
-        if (dt < interval_ticks) {
-            // this task is not yet scheduled to run again
-            continue;
-        }
-        // this task is due to run. Do we have enough time to run it?
-        _task_time_allowed = task.max_time_micros;
-
-        if (dt >= interval_ticks*2) {
-            perf_info.task_slipped(i);
-        }
-
-        if (dt >= interval_ticks*max_task_slowdown) {
-            // we are going beyond the maximum slowdown factor for a
-            // task. This will trigger increasing the time budget
-            task_not_achieved++;
-        }
-
-        if (_task_time_allowed > time_available) {
-            // not enough time to run this task.  Continue loop -
-            // maybe another task will fit into time remaining
-            continue;
-        }
+    if ((_options & uint8_t(Options::EDF_SCHEDULING)) && _edf_heap == nullptr) {
+        _edf_heap = new EDFEntry[_num_tasks];
+    }
 
-        // run it
-        _task_time_started = now;
-        hal.util->persistent_data.scheduler_task = i;
-        if (_debug > 1 && _perf_counters && _perf_counters[i]) {
-            hal.util->perf_begin(_perf_counters[i]);
+    if ((_options & uint8_t(Options::EDF_SCHEDULING)) && _edf_heap != nullptr) {
+        // order the due tasks by deadline, then run as many as fit
+        // in the time available, skipping any that don't fit so the
+        // remaining slack can be used by smaller tasks
+        _edf_heap_size = 0;
+        for (uint8_t i=0; i<_num_tasks; i++) {
+            const uint32_t dt = uint16_t(_tick_counter - _last_run[i]);
+            const uint32_t interval_ticks = task_interval_ticks(get_task(i));
+            if (dt >= interval_ticks) {
+                edf_push(i, int32_t(interval_ticks*2) - int32_t(dt));
+            }
         }
-#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
-        fill_nanf_stack();
-#endif
-        task.function();
-        if (_debug > 1 && _perf_counters && _perf_counters[i]) {
-            hal.util->perf_end(_perf_counters[i]);
+        while (_edf_heap_size > 0) {
+            if (!run_task(edf_pop(), run_started_usec, now, time_available)) {
+                break;
+            }
         }
-        hal.util->persistent_data.scheduler_task = -1;
-
-        // record the tick counter when we ran. This drives
-        // when we next run the event
-        _last_run[i] = _tick_counter;
-
-        // work out how long the event actually took
-        now = AP_HAL::micros();
-        uint32_t time_taken = now - _task_time_started;
-        bool overrun = false;
-        if (time_taken > _task_time_allowed) {
-            overrun = true;
-            // the event overran!
-            debug(3, "Scheduler overrun task[%u-%s] (%u/%u)\n",
-                  (unsigned)i,
-                  task.name,
-                  (unsigned)time_taken,
-                  (unsigned)_task_time_allowed);
+        // tasks left in the heap were due but there was no time
+        // left in this tick to run them
+        for (uint16_t n=0; n<_edf_heap_size; n++) {
+            perf_info.task_deadline_missed(_edf_heap[n].task);
         }
-
-        perf_info.update_task_info(i, time_taken, overrun);
-
-        if (time_taken >= time_available) {
-            time_available = 0;
-            break;
+        _edf_heap_size = 0;
+    } else {
+        for (uint8_t i=0; i<_num_tasks; i++) {
+            if (!run_task(i, run_started_usec, now, time_available)) {
+                break;
+            }
         }
-        time_available -= time_taken;
     }
 
     // update number of spare microseconds
@@ -288,7 +396,8 @@ void AP_Scheduler::loop()
     hal.util->persistent_data.scheduler_task = -1;
 
     const uint32_t sample_time_us = AP_HAL::micros();
-    
+    _loop_sample_time_us = sample_time_us;
+
     if (_loop_timer_start_us == 0) {
         _loop_timer_start_us = sample_time_us;
         _last_loop_time_s = get_loop_period_s();
@@ -376,6 +485,7 @@ void AP_Scheduler::update_logging()
     if (_log_performance_bit != (uint32_t)-1 &&
         AP::logger().should_log(_log_performance_bit)) {
         Log_Write_Performance();
+        Log_Write_Task_Stats();
     }
     perf_info.set_loop_rate(get_loop_rate_hz());
     perf_info.reset();
@@ -410,11 +520,43 @@ void AP_Scheduler::Log_Write_Performance()
     AP::logger().WriteCriticalBlock(&pkt, sizeof(pkt));
 }
 
+// Write per-task runtime percentiles and start jitter, one message
+// per task, when per-task perf info is being recorded
+void AP_Scheduler::Log_Write_Task_Stats()
+{
+    if (!perf_info.has_task_info()) {
+        return;
+    }
+    const uint64_t now = AP_HAL::micros64();
+    for (uint8_t i = 0; i < _num_tasks + 1; i++) {
+        const AP::PerfInfo::TaskInfo* ti = perf_info.get_task_info(i);
+        if (ti == nullptr || ti->tick_count == 0) {
+            continue;
+        }
+        const struct log_Task_Stats pkt = {
+            LOG_PACKET_HEADER_INIT(LOG_TASK_STATS_MSG),
+            time_us     : now,
+            task        : i,
+            count       : uint16_t(MIN(ti->tick_count, UINT16_MAX)),
+            p50         : ti->percentile_us(0.5f),
+            p99         : ti->percentile_us(0.99f),
+            p999        : ti->percentile_us(0.999f),
+            max_time    : ti->max_time_us,
+            avg_jitter  : ti->avg_jitter_us(),
+            max_jitter  : ti->max_jitter_us,
+            overruns    : ti->overrun_count,
+            slips       : ti->slip_count,
+            misses      : ti->deadline_miss_count,
+        };
+        AP::logger().WriteBlock(&pkt, sizeof(pkt));
+    }
+}
+
 // display task statistics as text buffer for @SYS/tasks.txt
 void AP_Scheduler::task_info(ExpandingString &str)
 {
     // a header to allow for machine parsers to determine format
-    str.printf("TasksV1\n");
+    str.printf("TasksV2\n");
 
     // dynamically enable statistics collection
     if (!(_options & uint8_t(Options::RECORD_TASK_INFO))) {
@@ -447,13 +589,17 @@ void AP_Scheduler::task_info(ExpandingString &str)
         }
 
 #if HAL_MINIMIZE_FEATURES
-        const char* fmt = "%-16.16s MIN=%3u MAX=%3u AVG=%3u OVR=%3u SLP=%3u, TOT=%4.1f%%\n";
+        const char* fmt = "%-16.16s MIN=%3u MAX=%3u AVG=%3u OVR=%3u SLP=%3u, TOT=%4.1f%% P50=%3u P99=%3u P999=%3u JIT=%4u JMX=%4u MISS=%3u\n";
 #else
-        const char* fmt = "%-32.32s MIN=%3u MAX=%3u AVG=%3u OVR=%3u SLP=%3u, TOT=%4.1f%%\n";
+        const char* fmt = "%-32.32s MIN=%3u MAX=%3u AVG=%3u OVR=%3u SLP=%3u, TOT=%4.1f%% P50=%3u P99=%3u P999=%3u JIT=%4u JMX=%4u MISS=%3u\n";
 #endif
         str.printf(fmt, task_name,
                    unsigned(MIN(ti->min_time_us, 999)), unsigned(MIN(ti->max_time_us, 999)), unsigned(avg),
-                   unsigned(MIN(ti->overrun_count, 999)), unsigned(MIN(ti->slip_count, 999)), pct);
+                   unsigned(MIN(ti->overrun_count, 999)), unsigned(MIN(ti->slip_count, 999)), pct,
+                   unsigned(MIN(ti->percentile_us(0.5f), 999)), unsigned(MIN(ti->percentile_us(0.99f), 999)),
+                   unsigned(MIN(ti->percentile_us(0.999f), 999)),
+                   unsigned(MIN(ti->avg_jitter_us(), 9999)), unsigned(MIN(ti->max_jitter_us, 9999)),
+                   unsigned(MIN(ti->deadline_miss_count, 999)));
     }
 }
 
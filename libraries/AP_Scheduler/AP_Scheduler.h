@@ -80,7 +80,8 @@ public:
     };
 
     enum class Options : uint8_t {
-        RECORD_TASK_INFO = 1 << 0
+        RECORD_TASK_INFO = 1 << 0,
+        EDF_SCHEDULING   = 1 << 1,
     };
 
     // initialise scheduler
@@ -96,6 +97,9 @@ public:
     // write out PERF message to logger
     void Log_Write_Performance();
 
+    // write out per-task latency statistics to logger
+    void Log_Write_Task_Stats();
+
     // call when one tick has passed
     void tick(void);
 
@@ -204,6 +208,14 @@ private:
     // tick counter at the time we last ran each task
     uint16_t *_last_run;
 
+    // heap of due tasks ordered by deadline, used when
+    // earliest-deadline-first scheduling is enabled
+    struct EDFEntry {
+        int32_t deadline;
+        uint8_t task;
+    } *_edf_heap;
+    uint8_t _edf_heap_size;
+
     // number of microseconds allowed for the current task
     uint32_t _task_time_allowed;
 
@@ -219,6 +231,10 @@ private:
     // start of loop timing
     uint32_t _loop_timer_start_us;
 
+    // time of the INS sample which started the current tick. Task
+    // start jitter is measured relative to this
+    uint32_t _loop_sample_time_us;
+
     // time of last loop in seconds
     float _last_loop_time_s;
     
@@ -244,6 +260,15 @@ private:
 
     // semaphore that is held while not waiting for ins samples
     HAL_Semaphore _rsem;
+
+    // return a task by its index across _tasks and _common_tasks
+    const Task &get_task(uint8_t i) const {
+        return (i < _num_unshared_tasks) ? _tasks[i] : _common_tasks[i - _num_unshared_tasks];
+    }
+    uint32_t task_interval_ticks(const Task &task) const;
+    bool run_task(uint8_t i, uint32_t run_started_usec, uint32_t &now, uint32_t &time_available);
+    void edf_push(uint8_t i, int32_t deadline);
+    uint8_t edf_pop();
 };
 
 namespace AP {
@@ -53,7 +53,7 @@ void AP::PerfInfo::free_task_info()
 }
 
 // called after each run of a task to update its statistics based on measurements taken by the scheduler
-void AP::PerfInfo::update_task_info(uint8_t task_index, uint16_t task_time_us, bool overrun)
+void AP::PerfInfo::update_task_info(uint8_t task_index, uint16_t task_time_us, bool overrun, uint32_t jitter_us)
 {
     if (_task_info == nullptr) {
         return;
@@ -75,6 +75,42 @@ void AP::PerfInfo::update_task_info(uint8_t task_index, uint16_t task_time_us, b
     if (overrun) {
         ti.overrun_count++;
     }
+
+    ti.max_jitter_us = MAX(ti.max_jitter_us, MIN(jitter_us, UINT16_MAX));
+    ti.elapsed_jitter_us += jitter_us;
+
+    // bucket is the index of the most significant set bit
+    uint8_t bucket = 0;
+    for (uint16_t t = task_time_us >> 1; t != 0 && bucket < TASK_HIST_BUCKETS-1; t >>= 1) {
+        bucket++;
+    }
+    if (ti.hist[bucket] < UINT16_MAX) {
+        ti.hist[bucket]++;
+    }
+}
+
+// estimate a runtime percentile from the log2 histogram. The result
+// is the upper edge of the bucket containing the percentile, limited
+// to the largest runtime seen, so it never under-reports the tail
+uint16_t AP::PerfInfo::TaskInfo::percentile_us(float fraction) const
+{
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < TASK_HIST_BUCKETS; i++) {
+        total += hist[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    const uint32_t target = MAX(1U, uint32_t(ceilf(total * fraction)));
+    uint32_t count = 0;
+    for (uint8_t i = 0; i < TASK_HIST_BUCKETS; i++) {
+        count += hist[i];
+        if (count >= target) {
+            const uint32_t upper = (2U << i) - 1;
+            return MIN(upper, max_time_us);
+        }
+    }
+    return max_time_us;
 }
 
 // check_loop_time - check latest loop time vs min, max and overtime threshold
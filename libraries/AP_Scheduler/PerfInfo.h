@@ -8,6 +8,12 @@ class PerfInfo {
 public:
     PerfInfo() {}
 
+    // number of log2-scaled buckets in the per-task runtime
+    // histogram. Bucket n counts runs taking [2^n, 2^(n+1)) us, with
+    // bucket 0 also holding runs of under 1us and the last bucket
+    // holding everything longer
+    static const uint8_t TASK_HIST_BUCKETS = 16;
+
     // per-task timing information
     struct TaskInfo {
         uint16_t min_time_us;
@@ -16,6 +22,22 @@ public:
         uint32_t tick_count;
         uint16_t slip_count;
         uint16_t overrun_count;
+        // number of times the task was due but was deferred to a
+        // later tick because it did not fit in the time available
+        uint16_t deadline_miss_count;
+        // start time jitter relative to the nominal slot of the task
+        uint16_t max_jitter_us;
+        uint32_t elapsed_jitter_us;
+        // runtime histogram
+        uint16_t hist[TASK_HIST_BUCKETS];
+
+        // return the runtime below which the given fraction of runs
+        // completed, estimated from the histogram
+        uint16_t percentile_us(float fraction) const;
+        // average start time jitter
+        uint16_t avg_jitter_us() const {
+            return tick_count ? elapsed_jitter_us / tick_count : 0;
+        }
     };
 
     /* Do not allow copies */
@@ -46,11 +68,17 @@ public:
         return (_task_info && task_index <= _num_tasks) ? &_task_info[task_index] : nullptr;
     }
     // called after each run of a task to update its statistics based on measurements taken by the scheduler
-    void update_task_info(uint8_t task_index, uint16_t task_time_us, bool overrun);
+    void update_task_info(uint8_t task_index, uint16_t task_time_us, bool overrun, uint32_t jitter_us=0);
     // record that a task slipped
     void task_slipped(uint8_t task_index) {
         if (_task_info && task_index <= _num_tasks) {
-            _task_info[task_index].overrun_count++;
+            _task_info[task_index].slip_count++;
+        }
+    }
+    // record that a due task could not be run in this tick
+    void task_deadline_missed(uint8_t task_index) {
+        if (_task_info && task_index <= _num_tasks) {
+            _task_info[task_index].deadline_miss_count++;
         }
     }
 
@@ -53,7 +53,17 @@ const AP_Param::GroupInfo AP_Terrain::var_info[] = {
     // @Bitmask: 0:Disable Download
     // @User: Advanced
     AP_GROUPINFO("OPTIONS",   2, AP_Terrain, options, 0),
-    
+
+#if AP_TERRAIN_LARGE_CACHE_ENABLED
+    // @Param: CACHE_SZ
+    // @DisplayName: Terrain cache size
+    // @Description: The number of terrain grid blocks kept in memory. Each block takes about 2 kilobytes and covers 28 by 32 grid points. A larger cache allows fast vehicles to load terrain data from the SD card well ahead of their position.
+    // @Range: 2 512
+    // @RebootRequired: True
+    // @User: Advanced
+    AP_GROUPINFO("CACHE_SZ",  3, AP_Terrain, config_cache_size, TERRAIN_GRID_BLOCK_CACHE_SIZE),
+#endif
+
     AP_GROUPEND
 };
 
@@ -328,6 +338,11 @@ void AP_Terrain::update(void)
     // check for pending rally data
     update_rally_data();
 
+#if AP_TERRAIN_LARGE_CACHE_ENABLED
+    // queue reads of blocks along our path
+    update_prefetch();
+#endif
+
     // update capabilities and status
     if (allocate()) {
         if (!pos_valid) {
@@ -390,13 +405,36 @@ bool AP_Terrain::allocate(void)
     if (cache != nullptr) {
         return true;
     }
-    cache = (struct grid_cache *)calloc(TERRAIN_GRID_BLOCK_CACHE_SIZE, sizeof(cache[0]));
+#if AP_TERRAIN_LARGE_CACHE_ENABLED
+    const uint16_t size = constrain_int16(config_cache_size, 2, TERRAIN_GRID_BLOCK_CACHE_MAX);
+    uint16_t hash_size = 1;
+    while (hash_size < size) {
+        hash_size <<= 1;
+    }
+    cache_hash = (uint16_t *)malloc(hash_size * sizeof(cache_hash[0]));
+    if (cache_hash == nullptr) {
+        gcs().send_text(MAV_SEVERITY_CRITICAL, "Terrain: Allocation failed");
+        memory_alloc_failed = true;
+        return false;
+    }
+    memset(cache_hash, 0xFF, hash_size * sizeof(cache_hash[0]));
+    cache_hash_mask = hash_size - 1;
+#else
+    const uint16_t size = TERRAIN_GRID_BLOCK_CACHE_SIZE;
+#endif
+    cache = (struct grid_cache *)calloc(size, sizeof(cache[0]));
     if (cache == nullptr) {
         gcs().send_text(MAV_SEVERITY_CRITICAL, "Terrain: Allocation failed");
         memory_alloc_failed = true;
         return false;
     }
-    cache_size = TERRAIN_GRID_BLOCK_CACHE_SIZE;
+#if AP_TERRAIN_LARGE_CACHE_ENABLED
+    for (uint16_t i=0; i<size; i++) {
+        cache[i].hash_bucket = UINT16_MAX;
+        cache[i].hash_next = UINT16_MAX;
+    }
+#endif
+    cache_size = size;
     return true;
 }
 
@@ -54,6 +54,24 @@
 // number of grid_blocks in the LRU memory cache
 #define TERRAIN_GRID_BLOCK_CACHE_SIZE 12
 
+// boards with plenty of memory can have a larger, configurable cache
+// with hashed lookup, and prefetch blocks ahead of the vehicle
+#ifndef AP_TERRAIN_LARGE_CACHE_ENABLED
+#define AP_TERRAIN_LARGE_CACHE_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#endif
+
+// largest allowed TERRAIN_CACHE_SZ, in grid_blocks
+#define TERRAIN_GRID_BLOCK_CACHE_MAX 512
+
+// how far ahead of the vehicle to prefetch, in seconds of flight
+#define TERRAIN_PREFETCH_TIME_S 60
+
+// number of upcoming mission legs to prefetch along
+#define TERRAIN_PREFETCH_MISSION_LEGS 3
+
+// most blocks queued by one prefetch pass, once a second
+#define TERRAIN_PREFETCH_MAX_BLOCKS 4
+
 // format of grid on disk
 #define TERRAIN_GRID_FORMAT_VERSION 1
 
@@ -255,6 +273,13 @@ private:
 
         // the last time access was requested to this block, used for LRU
         uint32_t last_access_ms;
+
+#if AP_TERRAIN_LARGE_CACHE_ENABLED
+        // hash bucket this block is in and the next block in the same
+        // bucket, UINT16_MAX for none
+        uint16_t hash_bucket;
+        uint16_t hash_next;
+#endif
     };
 
     /*
@@ -294,6 +319,23 @@ private:
     */
     struct grid_cache &find_grid_cache(const struct grid_info &info);
 
+#if AP_TERRAIN_LARGE_CACHE_ENABLED
+    /*
+      hashed lookup of grid_cache entries
+     */
+    uint16_t grid_hash(const struct grid_info &info) const;
+    int16_t hash_find(const struct grid_info &info) const;
+    void hash_insert(uint16_t idx, const struct grid_info &info);
+    void hash_remove(uint16_t idx);
+
+    /*
+      queue disk reads for blocks the vehicle is heading towards
+     */
+    void update_prefetch(void);
+    bool prefetch(const Location &loc);
+    uint16_t prefetch_line(const Location &from, const Location &to, uint16_t max_blocks);
+#endif
+
     /*
       calculate bit number in grid_block bitmap. This corresponds to a
       bit representing a 4x4 mavlink transmitted block
@@ -351,6 +393,9 @@ private:
     AP_Int8  enable;
     AP_Int16 grid_spacing; // meters between grid points
     AP_Int16 options; // option bits
+#if AP_TERRAIN_LARGE_CACHE_ENABLED
+    AP_Int16 config_cache_size;
+#endif
 
     enum class Options {
         DisableDownload = (1U<<0),
@@ -361,9 +406,18 @@ private:
     const AP_Mission &mission;
 
     // cache of grids in memory, LRU
-    uint8_t cache_size = 0;
+    uint16_t cache_size = 0;
     struct grid_cache *cache = nullptr;
 
+#if AP_TERRAIN_LARGE_CACHE_ENABLED
+    // heads of the hash chains into cache, UINT16_MAX for empty
+    uint16_t *cache_hash = nullptr;
+    uint16_t cache_hash_mask;
+
+    // last time we queued prefetch reads
+    uint32_t last_prefetch_ms;
+#endif
+
     // a grid_cache block waiting for disk IO
     enum DiskIoState {
         DiskIoIdle      = 0,
@@ -94,6 +94,9 @@ void AP_Terrain::schedule_disk_io(void)
             cache[cache_idx].last_access_ms = AP_HAL::millis();
         }
         disk_io_state = DiskIoIdle;
+        // start on the next read straight away, so a queue of
+        // prefetched blocks doesn't wait for our next call
+        check_disk_read();
         break;
     }
 
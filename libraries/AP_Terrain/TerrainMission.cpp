@@ -24,6 +24,7 @@
 #include <GCS_MAVLink/GCS.h>
 #include "AP_Terrain.h"
 #include <AP_GPS/AP_GPS.h>
+#include <AP_AHRS/AP_AHRS.h>
 
 #if AP_TERRAIN_AVAILABLE
 
@@ -164,4 +165,124 @@ void AP_Terrain::update_rally_data(void)
     }
 }
 
+#if AP_TERRAIN_LARGE_CACHE_ENABLED
+/*
+  queue a disk read of the block holding loc if it isn't already in
+  the cache. Returns true if a new block was queued
+ */
+bool AP_Terrain::prefetch(const Location &loc)
+{
+    struct grid_info info;
+    calculate_grid_info(loc, info);
+    if (hash_find(info) != -1) {
+        return false;
+    }
+    // find_grid_cache() replaces the oldest block. Don't let it throw
+    // away one that is in use or waiting for disk IO
+    uint16_t oldest_i = 0;
+    for (uint16_t i=1; i<cache_size; i++) {
+        if (cache[i].last_access_ms < cache[oldest_i].last_access_ms) {
+            oldest_i = i;
+        }
+    }
+    const struct grid_cache &oldest = cache[oldest_i];
+    if (oldest.state == GRID_CACHE_DISKWAIT ||
+        oldest.state == GRID_CACHE_DIRTY ||
+        (oldest.state != GRID_CACHE_INVALID && AP_HAL::millis() - oldest.last_access_ms < 5000)) {
+        return false;
+    }
+    find_grid_cache(info);
+    return true;
+}
+
+/*
+  prefetch blocks along a line, returning the number queued
+ */
+uint16_t AP_Terrain::prefetch_line(const Location &from, const Location &to, uint16_t max_blocks)
+{
+    // sample at half the smallest block dimension so no block along
+    // the line is skipped
+    const float step = 0.5f * TERRAIN_GRID_BLOCK_SPACING_X * grid_spacing;
+    const float distance = from.get_distance(to);
+    const float bearing = from.get_bearing_to(to) * 0.01f;
+    uint16_t count = 0;
+    Location loc = from;
+    for (float d = step; d < distance + step && count < max_blocks; d += step) {
+        if (d >= distance) {
+            loc = to;
+        } else {
+            loc.offset_bearing(bearing, step);
+        }
+        if (prefetch(loc)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+/*
+  queue disk reads for the blocks we will need soon, so a fast vehicle
+  isn't left waiting on the SD card. We look ahead along the current
+  velocity vector and along the upcoming legs of a running mission.
+  Prefetch shares the request budget of the mission and rally checks:
+  it waits until they are done and every block already asked for has
+  arrived, then queues a few more
+ */
+void AP_Terrain::update_prefetch(void)
+{
+    const uint32_t now = AP_HAL::millis();
+    if (now - last_prefetch_ms < 1000 || grid_spacing <= 0) {
+        return;
+    }
+    last_prefetch_ms = now;
+
+    if (next_mission_index != 0 || next_rally_index != 0) {
+        return;
+    }
+    uint16_t pending, loaded;
+    get_statistics(pending, loaded);
+    if (pending) {
+        return;
+    }
+
+    const AP_AHRS &ahrs = AP::ahrs();
+    Location loc;
+    if (!ahrs.get_position(loc)) {
+        return;
+    }
+
+    uint16_t budget = MIN(cache_size / 2, TERRAIN_PREFETCH_MAX_BLOCKS);
+
+    Vector3f vel;
+    if (ahrs.get_velocity_NED(vel)) {
+        const float speed = norm(vel.x, vel.y);
+        if (speed > 1) {
+            Location ahead = loc;
+            ahead.offset(vel.x * TERRAIN_PREFETCH_TIME_S, vel.y * TERRAIN_PREFETCH_TIME_S);
+            budget -= prefetch_line(loc, ahead, budget);
+        }
+    }
+
+    if (mission.state() != AP_Mission::MISSION_RUNNING) {
+        return;
+    }
+    // follow the stored mission order; jumps are not taken
+    Location from = loc;
+    uint16_t index = mission.get_current_nav_index();
+    for (uint8_t legs=0; legs<TERRAIN_PREFETCH_MISSION_LEGS && budget > 0; index++) {
+        AP_Mission::Mission_Command cmd;
+        if (!mission.read_cmd_from_storage(index, cmd)) {
+            break;
+        }
+        if (!AP_Mission::is_nav_cmd(cmd) ||
+            (cmd.content.location.lat == 0 && cmd.content.location.lng == 0)) {
+            continue;
+        }
+        budget -= prefetch_line(from, cmd.content.location, budget);
+        from = cmd.content.location;
+        legs++;
+    }
+}
+#endif // AP_TERRAIN_LARGE_CACHE_ENABLED
+
 #endif // AP_TERRAIN_AVAILABLE
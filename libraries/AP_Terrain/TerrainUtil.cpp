@@ -111,6 +111,19 @@ AP_Terrain::grid_cache &AP_Terrain::find_grid_cache(const struct grid_info &info
 {
     uint16_t oldest_i = 0;
 
+#if AP_TERRAIN_LARGE_CACHE_ENABLED
+    const int16_t idx = hash_find(info);
+    if (idx != -1) {
+        cache[idx].last_access_ms = AP_HAL::millis();
+        return cache[idx];
+    }
+    for (uint16_t i=1; i<cache_size; i++) {
+        if (cache[i].last_access_ms < cache[oldest_i].last_access_ms) {
+            oldest_i = i;
+        }
+    }
+    hash_remove(oldest_i);
+#else
     // see if we have that grid
     for (uint16_t i=0; i<cache_size; i++) {
         if (TERRAIN_LATLON_EQUAL(cache[i].grid.lat,info.grid_lat) &&
@@ -123,6 +136,7 @@ AP_Terrain::grid_cache &AP_Terrain::find_grid_cache(const struct grid_info &info
             oldest_i = i;
         }
     }
+#endif
 
     // Not found. Use the oldest grid and make it this grid,
     // initially unpopulated
@@ -142,9 +156,73 @@ AP_Terrain::grid_cache &AP_Terrain::find_grid_cache(const struct grid_info &info
     // mark as waiting for disk read
     grid.state = GRID_CACHE_DISKWAIT;
 
+#if AP_TERRAIN_LARGE_CACHE_ENABLED
+    hash_insert(oldest_i, info);
+#endif
+
     return grid;
 }
 
+#if AP_TERRAIN_LARGE_CACHE_ENABLED
+/*
+  hash of the block indices in a grid_info. The block lat/lon can't be
+  used as blocks read from disk may have corners a little different to
+  the ones we calculate
+ */
+uint16_t AP_Terrain::grid_hash(const struct grid_info &info) const
+{
+    uint32_t h = info.grid_idx_x;
+    h = h * 31U + info.grid_idx_y;
+    h = h * 31U + uint8_t(info.lat_degrees);
+    h = h * 31U + uint16_t(info.lon_degrees);
+    h ^= h >> 16;
+    h *= 0x45d9f3bU;
+    h ^= h >> 16;
+    return h & cache_hash_mask;
+}
+
+/*
+  find the cache index of a grid_info, or -1 if not in the cache
+ */
+int16_t AP_Terrain::hash_find(const struct grid_info &info) const
+{
+    for (uint16_t i = cache_hash[grid_hash(info)]; i != UINT16_MAX; i = cache[i].hash_next) {
+        if (TERRAIN_LATLON_EQUAL(cache[i].grid.lat,info.grid_lat) &&
+            TERRAIN_LATLON_EQUAL(cache[i].grid.lon,info.grid_lon) &&
+            cache[i].grid.spacing == grid_spacing) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void AP_Terrain::hash_insert(uint16_t idx, const struct grid_info &info)
+{
+    const uint16_t bucket = grid_hash(info);
+    cache[idx].hash_bucket = bucket;
+    cache[idx].hash_next = cache_hash[bucket];
+    cache_hash[bucket] = idx;
+}
+
+void AP_Terrain::hash_remove(uint16_t idx)
+{
+    const uint16_t bucket = cache[idx].hash_bucket;
+    if (bucket == UINT16_MAX) {
+        return;
+    }
+    uint16_t *p = &cache_hash[bucket];
+    while (*p != UINT16_MAX) {
+        if (*p == idx) {
+            *p = cache[idx].hash_next;
+            break;
+        }
+        p = &cache[*p].hash_next;
+    }
+    cache[idx].hash_bucket = UINT16_MAX;
+    cache[idx].hash_next = UINT16_MAX;
+}
+#endif // AP_TERRAIN_LARGE_CACHE_ENABLED
+
 /*
   find cache index of disk_block
  */
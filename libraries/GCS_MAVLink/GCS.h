@@ -9,6 +9,8 @@
 #include <AP_Mission/AP_Mission.h>
 #include <stdint.h>
 #include "MAVLink_routing.h"
+#include "GCS_StreamScheduler.h"
+#include "GCS_CompactState.h"
 #include <AP_Frsky_Telem/AP_Frsky_Telem.h>
 #include <AP_AdvancedFailsafe/AP_AdvancedFailsafe.h>
 #include <AP_RTC/JitterCorrection.h>
@@ -74,6 +76,12 @@ void gcs_out_of_space_to_send_count(mavlink_channel_t chan);
 #define MAV_STREAM_TERMINATOR { (streams)0, nullptr, 0 }
 
 #define GCS_MAVLINK_NUM_STREAM_RATES 10
+
+// number of files which may be open over MAVLink FTP at once
+#ifndef HAL_GCS_FTP_MAX_SESSIONS
+#define HAL_GCS_FTP_MAX_SESSIONS 4
+#endif
+
 class GCS_MAVLINK_Parameters
 {
 public:
@@ -84,6 +92,23 @@ public:
 
     // saveable rate of each stream
     AP_Int16        streamRates[GCS_MAVLINK_NUM_STREAM_RATES];
+
+#if HAL_GCS_STREAM_SCHEDULER_ENABLED
+    enum class SchedulerMode : uint8_t {
+        INTERVAL = 0,   // fixed interval buckets
+        ADAPTIVE = 1,   // GCS_StreamScheduler
+    };
+    AP_Int8         sched_mode;
+    AP_Int8         sched_util;     // target link utilisation in percent for the adaptive scheduler
+#endif
+
+    // number of mission items requested at once during an upload
+    AP_Int8         mission_window;
+
+#if HAL_GCS_COMPACT_STATE_ENABLED
+    // bitmask of GCS_CompactState::Field sent in the compact state stream
+    AP_Int32        cstate_fields;
+#endif
 };
 
 ///
@@ -335,6 +360,9 @@ public:
 
     virtual uint64_t capabilities() const;
     uint16_t get_stream_slowdown_ms() const { return stream_slowdown_ms; }
+
+    // number of mission items which may be requested at once on this link
+    uint8_t get_mission_window() const { return MAX(_parameters.mission_window.get(), 1); }
     uint8_t get_last_txbuf() const { return last_txbuf; }
 
     MAV_RESULT set_message_interval(uint32_t msg_id, int32_t interval_us);
@@ -369,6 +397,8 @@ protected:
     // saveable rate of each stream
     AP_Int16        *streamRates;
 
+    const GCS_MAVLINK_Parameters &_parameters;
+
     virtual bool persist_streamrates() const { return false; }
     void handle_request_data_stream(const mavlink_message_t &msg);
 
@@ -576,6 +606,11 @@ private:
     // last reported radio buffer percent available
     uint8_t          last_txbuf = 100;
 
+    // receive helpers for update_receive()
+    bool alternative_protocol_active(uint32_t now_ms) const;
+    bool parse_char(uint8_t c, mavlink_message_t &msg, mavlink_status_t &status, uint32_t now_ms);
+    void handle_received_packet(const mavlink_status_t &status, const mavlink_message_t &msg, uint32_t now_ms);
+
     // perf counters
     AP_HAL::Util::perf_counter_t _perf_packet;
     AP_HAL::Util::perf_counter_t _perf_update;
@@ -658,6 +693,21 @@ private:
     // the interval specified in "deferred"
     uint16_t get_reschedule_interval_ms(const deferred_message_bucket_t &deferred) const;
 
+#if HAL_GCS_STREAM_SCHEDULER_ENABLED
+    // bandwidth aware scheduling of stream-rated messages, used in
+    // place of the buckets when SRn_SCHED is adaptive
+    GCS_StreamScheduler stream_scheduler;
+    bool stream_scheduler_ok;
+    uint32_t stream_scheduler_tx_bytes;
+    bool using_stream_scheduler() const { return stream_scheduler_ok; }
+    void log_stream_scheduler_stats();
+#endif
+
+#if HAL_GCS_COMPACT_STATE_ENABLED
+    GCS_CompactState compact_state;
+    void send_compact_state();
+#endif
+
     bool do_try_send_message(const ap_message id);
 
     // time when we missed sending a parameter for GCS
@@ -756,14 +806,37 @@ private:
         Write,
     };
 
+    // a session is an open file, identified by the client's system
+    // and component ids and its session number
+    struct ftp_session {
+        int fd = -1;
+        FTP_FILE_MODE mode; // work around AP_Filesystem not supporting file modes
+        uint8_t id;
+        uint8_t sysid;
+        uint8_t compid;
+        mavlink_channel_t chan;
+        uint32_t last_activity_ms;
+
+        // burst read in progress
+        bool bursting;
+        uint8_t burst_size;         // bytes per reply
+        uint16_t burst_seq;         // seq_number of the next reply
+        uint32_t burst_offset;      // file offset of the next reply
+        uint32_t burst_end;         // end of the window the client asked for
+        uint32_t burst_request_offset; // offset of the client's last burst request
+
+        // read-ahead buffer, nullptr if not used for this file
+        uint8_t *readahead;
+        uint32_t readahead_ofs;
+        uint16_t readahead_len;
+    };
+
     struct ftp_state {
         ObjectBuffer<pending_ftp> *requests;
         ObjectBuffer<pending_ftp> *replies;
 
-        // session specific info, currently only support a single session over all links
-        int fd = -1;
-        FTP_FILE_MODE mode; // work around AP_Filesystem not supporting file modes
-        int16_t current_session;
+        struct ftp_session sessions[HAL_GCS_FTP_MAX_SESSIONS];
+        uint8_t next_burst;         // session whose burst continues next
         uint32_t last_send_ms;
         uint8_t need_banner_send_mask;
     };
@@ -772,11 +845,18 @@ private:
     static void ftp_error(struct pending_ftp &response, FTP_ERROR error); // FTP helper method for packing a NAK
     static int gen_dir_entry(char *dest, size_t space, const char * path, const struct dirent * entry); // FTP helper for emitting a dir response
     static void ftp_list_dir(struct pending_ftp &request, struct pending_ftp &response);
+    static struct ftp_session *ftp_find_session(const struct pending_ftp &request);
+    static struct ftp_session *ftp_open_session(const struct pending_ftp &request, struct pending_ftp &reply,
+                                                const char *path, int flags, FTP_FILE_MODE mode);
+    static void ftp_close_session(struct ftp_session &session);
+    static ssize_t ftp_read(struct ftp_session &session, uint32_t offset, uint8_t *buf, uint8_t len);
 
     bool ftp_init(void);
     void handle_file_transfer_protocol(const mavlink_message_t &msg);
     void send_ftp_replies(void);
     void ftp_worker(void);
+    void ftp_handle_request(struct pending_ftp &request, struct pending_ftp &reply);
+    bool ftp_burst_send(void);
     void ftp_push_replies(pending_ftp &reply);
 
     void send_distance_sensor(const class AP_RangeFinder_Backend *sensor, const uint8_t instance) const;
@@ -90,6 +90,7 @@ GCS *GCS::_singleton = nullptr;
 
 GCS_MAVLINK::GCS_MAVLINK(GCS_MAVLINK_Parameters &parameters,
                          AP_HAL::UARTDriver &uart)
+    : _parameters(parameters)
 {
     _port = &uart;
 
@@ -139,7 +140,15 @@ bool GCS_MAVLINK::init(uint8_t instance)
     _port->set_flow_control(old_flow_control);
 
     // now change back to desired baudrate
-    _port->begin(serial_manager.find_baudrate(protocol, instance));
+    const uint32_t baudrate = serial_manager.find_baudrate(protocol, instance);
+    _port->begin(baudrate);
+
+#if HAL_GCS_STREAM_SCHEDULER_ENABLED
+    if (_parameters.sched_mode == (int8_t)GCS_MAVLINK_Parameters::SchedulerMode::ADAPTIVE) {
+        // falls back to the interval buckets if we can't allocate
+        stream_scheduler_ok = stream_scheduler.init(baudrate, AP_HAL::millis());
+    }
+#endif
 
     mavlink_comm_port[chan] = _port;
 
@@ -653,6 +662,13 @@ void GCS_MAVLINK::handle_radio_status(const mavlink_message_t &msg, bool log_rad
 
     last_txbuf = packet.txbuf;
 
+#if HAL_GCS_STREAM_SCHEDULER_ENABLED
+    if (using_stream_scheduler() && packet.txbuf < 50) {
+        // the radio can't keep up with what we're giving it
+        stream_scheduler.remote_backlog();
+    }
+#endif
+
     // use the state of the transmit buffer in the radio to
     // control the stream rate, giving us adaptive software
     // flow control
@@ -826,6 +842,14 @@ ap_message GCS_MAVLINK::mavlink_id_to_ap_message_id(const uint32_t mavlink_id) c
         { MAVLINK_MSG_ID_WINCH_STATUS,          MSG_WINCH_STATUS},
             };
 
+#if HAL_GCS_COMPACT_STATE_ENABLED
+    // DATA96 is a general container, so it only means the compact
+    // state stream on links where SRn_CSTATE has turned it on
+    if (mavlink_id == MAVLINK_MSG_ID_DATA96 && _parameters.cstate_fields != 0) {
+        return MSG_COMPACT_STATE;
+    }
+#endif
+
     for (uint8_t i=0; i<ARRAY_SIZE(map); i++) {
         if (map[i].mavlink_id == mavlink_id) {
             return map[i].msg_id;
@@ -1076,6 +1100,16 @@ void GCS_MAVLINK::update_send()
 
     const uint32_t start = AP_HAL::millis();
     const uint16_t start16 = start & 0xFFFF;
+
+#if HAL_GCS_STREAM_SCHEDULER_ENABLED
+    if (using_stream_scheduler()) {
+        stream_scheduler.update(start,
+                                mavlink_comm_tx_bytes[chan] - stream_scheduler_tx_bytes,
+                                _port->txspace(),
+                                _parameters.sched_util);
+        stream_scheduler_tx_bytes = mavlink_comm_tx_bytes[chan];
+    }
+#endif
     while (AP_HAL::millis() - start < 5) { // spend a max of 5ms sending messages.  This should never trigger - out_of_time() should become true
         if (gcs().out_of_time()) {
 #if GCS_DEBUG_SEND_MESSAGE_TIMINGS
@@ -1136,6 +1170,29 @@ void GCS_MAVLINK::update_send()
             continue;
         }
 
+#if HAL_GCS_STREAM_SCHEDULER_ENABLED
+        if (using_stream_scheduler()) {
+            ap_message next;
+            if (!stream_scheduler.next_message(start, next)) {
+                break;
+            }
+            const uint32_t tx_bytes = mavlink_comm_tx_bytes[chan];
+            if (!do_try_send_message(next)) {
+                break;
+            }
+            stream_scheduler.message_sent(next, start, mavlink_comm_tx_bytes[chan] - tx_bytes);
+#if GCS_DEBUG_SEND_MESSAGE_TIMINGS
+            const uint32_t stop = AP_HAL::micros();
+            const uint32_t delta = stop - retry_deferred_body_start;
+            if (delta > try_send_message_stats.max_retry_deferred_body_us) {
+                try_send_message_stats.max_retry_deferred_body_us = delta;
+                try_send_message_stats.max_retry_deferred_body_type = 3;
+            }
+#endif
+            continue;
+        }
+#endif
+
         ap_message next = next_deferred_bucket_message_to_send(start16);
         if (next != no_message_to_send) {
             if (!do_try_send_message(next)) {
@@ -1239,6 +1296,12 @@ bool GCS_MAVLINK::set_ap_message_interval(enum ap_message id, uint16_t interval_
         return true;
     }
 
+#if HAL_GCS_STREAM_SCHEDULER_ENABLED
+    // the buckets are still maintained as they are used to report
+    // message intervals
+    stream_scheduler.set_interval(id, interval_ms, AP_HAL::millis());
+#endif
+
     // see which bucket has the closest interval:
     int8_t closest_bucket = -1;
     uint16_t closest_bucket_interval_delta = UINT16_MAX;
@@ -1369,6 +1432,63 @@ void GCS_MAVLINK::packetReceived(const mavlink_status_t &status,
     handleMessage(msg);
 }
 
+// time without a packet before switching between MAVLink and an
+// alternative protocol
+static const uint32_t alternative_protocol_timeout_ms = 4000;
+
+/*
+  true if we have an alternative protocol handler installed and we
+  haven't parsed a MAVLink packet for 4 seconds, so bytes should be
+  offered to the alternative handler
+ */
+bool GCS_MAVLINK::alternative_protocol_active(uint32_t now_ms) const
+{
+    return alternative.handler &&
+        now_ms - alternative.last_mavlink_ms > alternative_protocol_timeout_ms;
+}
+
+// process a packet from either parser
+void GCS_MAVLINK::handle_received_packet(const mavlink_status_t &status, const mavlink_message_t &msg, uint32_t now_ms)
+{
+    hal.util->persistent_data.last_mavlink_msgid = msg.msgid;
+    hal.util->perf_begin(_perf_packet);
+    packetReceived(status, msg);
+    hal.util->perf_end(_perf_packet);
+    gcs_alternative_active[chan] = false;
+    alternative.last_mavlink_ms = now_ms;
+    hal.util->persistent_data.last_mavlink_msgid = 0;
+}
+
+/*
+  parse one byte, giving it to the alternative protocol handler if
+  there is one and MAVLink has gone quiet. Returns true if a MAVLink
+  packet was completed and handled
+ */
+bool GCS_MAVLINK::parse_char(uint8_t c, mavlink_message_t &msg, mavlink_status_t &status, uint32_t now_ms)
+{
+    if (alternative_protocol_active(now_ms)) {
+        if (alternative.handler(c, mavlink_comm_port[chan])) {
+            alternative.last_alternate_ms = now_ms;
+            gcs_alternative_active[chan] = true;
+        }
+
+        /*
+          we may also try parsing as MAVLink if we haven't had a
+          successful parse on the alternative protocol for 4s
+         */
+        if (now_ms - alternative.last_alternate_ms <= alternative_protocol_timeout_ms) {
+            return false;
+        }
+    }
+
+    // Try to get a new message
+    if (mavlink_parse_char(chan, c, &msg, &status)) {
+        handle_received_packet(status, msg, now_ms);
+        return true;
+    }
+    return false;
+}
+
 void
 GCS_MAVLINK::update_receive(uint32_t max_time_us)
 {
@@ -1387,48 +1507,54 @@ GCS_MAVLINK::update_receive(uint32_t max_time_us)
 
     status.packet_rx_drop_count = 0;
 
-    const uint16_t nbytes = _port->available();
-    for (uint16_t i=0; i<nbytes; i++)
-    {
-        const uint8_t c = (uint8_t)_port->read();
-        const uint32_t protocol_timeout = 4000;
-        
-        if (alternative.handler &&
-            now_ms - alternative.last_mavlink_ms > protocol_timeout) {
-            /*
-              we have an alternative protocol handler installed and we
-              haven't parsed a MAVLink packet for 4 seconds. Try
-              parsing using alternative handler
-             */
-            if (alternative.handler(c, mavlink_comm_port[chan])) {
-                alternative.last_alternate_ms = now_ms;
-                gcs_alternative_active[chan] = true;
-            }
-            
-            /*
-              we may also try parsing as MAVLink if we haven't had a
-              successful parse on the alternative protocol for 4s
-             */
-            if (now_ms - alternative.last_alternate_ms <= protocol_timeout) {
-                continue;
+    /*
+      whole frames are read from the port and parsed as a block when
+      the parser is idle; bytes for an alternative protocol, partial
+      frames and anything mavlink_parse_frame() rejects go through the
+      byte parser, which gives the same result for the same bytes
+     */
+    uint32_t nbytes = _port->available();
+    uint16_t count = 0;
+    while (nbytes > 0) {
+        uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+        int16_t c = _port->read();
+        if (c < 0) {
+            break;
+        }
+        buf[0] = c;
+        uint16_t len = 1;
+        nbytes--;
+
+        MAVLinkFrame result = MAVLinkFrame::FALLBACK;
+        uint16_t frame_len = 0;
+        if (!alternative_protocol_active(now_ms)) {
+            while ((result = mavlink_parse_frame(chan, buf, len, frame_len, msg, status)) == MAVLinkFrame::INCOMPLETE &&
+                   nbytes >= uint32_t(frame_len - len)) {
+                const ssize_t n = _port->read(&buf[len], frame_len - len);
+                if (n <= 0) {
+                    result = MAVLinkFrame::FALLBACK;
+                    break;
+                }
+                len += n;
+                nbytes -= n;
             }
         }
 
         bool parsed_packet = false;
-
-        // Try to get a new message
-        if (mavlink_parse_char(chan, c, &msg, &status)) {
-            hal.util->persistent_data.last_mavlink_msgid = msg.msgid;
-            hal.util->perf_begin(_perf_packet);
-            packetReceived(status, msg);
-            hal.util->perf_end(_perf_packet);
+        if (result == MAVLinkFrame::OK) {
+            handle_received_packet(status, msg, now_ms);
             parsed_packet = true;
-            gcs_alternative_active[chan] = false;
-            alternative.last_mavlink_ms = now_ms;
-            hal.util->persistent_data.last_mavlink_msgid = 0;
+        } else {
+            for (uint16_t i=0; i<len; i++) {
+                if (parse_char(buf[i], msg, status, now_ms)) {
+                    parsed_packet = true;
+                }
+            }
         }
 
-        if (parsed_packet || i % 100 == 0) {
+        const uint16_t old_count = count;
+        count += len;
+        if (parsed_packet || old_count / 100 != count / 100) {
             // make sure we don't spend too much time parsing mavlink messages
             if (AP_HAL::micros() - tstart_us > max_time_us) {
                 break;
@@ -1580,7 +1706,43 @@ void GCS_MAVLINK::log_mavlink_stats()
     };
 
     AP::logger().WriteBlock(&pkt, sizeof(pkt));
+
+#if HAL_GCS_STREAM_SCHEDULER_ENABLED
+    log_stream_scheduler_stats();
+#endif
+}
+
+#if HAL_GCS_STREAM_SCHEDULER_ENABLED
+/*
+  record requested and achieved rate of each message sent by the
+  adaptive stream scheduler
+*/
+void GCS_MAVLINK::log_stream_scheduler_stats()
+{
+    if (!using_stream_scheduler()) {
+        return;
+    }
+    const uint64_t now_us = AP_HAL::micros64();
+    for (uint8_t i=0; i<MSG_LAST; i++) {
+        GCS_StreamScheduler::MessageStats stats;
+        if (!stream_scheduler.get_stats((ap_message)i, stats)) {
+            continue;
+        }
+        const struct log_MAV_Rate pkt{
+            LOG_PACKET_HEADER_INIT(LOG_MAV_RATE_MSG),
+            time_us      : now_us,
+            chan         : (uint8_t)chan,
+            id           : i,
+            requested_hz : stats.requested_hz,
+            achieved_hz  : stats.achieved_hz,
+            sent         : stats.sent,
+            stale        : stats.stale,
+            link_rate    : stream_scheduler.link_rate(),
+        };
+        AP::logger().WriteBlock(&pkt, sizeof(pkt));
+    }
 }
+#endif
 
 /*
   send the SYSTEM_TIME message
@@ -2995,9 +3157,17 @@ void GCS_MAVLINK::handle_set_gps_global_origin(const mavlink_message_t &msg)
  */
 void GCS_MAVLINK::handle_data_packet(const mavlink_message_t &msg)
 {
-#if HAL_RCINPUT_WITH_AP_RADIO
+#if HAL_RCINPUT_WITH_AP_RADIO || HAL_GCS_COMPACT_STATE_ENABLED
     mavlink_data96_t m;
     mavlink_msg_data96_decode(&msg, &m);
+#if HAL_GCS_COMPACT_STATE_ENABLED
+    if (GCS_CompactState::is_compact_state(m.type, m.data, MIN(m.len, sizeof(m.data)))) {
+        // the compact state stream is output only, and its frames
+        // are not for any other user of DATA96
+        return;
+    }
+#endif
+#if HAL_RCINPUT_WITH_AP_RADIO
     switch (m.type) {
     case 42:
     case 43: {
@@ -3012,6 +3182,7 @@ void GCS_MAVLINK::handle_data_packet(const mavlink_message_t &msg)
         // unknown
         break;
     }
+#endif // HAL_RCINPUT_WITH_AP_RADIO
 #endif
 }
 
@@ -4428,6 +4599,28 @@ void GCS_MAVLINK::send_extended_sys_state() const
     mavlink_msg_extended_sys_state_send(chan, vtol_state(), landed_state());
 }
 
+#if HAL_GCS_COMPACT_STATE_ENABLED
+/*
+  send the fields selected by SRn_CSTATE as one compact frame, or the
+  schema describing them when it is due
+ */
+void GCS_MAVLINK::send_compact_state()
+{
+    const uint32_t mask = uint32_t(_parameters.cstate_fields.get());
+    if (mask == 0) {
+        return;
+    }
+    uint8_t data[GCS_CompactState::MAX_LEN] {};
+    if (compact_state.schema_due(mask, AP_HAL::millis())) {
+        const uint8_t len = compact_state.pack_schema(mask, data);
+        mavlink_msg_data96_send(chan, GCS_CompactState::DATA96_TYPE_SCHEMA, len, data);
+        return;
+    }
+    const uint8_t len = compact_state.pack_frame(mask, data);
+    mavlink_msg_data96_send(chan, GCS_CompactState::DATA96_TYPE_FRAME, len, data);
+}
+#endif
+
 void GCS_MAVLINK::send_attitude() const
 {
     const AP_AHRS &ahrs = AP::ahrs();
@@ -4887,6 +5080,13 @@ bool GCS_MAVLINK::try_send_message(const enum ap_message id)
         send_winch_status();
         break;
 
+    case MSG_COMPACT_STATE:
+#if HAL_GCS_COMPACT_STATE_ENABLED
+        CHECK_PAYLOAD_SIZE(DATA96);
+        send_compact_state();
+#endif
+        break;
+
     default:
         // try_send_message must always at some stage return true for
         // a message, or we will attempt to infinitely retry the
@@ -0,0 +1,278 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GCS_CompactState.h"
+
+#if HAL_GCS_COMPACT_STATE_ENABLED
+
+#include <AP_AHRS/AP_AHRS.h>
+#include <AP_InertialSensor/AP_InertialSensor.h>
+
+// the schema is repeated this often so a late listener can decode
+#define COMPACT_STATE_SCHEMA_INTERVAL_MS 5000
+
+static const struct {
+    GCS_CompactState::ElementType type;
+    uint8_t count;
+} field_layout[] = {
+    { GCS_CompactState::ElementType::FLOAT, 3 }, // ATTITUDE
+    { GCS_CompactState::ElementType::FLOAT, 3 }, // BODY_RATE
+    { GCS_CompactState::ElementType::FLOAT, 4 }, // QUATERNION
+    { GCS_CompactState::ElementType::FLOAT, 3 }, // ACCEL
+    { GCS_CompactState::ElementType::FLOAT, 3 }, // GYRO
+    { GCS_CompactState::ElementType::FLOAT, 3 }, // POSITION_NED
+    { GCS_CompactState::ElementType::FLOAT, 3 }, // VELOCITY_NED
+    { GCS_CompactState::ElementType::INT32, 3 }, // LOCATION
+    { GCS_CompactState::ElementType::FLOAT, 5 }, // EKF_VARIANCES
+    { GCS_CompactState::ElementType::FLOAT, 3 }, // WIND
+};
+static_assert(ARRAY_SIZE(field_layout) == uint8_t(GCS_CompactState::Field::NUM_FIELDS), "field_layout must match Field");
+
+bool GCS_CompactState::schema_due(uint32_t mask, uint32_t now_ms)
+{
+    if (mask != last_mask) {
+        last_mask = mask;
+        schema_id++;
+    } else if (now_ms - last_schema_ms < COMPACT_STATE_SCHEMA_INTERVAL_MS) {
+        return false;
+    }
+    last_schema_ms = now_ms;
+    return true;
+}
+
+uint8_t GCS_CompactState::encode_schema(uint8_t schema_id, uint32_t mask, uint8_t data[MAX_LEN])
+{
+    SchemaHeader hdr {};
+    hdr.magic = MAGIC;
+    hdr.version = VERSION;
+    hdr.schema_id = schema_id;
+    hdr.header_len = sizeof(FrameHeader);
+
+    uint8_t len = sizeof(hdr);
+    uint8_t ofs = sizeof(FrameHeader);
+    for (uint8_t i=0; i<ARRAY_SIZE(field_layout); i++) {
+        const uint8_t size = field_layout[i].count * 4;
+        if (!(mask & (1U<<i)) || ofs + size > MAX_LEN) {
+            continue;
+        }
+        SchemaEntry entry;
+        entry.field = i;
+        entry.offset = ofs;
+        entry.type = uint8_t(field_layout[i].type);
+        entry.count = field_layout[i].count;
+        memcpy(&data[len], &entry, sizeof(entry));
+        len += sizeof(entry);
+        ofs += size;
+        hdr.num_fields++;
+    }
+    memcpy(data, &hdr, sizeof(hdr));
+    return len;
+}
+
+uint8_t GCS_CompactState::pack_frame(uint32_t mask, uint8_t data[MAX_LEN])
+{
+    Values values {};
+    for (uint8_t i=0; i<ARRAY_SIZE(field_layout); i++) {
+        if (!(mask & (1U<<i))) {
+            continue;
+        }
+        bool valid;
+        if (field_layout[i].type == ElementType::INT32) {
+            int32_t v[MAX_ELEMENTS] {};
+            valid = get_location(v);
+            for (uint8_t j=0; j<MAX_ELEMENTS; j++) {
+                values.field[i][j].i = v[j];
+            }
+        } else {
+            float v[MAX_ELEMENTS] {};
+            valid = get_field(Field(i), v);
+            for (uint8_t j=0; j<MAX_ELEMENTS; j++) {
+                values.field[i][j].f = v[j];
+            }
+        }
+        if (valid) {
+            values.valid |= (1U<<i);
+        }
+    }
+    return encode_frame(schema_id, seq++, AP_HAL::micros(), mask, values, data);
+}
+
+uint8_t GCS_CompactState::encode_frame(uint8_t schema_id, uint16_t seq, uint32_t time_us,
+                                       uint32_t mask, const Values &values, uint8_t data[MAX_LEN])
+{
+    FrameHeader hdr {};
+    hdr.magic = MAGIC;
+    hdr.version = VERSION;
+    hdr.schema_id = schema_id;
+    hdr.seq = seq;
+    hdr.time_us = time_us;
+
+    uint8_t len = sizeof(hdr);
+    for (uint8_t i=0; i<ARRAY_SIZE(field_layout); i++) {
+        const uint8_t size = field_layout[i].count * 4;
+        if (!(mask & (1U<<i)) || len + size > MAX_LEN) {
+            continue;
+        }
+        memcpy(&data[len], values.field[i], size);
+        if (values.valid & (1U<<i)) {
+            hdr.valid |= (1U<<i);
+        }
+        len += size;
+    }
+    memcpy(data, &hdr, sizeof(hdr));
+    return len;
+}
+
+bool GCS_CompactState::decode_schema(uint8_t type, const uint8_t *data, uint8_t len, Layout &layout)
+{
+    SchemaHeader hdr;
+    if (type != DATA96_TYPE_SCHEMA || !is_compact_state(type, data, len) ||
+        len < sizeof(hdr)) {
+        return false;
+    }
+    memcpy(&hdr, data, sizeof(hdr));
+    if (hdr.header_len != sizeof(FrameHeader) ||
+        hdr.num_fields > ARRAY_SIZE(layout.entries) ||
+        len < sizeof(hdr) + hdr.num_fields * sizeof(SchemaEntry)) {
+        return false;
+    }
+    layout.schema_id = hdr.schema_id;
+    layout.num_fields = hdr.num_fields;
+    for (uint8_t n=0; n<hdr.num_fields; n++) {
+        SchemaEntry entry;
+        memcpy(&entry, &data[sizeof(hdr) + n*sizeof(entry)], sizeof(entry));
+        if (entry.field >= ARRAY_SIZE(field_layout) ||
+            entry.count > MAX_ELEMENTS ||
+            entry.offset + entry.count*4U > MAX_LEN) {
+            return false;
+        }
+        layout.entries[n].field = entry.field;
+        layout.entries[n].offset = entry.offset;
+        layout.entries[n].type = entry.type;
+        layout.entries[n].count = entry.count;
+    }
+    return true;
+}
+
+bool GCS_CompactState::decode_frame(uint8_t type, const uint8_t *data, uint8_t len, const Layout &layout,
+                                    uint16_t &seq, uint32_t &time_us, Values &values)
+{
+    FrameHeader hdr;
+    if (type != DATA96_TYPE_FRAME || !is_compact_state(type, data, len) ||
+        len < sizeof(hdr)) {
+        return false;
+    }
+    memcpy(&hdr, data, sizeof(hdr));
+    if (hdr.schema_id != layout.schema_id) {
+        // the frame is from a layout we don't have yet
+        return false;
+    }
+    seq = hdr.seq;
+    time_us = hdr.time_us;
+    values.valid = 0;
+    for (uint8_t n=0; n<layout.num_fields; n++) {
+        const auto &e = layout.entries[n];
+        if (e.offset + e.count*4U > len) {
+            return false;
+        }
+        memcpy(values.field[e.field], &data[e.offset], e.count*4U);
+        values.valid |= hdr.valid & (1U<<e.field);
+    }
+    return true;
+}
+
+bool GCS_CompactState::get_field(Field field, float *values) const
+{
+    const AP_AHRS &ahrs = AP::ahrs();
+    Vector3f v;
+
+    switch (field) {
+    case Field::ATTITUDE:
+        values[0] = ahrs.roll;
+        values[1] = ahrs.pitch;
+        values[2] = ahrs.yaw;
+        return true;
+
+    case Field::BODY_RATE:
+        v = ahrs.get_gyro();
+        break;
+
+    case Field::QUATERNION: {
+        Quaternion q;
+        ahrs.get_quat_body_to_ned(q);
+        values[0] = q.q1;
+        values[1] = q.q2;
+        values[2] = q.q3;
+        values[3] = q.q4;
+        return true;
+    }
+
+    case Field::ACCEL:
+        v = AP::ins().get_accel();
+        break;
+
+    case Field::GYRO:
+        v = AP::ins().get_gyro();
+        break;
+
+    case Field::POSITION_NED:
+        if (!ahrs.get_relative_position_NED_origin(v)) {
+            return false;
+        }
+        break;
+
+    case Field::VELOCITY_NED:
+        if (!ahrs.get_velocity_NED(v)) {
+            return false;
+        }
+        break;
+
+    case Field::EKF_VARIANCES: {
+        Vector3f mag_var;
+        if (!ahrs.get_variances(values[0], values[1], values[2], mag_var, values[4])) {
+            return false;
+        }
+        values[3] = mag_var.length();
+        return true;
+    }
+
+    case Field::WIND:
+        v = ahrs.wind_estimate();
+        break;
+
+    case Field::LOCATION:
+    case Field::NUM_FIELDS:
+        return false;
+    }
+
+    values[0] = v.x;
+    values[1] = v.y;
+    values[2] = v.z;
+    return true;
+}
+
+bool GCS_CompactState::get_location(int32_t *values) const
+{
+    Location loc;
+    if (!AP::ahrs().get_position(loc)) {
+        return false;
+    }
+    values[0] = loc.lat;
+    values[1] = loc.lng;
+    values[2] = loc.alt;
+    return true;
+}
+
+#endif // HAL_GCS_COMPACT_STATE_ENABLED
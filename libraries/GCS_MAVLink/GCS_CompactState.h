@@ -0,0 +1,167 @@
+/// @file	GCS_CompactState.h
+/// @brief	compact fixed-layout state stream for companion computers
+#pragma once
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/AP_Common.h>
+
+#ifndef HAL_GCS_COMPACT_STATE_ENABLED
+#define HAL_GCS_COMPACT_STATE_ENABLED (BOARD_FLASH_SIZE > 1024)
+#endif
+
+#if HAL_GCS_COMPACT_STATE_ENABLED
+
+/*
+  Compact state stream. The fields selected by SRn_CSTATE are packed
+  into the data of one DATA96 message per tick, behind a single
+  header and timestamp, instead of being spread across ATTITUDE,
+  LOCAL_POSITION_NED, HIGHRES_IMU and friends. The rate is set by
+  requesting DATA96 with MAV_CMD_SET_MESSAGE_INTERVAL; DATA96 only
+  selects this stream on links where SRn_CSTATE is non-zero.
+
+  Other users of DATA96 pick their own types, so both kinds of
+  message start with a magic byte which the decoder checks along
+  with the type.
+
+  A frame is DATA96 type 200. All values are little-endian:
+    uint8_t  magic      0xC5
+    uint8_t  version
+    uint8_t  schema_id
+    uint16_t seq
+    uint16_t valid      bit n set if field n holds a current value
+    uint32_t time_us    AP_HAL::micros() when the frame was packed
+  followed by the fields in order of their number.
+
+  The layout is described by a schema, DATA96 type 201, sent when the
+  field selection changes and every few seconds after:
+    uint8_t  magic      0xC5
+    uint8_t  version
+    uint8_t  schema_id
+    uint8_t  header_len
+    uint8_t  num_fields
+  then for each field in the frame:
+    uint8_t  field
+    uint8_t  offset     from the start of the frame data
+    uint8_t  type       1: float, 2: int32_t
+    uint8_t  count      number of elements
+  Fields which don't fit in a frame after those before them are left
+  out of both.
+ */
+class GCS_CompactState
+{
+public:
+
+    static constexpr uint8_t DATA96_TYPE_FRAME = 200;
+    static constexpr uint8_t DATA96_TYPE_SCHEMA = 201;
+    static constexpr uint8_t MAGIC = 0xC5;
+    static constexpr uint8_t VERSION = 2;
+    static constexpr uint8_t MAX_LEN = 96;
+    static constexpr uint8_t MAX_ELEMENTS = 5;
+
+    enum class Field : uint8_t {
+        ATTITUDE      = 0,  // roll, pitch, yaw (rad)
+        BODY_RATE     = 1,  // AHRS body rates (rad/s)
+        QUATERNION    = 2,  // body to NED rotation
+        ACCEL         = 3,  // primary IMU acceleration, body frame (m/s/s)
+        GYRO          = 4,  // primary IMU rotation rates, body frame (rad/s)
+        POSITION_NED  = 5,  // position relative to the EKF origin (m)
+        VELOCITY_NED  = 6,  // velocity (m/s)
+        LOCATION      = 7,  // lat, lng (1e-7 deg), alt above MSL (cm); int32_t
+        EKF_VARIANCES = 8,  // velocity, position, height, compass and airspeed test ratios
+        WIND          = 9,  // wind estimate NED (m/s)
+        NUM_FIELDS
+    };
+
+    enum class ElementType : uint8_t {
+        FLOAT = 1,
+        INT32 = 2,
+    };
+
+    // the value of every field, as carried in a frame
+    union Element {
+        float f;
+        int32_t i;
+    };
+    struct Values {
+        uint16_t valid;     // bit n set if field n holds a current value
+        Element field[uint8_t(Field::NUM_FIELDS)][MAX_ELEMENTS];
+    };
+
+    // a frame layout, as carried in a schema
+    struct Layout {
+        uint8_t schema_id;
+        uint8_t num_fields;
+        struct {
+            uint8_t field;
+            uint8_t offset;
+            uint8_t type;
+            uint8_t count;
+        } entries[uint8_t(Field::NUM_FIELDS)];
+    };
+
+    // true if the schema for mask should be sent before the next
+    // frame; the schema id changes with the field selection
+    bool schema_due(uint32_t mask, uint32_t now_ms);
+
+    // fill in the schema for mask, returning its length
+    uint8_t pack_schema(uint32_t mask, uint8_t data[MAX_LEN]) const {
+        return encode_schema(schema_id, mask, data);
+    }
+
+    // fill in a frame with the current values of the fields in mask,
+    // returning its length
+    uint8_t pack_frame(uint32_t mask, uint8_t data[MAX_LEN]);
+
+    // encoding and decoding, for listeners and tests. The decoders
+    // return false for a DATA96 which is not part of this stream
+    static uint8_t encode_schema(uint8_t schema_id, uint32_t mask, uint8_t data[MAX_LEN]);
+    static uint8_t encode_frame(uint8_t schema_id, uint16_t seq, uint32_t time_us,
+                                uint32_t mask, const Values &values, uint8_t data[MAX_LEN]);
+    static bool decode_schema(uint8_t type, const uint8_t *data, uint8_t len, Layout &layout);
+    static bool decode_frame(uint8_t type, const uint8_t *data, uint8_t len, const Layout &layout,
+                             uint16_t &seq, uint32_t &time_us, Values &values);
+
+    // true if a DATA96 is part of this stream
+    static bool is_compact_state(uint8_t type, const uint8_t *data, uint8_t len) {
+        return (type == DATA96_TYPE_FRAME || type == DATA96_TYPE_SCHEMA) &&
+            len >= 2 && data[0] == MAGIC && data[1] == VERSION;
+    }
+
+private:
+
+    struct PACKED FrameHeader {
+        uint8_t magic;
+        uint8_t version;
+        uint8_t schema_id;
+        uint16_t seq;
+        uint16_t valid;
+        uint32_t time_us;
+    };
+    static_assert(uint8_t(Field::NUM_FIELDS) <= 16, "valid bits must fit in the header");
+
+    struct PACKED SchemaHeader {
+        uint8_t magic;
+        uint8_t version;
+        uint8_t schema_id;
+        uint8_t header_len;
+        uint8_t num_fields;
+    };
+
+    struct PACKED SchemaEntry {
+        uint8_t field;
+        uint8_t offset;
+        uint8_t type;
+        uint8_t count;
+    };
+
+    // fetch the value of a field; returns false if it isn't available
+    bool get_field(Field field, float *values) const;
+    bool get_location(int32_t *values) const;
+
+    uint32_t last_mask;
+    uint32_t last_schema_ms;
+    uint16_t seq;
+    uint8_t schema_id;
+};
+
+#endif // HAL_GCS_COMPACT_STATE_ENABLED
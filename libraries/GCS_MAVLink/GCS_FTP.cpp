@@ -29,6 +29,18 @@ struct GCS_MAVLINK::ftp_state GCS_MAVLINK::ftp;
 // timeout for session inactivity
 #define FTP_SESSION_TIMEOUT 3000
 
+// bytes sent in response to a burst read before burst_complete is
+// set and the client must ask for more
+#ifndef FTP_BURST_WINDOW
+#define FTP_BURST_WINDOW 65536
+#endif
+
+// size of the read-ahead buffer of each file open for reading, zero
+// to disable
+#ifndef FTP_READAHEAD_SIZE
+#define FTP_READAHEAD_SIZE (BOARD_FLASH_SIZE > 1024 ? 4096 : 0)
+#endif
+
 bool GCS_MAVLINK::ftp_init(void) {
 
     // check if ftp is disabled for memory savings
@@ -52,7 +64,7 @@ bool GCS_MAVLINK::ftp_init(void) {
     }
 
     if (!hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&GCS_MAVLINK::ftp_worker, void),
-                                      "FTP", 2560, AP_HAL::Scheduler::PRIORITY_IO, 0)) {
+                                      "FTP", 2816, AP_HAL::Scheduler::PRIORITY_IO, 0)) {
         goto failed;
     }
 
@@ -177,389 +189,516 @@ void GCS_MAVLINK::ftp_worker(void) {
     reply.session = -1; // flag the reply as invalid for any reuse
 
     while (true) {
-        bool skip_push_reply = false;
-
-        while (!ftp.requests->pop(request)) {
-            // nothing to handle, delay ourselves a bit then check again. Ideally we'd use conditional waits here
-            hal.scheduler->delay(2);
+        if (!ftp.requests->pop(request)) {
+            // nothing to handle, continue any burst reads. If there
+            // are none, or no room for their replies, delay ourselves
+            // a bit then check again. Ideally we'd use conditional
+            // waits here
+            if (!ftp_burst_send()) {
+                hal.scheduler->delay(2);
+            }
+            continue;
         }
 
         // if it's a rerequest and we still have the last response then send it
-        if ((request.sysid == reply.sysid) && (request.compid = reply.compid) &&
+        if ((request.sysid == reply.sysid) && (request.compid == reply.compid) &&
             (request.session == reply.session) && (request.seq_number + 1 == reply.seq_number)) {
             ftp_push_replies(reply);
             continue;
         }
 
-        // setup the response
-        memset(&reply, 0, sizeof(reply));
-        reply.req_opcode = request.opcode;
-        reply.session = request.session;
-        reply.seq_number = request.seq_number + 1;
-        reply.chan = request.chan;
-        reply.sysid = request.sysid;
-        reply.compid = request.compid;
-
-        // sanity check the request size
-        if (request.size > sizeof(request.data)) {
-            ftp_error(reply, FTP_ERROR::InvalidDataSize);
-            ftp_push_replies(reply);
+        ftp_handle_request(request, reply);
+    }
+}
+
+/*
+  find the open session a request is for
+ */
+struct GCS_MAVLINK::ftp_session *GCS_MAVLINK::ftp_find_session(const struct pending_ftp &request)
+{
+    for (auto &s : ftp.sessions) {
+        if (s.fd != -1 && s.id == request.session &&
+            s.sysid == request.sysid && s.compid == request.compid) {
+            return &s;
+        }
+    }
+    return nullptr;
+}
+
+/*
+  open a file for a request, using a free session slot. A slot whose
+  session has been idle for longer than the timeout is taken over, as
+  its client has probably gone away. On failure the reply is filled in
+  with the error and nullptr is returned
+ */
+struct GCS_MAVLINK::ftp_session *GCS_MAVLINK::ftp_open_session(const struct pending_ftp &request, struct pending_ftp &reply,
+                                                              const char *path, int flags, FTP_FILE_MODE mode)
+{
+    const uint32_t now = AP_HAL::millis();
+
+    // only allow one file to be open per session
+    struct ftp_session *session = ftp_find_session(request);
+    if (session != nullptr) {
+        if (now - session->last_activity_ms < FTP_SESSION_TIMEOUT) {
+            ftp_error(reply, FTP_ERROR::Fail);
+            return nullptr;
+        }
+        // no activity for 3s, assume client has timed out receiving
+        // open reply, close the file
+        ftp_close_session(*session);
+    }
+
+    session = nullptr;
+    for (auto &s : ftp.sessions) {
+        if (s.fd == -1) {
+            session = &s;
+            break;
+        }
+        if (now - s.last_activity_ms >= FTP_SESSION_TIMEOUT &&
+            (session == nullptr || s.last_activity_ms - session->last_activity_ms > UINT32_MAX/2)) {
+            // oldest idle session
+            session = &s;
+        }
+    }
+    if (session == nullptr) {
+        ftp_error(reply, FTP_ERROR::NoSessionsAvailable);
+        return nullptr;
+    }
+    if (session->fd != -1) {
+        ftp_close_session(*session);
+    }
+
+    const int fd = AP::FS().open(path, flags);
+    if (fd == -1) {
+        ftp_error(reply, FTP_ERROR::FailErrno);
+        return nullptr;
+    }
+
+    session->fd = fd;
+    session->mode = mode;
+    session->id = request.session;
+    session->sysid = request.sysid;
+    session->compid = request.compid;
+    session->chan = request.chan;
+    session->last_activity_ms = now;
+    session->bursting = false;
+
+#if FTP_READAHEAD_SIZE > 0
+    // virtual files are not read through a buffer; @PARAM/param.pck
+    // needs every read to be the size the client asked for
+    if (mode == FTP_FILE_MODE::Read && path[0] != '@') {
+        session->readahead = new uint8_t[FTP_READAHEAD_SIZE];
+        session->readahead_len = 0;
+    }
+#endif
+
+    return session;
+}
+
+void GCS_MAVLINK::ftp_close_session(struct ftp_session &session)
+{
+    if (session.fd != -1) {
+        AP::FS().close(session.fd);
+        session.fd = -1;
+    }
+    session.bursting = false;
+    delete [] session.readahead;
+    session.readahead = nullptr;
+}
+
+/*
+  read from a session's file at an offset. Reads of real files are
+  served from a read-ahead buffer, so that the filesystem sees large
+  sequential reads rather than one per reply
+ */
+ssize_t GCS_MAVLINK::ftp_read(struct ftp_session &session, uint32_t offset, uint8_t *buf, uint8_t len)
+{
+    if (session.readahead == nullptr) {
+        if (AP::FS().lseek(session.fd, offset, SEEK_SET) == -1) {
+            return -1;
+        }
+        return AP::FS().read(session.fd, buf, len);
+    }
+
+    if (offset < session.readahead_ofs ||
+        offset + len > session.readahead_ofs + session.readahead_len) {
+        // refill starting at the requested offset. A short fill
+        // means end of file, and is refilled on the next read in case
+        // the file has grown
+        if (AP::FS().lseek(session.fd, offset, SEEK_SET) == -1) {
+            return -1;
+        }
+        const ssize_t n = AP::FS().read(session.fd, session.readahead, FTP_READAHEAD_SIZE);
+        if (n == -1) {
+            session.readahead_len = 0;
+            return -1;
+        }
+        session.readahead_ofs = offset;
+        session.readahead_len = n;
+    }
+
+    const uint32_t n = MIN(uint32_t(len), session.readahead_ofs + session.readahead_len - offset);
+    memcpy(buf, &session.readahead[offset - session.readahead_ofs], n);
+    return n;
+}
+
+/*
+  send the next reply of the burst reads in progress, taking one from
+  each session in turn. Returns true if a reply was queued
+ */
+bool GCS_MAVLINK::ftp_burst_send(void)
+{
+    bool sent = false;
+    for (uint8_t i = 0; i < HAL_GCS_FTP_MAX_SESSIONS; i++) {
+        if (ftp.replies->space() == 0) {
+            break;
+        }
+        struct ftp_session &s = ftp.sessions[ftp.next_burst];
+        ftp.next_burst = (ftp.next_burst + 1) % HAL_GCS_FTP_MAX_SESSIONS;
+        if (s.fd == -1 || !s.bursting) {
             continue;
         }
 
-        uint32_t now = AP_HAL::millis();
+        pending_ftp reply;
+        memset(&reply, 0, sizeof(reply));
+        reply.req_opcode = FTP_OP::BurstReadFile;
+        reply.session = s.id;
+        reply.seq_number = s.burst_seq++;
+        reply.chan = s.chan;
+        reply.sysid = s.sysid;
+        reply.compid = s.compid;
+        reply.offset = s.burst_offset;
+
+        const ssize_t read_bytes = ftp_read(s, s.burst_offset, reply.data, s.burst_size);
+        if (read_bytes == -1) {
+            ftp_error(reply, FTP_ERROR::FailErrno);
+            s.bursting = false;
+        } else if (read_bytes == 0) {
+            ftp_error(reply, FTP_ERROR::EndOfFile);
+            s.bursting = false;
+        } else {
+            reply.opcode = FTP_OP::Ack;
+            reply.size = (uint8_t)read_bytes;
+            s.burst_offset += read_bytes;
+            if (s.burst_offset >= s.burst_end) {
+                reply.burst_complete = true;
+                s.bursting = false;
+            }
+        }
+        s.last_activity_ms = AP_HAL::millis();
+
+        ftp.replies->push(reply);
+        sent = true;
+    }
+    return sent;
+}
+
+void GCS_MAVLINK::ftp_handle_request(struct pending_ftp &request, struct pending_ftp &reply)
+{
+    bool skip_push_reply = false;
+
+    // setup the response
+    memset(&reply, 0, sizeof(reply));
+    reply.req_opcode = request.opcode;
+    reply.session = request.session;
+    reply.seq_number = request.seq_number + 1;
+    reply.chan = request.chan;
+    reply.sysid = request.sysid;
+    reply.compid = request.compid;
+
+    // sanity check the request size
+    if (request.size > sizeof(request.data)) {
+        ftp_error(reply, FTP_ERROR::InvalidDataSize);
+        ftp_push_replies(reply);
+        return;
+    }
+
+    struct ftp_session *session = ftp_find_session(request);
+    if (session != nullptr) {
+        // replies go to the link the client last used
+        session->chan = request.chan;
+    }
 
-        // check for session termination
-        if (request.session != ftp.current_session &&
-            (request.opcode == FTP_OP::TerminateSession || request.opcode == FTP_OP::ResetSessions)) {
-            // terminating a different session, just ack
+    // dispatch the command as needed
+    switch (request.opcode) {
+        case FTP_OP::None:
             reply.opcode = FTP_OP::Ack;
-        } else if (ftp.fd != -1 && request.session != ftp.current_session &&
-                   now - ftp.last_send_ms < FTP_SESSION_TIMEOUT) {
-            // if we have an open file and the session isn't right
-            // then reject. This prevents IO on the wrong file
-            ftp_error(reply, FTP_ERROR::InvalidSession);
-        } else {
-            if (ftp.fd != -1 &&
-                request.session != ftp.current_session &&
-                now - ftp.last_send_ms >= FTP_SESSION_TIMEOUT) {
-                // if a new session appears and the old session has
-                // been idle for more than the timeout then force
-                // close the old session
-                AP::FS().close(ftp.fd);
-                ftp.fd = -1;
-                ftp.current_session = -1;
+            break;
+        case FTP_OP::TerminateSession:
+            if (session != nullptr) {
+                ftp_close_session(*session);
+            }
+            reply.opcode = FTP_OP::Ack;
+            break;
+        case FTP_OP::ResetSessions:
+            // close every session of this client
+            for (auto &s : ftp.sessions) {
+                if (s.fd != -1 && s.sysid == request.sysid && s.compid == request.compid) {
+                    ftp_close_session(s);
+                }
+            }
+            reply.opcode = FTP_OP::Ack;
+            break;
+        case FTP_OP::ListDirectory:
+            ftp_list_dir(request, reply);
+            break;
+        case FTP_OP::OpenFileRO:
+            {
+                // sanity check that our the request looks well formed
+                const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
+                if ((file_name_len != request.size) || (request.size == 0)) {
+                    ftp_error(reply, FTP_ERROR::InvalidDataSize);
+                    break;
+                }
+
+                request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
+
+                // get the file size
+                struct stat st;
+                if (AP::FS().stat((char *)request.data, &st)) {
+                    ftp_error(reply, FTP_ERROR::FailErrno);
+                    break;
+                }
+                const size_t file_size = st.st_size;
+
+                // actually open the file
+                if (ftp_open_session(request, reply, (char *)request.data, 0, FTP_FILE_MODE::Read) == nullptr) {
+                    break;
+                }
+
+                reply.opcode = FTP_OP::Ack;
+                reply.size = sizeof(uint32_t);
+                put_le32_ptr(reply.data, (uint32_t)file_size);
+
+                // provide compatibility with old protocol banner download
+                if (strncmp((const char *)request.data, "@PARAM/param.pck", 16) == 0) {
+                    ftp.need_banner_send_mask |= 1U<<reply.chan;
+                }
+                break;
             }
-            // dispatch the command as needed
-            switch (request.opcode) {
-                case FTP_OP::None:
-                    reply.opcode = FTP_OP::Ack;
+        case FTP_OP::ReadFile:
+            {
+                // must actually be working on a file
+                if (session == nullptr) {
+                    ftp_error(reply, FTP_ERROR::FileNotFound);
                     break;
-                case FTP_OP::TerminateSession:
-                case FTP_OP::ResetSessions:
-                    // we already handled this, just listed for completeness
-                    if (ftp.fd != -1) {
-                        AP::FS().close(ftp.fd);
-                        ftp.fd = -1;
-                    }
-                    ftp.current_session = -1;
-                    reply.opcode = FTP_OP::Ack;
+                }
+
+                // must have the file in read mode
+                if ((session->mode != FTP_FILE_MODE::Read)) {
+                    ftp_error(reply, FTP_ERROR::Fail);
                     break;
-                case FTP_OP::ListDirectory:
-                    ftp_list_dir(request, reply);
+                }
+
+                // fill the buffer
+                const ssize_t read_bytes = ftp_read(*session, request.offset, reply.data, request.size);
+                if (read_bytes == -1) {
+                    ftp_error(reply, FTP_ERROR::FailErrno);
                     break;
-                case FTP_OP::OpenFileRO:
-                    {
-                        // only allow one file to be open per session
-                        if (ftp.fd != -1 && now - ftp.last_send_ms > FTP_SESSION_TIMEOUT) {
-                            // no activity for 3s, assume client has
-                            // timed out receiving open reply, close
-                            // the file
-                            AP::FS().close(ftp.fd);
-                            ftp.fd = -1;
-                            ftp.current_session = -1;
-                        }
-                        if (ftp.fd != -1) {
-                            ftp_error(reply, FTP_ERROR::Fail);
-                            break;
-                        }
-
-                        // sanity check that our the request looks well formed
-                        const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
-                        if ((file_name_len != request.size) || (request.size == 0)) {
-                            ftp_error(reply, FTP_ERROR::InvalidDataSize);
-                            break;
-                        }
-
-                        request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
-
-                        // get the file size
-                        struct stat st;
-                        if (AP::FS().stat((char *)request.data, &st)) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-                        const size_t file_size = st.st_size;
-
-                        // actually open the file
-                        ftp.fd = AP::FS().open((char *)request.data, 0);
-                        if (ftp.fd == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-                        ftp.mode = FTP_FILE_MODE::Read;
-                        ftp.current_session = request.session;
-
-                        reply.opcode = FTP_OP::Ack;
-                        reply.size = sizeof(uint32_t);
-                        put_le32_ptr(reply.data, (uint32_t)file_size);
-
-                        // provide compatibility with old protocol banner download
-                        if (strncmp((const char *)request.data, "@PARAM/param.pck", 16) == 0) {
-                            ftp.need_banner_send_mask |= 1U<<reply.chan;
-                        }
-                        break;
-                    }
-                case FTP_OP::ReadFile:
-                    {
-                        // must actually be working on a file
-                        if (ftp.fd == -1) {
-                            ftp_error(reply, FTP_ERROR::FileNotFound);
-                            break;
-                        }
-
-                        // must have the file in read mode
-                        if ((ftp.mode != FTP_FILE_MODE::Read)) {
-                            ftp_error(reply, FTP_ERROR::Fail);
-                            break;
-                        }
-
-                        // seek to requested offset
-                        if (AP::FS().lseek(ftp.fd, request.offset, SEEK_SET) == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-
-                        // fill the buffer
-                        const ssize_t read_bytes = AP::FS().read(ftp.fd, reply.data, request.size);
-                        if (read_bytes == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-                        if (read_bytes == 0) {
-                            ftp_error(reply, FTP_ERROR::EndOfFile);
-                            break;
-                        }
-
-                        reply.opcode = FTP_OP::Ack;
-                        reply.offset = request.offset;
-                        reply.size = (uint8_t)read_bytes;
-                        break;
-                    }
-                case FTP_OP::Ack:
-                case FTP_OP::Nack:
-                    // eat these, we just didn't expect them
-                    continue;
+                }
+                if (read_bytes == 0) {
+                    ftp_error(reply, FTP_ERROR::EndOfFile);
                     break;
-                case FTP_OP::OpenFileWO:
-                case FTP_OP::CreateFile:
-                    {
-                        // only allow one file to be open per session
-                        if (ftp.fd != -1) {
-                            ftp_error(reply, FTP_ERROR::Fail);
-                            break;
-                        }
-
-                        // sanity check that our the request looks well formed
-                        const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
-                        if ((file_name_len != request.size) || (request.size == 0)) {
-                            ftp_error(reply, FTP_ERROR::InvalidDataSize);
-                            break;
-                        }
-
-                        request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
-
-                        // actually open the file
-                        ftp.fd = AP::FS().open((char *)request.data,
-                                               (request.opcode == FTP_OP::CreateFile) ? O_WRONLY|O_CREAT|O_TRUNC : O_WRONLY);
-                        if (ftp.fd == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-                        ftp.mode = FTP_FILE_MODE::Write;
-                        ftp.current_session = request.session;
-
-                        reply.opcode = FTP_OP::Ack;
-                        break;
-                    }
-                case FTP_OP::WriteFile:
-                    {
-                        // must actually be working on a file
-                        if (ftp.fd == -1) {
-                            ftp_error(reply, FTP_ERROR::FileNotFound);
-                            break;
-                        }
-
-                        // must have the file in write mode
-                        if ((ftp.mode != FTP_FILE_MODE::Write)) {
-                            ftp_error(reply, FTP_ERROR::Fail);
-                            break;
-                        }
-
-                        // seek to requested offset
-                        if (AP::FS().lseek(ftp.fd, request.offset, SEEK_SET) == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-
-                        // fill the buffer
-                        const ssize_t write_bytes = AP::FS().write(ftp.fd, request.data, request.size);
-                        if (write_bytes == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-
-                        reply.opcode = FTP_OP::Ack;
-                        reply.offset = request.offset;
-                        break;
-                    }
-                case FTP_OP::CreateDirectory:
-                    {
-                        // sanity check that our the request looks well formed
-                        const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
-                        if ((file_name_len != request.size) || (request.size == 0)) {
-                            ftp_error(reply, FTP_ERROR::InvalidDataSize);
-                            break;
-                        }
-
-                        request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
-
-                        // actually make the directory
-                        if (AP::FS().mkdir((char *)request.data) == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-
-                        reply.opcode = FTP_OP::Ack;
-                        break;
-                    }
-                case FTP_OP::RemoveDirectory:
-                case FTP_OP::RemoveFile:
-                    {
-                        // sanity check that our the request looks well formed
-                        const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
-                        if ((file_name_len != request.size) || (request.size == 0)) {
-                            ftp_error(reply, FTP_ERROR::InvalidDataSize);
-                            break;
-                        }
-
-                        request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
-
-                        // remove the file/dir
-                        if (AP::FS().unlink((char *)request.data) == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-
-                        reply.opcode = FTP_OP::Ack;
-                        break;
-                    }
-                case FTP_OP::CalcFileCRC32:
-                    {
-                        // sanity check that our the request looks well formed
-                        const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
-                        if ((file_name_len != request.size) || (request.size == 0)) {
-                            ftp_error(reply, FTP_ERROR::InvalidDataSize);
-                            break;
-                        }
-
-                        request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
-
-                        // actually open the file
-                        int fd = AP::FS().open((char *)request.data, O_RDONLY);
-                        if (fd == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-
-                        uint32_t checksum = 0;
-                        ssize_t read_size;
-                        do {
-                            read_size = AP::FS().read(fd, reply.data, sizeof(reply.data));
-                            if (read_size == -1) {
-                                ftp_error(reply, FTP_ERROR::FailErrno);
-                                break;
-                            }
-                            checksum = crc_crc32(checksum, reply.data, MIN((size_t)read_size, sizeof(reply.data)));
-                        } while (read_size > 0);
-
-                        AP::FS().close(fd);
-
-                        // reset our scratch area so we don't leak data, and can leverage trimming
-                        memset(reply.data, 0, sizeof(reply.data));
-                        reply.size = sizeof(uint32_t);
-                        put_le32_ptr(reply.data, checksum);
-                        reply.opcode = FTP_OP::Ack;
-                        break;
-                    }
-                case FTP_OP::BurstReadFile:
-                    {
-                        const uint16_t max_read = (request.size == 0?sizeof(reply.data):request.size);
-                        // must actually be working on a file
-                        if (ftp.fd == -1) {
-                            ftp_error(reply, FTP_ERROR::FileNotFound);
-                            break;
-                        }
-
-                        // must have the file in read mode
-                        if ((ftp.mode != FTP_FILE_MODE::Read)) {
-                            ftp_error(reply, FTP_ERROR::Fail);
-                            break;
-                        }
-
-                        // seek to requested offset
-                        if (AP::FS().lseek(ftp.fd, request.offset, SEEK_SET) == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-
-                        const uint32_t transfer_size = 100;
-                        for (uint32_t i = 0; (i < transfer_size); i++) {
-                            // fill the buffer
-                            const ssize_t read_bytes = AP::FS().read(ftp.fd, reply.data, max_read);
-                            if (read_bytes == -1) {
-                                ftp_error(reply, FTP_ERROR::FailErrno);
-                                break;
-                            }
-
-                            if (read_bytes != sizeof(reply.data)) {
-                                // don't send any old data
-                                memset(reply.data + read_bytes, 0, sizeof(reply.data) - read_bytes);
-                            }
-
-                            if (read_bytes == 0) {
-                                ftp_error(reply, FTP_ERROR::EndOfFile);
-                                break;
-                            }
-
-                            reply.opcode = FTP_OP::Ack;
-                            reply.offset = request.offset + i * max_read;
-                            reply.burst_complete = (i == (transfer_size - 1));
-                            reply.size = (uint8_t)read_bytes;
-
-                            ftp_push_replies(reply);
-
-                            if (read_bytes < max_read) {
-                                // ensure the NACK which we send next is at the right offset
-                                reply.offset += read_bytes;
-                            }
-
-                            // prep the reply to be used again
-                            reply.seq_number++;
-                        }
-
-                        if (reply.opcode != FTP_OP::Nack) {
-                            // prevent a duplicate packet send for
-                            // normal replies of burst reads
-                            skip_push_reply = true;
-                        }
+                }
+
+                reply.opcode = FTP_OP::Ack;
+                reply.offset = request.offset;
+                reply.size = (uint8_t)read_bytes;
+                break;
+            }
+        case FTP_OP::Ack:
+        case FTP_OP::Nack:
+            // eat these, we just didn't expect them
+            return;
+        case FTP_OP::OpenFileWO:
+        case FTP_OP::CreateFile:
+            {
+                // sanity check that our the request looks well formed
+                const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
+                if ((file_name_len != request.size) || (request.size == 0)) {
+                    ftp_error(reply, FTP_ERROR::InvalidDataSize);
+                    break;
+                }
+
+                request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
+
+                // actually open the file
+                if (ftp_open_session(request, reply, (char *)request.data,
+                                     (request.opcode == FTP_OP::CreateFile) ? O_WRONLY|O_CREAT|O_TRUNC : O_WRONLY,
+                                     FTP_FILE_MODE::Write) == nullptr) {
+                    break;
+                }
+
+                reply.opcode = FTP_OP::Ack;
+                break;
+            }
+        case FTP_OP::WriteFile:
+            {
+                // must actually be working on a file
+                if (session == nullptr) {
+                    ftp_error(reply, FTP_ERROR::FileNotFound);
+                    break;
+                }
+
+                // must have the file in write mode
+                if ((session->mode != FTP_FILE_MODE::Write)) {
+                    ftp_error(reply, FTP_ERROR::Fail);
+                    break;
+                }
+
+                // seek to requested offset
+                if (AP::FS().lseek(session->fd, request.offset, SEEK_SET) == -1) {
+                    ftp_error(reply, FTP_ERROR::FailErrno);
+                    break;
+                }
+
+                // fill the buffer
+                const ssize_t write_bytes = AP::FS().write(session->fd, request.data, request.size);
+                if (write_bytes == -1) {
+                    ftp_error(reply, FTP_ERROR::FailErrno);
+                    break;
+                }
+
+                reply.opcode = FTP_OP::Ack;
+                reply.offset = request.offset;
+                break;
+            }
+        case FTP_OP::CreateDirectory:
+            {
+                // sanity check that our the request looks well formed
+                const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
+                if ((file_name_len != request.size) || (request.size == 0)) {
+                    ftp_error(reply, FTP_ERROR::InvalidDataSize);
+                    break;
+                }
+
+                request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
+
+                // actually make the directory
+                if (AP::FS().mkdir((char *)request.data) == -1) {
+                    ftp_error(reply, FTP_ERROR::FailErrno);
+                    break;
+                }
+
+                reply.opcode = FTP_OP::Ack;
+                break;
+            }
+        case FTP_OP::RemoveDirectory:
+        case FTP_OP::RemoveFile:
+            {
+                // sanity check that our the request looks well formed
+                const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
+                if ((file_name_len != request.size) || (request.size == 0)) {
+                    ftp_error(reply, FTP_ERROR::InvalidDataSize);
+                    break;
+                }
+
+                request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
+
+                // remove the file/dir
+                if (AP::FS().unlink((char *)request.data) == -1) {
+                    ftp_error(reply, FTP_ERROR::FailErrno);
+                    break;
+                }
+
+                reply.opcode = FTP_OP::Ack;
+                break;
+            }
+        case FTP_OP::CalcFileCRC32:
+            {
+                // sanity check that our the request looks well formed
+                const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
+                if ((file_name_len != request.size) || (request.size == 0)) {
+                    ftp_error(reply, FTP_ERROR::InvalidDataSize);
+                    break;
+                }
+
+                request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
+
+                // actually open the file
+                int fd = AP::FS().open((char *)request.data, O_RDONLY);
+                if (fd == -1) {
+                    ftp_error(reply, FTP_ERROR::FailErrno);
+                    break;
+                }
+
+                uint32_t checksum = 0;
+                ssize_t read_size;
+                do {
+                    read_size = AP::FS().read(fd, reply.data, sizeof(reply.data));
+                    if (read_size == -1) {
+                        ftp_error(reply, FTP_ERROR::FailErrno);
                         break;
                     }
-                case FTP_OP::TruncateFile:
-                case FTP_OP::Rename:
-                default:
-                    // this was bad data, just nack it
-                    gcs().send_text(MAV_SEVERITY_DEBUG, "Unsupported FTP: %d", static_cast<int>(request.opcode));
+                    checksum = crc_crc32(checksum, reply.data, MIN((size_t)read_size, sizeof(reply.data)));
+                } while (read_size > 0);
+
+                AP::FS().close(fd);
+
+                // reset our scratch area so we don't leak data, and can leverage trimming
+                memset(reply.data, 0, sizeof(reply.data));
+                reply.size = sizeof(uint32_t);
+                put_le32_ptr(reply.data, checksum);
+                reply.opcode = FTP_OP::Ack;
+                break;
+            }
+        case FTP_OP::BurstReadFile:
+            {
+                // must actually be working on a file
+                if (session == nullptr) {
+                    ftp_error(reply, FTP_ERROR::FileNotFound);
+                    break;
+                }
+
+                // must have the file in read mode
+                if ((session->mode != FTP_FILE_MODE::Read)) {
                     ftp_error(reply, FTP_ERROR::Fail);
                     break;
+                }
+
+                const uint8_t max_read = (request.size == 0?sizeof(reply.data):request.size);
+
+                /*
+                  the replies are sent by ftp_burst_send() while
+                  we carry on handling requests. A client may ask
+                  again, with the offset it has received up to, before
+                  the window is used up. If that is between its last
+                  request and what we have already sent the window
+                  slides on rather than starting again. Gaps from lost
+                  replies are filled by the client with ReadFile
+                 */
+                if (!(session->bursting &&
+                      session->burst_size == max_read &&
+                      request.offset >= session->burst_request_offset &&
+                      request.offset <= session->burst_offset)) {
+                    session->burst_offset = request.offset;
+                }
+                session->burst_request_offset = request.offset;
+                session->burst_end = request.offset + FTP_BURST_WINDOW;
+                session->burst_size = max_read;
+                session->burst_seq = request.seq_number + 1;
+                session->bursting = true;
+
+                // a resend of this request must not get a stale reply
+                reply.session = -1;
+                skip_push_reply = true;
+                break;
             }
-        }
+        case FTP_OP::TruncateFile:
+        case FTP_OP::Rename:
+        default:
+            // this was bad data, just nack it
+            gcs().send_text(MAV_SEVERITY_DEBUG, "Unsupported FTP: %d", static_cast<int>(request.opcode));
+            ftp_error(reply, FTP_ERROR::Fail);
+            break;
+    }
 
-        if (!skip_push_reply) {
-            ftp_push_replies(reply);
-        }
+    if (session != nullptr && session->fd != -1) {
+        session->last_activity_ms = AP_HAL::millis();
+    }
 
-        continue;
+    if (!skip_push_reply) {
+        ftp_push_replies(reply);
     }
 }
 
@@ -38,6 +38,7 @@ extern const AP_HAL::HAL& hal;
 
 AP_HAL::UARTDriver	*mavlink_comm_port[MAVLINK_COMM_NUM_BUFFERS];
 bool gcs_alternative_active[MAVLINK_COMM_NUM_BUFFERS];
+uint32_t mavlink_comm_tx_bytes[MAVLINK_COMM_NUM_BUFFERS];
 
 // per-channel lock
 static HAL_Semaphore chan_locks[MAVLINK_COMM_NUM_BUFFERS];
@@ -47,6 +48,119 @@ mavlink_system_t mavlink_system = {7,1};
 // routing table
 MAVLink_routing GCS_MAVLINK::routing;
 
+/*
+  parse a whole frame from a buffer. See GCS_MAVLink.h
+ */
+MAVLinkFrame mavlink_parse_frame(mavlink_channel_t chan, const uint8_t *buf, uint16_t len,
+                                 uint16_t &frame_len, mavlink_message_t &msg, mavlink_status_t &r_status)
+{
+    mavlink_status_t *status = mavlink_get_channel_status(chan);
+    if (status->parse_state > MAVLINK_PARSE_STATE_IDLE || len == 0) {
+        // in the middle of a frame, or nothing to look at
+        return len == 0 ? MAVLinkFrame::INCOMPLETE : MAVLinkFrame::FALLBACK;
+    }
+
+    const bool mavlink1 = (buf[0] == MAVLINK_STX_MAVLINK1);
+    if (!mavlink1 && buf[0] != MAVLINK_STX) {
+        return MAVLinkFrame::FALLBACK;
+    }
+    const uint8_t header_len = mavlink1 ? MAVLINK_CORE_HEADER_MAVLINK1_LEN+1 : MAVLINK_CORE_HEADER_LEN+1;
+    if (len < header_len) {
+        frame_len = header_len;
+        return MAVLinkFrame::INCOMPLETE;
+    }
+
+    const uint8_t payload_len = buf[1];
+    msg.magic = buf[0];
+    msg.len = payload_len;
+    if (mavlink1) {
+        msg.incompat_flags = 0;
+        msg.compat_flags = 0;
+        msg.seq = buf[2];
+        msg.sysid = buf[3];
+        msg.compid = buf[4];
+        msg.msgid = buf[5];
+    } else {
+        msg.incompat_flags = buf[2];
+        if ((msg.incompat_flags & ~MAVLINK_IFLAG_MASK) != 0) {
+            // let the byte parser count the error
+            return MAVLinkFrame::FALLBACK;
+        }
+        msg.compat_flags = buf[3];
+        msg.seq = buf[4];
+        msg.sysid = buf[5];
+        msg.compid = buf[6];
+        msg.msgid = buf[7] | (buf[8]<<8) | (((uint32_t)buf[9])<<16);
+    }
+    const bool is_signed = (msg.incompat_flags & MAVLINK_IFLAG_SIGNED) != 0;
+    frame_len = header_len + payload_len + MAVLINK_NUM_CHECKSUM_BYTES;
+    if (is_signed) {
+        frame_len += MAVLINK_SIGNATURE_BLOCK_LEN;
+    }
+    if (len < frame_len) {
+        return MAVLinkFrame::INCOMPLETE;
+    }
+
+    // the CRC covers the header after the STX, the payload and the
+    // message's CRC_EXTRA, all of which is contiguous here
+    const uint8_t *payload = &buf[header_len];
+    const mavlink_msg_entry_t *e = mavlink_get_msg_entry(msg.msgid);
+    uint16_t crc = crc_calculate(&buf[1], header_len-1);
+    crc_accumulate_buffer(&crc, (const char *)payload, payload_len);
+    crc_accumulate(e ? e->crc_extra : 0, &crc);
+    const uint8_t *ck = &payload[payload_len];
+    if (ck[0] != (crc & 0xFF) || ck[1] != (crc >> 8)) {
+        return MAVLinkFrame::FALLBACK;
+    }
+    msg.checksum = crc;
+    msg.ck[0] = ck[0];
+    msg.ck[1] = ck[1];
+
+    memcpy(_MAV_PAYLOAD_NON_CONST(&msg), payload, payload_len);
+    // zero-fill the payload to cope with truncated MAVLink2 packets
+    if (e && payload_len < e->max_msg_len) {
+        memset(&_MAV_PAYLOAD_NON_CONST(&msg)[payload_len], 0, e->max_msg_len - payload_len);
+    }
+
+    if (is_signed) {
+        memcpy(msg.signature, &ck[2], MAVLINK_SIGNATURE_BLOCK_LEN);
+        // a failed check has no side effects, so the byte parser can
+        // repeat it and apply the accept_unsigned_callback override
+        if (!mavlink_signature_check(status->signing, status->signing_streams, &msg)) {
+            return MAVLinkFrame::FALLBACK;
+        }
+    } else if (status->signing &&
+               (status->signing->accept_unsigned_callback == nullptr ||
+                !status->signing->accept_unsigned_callback(status, msg.msgid))) {
+        return MAVLinkFrame::FALLBACK;
+    }
+
+    // update the channel as mavlink_frame_char() would
+    if (mavlink1) {
+        status->flags |= MAVLINK_STATUS_FLAG_IN_MAVLINK1;
+    } else {
+        status->flags &= ~MAVLINK_STATUS_FLAG_IN_MAVLINK1;
+    }
+    status->msg_received = MAVLINK_FRAMING_OK;
+    status->parse_state = MAVLINK_PARSE_STATE_IDLE;
+    status->packet_idx = payload_len;
+    status->current_rx_seq = msg.seq;
+    if (status->packet_rx_success_count == 0) {
+        status->packet_rx_drop_count = 0;
+    }
+    status->packet_rx_success_count++;
+
+    r_status.parse_state = status->parse_state;
+    r_status.packet_idx = status->packet_idx;
+    r_status.current_rx_seq = status->current_rx_seq+1;
+    r_status.packet_rx_success_count = status->packet_rx_success_count;
+    r_status.packet_rx_drop_count = status->parse_error;
+    r_status.flags = status->flags;
+    status->parse_error = 0;
+
+    return MAVLinkFrame::OK;
+}
+
 // set a channel as private. Private channels get sent heartbeats, but
 // don't get broadcast packets or forwarded packets
 void GCS_MAVLINK::set_channel_private(mavlink_channel_t _chan)
@@ -98,6 +212,7 @@ void comm_send_buffer(mavlink_channel_t chan, const uint8_t *buf, uint8_t len)
         return;
     }
     const size_t written = mavlink_comm_port[chan]->write(buf, len);
+    mavlink_comm_tx_bytes[chan] += written;
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
     if (written < len) {
         AP_HAL::panic("Short write on UART: %lu < %u", (unsigned long)written, len);
@@ -44,6 +44,9 @@
 extern AP_HAL::UARTDriver	*mavlink_comm_port[MAVLINK_COMM_NUM_BUFFERS];
 extern bool gcs_alternative_active[MAVLINK_COMM_NUM_BUFFERS];
 
+/// bytes written to each MAVLink channel, wrapping
+extern uint32_t mavlink_comm_tx_bytes[MAVLINK_COMM_NUM_BUFFERS];
+
 /// MAVLink system definition
 extern mavlink_system_t mavlink_system;
 
@@ -66,6 +69,15 @@ void comm_send_buffer(mavlink_channel_t chan, const uint8_t *buf, uint8_t len);
 /// @returns		Number of bytes available
 uint16_t comm_get_txspace(mavlink_channel_t chan);
 
+// MAVLink2 signing uses the SHA-256 from AP_Common, which uses the
+// SHA instructions of the CPU where it has them
+#define HAVE_MAVLINK_SHA256 1
+#include <AP_Common/SHA256.h>
+typedef SHA256 mavlink_sha256_ctx;
+static inline void mavlink_sha256_init(mavlink_sha256_ctx *ctx) { ctx->init(); }
+static inline void mavlink_sha256_update(mavlink_sha256_ctx *ctx, const void *p, uint32_t len) { ctx->update(p, len); }
+static inline void mavlink_sha256_final_48(mavlink_sha256_ctx *ctx, uint8_t result[6]) { ctx->final(result, 6); }
+
 #define MAVLINK_USE_CONVENIENCE_FUNCTIONS
 #include "include/mavlink/v2.0/ardupilotmega/mavlink.h"
 
@@ -73,4 +85,23 @@ uint16_t comm_get_txspace(mavlink_channel_t chan);
 void comm_send_lock(mavlink_channel_t chan);
 void comm_send_unlock(mavlink_channel_t chan);
 
+// result of mavlink_parse_frame()
+enum class MAVLinkFrame : uint8_t {
+    OK,         // msg holds the frame, which was frame_len bytes
+    INCOMPLETE, // at least frame_len bytes are needed
+    FALLBACK,   // give these bytes to mavlink_parse_char() instead
+};
+
+/*
+  parse the frame at the start of buf in one go, rather than a byte
+  at a time. Only whole frames with a good CRC (and signature, if
+  signed) on an idle channel are parsed; msg, status and the channel
+  statistics then end up as mavlink_parse_char() would leave them
+  after the last byte of the frame. Anything else is FALLBACK, and
+  the same bytes given to mavlink_parse_char() produce the same
+  result as if this had never been called
+ */
+MAVLinkFrame mavlink_parse_frame(mavlink_channel_t chan, const uint8_t *buf, uint16_t len,
+                                 uint16_t &frame_len, mavlink_message_t &msg, mavlink_status_t &status);
+
 #pragma GCC diagnostic pop
@@ -0,0 +1,303 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GCS_StreamScheduler.h"
+
+#if HAL_GCS_STREAM_SCHEDULER_ENABLED
+
+#include <AP_Math/AP_Math.h>
+
+// size assumed for a message which has not been sent yet
+#define STREAM_SCHED_DEFAULT_MSG_SIZE 40
+
+// the budget may accumulate this much of a second's worth of bytes,
+// but always enough for the largest MAVLink2 packet
+#define STREAM_SCHED_BURST_FRACTION 0.1f
+#define STREAM_SCHED_MIN_BURST 280
+
+// free space this far below the largest seen means the transmit
+// buffer has a backlog
+#define STREAM_SCHED_BACKLOG_BYTES 8
+
+// while the budget, not the link, is limiting what we send, a burst is
+// sent this often to build a backlog the link rate can be measured from
+#define STREAM_SCHED_PROBE_INTERVAL_MS 2000
+#define STREAM_SCHED_PROBE_BURSTS 2
+
+#define STREAM_SCHED_MIN_LINK_RATE 100.0f
+
+// fixed point scale of the finish tags
+#define STREAM_SCHED_TAG_SCALE 64
+
+bool GCS_StreamScheduler::init(uint32_t baudrate, uint32_t now_ms)
+{
+    if (state == nullptr) {
+        state = new MessageState[MSG_LAST];
+        if (state == nullptr) {
+            return false;
+        }
+    }
+    // start from the nominal rate of the port; 10 bits per byte
+    link_rate_bps = MAX(baudrate / 10.0f, STREAM_SCHED_MIN_LINK_RATE);
+    last_update_ms = now_ms;
+    last_probe_ms = now_ms;
+    last_txspace = 0;
+    max_txspace = 0;
+    budget = 0;
+    sent_since_update = 0;
+    budget_limited = false;
+    virtual_time = 0;
+    return true;
+}
+
+GCS_StreamScheduler::Priority GCS_StreamScheduler::get_priority(ap_message id)
+{
+    switch (id) {
+    case MSG_HEARTBEAT:
+    case MSG_SYS_STATUS:
+    case MSG_EXTENDED_SYS_STATE:
+    case MSG_ATTITUDE:
+    case MSG_LOCATION:
+    case MSG_GPS_RAW:
+    case MSG_BATTERY_STATUS:
+    case MSG_CURRENT_WAYPOINT:
+    case MSG_MISSION_ITEM_REACHED:
+    case MSG_HOME:
+    case MSG_ORIGIN:
+    case MSG_EKF_STATUS_REPORT:
+    case MSG_FENCE_STATUS:
+    case MSG_NEXT_PARAM:
+    case MSG_COMPACT_STATE:
+        return Priority::HIGH;
+
+    case MSG_RAW_IMU:
+    case MSG_SCALED_IMU:
+    case MSG_SCALED_IMU2:
+    case MSG_SCALED_IMU3:
+    case MSG_SCALED_PRESSURE:
+    case MSG_SCALED_PRESSURE2:
+    case MSG_SCALED_PRESSURE3:
+    case MSG_SENSOR_OFFSETS:
+    case MSG_SERVO_OUTPUT_RAW:
+    case MSG_RC_CHANNELS:
+    case MSG_RC_CHANNELS_RAW:
+    case MSG_SERVO_OUT:
+    case MSG_MEMINFO:
+    case MSG_HWSTATUS:
+    case MSG_SIMSTATE:
+    case MSG_SIM_STATE:
+    case MSG_AHRS:
+    case MSG_AHRS2:
+    case MSG_PID_TUNING:
+    case MSG_VIBRATION:
+    case MSG_ESC_TELEMETRY:
+    case MSG_NAMED_FLOAT:
+    case MSG_GPS_RTK:
+    case MSG_GPS2_RTK:
+        return Priority::LOW;
+
+    default:
+        return Priority::NORMAL;
+    }
+}
+
+// time a message may be overdue before it is moved to the front of
+// the queue; zero if it never is
+uint32_t GCS_StreamScheduler::freshness_ms(ap_message id, uint16_t interval_ms) const
+{
+    switch (get_priority(id)) {
+    case Priority::HIGH:
+        return interval_ms;
+    case Priority::NORMAL:
+        return 3U * interval_ms;
+    case Priority::LOW:
+        break;
+    }
+    return 0;
+}
+
+void GCS_StreamScheduler::set_interval(ap_message id, uint16_t interval_ms, uint32_t now_ms)
+{
+    if (state == nullptr || id >= MSG_LAST) {
+        return;
+    }
+    MessageState &m = state[id];
+    if (m.interval_ms == interval_ms) {
+        return;
+    }
+    if (m.interval_ms == 0) {
+        m.due_ms = now_ms + interval_ms;
+        m.tagged = false;
+        if (m.size_bytes == 0) {
+            m.size_bytes = STREAM_SCHED_DEFAULT_MSG_SIZE;
+        }
+    }
+    m.interval_ms = interval_ms;
+}
+
+void GCS_StreamScheduler::update(uint32_t now_ms, uint32_t bytes_written, uint32_t txspace, uint8_t target_util_pct)
+{
+    if (state == nullptr) {
+        return;
+    }
+    // our own messages have already been charged to the budget
+    const uint32_t other_bytes = bytes_written > sent_since_update ? bytes_written - sent_since_update : 0;
+    sent_since_update = 0;
+
+    const uint32_t dt_ms = now_ms - last_update_ms;
+    if (dt_ms == 0) {
+        budget -= other_bytes;
+        return;
+    }
+    const float dt = dt_ms * 0.001f;
+
+    max_txspace = MAX(max_txspace, txspace);
+    const bool backlog = (last_txspace + STREAM_SCHED_BACKLOG_BYTES < max_txspace) &&
+                         (txspace + STREAM_SCHED_BACKLOG_BYTES < max_txspace);
+    if (backlog) {
+        // the buffer was never empty, so everything which drained
+        // from it is what the link carried
+        const int32_t drained = int32_t(bytes_written) + int32_t(txspace) - int32_t(last_txspace);
+        if (drained >= 0) {
+            const float measured_bps = drained / dt;
+            const float alpha = constrain_float(dt, 0.05f, 1.0f) * 0.5f;
+            link_rate_bps += (measured_bps - link_rate_bps) * alpha;
+        }
+    }
+    link_rate_bps = MAX(link_rate_bps, STREAM_SCHED_MIN_LINK_RATE);
+
+    // refill budget at the target utilisation of the link
+    const float target_bps = link_rate_bps * constrain_int16(target_util_pct, 10, 100) * 0.01f;
+    const int32_t burst = MAX(int32_t(target_bps * STREAM_SCHED_BURST_FRACTION), STREAM_SCHED_MIN_BURST);
+    budget += int32_t(target_bps * dt) - int32_t(other_bytes);
+    budget = constrain_int32(budget, -4 * burst, burst);
+    if (budget_limited && now_ms - last_probe_ms >= STREAM_SCHED_PROBE_INTERVAL_MS) {
+        // the link may be able to take more than we think
+        budget = MAX(budget, STREAM_SCHED_PROBE_BURSTS * burst);
+        last_probe_ms = now_ms;
+    }
+
+    last_update_ms = now_ms;
+    last_txspace = txspace;
+    budget_limited = false;
+}
+
+void GCS_StreamScheduler::remote_backlog()
+{
+    link_rate_bps = MAX(link_rate_bps * 0.9f, STREAM_SCHED_MIN_LINK_RATE);
+}
+
+bool GCS_StreamScheduler::next_message(uint32_t now_ms, ap_message &id)
+{
+    if (state == nullptr) {
+        return false;
+    }
+
+    bool found = false;
+    uint32_t best_tag = 0;
+    Priority best_priority = Priority::LOW;
+    for (uint8_t i=0; i<MSG_LAST; i++) {
+        MessageState &m = state[i];
+        if (m.interval_ms == 0 || int32_t(now_ms - m.due_ms) < 0) {
+            continue;
+        }
+        const ap_message msg = (ap_message)i;
+        const Priority priority = get_priority(msg);
+        if (!m.tagged) {
+            // a new instance joins the queue behind the last one sent
+            // and the previous instance of this message
+            const uint32_t start = int32_t(m.finish_tag - virtual_time) > 0 ? m.finish_tag : virtual_time;
+            const uint8_t weight = (priority == Priority::HIGH) ? 8 : (priority == Priority::NORMAL) ? 4 : 1;
+            m.finish_tag = start + m.size_bytes * STREAM_SCHED_TAG_SCALE / weight;
+            m.tagged = true;
+        }
+        uint32_t tag = m.finish_tag;
+        const uint32_t freshness = freshness_ms(msg, m.interval_ms);
+        if (freshness != 0 && now_ms - m.due_ms > freshness) {
+            // stale; serve before anything which is merely due
+            tag = virtual_time;
+        }
+        if (!found ||
+            int32_t(tag - best_tag) < 0 ||
+            (tag == best_tag && priority > best_priority)) {
+            found = true;
+            best_tag = tag;
+            best_priority = priority;
+            id = msg;
+        }
+    }
+    if (!found) {
+        return false;
+    }
+    if (budget <= 0) {
+        budget_limited = true;
+        return false;
+    }
+    return true;
+}
+
+void GCS_StreamScheduler::message_sent(ap_message id, uint32_t now_ms, uint16_t bytes)
+{
+    if (state == nullptr || id >= MSG_LAST) {
+        return;
+    }
+    MessageState &m = state[id];
+
+    const uint32_t freshness = freshness_ms(id, m.interval_ms);
+    if (freshness != 0 && now_ms - m.due_ms > freshness) {
+        m.stale++;
+    }
+
+    // advance virtual time to this message's finish
+    if (int32_t(m.finish_tag - virtual_time) > 0) {
+        virtual_time = m.finish_tag;
+    }
+    m.tagged = false;
+
+    budget -= bytes;
+    sent_since_update += bytes;
+    if (bytes != 0) {
+        m.size_bytes = (m.size_bytes * 3 + bytes + 3) / 4;
+    }
+
+    if (m.sent != 0) {
+        const float interval = now_ms - m.last_sent_ms;
+        m.achieved_interval_ms = m.sent == 1 ? interval : m.achieved_interval_ms * 0.9f + interval * 0.1f;
+    }
+    m.sent++;
+    m.last_sent_ms = now_ms;
+
+    // keep to a regular clock but do not try to catch up if we have
+    // fallen behind
+    m.due_ms += m.interval_ms;
+    if (int32_t(now_ms - m.due_ms) >= 0) {
+        m.due_ms = now_ms + m.interval_ms;
+    }
+}
+
+bool GCS_StreamScheduler::get_stats(ap_message id, MessageStats &stats) const
+{
+    if (state == nullptr || id >= MSG_LAST || state[id].interval_ms == 0) {
+        return false;
+    }
+    const MessageState &m = state[id];
+    stats.requested_hz = 1000.0f / m.interval_ms;
+    stats.achieved_hz = is_positive(m.achieved_interval_ms) ? 1000.0f / m.achieved_interval_ms : 0;
+    stats.sent = m.sent;
+    stats.stale = m.stale;
+    return true;
+}
+
+#endif // HAL_GCS_STREAM_SCHEDULER_ENABLED
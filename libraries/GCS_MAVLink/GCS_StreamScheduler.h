@@ -0,0 +1,116 @@
+/// @file	GCS_StreamScheduler.h
+/// @brief	bandwidth aware scheduling of stream-rated MAVLink messages
+#pragma once
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/AP_Common.h>
+#include "ap_message.h"
+
+#ifndef HAL_GCS_STREAM_SCHEDULER_ENABLED
+#define HAL_GCS_STREAM_SCHEDULER_ENABLED !HAL_MINIMIZE_FEATURES
+#endif
+
+#if HAL_GCS_STREAM_SCHEDULER_ENABLED
+
+/*
+  Adaptive scheduler for the stream-rated messages of one MAVLink
+  channel.
+
+  The throughput of the link is measured from how quickly the UART
+  transmit buffer drains while it has a backlog; while the link is
+  not the limit a short burst is sent every few seconds to create
+  one. Each update the
+  channel is given a byte budget of the measured throughput times a
+  target utilisation, and everything written to the channel (including
+  parameters, mission items and FTP) is charged against it.
+
+  Messages which are due are sent in weighted fair queueing order
+  (self-clocked: the virtual time is the finish tag of the last
+  message sent). High priority messages have a larger weight so they
+  get a larger share of a congested link, and a message which has
+  been due for longer than its freshness budget is moved to the front
+  of the queue.
+ */
+class GCS_StreamScheduler
+{
+public:
+
+    enum class Priority : uint8_t {
+        LOW = 0,
+        NORMAL = 1,
+        HIGH = 2,
+    };
+
+    // allocate per-message state; returns false on allocation failure
+    bool init(uint32_t baudrate, uint32_t now_ms);
+
+    // set the requested interval for a message; zero stops it
+    void set_interval(ap_message id, uint16_t interval_ms, uint32_t now_ms);
+
+    // called at the start of each send pass. bytes_written is the
+    // number of bytes written to the channel since the last call and
+    // txspace the current free space in the UART transmit buffer
+    void update(uint32_t now_ms, uint32_t bytes_written, uint32_t txspace, uint8_t target_util_pct);
+
+    // the remote radio reported its buffer filling; the link is
+    // slower than the UART drains
+    void remote_backlog();
+
+    // returns true and the message to send if one is due and fits in
+    // the budget
+    bool next_message(uint32_t now_ms, ap_message &id);
+
+    // record that id was sent using bytes bytes of link
+    void message_sent(ap_message id, uint32_t now_ms, uint16_t bytes);
+
+    // estimated throughput of the link in bytes per second
+    uint32_t link_rate() const { return uint32_t(link_rate_bps); }
+
+    // per-message statistics since boot
+    struct MessageStats {
+        float requested_hz;
+        float achieved_hz;
+        uint32_t sent;
+        uint32_t stale;     // number of times the message was late by more than its freshness budget
+    };
+    bool get_stats(ap_message id, MessageStats &stats) const;
+
+    static Priority get_priority(ap_message id);
+
+private:
+
+    struct MessageState {
+        uint16_t interval_ms;       // zero if not scheduled
+        uint16_t size_bytes;        // filtered size of the message on the link
+        uint32_t due_ms;            // time the message is next due
+        uint32_t finish_tag;        // virtual finish time of the current or last instance
+        uint32_t last_sent_ms;
+        float achieved_interval_ms; // filtered interval between sends
+        uint32_t sent;
+        uint32_t stale;
+        bool tagged;                // finish_tag belongs to the pending instance
+    };
+    MessageState *state = nullptr;
+
+    // link throughput estimate
+    float link_rate_bps;
+    uint32_t last_update_ms;
+    uint32_t last_probe_ms;
+    uint32_t last_txspace;
+    uint32_t max_txspace;
+
+    // bytes we may still write this period; may go negative when
+    // unscheduled traffic overruns the budget
+    int32_t budget;
+    uint32_t sent_since_update;
+
+    // true if a due message was held back by the budget since the last update
+    bool budget_limited;
+
+    // self-clocked virtual time
+    uint32_t virtual_time;
+
+    uint32_t freshness_ms(ap_message id, uint16_t interval_ms) const;
+};
+
+#endif // HAL_GCS_STREAM_SCHEDULER_ENABLED
@@ -27,7 +27,13 @@ extern const AP_HAL::HAL& hal;
 #define ROUTING_DEBUG 0
 
 // constructor
-MAVLink_routing::MAVLink_routing(void) : num_routes(0) {}
+MAVLink_routing::MAVLink_routing(void) :
+    num_routes(0),
+    routes_end(0)
+{
+    memset(key_head, no_route, sizeof(key_head));
+    memset(sysid_head, no_route, sizeof(sysid_head));
+}
 
 /*
   forward a MAVLink message to the right port. This also
@@ -143,36 +149,25 @@ bool MAVLink_routing::check_and_forward(mavlink_channel_t in_channel, const mavl
     bool forwarded = false;
     bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS];
     memset(sent_to_chan, 0, sizeof(sent_to_chan));
-    for (uint8_t i=0; i<num_routes; i++) {
-
-        // Skip if channel is private and the target system or component IDs do not match
-        if ((GCS_MAVLINK::is_private(routes[i].channel)) &&
-            (target_system != routes[i].sysid ||
-             target_component != routes[i].compid)) {
-            continue;
+    if (broadcast_system) {
+        // every route
+        for (uint8_t i=0; i<routes_end; i++) {
+            if (routes[i].in_use) {
+                forward_on_route(routes[i], in_channel, msg, target_system, target_component, sent_to_chan, forwarded);
+            }
         }
-
-        if (broadcast_system || (target_system == routes[i].sysid &&
-                                 (broadcast_component || 
-                                  target_component == routes[i].compid ||
-                                  !match_system))) {
-
-            if (in_channel != routes[i].channel && !sent_to_chan[routes[i].channel]) {
-                
-                if (comm_get_txspace(routes[i].channel) >= ((uint16_t)msg.len) +
-                    GCS_MAVLINK::packet_overhead_chan(routes[i].channel)) {
-#if ROUTING_DEBUG
-                    ::printf("fwd msg %u from chan %u on chan %u sysid=%d compid=%d\n",
-                             msg.msgid,
-                             (unsigned)in_channel,
-                             (unsigned)routes[i].channel,
-                             (int)target_system,
-                             (int)target_component);
-#endif
-                    _mavlink_resend_uart(routes[i].channel, &msg);
-                }
-                sent_to_chan[routes[i].channel] = true;
-                forwarded = true;
+    } else if (broadcast_component || !match_system) {
+        // every component of the target system
+        for (uint8_t i=sysid_head[sysid_hash(target_system)]; i!=no_route; i=routes[i].next_sysid) {
+            if (routes[i].sysid == target_system) {
+                forward_on_route(routes[i], in_channel, msg, target_system, target_component, sent_to_chan, forwarded);
+            }
+        }
+    } else {
+        // just the target component
+        for (uint8_t i=key_head[key_hash(target_system, target_component)]; i!=no_route; i=routes[i].next_key) {
+            if (routes[i].sysid == target_system && routes[i].compid == target_component) {
+                forward_on_route(routes[i], in_channel, msg, target_system, target_component, sent_to_chan, forwarded);
             }
         }
     }
@@ -185,6 +180,37 @@ bool MAVLink_routing::check_and_forward(mavlink_channel_t in_channel, const mavl
     return process_locally;
 }
 
+void MAVLink_routing::forward_on_route(const route &r, mavlink_channel_t in_channel, const mavlink_message_t &msg,
+                                       int16_t target_system, int16_t target_component,
+                                       bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS], bool &forwarded) const
+{
+    // Skip if channel is private and the target system or component IDs do not match
+    if ((GCS_MAVLINK::is_private(r.channel)) &&
+        (target_system != r.sysid ||
+         target_component != r.compid)) {
+        return;
+    }
+
+    if (in_channel == r.channel || sent_to_chan[r.channel]) {
+        return;
+    }
+
+    if (comm_get_txspace(r.channel) >= ((uint16_t)msg.len) +
+        GCS_MAVLINK::packet_overhead_chan(r.channel)) {
+#if ROUTING_DEBUG
+        ::printf("fwd msg %u from chan %u on chan %u sysid=%d compid=%d\n",
+                 msg.msgid,
+                 (unsigned)in_channel,
+                 (unsigned)r.channel,
+                 (int)target_system,
+                 (int)target_component);
+#endif
+        _mavlink_resend_uart(r.channel, &msg);
+    }
+    sent_to_chan[r.channel] = true;
+    forwarded = true;
+}
+
 /*
   send a MAVLink message to all components with this vehicle's system id
 
@@ -204,7 +230,7 @@ void MAVLink_routing::send_to_components(const char *pkt, const mavlink_msg_entr
     bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS] {};
 
     // check learned routes
-    for (uint8_t i=0; i<num_routes; i++) {
+    for (uint8_t i=sysid_head[sysid_hash(mavlink_system.sysid)]; i!=no_route; i=routes[i].next_sysid) {
         if (routes[i].sysid != mavlink_system.sysid) {
             // our system ID hasn't been seen on this link
             continue;
@@ -248,8 +274,8 @@ void MAVLink_routing::send_to_components(const char *pkt, const mavlink_msg_entr
 bool MAVLink_routing::find_by_mavtype(uint8_t mavtype, uint8_t &sysid, uint8_t &compid, mavlink_channel_t &channel)
 {
     // check learned routes
-    for (uint8_t i=0; i<num_routes; i++) {
-        if (routes[i].mavtype == mavtype) {
+    for (uint8_t i=0; i<routes_end; i++) {
+        if (routes[i].in_use && routes[i].mavtype == mavtype) {
             sysid = routes[i].sysid;
             compid = routes[i].compid;
             channel = routes[i].channel;
@@ -266,7 +292,6 @@ bool MAVLink_routing::find_by_mavtype(uint8_t mavtype, uint8_t &sysid, uint8_t &
 */
 void MAVLink_routing::learn_route(mavlink_channel_t in_channel, const mavlink_message_t &msg)
 {
-    uint8_t i;
     if (msg.sysid == 0) {
         // don't learn routes to the broadcast system
         return;
@@ -283,24 +308,14 @@ void MAVLink_routing::learn_route(mavlink_channel_t in_channel, const mavlink_me
         // should also process them locally.
         return;
     }
-    for (i=0; i<num_routes; i++) {
-        if (routes[i].sysid == msg.sysid &&
-            routes[i].compid == msg.compid &&
-            routes[i].channel == in_channel) {
-            if (routes[i].mavtype == 0 && msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-                routes[i].mavtype = mavlink_msg_heartbeat_get_type(&msg);
-            }
-            break;
+    const uint32_t now_ms = AP_HAL::millis();
+    uint8_t i = find_route(msg.sysid, msg.compid, in_channel);
+    if (i == no_route) {
+        i = add_route(msg.sysid, msg.compid, in_channel, now_ms);
+        if (i == no_route) {
+            // table is full of active routes
+            return;
         }
-    }
-    if (i == num_routes && i<MAVLINK_MAX_ROUTES) {
-        routes[i].sysid = msg.sysid;
-        routes[i].compid = msg.compid;
-        routes[i].channel = in_channel;
-        if (msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-            routes[i].mavtype = mavlink_msg_heartbeat_get_type(&msg);
-        }
-        num_routes++;
 #if ROUTING_DEBUG
         ::printf("learned route %u %u via %u\n",
                  (unsigned)msg.sysid,
@@ -308,6 +323,97 @@ void MAVLink_routing::learn_route(mavlink_channel_t in_channel, const mavlink_me
                  (unsigned)in_channel);
 #endif
     }
+    routes[i].last_seen_ms = now_ms;
+    if (routes[i].mavtype == 0 && msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+        routes[i].mavtype = mavlink_msg_heartbeat_get_type(&msg);
+    }
+}
+
+uint8_t MAVLink_routing::find_route(uint8_t sysid, uint8_t compid, mavlink_channel_t channel) const
+{
+    for (uint8_t i=key_head[key_hash(sysid, compid)]; i!=no_route; i=routes[i].next_key) {
+        if (routes[i].sysid == sysid &&
+            routes[i].compid == compid &&
+            routes[i].channel == channel) {
+            return i;
+        }
+    }
+    return no_route;
+}
+
+uint8_t MAVLink_routing::add_route(uint8_t sysid, uint8_t compid, mavlink_channel_t channel, uint32_t now_ms)
+{
+    uint8_t idx = no_route;
+    if (num_routes < MAVLINK_MAX_ROUTES) {
+        // use the first free slot
+        for (uint8_t i=0; i<MAVLINK_MAX_ROUTES; i++) {
+            if (!routes[i].in_use) {
+                idx = i;
+                break;
+            }
+        }
+    } else {
+        // evict the least recently seen route if it has gone stale
+        uint32_t oldest_ms = 0;
+        for (uint8_t i=0; i<routes_end; i++) {
+            const uint32_t age_ms = now_ms - routes[i].last_seen_ms;
+            if (age_ms >= MAVLINK_ROUTE_STALE_MS && age_ms >= oldest_ms) {
+                idx = i;
+                oldest_ms = age_ms;
+            }
+        }
+        if (idx == no_route) {
+            return no_route;
+        }
+#if ROUTING_DEBUG
+        ::printf("evicted route %u %u via %u\n",
+                 (unsigned)routes[idx].sysid,
+                 (unsigned)routes[idx].compid,
+                 (unsigned)routes[idx].channel);
+#endif
+        remove_route(idx);
+    }
+
+    route &r = routes[idx];
+    r.sysid = sysid;
+    r.compid = compid;
+    r.channel = channel;
+    r.mavtype = 0;
+    r.in_use = true;
+    r.last_seen_ms = now_ms;
+
+    uint8_t &khead = key_head[key_hash(sysid, compid)];
+    r.next_key = khead;
+    khead = idx;
+    uint8_t &shead = sysid_head[sysid_hash(sysid)];
+    r.next_sysid = shead;
+    shead = idx;
+
+    num_routes++;
+    routes_end = MAX(routes_end, uint8_t(idx+1));
+    return idx;
+}
+
+void MAVLink_routing::remove_route(uint8_t idx)
+{
+    route &r = routes[idx];
+
+    // unlink from both hash chains
+    for (uint8_t *p = &key_head[key_hash(r.sysid, r.compid)]; *p != no_route; p = &routes[*p].next_key) {
+        if (*p == idx) {
+            *p = r.next_key;
+            break;
+        }
+    }
+    for (uint8_t *p = &sysid_head[sysid_hash(r.sysid)]; *p != no_route; p = &routes[*p].next_sysid) {
+        if (*p == idx) {
+            *p = r.next_sysid;
+            break;
+        }
+    }
+
+    r.in_use = false;
+    num_routes--;
 }
 
 
@@ -328,7 +434,7 @@ void MAVLink_routing::handle_heartbeat(mavlink_channel_t in_channel, const mavli
     mask &= ~no_route_mask;
     
     // mask out channels that are known sources for this sysid/compid
-    for (uint8_t i=0; i<num_routes; i++) {
+    for (uint8_t i=key_head[key_hash(msg.sysid, msg.compid)]; i!=no_route; i=routes[i].next_key) {
         if (routes[i].sysid == msg.sysid && routes[i].compid == msg.compid) {
             mask &= ~(1U<<((unsigned)(routes[i].channel-MAVLINK_COMM_0)));
         }
@@ -6,9 +6,26 @@
 #include <AP_Common/AP_Common.h>
 #include "GCS_MAVLink.h"
 
-// 20 routes should be enough for now. This may need to increase as
-// we make more extensive use of MAVLink forwarding
-#define MAVLINK_MAX_ROUTES 20
+// maximum number of (sysid, compid, channel) routes. Companion
+// computers with many cameras, gimbals and other components behind
+// them can use a lot of routes
+#ifndef MAVLINK_MAX_ROUTES
+#define MAVLINK_MAX_ROUTES 64
+#endif
+
+// number of hash buckets, must be a power of two
+#ifndef MAVLINK_ROUTE_HASH_SIZE
+#define MAVLINK_ROUTE_HASH_SIZE 64
+#endif
+
+// a route which has not been used for this long may be evicted to
+// make room for a new one when the table is full
+#ifndef MAVLINK_ROUTE_STALE_MS
+#define MAVLINK_ROUTE_STALE_MS 10000
+#endif
+
+static_assert(MAVLINK_MAX_ROUTES < 255, "route indexes must fit in a uint8_t");
+static_assert((MAVLINK_ROUTE_HASH_SIZE & (MAVLINK_ROUTE_HASH_SIZE-1)) == 0, "MAVLINK_ROUTE_HASH_SIZE must be a power of two");
 
 /*
   object to handle MAVLink packet routing
@@ -45,15 +62,49 @@ public:
     bool find_by_mavtype(uint8_t mavtype, uint8_t &sysid, uint8_t &compid, mavlink_channel_t &channel);
 
 private:
-    // a simple linear routing table. We don't expect to have a lot of
-    // routes, so a scalable structure isn't worthwhile yet.
+    // routing table. Routes are hashed on (sysid, compid) for
+    // targeted messages and on sysid alone for messages targeted at
+    // all components of a system. Each bucket is a chain of indexes
+    // into routes[]
+    static const uint8_t no_route = 255;
     uint8_t num_routes;
     struct route {
         uint8_t sysid;
         uint8_t compid;
         mavlink_channel_t channel;
         uint8_t mavtype;
+        bool in_use;
+        uint8_t next_key;       // next route with the same (sysid, compid) hash
+        uint8_t next_sysid;     // next route with the same sysid hash
+        uint32_t last_seen_ms;
     } routes[MAVLINK_MAX_ROUTES];
+    uint8_t key_head[MAVLINK_ROUTE_HASH_SIZE];
+    uint8_t sysid_head[MAVLINK_ROUTE_HASH_SIZE];
+
+    // one past the highest routes[] index in use
+    uint8_t routes_end;
+
+    static uint8_t key_hash(uint8_t sysid, uint8_t compid) {
+        uint16_t h = (uint16_t(sysid) << 8 | compid) * 40503U;
+        return (h >> 8) & (MAVLINK_ROUTE_HASH_SIZE-1);
+    }
+    static uint8_t sysid_hash(uint8_t sysid) {
+        return uint8_t(sysid * 157U) & (MAVLINK_ROUTE_HASH_SIZE-1);
+    }
+
+    // return index of the route for (sysid, compid, channel) or no_route
+    uint8_t find_route(uint8_t sysid, uint8_t compid, mavlink_channel_t channel) const;
+
+    // add a route, evicting the least recently used stale route if the
+    // table is full. Returns the new index or no_route
+    uint8_t add_route(uint8_t sysid, uint8_t compid, mavlink_channel_t channel, uint32_t now_ms);
+    void remove_route(uint8_t idx);
+
+    // forward msg on the route if it passes the private channel check
+    // and has not already been sent on that channel
+    void forward_on_route(const route &r, mavlink_channel_t in_channel, const mavlink_message_t &msg,
+                          int16_t target_system, int16_t target_component,
+                          bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS], bool &forwarded) const;
     
     // a channel mask to block routing as required
     uint8_t no_route_mask;
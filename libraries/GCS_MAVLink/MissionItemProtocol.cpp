@@ -18,10 +18,39 @@ void MissionItemProtocol::init_send_requests(GCS_MAVLINK &_link,
 
     link = &_link;
 
+    free_window();
+    window = MIN(_link.get_mission_window(), MISSION_ITEM_PROTOCOL_MAX_WINDOW);
+    if (window > 1) {
+        window_items = new mavlink_mission_item_int_t[window];
+        if (window_items == nullptr) {
+            window = 1;
+        }
+    }
+
     timelast_request_ms = AP_HAL::millis();
     link->send_message(next_item_ap_message_id());
 }
 
+void MissionItemProtocol::free_window()
+{
+    delete[] window_items;
+    window_items = nullptr;
+    window = 1;
+    requested_mask = 0;
+    received_mask = 0;
+}
+
+// mask of the bits in requested_mask and received_mask which are
+// for items still to be uploaded
+uint32_t MissionItemProtocol::window_mask() const
+{
+    const uint16_t remaining = request_last - request_i + 1;
+    if (remaining >= 32 && window >= 32) {
+        return 0xFFFFFFFFU;
+    }
+    return (1U << MIN(remaining, uint16_t(window))) - 1;
+}
+
 void MissionItemProtocol::handle_mission_clear_all(const GCS_MAVLINK &_link,
                                                    const mavlink_message_t &msg)
 {
@@ -219,8 +248,12 @@ void MissionItemProtocol::handle_mission_item(const mavlink_message_t &msg, cons
         return;
     }
 
-    // check if this is the requested waypoint
-    if (cmd.seq != request_i) {
+    // check if this is one of the requested waypoints
+    if (cmd.seq < request_i || cmd.seq - request_i >= window || cmd.seq > request_last) {
+        if (window > 1 && cmd.seq < request_i) {
+            // a repeat of an item we have already stored
+            return;
+        }
         send_mission_ack(msg, MAV_MISSION_INVALID_SEQUENCE);
         return;
     }
@@ -234,31 +267,38 @@ void MissionItemProtocol::handle_mission_item(const mavlink_message_t &msg, cons
         return;
     }
 
-    const uint16_t _item_count = item_count();
+    timelast_receive_ms = AP_HAL::millis();
 
-    MAV_MISSION_RESULT result;
-    if (cmd.seq < _item_count) {
-        // command index is within the existing list, replace the command
-        result = replace_item(cmd);
-    } else if (cmd.seq == _item_count) {
-        // command is at the end of command list, add the command
-        result = append_item(cmd);
-    } else {
-        // beyond the end of the command list, return an error
-        result = MAV_MISSION_ERROR;
+    const uint8_t ofs = cmd.seq - request_i;
+    if (ofs != 0) {
+        // hold the item until the ones before it have arrived
+        if ((received_mask & (1U<<ofs)) == 0) {
+            window_items[cmd.seq % window] = cmd;
+            received_mask |= 1U<<ofs;
+        }
+        return;
+    }
+
+    // store this item and any held items which follow it
+    MAV_MISSION_RESULT result = store_item(cmd);
+    while (result == MAV_MISSION_ACCEPTED) {
+        request_i++;
+        requested_mask >>= 1;
+        received_mask >>= 1;
+        if ((received_mask & 1U) == 0) {
+            break;
+        }
+        result = store_item(window_items[request_i % window]);
     }
     if (result != MAV_MISSION_ACCEPTED) {
         send_mission_ack(msg, result);
         receiving = false;
         link = nullptr;
         free_upload_resources();
+        free_window();
         return;
     }
 
-    // update waypoint receiving state machine
-    timelast_receive_ms = AP_HAL::millis();
-    request_i++;
-
     if (request_i > request_last) {
         transfer_is_complete(*link, msg);
         return;
@@ -271,11 +311,28 @@ void MissionItemProtocol::handle_mission_item(const mavlink_message_t &msg, cons
     }
 }
 
+MAV_MISSION_RESULT MissionItemProtocol::store_item(const mavlink_mission_item_int_t &cmd)
+{
+    const uint16_t _item_count = item_count();
+
+    if (cmd.seq < _item_count) {
+        // command index is within the existing list, replace the command
+        return replace_item(cmd);
+    }
+    if (cmd.seq == _item_count) {
+        // command is at the end of command list, add the command
+        return append_item(cmd);
+    }
+    // beyond the end of the command list, return an error
+    return MAV_MISSION_ERROR;
+}
+
 void MissionItemProtocol::transfer_is_complete(const GCS_MAVLINK &_link, const mavlink_message_t &msg)
 {
     const MAV_MISSION_RESULT result = complete(_link);
     send_mission_ack(_link, msg, result);
     free_upload_resources();
+    free_window();
     receiving = false;
     link = nullptr;
 }
@@ -301,8 +358,9 @@ void MissionItemProtocol::send_mission_ack(const GCS_MAVLINK &_link,
 }
 
 /**
- * @brief Send the next pending waypoint, called from deferred message
- * handling code
+ * @brief Send requests for the pending waypoints in the window which
+ * have not been requested yet, called from deferred message handling
+ * code
  */
 void MissionItemProtocol::queued_request_send()
 {
@@ -316,13 +374,24 @@ void MissionItemProtocol::queued_request_send()
         INTERNAL_ERROR(AP_InternalError::error_t::gcs_bad_missionprotocol_link);
         return;
     }
-    mavlink_msg_mission_request_send(
-        link->get_chan(),
-        dest_sysid,
-        dest_compid,
-        request_i,
-        mission_type());
-    timelast_request_ms = AP_HAL::millis();
+    const uint32_t pending = window_mask() & ~(requested_mask | received_mask);
+    for (uint8_t i=0; i<window; i++) {
+        if ((pending & (1U<<i)) == 0) {
+            continue;
+        }
+        if (!HAVE_PAYLOAD_SPACE(link->get_chan(), MISSION_REQUEST)) {
+            // update() will queue the rest
+            break;
+        }
+        mavlink_msg_mission_request_send(
+            link->get_chan(),
+            dest_sysid,
+            dest_compid,
+            request_i + i,
+            mission_type());
+        requested_mask |= 1U<<i;
+        timelast_request_ms = AP_HAL::millis();
+    }
 }
 
 void MissionItemProtocol::update()
@@ -347,12 +416,18 @@ void MissionItemProtocol::update()
                                      mission_type());
         link = nullptr;
         free_upload_resources();
+        free_window();
         return;
     }
     // resend request if we haven't gotten one:
     const uint32_t wp_recv_timeout_ms = 1000U + link->get_stream_slowdown_ms();
     if (tnow - timelast_request_ms > wp_recv_timeout_ms) {
         timelast_request_ms = tnow;
+        // request again only the items which have not arrived
+        requested_mask = 0;
+        link->send_message(next_item_ap_message_id());
+    } else if ((window_mask() & ~(requested_mask | received_mask)) != 0) {
+        // fill the window as link space allows
         link->send_message(next_item_ap_message_id());
     }
 }
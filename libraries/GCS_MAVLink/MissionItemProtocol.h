@@ -21,6 +21,16 @@
 // Starting of uploads (for the same protocol) is also blocked -
 // essentially the GCS uploading a set of items (e.g. a mission) has a
 // mutex over the mission.
+//
+// When the link's mission window is larger than one, several items are
+// requested at once.  Items which arrive ahead of the next one to be
+// stored are held until the gap is filled, and on a timeout only the
+// items in the window which have not been received are requested
+// again.
+
+// largest number of items which may be requested at once
+#define MISSION_ITEM_PROTOCOL_MAX_WINDOW 32
+
 class MissionItemProtocol
 {
 public:
@@ -79,6 +89,17 @@ private:
 
     uint16_t        request_i; // request index
 
+    // items requested at once, and the items held because they
+    // arrived before request_i.  Bit n of the masks is for item
+    // request_i+n, which is held in window_items[(request_i+n) % window]
+    uint8_t         window = 1;
+    uint32_t        requested_mask;
+    uint32_t        received_mask;
+    mavlink_mission_item_int_t *window_items;
+    void free_window();
+    uint32_t window_mask() const;
+    MAV_MISSION_RESULT store_item(const mavlink_mission_item_int_t &cmd);
+
     // waypoints
     uint8_t         dest_sysid;  // where to send requests
     uint8_t         dest_compid; // "
@@ -76,5 +76,6 @@ enum ap_message : uint8_t {
     MSG_EFI_STATUS,
     MSG_GENERATOR_STATUS,
     MSG_WINCH_STATUS,
+    MSG_COMPACT_STATE,
     MSG_LAST // MSG_LAST must be the last entry in this enum
 };
@@ -0,0 +1,166 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <GCS_MAVLink/GCS.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+/*
+  cost of parsing a capture of mixed telemetry with the byte parser
+  and with the block parser used by GCS_MAVLINK::update_receive(). The
+  argument selects the capture: 0 is clean traffic, 1 adds line noise
+  and corrupted frames, 2 is clean traffic with every packet
+  signed. items/s is the number of bytes parsed per second
+ */
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+const AP_Param::GroupInfo GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+
+GCS_Dummy _gcs;
+
+static const mavlink_channel_t tx_chan = MAVLINK_COMM_0;
+static const mavlink_channel_t rx_chan = MAVLINK_COMM_1;
+
+static uint8_t capture[32768];
+static uint32_t capture_len;
+static uint32_t capture_packets;
+
+static mavlink_signing_t signing[2];
+static mavlink_signing_streams_t signing_streams;
+
+static void add_msg(const mavlink_message_t &msg)
+{
+    capture_len += mavlink_msg_to_send_buffer(&capture[capture_len], &msg);
+    capture_packets++;
+}
+
+static void set_signing(mavlink_channel_t chan, mavlink_signing_t *s)
+{
+    mavlink_status_t *status = mavlink_get_channel_status(chan);
+    status->signing = s;
+    status->signing_streams = s ? &signing_streams : nullptr;
+    if (s == nullptr) {
+        return;
+    }
+    memset(s, 0, sizeof(*s));
+    memset(s->secret_key, 0x5a, sizeof(s->secret_key));
+    s->link_id = (uint8_t)chan;
+    s->timestamp = 1;
+    s->flags = MAVLINK_SIGNING_FLAG_SIGN_OUTGOING;
+}
+
+// a second or so of the telemetry a vehicle sends to a GCS
+static void make_capture(uint8_t type)
+{
+    capture_len = 0;
+    capture_packets = 0;
+    memset(&signing_streams, 0, sizeof(signing_streams));
+    set_signing(tx_chan, type == 2 ? &signing[0] : nullptr);
+    mavlink_reset_channel_status(rx_chan);
+    set_signing(rx_chan, type == 2 ? &signing[1] : nullptr);
+
+    mavlink_message_t msg;
+    uint16_t seq = 0;
+    while (capture_len + 4 * MAVLINK_MAX_PACKET_LEN < sizeof(capture)) {
+        switch (seq % 8) {
+        case 0:
+            mavlink_msg_heartbeat_pack_chan(1, 1, tx_chan, &msg, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_ARDUPILOTMEGA, 0, 0, MAV_STATE_ACTIVE);
+            break;
+        case 1:
+        case 5:
+            mavlink_msg_attitude_pack_chan(1, 1, tx_chan, &msg, seq, 0.1, -0.2, 1.5, 0.01, 0.02, 0);
+            break;
+        case 2:
+        case 6:
+            mavlink_msg_global_position_int_pack_chan(1, 1, tx_chan, &msg, seq, -353632610, 1491652370, 584000, 10000, 120, -30, 0, 9000);
+            break;
+        case 3:
+            mavlink_msg_vfr_hud_pack_chan(1, 1, tx_chan, &msg, 12.5, 12.1, 90, 55, 584, 0.3);
+            break;
+        case 4:
+            mavlink_msg_param_value_pack_chan(1, 1, tx_chan, &msg, "SERIAL1_BAUD", 921, MAV_PARAM_TYPE_INT32, 900, seq);
+            break;
+        case 7: {
+            uint8_t payload[251] {};
+            memset(payload, seq, 200);
+            mavlink_msg_file_transfer_protocol_pack_chan(1, 1, tx_chan, &msg, 0, 255, 0, payload);
+            break;
+        }
+        }
+        add_msg(msg);
+
+        if (type == 1 && seq % 16 == 9) {
+            // a burst of line noise, then a frame with a bad CRC
+            for (uint8_t i=0; i<23; i++) {
+                capture[capture_len++] = (uint8_t)(seq * 31 + i * 7);
+            }
+            mavlink_msg_attitude_pack_chan(1, 1, tx_chan, &msg, seq, 0.1, -0.2, 1.5, 0.01, 0.02, 0);
+            const uint16_t len = mavlink_msg_to_send_buffer(&capture[capture_len], &msg);
+            capture[capture_len + len/2] ^= 0x55;
+            capture_len += len;
+        }
+        seq++;
+    }
+}
+
+static void BM_ParseChar(benchmark::State& state)
+{
+    make_capture(state.range(0));
+    mavlink_message_t msg;
+    mavlink_status_t status;
+    uint32_t packets = 0;
+    while (state.KeepRunning()) {
+        // the capture repeats, so forget the signing timestamps
+        memset(&signing_streams, 0, sizeof(signing_streams));
+        for (uint32_t i=0; i<capture_len; i++) {
+            if (mavlink_parse_char(rx_chan, capture[i], &msg, &status)) {
+                packets++;
+            }
+        }
+        gbenchmark_escape(&msg);
+    }
+    if (packets != capture_packets * state.iterations()) {
+        state.SetLabel("packets lost");
+    }
+    state.SetItemsProcessed(state.iterations() * capture_len);
+}
+
+// whole frames as a block, falling back to the byte parser as
+// update_receive() does
+static void BM_ParseBlock(benchmark::State& state)
+{
+    make_capture(state.range(0));
+    mavlink_message_t msg;
+    mavlink_status_t status;
+    uint32_t packets = 0;
+    while (state.KeepRunning()) {
+        // the capture repeats, so forget the signing timestamps
+        memset(&signing_streams, 0, sizeof(signing_streams));
+        uint32_t ofs = 0;
+        while (ofs < capture_len) {
+            const uint16_t len = MIN(capture_len - ofs, MAVLINK_MAX_PACKET_LEN);
+            uint16_t frame_len;
+            if (mavlink_parse_frame(rx_chan, &capture[ofs], len, frame_len, msg, status) == MAVLinkFrame::OK) {
+                packets++;
+                ofs += frame_len;
+                continue;
+            }
+            if (mavlink_parse_char(rx_chan, capture[ofs], &msg, &status)) {
+                packets++;
+            }
+            ofs++;
+        }
+        gbenchmark_escape(&msg);
+    }
+    if (packets != capture_packets * state.iterations()) {
+        state.SetLabel("packets lost");
+    }
+    state.SetItemsProcessed(state.iterations() * capture_len);
+}
+
+BENCHMARK(BM_ParseChar)->Arg(0)->Arg(1)->Arg(2);
+BENCHMARK(BM_ParseBlock)->Arg(0)->Arg(1)->Arg(2);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,94 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <GCS_MAVLink/GCS.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+/*
+  cost of routing a message with a routing table full of components
+  spread across several channels, as on a companion computer with
+  many cameras and gimbals behind it. Each iteration routes one
+  message so items/s is the number of messages per second a single
+  core can route
+ */
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+const AP_Param::GroupInfo GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+
+GCS_Dummy _gcs;
+
+static const uint8_t num_channels = 4;
+static const uint8_t num_systems = 6;
+static const uint8_t num_components = 10;
+
+// learn one route per (system, component), systems spread over channels
+static void setup_routes(MAVLink_routing &routing)
+{
+    mavlink_heartbeat_t heartbeat {};
+    heartbeat.type = MAV_TYPE_CAMERA;
+    for (uint8_t s=0; s<num_systems; s++) {
+        const mavlink_channel_t chan = (mavlink_channel_t)(MAVLINK_COMM_0 + s % num_channels);
+        for (uint8_t c=0; c<num_components; c++) {
+            mavlink_message_t msg;
+            mavlink_msg_heartbeat_encode(100+s, MAV_COMP_ID_CAMERA+c, &msg, &heartbeat);
+            routing.check_and_forward(chan, msg);
+        }
+    }
+}
+
+// COMMAND_LONG to a specific component
+static void BM_RoutingTargeted(benchmark::State& state)
+{
+    MAVLink_routing routing;
+    setup_routes(routing);
+
+    mavlink_message_t msgs[num_systems*num_components];
+    for (uint8_t s=0; s<num_systems; s++) {
+        for (uint8_t c=0; c<num_components; c++) {
+            mavlink_command_long_t cmd {};
+            cmd.target_system = 100+s;
+            cmd.target_component = MAV_COMP_ID_CAMERA+c;
+            mavlink_msg_command_long_encode(255, MAV_COMP_ID_MISSIONPLANNER, &msgs[s*num_components+c], &cmd);
+        }
+    }
+
+    uint16_t i = 0;
+    while (state.KeepRunning()) {
+        const mavlink_channel_t in_chan = (mavlink_channel_t)(MAVLINK_COMM_0 + i % num_channels);
+        bool local = routing.check_and_forward(in_chan, msgs[i % ARRAY_SIZE(msgs)]);
+        gbenchmark_escape(&local);
+        i++;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// messages from components which are not targeted, e.g. telemetry
+// from cameras, which are forwarded everywhere
+static void BM_RoutingBroadcast(benchmark::State& state)
+{
+    MAVLink_routing routing;
+    setup_routes(routing);
+
+    mavlink_message_t msgs[num_systems];
+    for (uint8_t s=0; s<num_systems; s++) {
+        mavlink_attitude_t attitude {};
+        mavlink_msg_attitude_encode(100+s, MAV_COMP_ID_CAMERA, &msgs[s], &attitude);
+    }
+
+    uint16_t i = 0;
+    while (state.KeepRunning()) {
+        const uint8_t s = i % num_systems;
+        bool local = routing.check_and_forward((mavlink_channel_t)(MAVLINK_COMM_0 + s % num_channels), msgs[s]);
+        gbenchmark_escape(&local);
+        i++;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_RoutingTargeted);
+BENCHMARK(BM_RoutingBroadcast);
+
+BENCHMARK_MAIN();
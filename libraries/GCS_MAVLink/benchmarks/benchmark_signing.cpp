@@ -0,0 +1,113 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/SHA256.h>
+#include <GCS_MAVLink/GCS.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+/*
+  cost of MAVLink2 signing with each SHA-256 kernel. The first
+  argument is the kernel, the second the payload length. A channel
+  signs or checks its packets on one thread, so items/s is the number
+  of signed packets per second one channel can handle
+ */
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+const AP_Param::GroupInfo GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+
+GCS_Dummy _gcs;
+
+static const mavlink_channel_t tx_chan = MAVLINK_COMM_0;
+static const mavlink_channel_t rx_chan = MAVLINK_COMM_1;
+
+static mavlink_signing_t signing[2];
+static mavlink_signing_streams_t signing_streams;
+
+static void setup_signing(mavlink_channel_t chan, mavlink_signing_t &s)
+{
+    memset(&s, 0, sizeof(s));
+    memset(s.secret_key, 0x5a, sizeof(s.secret_key));
+    s.link_id = (uint8_t)chan;
+    s.timestamp = 1;
+    s.flags = MAVLINK_SIGNING_FLAG_SIGN_OUTGOING;
+    mavlink_status_t *status = mavlink_get_channel_status(chan);
+    status->signing = &s;
+    status->signing_streams = &signing_streams;
+}
+
+// select the kernel, or label the benchmark if this CPU lacks it
+static bool setup(benchmark::State& state)
+{
+    if (!SHA256::set_kernel((SHA256::Kernel)state.range(0))) {
+        state.SetLabel("not supported");
+        while (state.KeepRunning()) {
+        }
+        return false;
+    }
+    memset(&signing_streams, 0, sizeof(signing_streams));
+    setup_signing(tx_chan, signing[0]);
+    setup_signing(rx_chan, signing[1]);
+    return true;
+}
+
+// FILE_TRANSFER_PROTOCOL payload giving a packet of payload_len
+// bytes; MAVLink2 drops trailing zeros
+static void fill_payload(uint8_t payload[251], uint8_t payload_len)
+{
+    const uint8_t data_len = payload_len > 3 ? payload_len - 3 : 1;
+    memset(payload, 0, 251);
+    memset(payload, 0x11, data_len);
+}
+
+static void BM_SignPacket(benchmark::State& state)
+{
+    if (!setup(state)) {
+        return;
+    }
+    uint8_t payload[251];
+    fill_payload(payload, state.range(1));
+    mavlink_message_t msg;
+    while (state.KeepRunning()) {
+        mavlink_msg_file_transfer_protocol_pack_chan(1, 1, tx_chan, &msg, 0, 255, 0, payload);
+        gbenchmark_escape(&msg);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// sign on one channel and check the signature on another
+static void BM_SignAndCheckPacket(benchmark::State& state)
+{
+    if (!setup(state)) {
+        return;
+    }
+    uint8_t payload[251];
+    fill_payload(payload, state.range(1));
+    mavlink_message_t msg;
+    mavlink_message_t rx_msg;
+    mavlink_status_t rx_status;
+    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+    uint32_t accepted = 0;
+    while (state.KeepRunning()) {
+        mavlink_msg_file_transfer_protocol_pack_chan(1, 1, tx_chan, &msg, 0, 255, 0, payload);
+        const uint16_t len = mavlink_msg_to_send_buffer(buf, &msg);
+        for (uint16_t i=0; i<len; i++) {
+            if (mavlink_parse_char(rx_chan, buf[i], &rx_msg, &rx_status)) {
+                accepted++;
+            }
+        }
+    }
+    if (accepted != state.iterations()) {
+        state.SetLabel("signature check failed");
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_SignPacket)->ArgPair(0, 10)->ArgPair(1, 10)->ArgPair(2, 10)
+                        ->ArgPair(0, 254)->ArgPair(1, 254)->ArgPair(2, 254);
+BENCHMARK(BM_SignAndCheckPacket)->ArgPair(0, 10)->ArgPair(1, 10)->ArgPair(2, 10)
+                                ->ArgPair(0, 254)->ArgPair(1, 254)->ArgPair(2, 254);
+
+BENCHMARK_MAIN();
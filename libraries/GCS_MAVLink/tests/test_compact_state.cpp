@@ -0,0 +1,135 @@
+#include <AP_gtest.h>
+
+#include <GCS_MAVLink/GCS_Dummy.h>
+#include <GCS_MAVLink/GCS_CompactState.h>
+
+/*
+  encode compact state schemas and frames and decode them again the
+  way a listener on a companion computer would
+ */
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+GCS_Dummy _gcs;
+
+#if HAL_GCS_COMPACT_STATE_ENABLED
+
+typedef GCS_CompactState CS;
+
+static uint32_t field_bit(CS::Field f)
+{
+    return 1U << uint8_t(f);
+}
+
+static CS::Values test_values(void)
+{
+    CS::Values v {};
+    for (uint8_t i=0; i<uint8_t(CS::Field::NUM_FIELDS); i++) {
+        for (uint8_t j=0; j<CS::MAX_ELEMENTS; j++) {
+            if (CS::Field(i) == CS::Field::LOCATION) {
+                v.field[i][j].i = -350000000 + i*1000 + j;
+            } else {
+                v.field[i][j].f = i + j*0.25f;
+            }
+        }
+    }
+    return v;
+}
+
+TEST(GCS_CompactState, RoundTrip)
+{
+    const uint32_t mask = field_bit(CS::Field::ATTITUDE) |
+        field_bit(CS::Field::QUATERNION) |
+        field_bit(CS::Field::LOCATION) |
+        field_bit(CS::Field::EKF_VARIANCES);
+    uint8_t data[CS::MAX_LEN];
+
+    const uint8_t schema_len = CS::encode_schema(7, mask, data);
+    CS::Layout layout {};
+    ASSERT_TRUE(CS::decode_schema(CS::DATA96_TYPE_SCHEMA, data, schema_len, layout));
+    EXPECT_EQ(7, layout.schema_id);
+    ASSERT_EQ(4, layout.num_fields);
+    EXPECT_EQ(uint8_t(CS::Field::LOCATION), layout.entries[2].field);
+    EXPECT_EQ(uint8_t(CS::ElementType::INT32), layout.entries[2].type);
+    EXPECT_EQ(5, layout.entries[3].count);
+
+    CS::Values in = test_values();
+    // location is not current
+    in.valid = mask & ~field_bit(CS::Field::LOCATION);
+    const uint8_t frame_len = CS::encode_frame(7, 1234, 5678901, mask, in, data);
+    EXPECT_LE(frame_len, unsigned(CS::MAX_LEN));
+
+    CS::Values out {};
+    uint16_t seq;
+    uint32_t time_us;
+    ASSERT_TRUE(CS::decode_frame(CS::DATA96_TYPE_FRAME, data, frame_len, layout, seq, time_us, out));
+    EXPECT_EQ(1234, seq);
+    EXPECT_EQ(5678901U, time_us);
+    EXPECT_EQ(in.valid, out.valid);
+    for (uint8_t n=0; n<layout.num_fields; n++) {
+        const uint8_t f = layout.entries[n].field;
+        for (uint8_t j=0; j<layout.entries[n].count; j++) {
+            EXPECT_EQ(in.field[f][j].i, out.field[f][j].i);
+        }
+    }
+}
+
+TEST(GCS_CompactState, FieldsThatDontFit)
+{
+    // all fields need more than 96 bytes; the schema and frame both
+    // drop the ones after the frame is full
+    const uint32_t mask = (1U << uint8_t(CS::Field::NUM_FIELDS)) - 1;
+    uint8_t data[CS::MAX_LEN];
+    CS::Layout layout {};
+    ASSERT_TRUE(CS::decode_schema(CS::DATA96_TYPE_SCHEMA, data, CS::encode_schema(1, mask, data), layout));
+    EXPECT_LT(layout.num_fields, uint8_t(CS::Field::NUM_FIELDS));
+
+    CS::Values in = test_values();
+    in.valid = mask;
+    CS::Values out {};
+    uint16_t seq;
+    uint32_t time_us;
+    const uint8_t len = CS::encode_frame(1, 0, 0, mask, in, data);
+    ASSERT_TRUE(CS::decode_frame(CS::DATA96_TYPE_FRAME, data, len, layout, seq, time_us, out));
+    const auto &last = layout.entries[layout.num_fields-1];
+    EXPECT_EQ(len, last.offset + last.count*4);
+    // only the fields in the frame are valid
+    EXPECT_EQ((1U << layout.num_fields) - 1, out.valid);
+}
+
+TEST(GCS_CompactState, RejectsOtherData96)
+{
+    const uint32_t mask = field_bit(CS::Field::ATTITUDE);
+    uint8_t data[CS::MAX_LEN];
+    const uint8_t schema_len = CS::encode_schema(3, mask, data);
+    CS::Layout layout {};
+    ASSERT_TRUE(CS::decode_schema(CS::DATA96_TYPE_SCHEMA, data, schema_len, layout));
+
+    // the same bytes under another type
+    EXPECT_FALSE(CS::decode_schema(42, data, schema_len, layout));
+    EXPECT_FALSE(CS::decode_schema(CS::DATA96_TYPE_FRAME, data, schema_len, layout));
+
+    CS::Values in = test_values();
+    uint16_t seq;
+    uint32_t time_us;
+    CS::Values out {};
+    uint8_t len = CS::encode_frame(3, 0, 0, mask, in, data);
+    ASSERT_TRUE(CS::decode_frame(CS::DATA96_TYPE_FRAME, data, len, layout, seq, time_us, out));
+
+    // another user's DATA96 with the same type but no magic byte
+    data[0] = 0;
+    EXPECT_FALSE(CS::is_compact_state(CS::DATA96_TYPE_FRAME, data, len));
+    EXPECT_FALSE(CS::decode_frame(CS::DATA96_TYPE_FRAME, data, len, layout, seq, time_us, out));
+
+    // a frame from a schema we have not seen
+    len = CS::encode_frame(4, 0, 0, mask, in, data);
+    EXPECT_FALSE(CS::decode_frame(CS::DATA96_TYPE_FRAME, data, len, layout, seq, time_us, out));
+
+    // truncated
+    len = CS::encode_frame(3, 0, 0, mask, in, data);
+    EXPECT_FALSE(CS::decode_frame(CS::DATA96_TYPE_FRAME, data, len-1, layout, seq, time_us, out));
+}
+
+#endif // HAL_GCS_COMPACT_STATE_ENABLED
+
+AP_GTEST_MAIN()
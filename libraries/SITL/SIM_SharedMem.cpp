@@ -0,0 +1,240 @@
+/*
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*
+    Simulator Connector for physics over shared memory
+*/
+
+#include "SIM_SharedMem.h"
+
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <AP_HAL/AP_HAL.h>
+
+#define SHM_TIMEOUT_MS 100
+
+extern const AP_HAL::HAL& hal;
+
+using namespace SITL;
+
+static const struct {
+    const char *name;
+    float value;
+} sim_defaults[] = {
+    { "BRD_OPTIONS", 0},
+    { "INS_GYR_CAL", 0 },
+    { "INS_ACC2OFFS_X",    0.001 },
+    { "INS_ACC2OFFS_Y",    0.001 },
+    { "INS_ACC2OFFS_Z",    0.001 },
+    { "INS_ACC2SCAL_X",    1.001 },
+    { "INS_ACC2SCAL_Y",    1.001 },
+    { "INS_ACC2SCAL_Z",    1.001 },
+    { "INS_ACCOFFS_X",     0.001 },
+    { "INS_ACCOFFS_Y",     0.001 },
+    { "INS_ACCOFFS_Z",     0.001 },
+    { "INS_ACCSCAL_X",     1.001 },
+    { "INS_ACCSCAL_Y",     1.001 },
+    { "INS_ACCSCAL_Z",     1.001 },
+};
+
+SharedMem::SharedMem(const char *frame_str) :
+    Aircraft(frame_str)
+{
+    printf("Starting SITL: SharedMem\n");
+
+    const char *colon = strchr(frame_str, ':');
+    if (colon) {
+        shm_name = colon+1;
+    }
+
+    for (uint8_t i=0; i<ARRAY_SIZE(sim_defaults); i++) {
+        AP_Param::set_default_by_name(sim_defaults[i].name, sim_defaults[i].value);
+    }
+}
+
+/*
+  create the shared memory and start a new generation of frames. The
+  instance number is only known after construction so this is done
+  on the first update
+ */
+bool SharedMem::map_region(void)
+{
+    char default_name[32];
+    if (shm_name == nullptr) {
+        snprintf(default_name, sizeof(default_name), SIM_SHM_DEFAULT_PREFIX "%u", (unsigned)instance);
+        shm_name = strdup(default_name);
+    }
+
+    const int fd = shm_open(shm_name, O_RDWR | O_CREAT, 0600);
+    if (fd == -1) {
+        printf("shm_open(%s) failed: %s\n", shm_name, strerror(errno));
+        return false;
+    }
+    if (ftruncate(fd, sizeof(sim_shm_region)) != 0) {
+        printf("ftruncate(%s) failed: %s\n", shm_name, strerror(errno));
+        close(fd);
+        return false;
+    }
+    void *p = mmap(nullptr, sizeof(sim_shm_region), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        printf("mmap(%s) failed: %s\n", shm_name, strerror(errno));
+        return false;
+    }
+    region = (sim_shm_region *)p;
+
+    // a physics process still attached from a previous run sees the
+    // magic cleared and the generation change, then starts again
+    const uint32_t generation = region->generation + 1;
+    __atomic_store_n(&region->magic, 0U, __ATOMIC_RELEASE);
+    memset((void *)region, 0, sizeof(*region));
+    region->version = SIM_SHM_VERSION;
+    region->ring_length = SIM_SHM_RING_LENGTH;
+    region->region_size = sizeof(sim_shm_region);
+    region->generation = generation;
+    __atomic_store_n(&region->magic, uint32_t(SIM_SHM_MAGIC), __ATOMIC_RELEASE);
+
+    printf("SharedMem physics interface at %s\n", shm_name);
+    return true;
+}
+
+/*
+    send servos
+*/
+void SharedMem::output_servos(const struct sitl_input &input)
+{
+    sim_shm_servos pkt {};
+    pkt.frame_count = frame_counter;
+    pkt.frame_rate = rate_hz;
+    for (uint8_t i=0; i<SIM_SHM_NUM_SERVOS; i++) {
+        pkt.pwm[i] = input.servos[i];
+    }
+    pkt.sent_ns = sim_shm_time_ns();
+    last_sent_ns = pkt.sent_ns;
+
+    // in lockstep there is never more than one frame waiting, so a
+    // full ring means the physics process has stopped
+    while (!sim_shm_push(region->servos, pkt, SHM_TIMEOUT_MS)) {
+        printf("SharedMem servo ring full, waiting for physics\n");
+    }
+}
+
+/*
+    receive the state that answers the last servo frame. This is a
+    blocking function
+*/
+void SharedMem::recv_state(void)
+{
+    sim_shm_state state;
+    uint32_t wait_ms = 0;
+    while (true) {
+        if (!sim_shm_pop(region->state, state, SHM_TIMEOUT_MS)) {
+            wait_ms += SHM_TIMEOUT_MS;
+            if (wait_ms >= 1000) {
+                wait_ms = 0;
+                printf("No SharedMem state received from %s\n", shm_name);
+            }
+            continue;
+        }
+        if (state.frame_count == frame_counter && state.servos_sent_ns == last_sent_ns) {
+            break;
+        }
+        // a state answering another servo frame, for example from a
+        // physics process which has not yet seen a SITL restart.
+        // Using it would break lockstep, so drop it and keep waiting
+        dropped_states++;
+        const uint64_t now_ns = sim_shm_time_ns();
+        if (now_ns - last_drop_report_ns > 1000000000ULL) {
+            last_drop_report_ns = now_ns;
+            printf("SharedMem dropped %u states, got frame %u expected %u\n",
+                   (unsigned)dropped_states, (unsigned)state.frame_count, (unsigned)frame_counter);
+        }
+    }
+
+    accel_body = Vector3f(state.accel_body[0], state.accel_body[1], state.accel_body[2]);
+    gyro = Vector3f(state.gyro[0], state.gyro[1], state.gyro[2]);
+    velocity_ef = Vector3f(state.velocity[0], state.velocity[1], state.velocity[2]);
+    position = Vector3f(state.position[0], state.position[1], state.position[2]);
+
+    const Quaternion quat(state.quaternion[0], state.quaternion[1], state.quaternion[2], state.quaternion[3]);
+    quat.rotation_matrix(dcm);
+
+    // velocity relative to airmass in body frame
+    velocity_air_bf = dcm.transposed() * velocity_ef;
+
+    // airspeed
+    airspeed = velocity_air_bf.length();
+
+    // airspeed as seen by a fwd pitot tube (limited to 120m/s)
+    airspeed_pitot = constrain_float(velocity_air_bf * Vector3f(1.0f, 0.0f, 0.0f), 0.0f, 120.0f);
+
+    // Convert from a meters from origin physics to a lat long alt
+    update_position();
+
+    // update range finder distances
+    for (uint8_t i=0; i<ARRAY_SIZE(state.rng); i++) {
+        if (state.fields & (SIM_SHM_FIELD_RNG_1 << i)) {
+            rangefinder_m[i] = state.rng[i];
+        }
+    }
+
+    // update wind vane
+    if (state.fields & SIM_SHM_FIELD_WINDVANE) {
+        wind_vane_apparent.direction = state.windvane_direction;
+        wind_vane_apparent.speed = state.windvane_speed;
+    }
+
+    double deltat;
+    if (state.timestamp_s < last_timestamp_s) {
+        // Physics time has gone backwards, don't reset AP
+        printf("Detected physics reset\n");
+        deltat = 0;
+    } else {
+        deltat = state.timestamp_s - last_timestamp_s;
+    }
+    time_now_us += deltat * 1.0e6;
+
+    if (is_positive(deltat) && deltat < 0.1) {
+        // time in us to hz
+        adjust_frame_time(1.0 / deltat);
+
+        // match actual frame rate with desired speedup
+        time_advance();
+    }
+    last_timestamp_s = state.timestamp_s;
+    frame_counter++;
+}
+
+/*
+   update the simulation by one time step
+*/
+void SharedMem::update(const struct sitl_input &input)
+{
+    if (region == nullptr && !map_region()) {
+        AP_HAL::panic("SharedMem: unable to create %s", shm_name);
+    }
+
+    output_servos(input);
+    recv_state();
+
+    // as the model does not provide mag field we calculate it from position and attitude
+    update_mag_field_bf();
+
+    // allow for changes in physics step
+    adjust_frame_time(constrain_float(sitl->loop_rate_hz, rate_hz-1, rate_hz+1));
+}
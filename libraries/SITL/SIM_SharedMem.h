@@ -0,0 +1,60 @@
+/*
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*
+  simulator connector for external physics over shared memory. This
+  carries the same data as the JSON backend in a fixed binary layout
+  and runs in lockstep with the physics process, without sockets or
+  text parsing. See SIM_SharedMem_Protocol.h for the layout
+ */
+#pragma once
+
+#include "SIM_Aircraft.h"
+#include "SIM_SharedMem_Protocol.h"
+
+namespace SITL {
+
+class SharedMem : public Aircraft {
+public:
+    SharedMem(const char *frame_str);
+
+    /* update model by one time step */
+    void update(const struct sitl_input &input) override;
+
+    /* static object creator */
+    static Aircraft *create(const char *frame_str) {
+        return new SharedMem(frame_str);
+    }
+
+private:
+    // name of the shared memory object, from the frame string or
+    // made from the instance number
+    const char *shm_name;
+
+    sim_shm_region *region;
+
+    uint32_t frame_counter;
+    uint64_t last_sent_ns;      // sent_ns of the last servo frame
+    double last_timestamp_s;
+
+    // states which did not answer the last servo frame
+    uint32_t dropped_states;
+    uint64_t last_drop_report_ns;
+
+    bool map_region(void);
+    void output_servos(const struct sitl_input &input);
+    void recv_state(void);
+};
+
+}
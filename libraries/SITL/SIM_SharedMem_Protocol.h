@@ -0,0 +1,195 @@
+/*
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*
+  layout of the shared memory used by the SharedMem SITL backend to
+  exchange frames with an external physics simulator in lockstep.
+
+  SITL creates a POSIX shared memory object holding one sim_shm_region.
+  Servo frames go to the physics process through one ring and sensor
+  states come back through another. Each ring has a single producer
+  and a single consumer, which wait for each other on the ring
+  counters with futexes. SITL sends a servo frame and waits for the
+  state that answers it, so the two processes run in lockstep.
+
+  Physics backends include this header to get the same layout and
+  ring operations, so it only uses the C++ standard library and the
+  OS. All fields are in host byte order
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#define SIM_SHM_MAGIC          0x314D4853  // "SHM1"
+#define SIM_SHM_VERSION        1
+#define SIM_SHM_RING_LENGTH    4           // must be a power of 2
+#define SIM_SHM_NUM_SERVOS     16
+#define SIM_SHM_DEFAULT_PREFIX "/ardupilot_sitl_" // instance number is appended
+
+// optional fields of sim_shm_state
+#define SIM_SHM_FIELD_RNG_1     (1U<<0)   // rng[0] valid, up to RNG_6
+#define SIM_SHM_FIELD_WINDVANE  (1U<<6)   // windvane_direction and windvane_speed valid
+
+// frame from SITL to physics
+struct sim_shm_servos {
+    uint64_t sent_ns;           // CLOCK_MONOTONIC time the frame was sent
+    uint32_t frame_count;       // incremented for each frame; reset when SITL restarts
+    uint16_t frame_rate;        // requested physics rate (Hz)
+    uint16_t pwm[SIM_SHM_NUM_SERVOS];
+    uint16_t reserved;
+};
+static_assert(sizeof(sim_shm_servos) == 48, "sim_shm_servos layout");
+
+// frame from physics to SITL. Units and frames are the same as the
+// JSON backend
+struct sim_shm_state {
+    uint64_t servos_sent_ns;    // sent_ns of the servo frame this answers
+    uint32_t frame_count;       // frame_count of the servo frame this answers
+    uint32_t fields;            // SIM_SHM_FIELD_* mask of valid optional fields
+    double timestamp_s;         // physics time (s)
+    double position[3];         // NED from the origin (m)
+    float gyro[3];              // body frame (rad/s)
+    float accel_body[3];        // body frame (m/s/s)
+    float velocity[3];          // NED (m/s)
+    float quaternion[4];        // attitude, q1 is the scalar part
+    float rng[6];               // rangefinder distances (m)
+    float windvane_direction;   // apparent wind direction, clockwise from the front (rad)
+    float windvane_speed;       // apparent wind speed (m/s)
+    float reserved;
+};
+static_assert(sizeof(sim_shm_state) == 136, "sim_shm_state layout");
+
+/*
+  single producer, single consumer ring. head and tail count the
+  frames written and read, and are each on their own cache line
+ */
+template <typename T>
+struct sim_shm_ring {
+    alignas(64) uint32_t head;
+    alignas(64) uint32_t tail;
+    alignas(64) T slot[SIM_SHM_RING_LENGTH];
+};
+
+struct sim_shm_region {
+    uint32_t magic;             // set last when SITL has initialised the region
+    uint16_t version;
+    uint16_t ring_length;
+    uint32_t region_size;       // sizeof(sim_shm_region)
+    uint32_t generation;        // incremented each time SITL starts
+    sim_shm_ring<sim_shm_servos> servos;    // SITL to physics
+    sim_shm_ring<sim_shm_state> state;      // physics to SITL
+};
+
+static inline uint64_t sim_shm_time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+  wait for *word to change from val, for up to timeout_ms. A frame
+  normally comes back within a few microseconds in lockstep, so spin
+  briefly before sleeping. Returns false on timeout
+ */
+static inline bool sim_shm_wait(uint32_t *word, uint32_t val, uint32_t timeout_ms)
+{
+    for (uint16_t i=0; i<1000; i++) {
+        if (__atomic_load_n(word, __ATOMIC_ACQUIRE) != val) {
+            return true;
+        }
+    }
+#ifdef __linux__
+    struct timespec ts;
+    ts.tv_sec = timeout_ms / 1000;
+    ts.tv_nsec = (timeout_ms % 1000) * 1000000L;
+    // the region is shared between processes so this is not a
+    // private futex
+    syscall(SYS_futex, word, FUTEX_WAIT, val, &ts, nullptr, 0);
+#else
+    const uint64_t end_ns = sim_shm_time_ns() + timeout_ms * 1000000ULL;
+    while (__atomic_load_n(word, __ATOMIC_ACQUIRE) == val && sim_shm_time_ns() < end_ns) {
+        usleep(10);
+    }
+#endif
+    return __atomic_load_n(word, __ATOMIC_ACQUIRE) != val;
+}
+
+static inline void sim_shm_wake(uint32_t *word)
+{
+#ifdef __linux__
+    syscall(SYS_futex, word, FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#else
+    (void)word;
+#endif
+}
+
+/*
+  add a frame to a ring, waiting for space. Returns false on timeout
+ */
+template <typename T>
+static inline bool sim_shm_push(sim_shm_ring<T> &ring, const T &frame, uint32_t timeout_ms)
+{
+    const uint32_t head = __atomic_load_n(&ring.head, __ATOMIC_RELAXED);
+    uint32_t tail;
+    while (head - (tail = __atomic_load_n(&ring.tail, __ATOMIC_ACQUIRE)) >= SIM_SHM_RING_LENGTH) {
+        if (!sim_shm_wait(&ring.tail, tail, timeout_ms)) {
+            return false;
+        }
+    }
+    memcpy(&ring.slot[head % SIM_SHM_RING_LENGTH], &frame, sizeof(frame));
+    __atomic_store_n(&ring.head, head+1, __ATOMIC_RELEASE);
+    sim_shm_wake(&ring.head);
+    return true;
+}
+
+/*
+  take the oldest frame from a ring if there is one, without
+  waiting. This lets one thread serve several rings by polling them
+ */
+template <typename T>
+static inline bool sim_shm_try_pop(sim_shm_ring<T> &ring, T &frame)
+{
+    const uint32_t tail = __atomic_load_n(&ring.tail, __ATOMIC_RELAXED);
+    if (__atomic_load_n(&ring.head, __ATOMIC_ACQUIRE) == tail) {
+        return false;
+    }
+    memcpy(&frame, &ring.slot[tail % SIM_SHM_RING_LENGTH], sizeof(frame));
+    __atomic_store_n(&ring.tail, tail+1, __ATOMIC_RELEASE);
+    sim_shm_wake(&ring.tail);
+    return true;
+}
+
+/*
+  take the oldest frame from a ring, waiting for one to arrive.
+  Returns false on timeout
+ */
+template <typename T>
+static inline bool sim_shm_pop(sim_shm_ring<T> &ring, T &frame, uint32_t timeout_ms)
+{
+    while (!sim_shm_try_pop(ring, frame)) {
+        const uint32_t tail = __atomic_load_n(&ring.tail, __ATOMIC_RELAXED);
+        if (!sim_shm_wait(&ring.head, tail, timeout_ms)) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,810 @@
+/*
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*
+  stand-in physics process for the SharedMem and JSON SITL backends.
+  The vehicle stays level and moves vertically with the mean thrust
+  of the first four motors, which is enough to arm and take off.
+
+  physics_standin shm [NAME]     serve SITL started with -f shm[:NAME]
+  physics_standin json [PORT]    serve SITL started with -f JSON
+  physics_standin bench [FRAMES] compare the two transports, with a
+                                 child process taking the place of SITL
+  physics_standin swarm COUNT [PREFIX]
+                                 serve COUNT SITL instances from one
+                                 thread, at PREFIX0 to PREFIX<COUNT-1>
+  physics_standin swarm-bench [MAX_COUNT] [RATE_HZ]
+                                 find how many vehicles one physics
+                                 thread can step at real time
+
+  build with: g++ -O2 -std=gnu++11 physics_standin.cpp -o physics_standin -lrt
+ */
+
+#include "../../SIM_SharedMem_Protocol.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#define GRAVITY_MSS 9.80665
+#define JSON_MAGIC 18458
+
+// servo packet of the JSON backend
+struct json_servo_packet {
+    uint16_t magic;
+    uint16_t frame_rate;
+    uint32_t frame_count;
+    uint16_t pwm[16];
+};
+
+class Physics {
+public:
+    void reset(void) {
+        *this = Physics();
+    }
+
+    // advance by one frame and fill in the state sent to SITL
+    void step(const uint16_t pwm[], uint16_t frame_rate, sim_shm_state &s) {
+        const double dt = 1.0 / (frame_rate > 0 ? frame_rate : 1200);
+        float throttle = 0;
+        for (uint8_t i=0; i<4; i++) {
+            throttle += std::min(std::max((pwm[i] - 1000) * 0.001f, 0.0f), 1.0f) * 0.25f;
+        }
+        // hover at half throttle
+        double accel_down = GRAVITY_MSS * (1 - 2 * throttle);
+        vel_down += accel_down * dt;
+        pos_down += vel_down * dt;
+        if (pos_down >= 0) {
+            pos_down = 0;
+            vel_down = std::min(vel_down, 0.0);
+            accel_down = std::min(accel_down, 0.0);
+        }
+        t += dt;
+
+        memset(&s, 0, sizeof(s));
+        s.timestamp_s = t;
+        s.position[2] = pos_down;
+        s.velocity[2] = vel_down;
+        s.accel_body[2] = accel_down - GRAVITY_MSS;
+        s.quaternion[0] = 1;
+    }
+
+private:
+    double t = 0;
+    double pos_down = 0;
+    double vel_down = 0;
+};
+
+static uint64_t now_ns(void)
+{
+    return sim_shm_time_ns();
+}
+
+/*
+  JSON text for a state, in the format the JSON backend parses
+ */
+static int format_json(const sim_shm_state &s, char *buf, size_t len)
+{
+    return snprintf(buf, len,
+                    "\n{\"timestamp\":%f,"
+                    "\"imu\":{\"gyro\":[%f, %f, %f],\"accel_body\":[%f, %f, %f]},"
+                    "\"position\":[%f, %f, %f],"
+                    "\"quaternion\":[%f, %f, %f, %f],"
+                    "\"velocity\":[%f, %f, %f]}\n",
+                    s.timestamp_s,
+                    s.gyro[0], s.gyro[1], s.gyro[2],
+                    s.accel_body[0], s.accel_body[1], s.accel_body[2],
+                    s.position[0], s.position[1], s.position[2],
+                    s.quaternion[0], s.quaternion[1], s.quaternion[2], s.quaternion[3],
+                    s.velocity[0], s.velocity[1], s.velocity[2]);
+}
+
+/*
+  parse JSON text the way the JSON backend does, so the benchmark
+  includes the cost of parsing
+ */
+static bool parse_json(const char *json, sim_shm_state &s)
+{
+    const char *p;
+    if ((p = strstr(json, "timestamp")) == nullptr) {
+        return false;
+    }
+    s.timestamp_s = atof(p + strlen("timestamp") + 2);
+    if ((p = strstr(json, "gyro")) == nullptr ||
+        sscanf(p + strlen("gyro") + 2, "[%f, %f, %f]", &s.gyro[0], &s.gyro[1], &s.gyro[2]) != 3) {
+        return false;
+    }
+    if ((p = strstr(json, "accel_body")) == nullptr ||
+        sscanf(p + strlen("accel_body") + 2, "[%f, %f, %f]", &s.accel_body[0], &s.accel_body[1], &s.accel_body[2]) != 3) {
+        return false;
+    }
+    float pos[3];
+    if ((p = strstr(json, "position")) == nullptr ||
+        sscanf(p + strlen("position") + 2, "[%f, %f, %f]", &pos[0], &pos[1], &pos[2]) != 3) {
+        return false;
+    }
+    for (uint8_t i=0; i<3; i++) {
+        s.position[i] = pos[i];
+    }
+    if ((p = strstr(json, "quaternion")) == nullptr ||
+        sscanf(p + strlen("quaternion") + 2, "[%f, %f, %f, %f]", &s.quaternion[0], &s.quaternion[1], &s.quaternion[2], &s.quaternion[3]) != 4) {
+        return false;
+    }
+    if ((p = strstr(json, "velocity")) == nullptr ||
+        sscanf(p + strlen("velocity") + 2, "[%f, %f, %f]", &s.velocity[0], &s.velocity[1], &s.velocity[2]) != 3) {
+        return false;
+    }
+    return true;
+}
+
+/*
+  frame rate and latency over a reporting period
+ */
+class Stats {
+public:
+    void add(uint64_t latency_ns) {
+        latencies.push_back(latency_ns);
+    }
+
+    void report(const char *label, double elapsed_s) {
+        if (latencies.empty()) {
+            printf("%-10s no frames\n", label);
+            return;
+        }
+        std::sort(latencies.begin(), latencies.end());
+        double sum = 0;
+        for (uint64_t l : latencies) {
+            sum += l;
+        }
+        printf("%-10s %9.0f frames/s  latency mean %7.2f us  p50 %7.2f us  p99 %7.2f us\n",
+               label,
+               latencies.size() / elapsed_s,
+               sum * 1.0e-3 / latencies.size(),
+               latencies[latencies.size() / 2] * 1.0e-3,
+               latencies[latencies.size() * 99 / 100] * 1.0e-3);
+        latencies.clear();
+    }
+
+private:
+    std::vector<uint64_t> latencies;
+};
+
+static sim_shm_region *open_region(const char *name, bool create)
+{
+    const int fd = shm_open(name, create ? (O_RDWR | O_CREAT) : O_RDWR, 0600);
+    if (fd == -1) {
+        return nullptr;
+    }
+    if (create && ftruncate(fd, sizeof(sim_shm_region)) != 0) {
+        close(fd);
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(sim_shm_region)) {
+        close(fd);
+        return nullptr;
+    }
+    void *p = mmap(nullptr, sizeof(sim_shm_region), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    return p == MAP_FAILED ? nullptr : (sim_shm_region *)p;
+}
+
+// initialise a region the way SITL does
+static void init_region(sim_shm_region *region)
+{
+    memset((void *)region, 0, sizeof(*region));
+    region->version = SIM_SHM_VERSION;
+    region->ring_length = SIM_SHM_RING_LENGTH;
+    region->region_size = sizeof(sim_shm_region);
+    region->generation = 1;
+    __atomic_store_n(&region->magic, uint32_t(SIM_SHM_MAGIC), __ATOMIC_RELEASE);
+}
+
+static bool region_valid(const sim_shm_region *region)
+{
+    return __atomic_load_n(&region->magic, __ATOMIC_ACQUIRE) == SIM_SHM_MAGIC &&
+        region->version == SIM_SHM_VERSION &&
+        region->ring_length == SIM_SHM_RING_LENGTH &&
+        region->region_size == sizeof(sim_shm_region);
+}
+
+/*
+  answer servo frames from a region until frames frames have been
+  answered, or forever if frames is zero. Returns if SITL goes away
+ */
+static void serve_region(sim_shm_region *region, uint32_t frames, bool verbose)
+{
+    uint32_t generation = region->generation;
+    Physics physics;
+    Stats stats;
+    uint64_t report_ns = now_ns();
+    for (uint32_t n=0; frames == 0 || n < frames; ) {
+        sim_shm_servos servos;
+        if (!sim_shm_pop(region->servos, servos, 100)) {
+            if (!region_valid(region)) {
+                return;
+            }
+            continue;
+        }
+        if (region->generation != generation) {
+            // SITL restarted while we were waiting for a frame
+            printf("SITL restarted\n");
+            generation = region->generation;
+            physics.reset();
+        }
+        const uint64_t recv_ns = now_ns();
+        sim_shm_state state;
+        physics.step(servos.pwm, servos.frame_rate, state);
+        state.servos_sent_ns = servos.sent_ns;
+        state.frame_count = servos.frame_count;
+        if (!sim_shm_push(region->state, state, 1000)) {
+            return;
+        }
+        n++;
+        if (verbose) {
+            stats.add(recv_ns - servos.sent_ns);
+            if (recv_ns - report_ns > 5000000000ULL) {
+                stats.report("shm", (recv_ns - report_ns) * 1.0e-9);
+                report_ns = recv_ns;
+            }
+        }
+    }
+}
+
+static int serve_shm(const char *name)
+{
+    printf("Waiting for SITL at %s\n", name);
+    while (true) {
+        sim_shm_region *region = open_region(name, false);
+        if (region == nullptr || !region_valid(region)) {
+            if (region != nullptr) {
+                munmap(region, sizeof(*region));
+            }
+            usleep(100000);
+            continue;
+        }
+        printf("Connected to SITL generation %u\n", (unsigned)region->generation);
+        serve_region(region, 0, true);
+        printf("Lost SITL\n");
+        munmap(region, sizeof(*region));
+    }
+    return 0;
+}
+
+static int open_udp(uint16_t port)
+{
+    const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd == -1) {
+        return -1;
+    }
+    struct sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (port != 0 && bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/*
+  answer JSON servo packets on fd until frames packets have been
+  answered, or forever if frames is zero
+ */
+static void serve_udp(int fd, uint32_t frames, bool verbose)
+{
+    Physics physics;
+    Stats stats;
+    uint64_t report_ns = now_ns();
+    uint32_t last_frame_count = 0;
+    for (uint32_t n=0; frames == 0 || n < frames; ) {
+        json_servo_packet pkt;
+        struct sockaddr_in from;
+        socklen_t fromlen = sizeof(from);
+        const ssize_t ret = recvfrom(fd, &pkt, sizeof(pkt), 0, (struct sockaddr *)&from, &fromlen);
+        if (ret != sizeof(pkt) || pkt.magic != JSON_MAGIC) {
+            continue;
+        }
+        if (pkt.frame_count < last_frame_count) {
+            printf("SITL restarted\n");
+            physics.reset();
+        }
+        last_frame_count = pkt.frame_count;
+
+        sim_shm_state state;
+        physics.step(pkt.pwm, pkt.frame_rate, state);
+        char json[1024];
+        const int len = format_json(state, json, sizeof(json));
+        sendto(fd, json, len, 0, (struct sockaddr *)&from, fromlen);
+        n++;
+        if (verbose) {
+            // no send time in the JSON packet, so only the rate is known
+            stats.add(0);
+            const uint64_t t = now_ns();
+            if (t - report_ns > 5000000000ULL) {
+                stats.report("json", (t - report_ns) * 1.0e-9);
+                report_ns = t;
+            }
+        }
+    }
+}
+
+/*
+  SITL side of the benchmark over shared memory: send servos and wait
+  for the state, measuring the round trip
+ */
+static void bench_shm_client(sim_shm_region *region, uint32_t frames, Stats &stats)
+{
+    sim_shm_servos servos {};
+    for (uint8_t i=0; i<SIM_SHM_NUM_SERVOS; i++) {
+        servos.pwm[i] = 1500;
+    }
+    servos.frame_rate = 1200;
+    for (uint32_t n=0; n<frames; n++) {
+        servos.frame_count = n;
+        servos.sent_ns = now_ns();
+        sim_shm_state state;
+        if (!sim_shm_push(region->servos, servos, 1000) ||
+            !sim_shm_pop(region->state, state, 1000)) {
+            printf("shm benchmark timed out\n");
+            exit(1);
+        }
+        if (state.frame_count != servos.frame_count || state.servos_sent_ns != servos.sent_ns) {
+            printf("shm benchmark got the state for frame %u in answer to %u\n",
+                   (unsigned)state.frame_count, (unsigned)servos.frame_count);
+            exit(1);
+        }
+        stats.add(now_ns() - servos.sent_ns);
+    }
+}
+
+/*
+  SITL side of the benchmark over UDP with JSON, as the JSON backend
+  does it
+ */
+static void bench_udp_client(int fd, uint16_t port, uint32_t frames, Stats &stats)
+{
+    struct sockaddr_in to {};
+    to.sin_family = AF_INET;
+    to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    to.sin_port = htons(port);
+
+    json_servo_packet pkt {};
+    pkt.magic = JSON_MAGIC;
+    pkt.frame_rate = 1200;
+    for (uint8_t i=0; i<16; i++) {
+        pkt.pwm[i] = 1500;
+    }
+    char buf[1024];
+    for (uint32_t n=0; n<frames; n++) {
+        pkt.frame_count = n;
+        const uint64_t sent_ns = now_ns();
+        if (sendto(fd, &pkt, sizeof(pkt), 0, (struct sockaddr *)&to, sizeof(to)) != sizeof(pkt)) {
+            printf("send failed: %s\n", strerror(errno));
+            exit(1);
+        }
+        const ssize_t ret = recv(fd, buf, sizeof(buf)-1, 0);
+        if (ret <= 0) {
+            printf("json benchmark timed out\n");
+            exit(1);
+        }
+        buf[ret] = 0;
+        sim_shm_state state;
+        if (!parse_json(buf, state)) {
+            printf("bad JSON from physics\n");
+            exit(1);
+        }
+        stats.add(now_ns() - sent_ns);
+    }
+}
+
+static int bench(uint32_t frames)
+{
+    printf("Round trip of %u lockstep frames between two processes\n", (unsigned)frames);
+
+    // UDP and JSON, as used by the JSON backend
+    {
+        const uint16_t port = 19002;
+        const int server = open_udp(port);
+        const int client = open_udp(0);
+        if (server == -1 || client == -1) {
+            printf("Failed to open UDP sockets: %s\n", strerror(errno));
+            return 1;
+        }
+        struct timeval tv { 1, 0 };
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        const pid_t pid = fork();
+        if (pid == 0) {
+            serve_udp(server, frames, false);
+            _exit(0);
+        }
+        Stats stats;
+        const uint64_t start_ns = now_ns();
+        bench_udp_client(client, port, frames, stats);
+        stats.report("udp+json", (now_ns() - start_ns) * 1.0e-9);
+        waitpid(pid, nullptr, 0);
+        close(server);
+        close(client);
+    }
+
+    // shared memory, as used by the SharedMem backend
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "/ardupilot_sitl_bench_%d", (int)getpid());
+        sim_shm_region *region = open_region(name, true);
+        if (region == nullptr) {
+            printf("Failed to create %s: %s\n", name, strerror(errno));
+            return 1;
+        }
+        init_region(region);
+        const pid_t pid = fork();
+        if (pid == 0) {
+            serve_region(region, frames, false);
+            _exit(0);
+        }
+        Stats stats;
+        const uint64_t start_ns = now_ns();
+        bench_shm_client(region, frames, stats);
+        stats.report("shm", (now_ns() - start_ns) * 1.0e-9);
+        waitpid(pid, nullptr, 0);
+        munmap(region, sizeof(*region));
+        shm_unlink(name);
+    }
+    return 0;
+}
+
+/*
+  physics for a swarm of SITL vehicles, one shared memory region each,
+  stepped in batches from a single thread. Each pass collects the
+  servo frames that are waiting, steps every vehicle that has one and
+  then answers them all, so the cost per frame stays low as the swarm
+  grows
+ */
+class Swarm {
+public:
+    Swarm(uint16_t count, const char *prefix, bool _verbose) :
+        vehicles(count),
+        verbose(_verbose)
+    {
+        for (uint16_t i=0; i<count; i++) {
+            snprintf(vehicles[i].name, sizeof(vehicles[i].name), "%s%u", prefix, (unsigned)i);
+        }
+    }
+
+    ~Swarm(void) {
+        for (Vehicle &v : vehicles) {
+            if (v.region != nullptr) {
+                munmap(v.region, sizeof(*v.region));
+            }
+        }
+    }
+
+    // one pass over the swarm, returning the number of frames answered
+    uint16_t update(void);
+
+    // poll the swarm, sleeping briefly when no vehicle has a frame
+    void run(uint64_t duration_ns);
+
+    // time spent stepping and answering frames
+    uint64_t busy_ns = 0;
+
+private:
+    struct Vehicle {
+        char name[64];
+        sim_shm_region *region = nullptr;
+        uint32_t generation = 0;
+        Physics physics;
+        bool ready = false;
+        sim_shm_servos servos;
+        sim_shm_state state;
+    };
+    std::vector<Vehicle> vehicles;
+    const bool verbose;
+    uint64_t last_attach_ns = 0;
+
+    void attach(void);
+};
+
+/*
+  map the regions of vehicles that have started since the last try
+ */
+void Swarm::attach(void)
+{
+    for (Vehicle &v : vehicles) {
+        if (v.region != nullptr) {
+            continue;
+        }
+        v.region = open_region(v.name, false);
+        if (v.region != nullptr) {
+            if (verbose) {
+                printf("Attached %s\n", v.name);
+            }
+            v.generation = v.region->generation;
+        }
+    }
+}
+
+uint16_t Swarm::update(void)
+{
+    const uint64_t start_ns = now_ns();
+    if (start_ns - last_attach_ns > 1000000000ULL) {
+        last_attach_ns = start_ns;
+        attach();
+    }
+
+    uint16_t count = 0;
+    for (Vehicle &v : vehicles) {
+        v.ready = v.region != nullptr && region_valid(v.region) &&
+            sim_shm_try_pop(v.region->servos, v.servos);
+        count += v.ready;
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    for (Vehicle &v : vehicles) {
+        if (!v.ready) {
+            continue;
+        }
+        if (v.region->generation != v.generation) {
+            if (verbose) {
+                printf("%s restarted\n", v.name);
+            }
+            v.generation = v.region->generation;
+            v.physics.reset();
+        }
+        v.physics.step(v.servos.pwm, v.servos.frame_rate, v.state);
+        v.state.servos_sent_ns = v.servos.sent_ns;
+        v.state.frame_count = v.servos.frame_count;
+    }
+
+    for (Vehicle &v : vehicles) {
+        // in lockstep the state ring always has space
+        if (v.ready && !sim_shm_push(v.region->state, v.state, 100)) {
+            printf("%s is not reading its state\n", v.name);
+        }
+    }
+
+    busy_ns += now_ns() - start_ns;
+    return count;
+}
+
+void Swarm::run(uint64_t duration_ns)
+{
+    const uint64_t start_ns = now_ns();
+    uint64_t report_ns = start_ns;
+    uint64_t report_busy_ns = busy_ns;
+    uint64_t frames = 0;
+    uint32_t idle_passes = 0;
+    while (duration_ns == 0 || now_ns() - start_ns < duration_ns) {
+        const uint16_t count = update();
+        frames += count;
+        if (count > 0) {
+            idle_passes = 0;
+        } else if (++idle_passes > 100) {
+            // the vehicles are busy with their own loops; give them the CPU
+            usleep(20);
+        }
+        if (verbose) {
+            const uint64_t t = now_ns();
+            if (t - report_ns > 5000000000ULL) {
+                const double dt = (t - report_ns) * 1.0e-9;
+                printf("%9.0f frames/s  physics busy %5.1f%%\n",
+                       frames / dt, (busy_ns - report_busy_ns) * 1.0e-7 / dt);
+                frames = 0;
+                report_ns = t;
+                report_busy_ns = busy_ns;
+            }
+        }
+    }
+}
+
+static int serve_swarm(uint16_t count, const char *prefix)
+{
+    printf("Serving %u vehicles at %s0 to %s%u\n", (unsigned)count, prefix, prefix, (unsigned)(count-1));
+    Swarm swarm(count, prefix, true);
+    swarm.run(0);
+    return 0;
+}
+
+/*
+  frames answered for one emulated vehicle of the swarm benchmark
+ */
+struct SwarmBenchResult {
+    uint64_t frames;
+    uint64_t elapsed_ns;
+};
+
+/*
+  SITL side of the swarm benchmark: a vehicle running its physics in
+  lockstep at real time
+ */
+static void swarm_bench_client(sim_shm_region *region, uint16_t rate_hz, uint64_t duration_ns, SwarmBenchResult &result)
+{
+    sim_shm_servos servos {};
+    for (uint8_t i=0; i<SIM_SHM_NUM_SERVOS; i++) {
+        servos.pwm[i] = 1500;
+    }
+    servos.frame_rate = rate_hz;
+    const uint64_t period_ns = 1000000000ULL / rate_hz;
+    const uint64_t start_ns = now_ns();
+    uint64_t next_ns = start_ns;
+    uint64_t frames = 0;
+    while (next_ns - start_ns < duration_ns) {
+        struct timespec ts;
+        ts.tv_sec = next_ns / 1000000000ULL;
+        ts.tv_nsec = next_ns % 1000000000ULL;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+        next_ns += period_ns;
+
+        servos.frame_count = frames;
+        servos.sent_ns = now_ns();
+        sim_shm_state state;
+        if (!sim_shm_push(region->servos, servos, 1000) ||
+            !sim_shm_pop(region->state, state, 1000)) {
+            break;
+        }
+        frames++;
+    }
+    result.frames = frames;
+    result.elapsed_ns = now_ns() - start_ns;
+}
+
+/*
+  run count emulated vehicles against one swarm physics thread, returning
+  the fraction of real time the slowest vehicle achieved
+ */
+static double swarm_bench_run(uint16_t count, uint16_t rate_hz, uint64_t duration_ns, double &busy)
+{
+    char prefix[48];
+    snprintf(prefix, sizeof(prefix), "/ardupilot_sitl_swarm_%d_", (int)getpid());
+
+    SwarmBenchResult *results = (SwarmBenchResult *)mmap(nullptr, count * sizeof(SwarmBenchResult),
+                                                         PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (results == MAP_FAILED) {
+        printf("Failed to map results\n");
+        exit(1);
+    }
+    std::vector<pid_t> pids;
+    for (uint16_t i=0; i<count; i++) {
+        char name[64];
+        snprintf(name, sizeof(name), "%s%u", prefix, (unsigned)i);
+        sim_shm_region *region = open_region(name, true);
+        if (region == nullptr) {
+            printf("Failed to create %s: %s\n", name, strerror(errno));
+            exit(1);
+        }
+        init_region(region);
+        const pid_t pid = fork();
+        if (pid == 0) {
+            swarm_bench_client(region, rate_hz, duration_ns, results[i]);
+            _exit(0);
+        }
+        munmap(region, sizeof(*region));
+        pids.push_back(pid);
+    }
+
+    Swarm swarm(count, prefix, false);
+    const uint64_t start_ns = now_ns();
+    // serve until every vehicle has finished so none is left waiting
+    swarm.run(duration_ns);
+    uint16_t running = count;
+    while (running > 0) {
+        swarm.update();
+        int status;
+        while (running > 0 && waitpid(-1, &status, WNOHANG) > 0) {
+            running--;
+        }
+    }
+    busy = swarm.busy_ns / double(now_ns() - start_ns);
+
+    double slowest = 1;
+    for (uint16_t i=0; i<count; i++) {
+        const double expected = results[i].elapsed_ns * 1.0e-9 * rate_hz;
+        slowest = std::min(slowest, expected > 0 ? results[i].frames / expected : 0);
+        char name[64];
+        snprintf(name, sizeof(name), "%s%u", prefix, (unsigned)i);
+        shm_unlink(name);
+    }
+    munmap(results, count * sizeof(SwarmBenchResult));
+    return slowest;
+}
+
+/*
+  double the swarm until the vehicles can no longer keep real time,
+  and report how many vehicles one physics core can step at real time
+ */
+static int swarm_bench(uint16_t max_count, uint16_t rate_hz)
+{
+    const uint64_t duration_ns = 2000000000ULL;
+    printf("Vehicles in lockstep at %u Hz with one physics thread\n", (unsigned)rate_hz);
+    printf("vehicles  real-time  physics busy  vehicles/core\n");
+    uint16_t best = 0;
+    double best_per_core = 0;
+    for (uint16_t count=1; count<=max_count; count*=2) {
+        double busy;
+        const double rt = swarm_bench_run(count, rate_hz, duration_ns, busy);
+        const double per_core = busy > 0 ? count / busy : 0;
+        printf("%8u  %9.3f  %11.1f%%  %13.0f\n", (unsigned)count, rt, busy*100, per_core);
+        if (rt < 0.98) {
+            break;
+        }
+        best = count;
+        best_per_core = per_core;
+    }
+    if (best == 0) {
+        printf("A single vehicle could not keep real time\n");
+        return 1;
+    }
+    printf("%u vehicles kept real time; one physics core would step about %.0f\n", (unsigned)best, best_per_core);
+    return 0;
+}
+
+static void usage(void)
+{
+    printf("Usage: physics_standin shm [NAME] | json [PORT] | bench [FRAMES] |\n"
+           "       swarm COUNT [PREFIX] | swarm-bench [MAX_COUNT] [RATE_HZ]\n");
+}
+
+int main(int argc, const char *argv[])
+{
+    if (argc < 2) {
+        usage();
+        return 1;
+    }
+    if (strcmp(argv[1], "shm") == 0) {
+        return serve_shm(argc > 2 ? argv[2] : SIM_SHM_DEFAULT_PREFIX "0");
+    }
+    if (strcmp(argv[1], "json") == 0) {
+        const uint16_t port = argc > 2 ? atoi(argv[2]) : 9002;
+        const int fd = open_udp(port);
+        if (fd == -1) {
+            printf("Failed to listen on port %u: %s\n", (unsigned)port, strerror(errno));
+            return 1;
+        }
+        printf("Waiting for SITL on UDP port %u\n", (unsigned)port);
+        serve_udp(fd, 0, true);
+        return 0;
+    }
+    if (strcmp(argv[1], "swarm") == 0 && argc > 2) {
+        const uint16_t count = atoi(argv[2]);
+        if (count == 0) {
+            usage();
+            return 1;
+        }
+        return serve_swarm(count, argc > 3 ? argv[3] : SIM_SHM_DEFAULT_PREFIX);
+    }
+    if (strcmp(argv[1], "swarm-bench") == 0) {
+        return swarm_bench(argc > 2 ? atoi(argv[2]) : 256,
+                           argc > 3 ? atoi(argv[3]) : 1200);
+    }
+    if (strcmp(argv[1], "bench") == 0) {
+        return bench(argc > 2 ? atoi(argv[2]) : 100000);
+    }
+    usage();
+    return 1;
+}